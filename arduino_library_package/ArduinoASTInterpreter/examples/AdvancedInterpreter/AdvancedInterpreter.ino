@@ -250,6 +250,15 @@
 // Default AST file to load (filesystem mode only)
 #define DEFAULT_AST_FILE "/blink.ast"
 
+// Resident program cache (filesystem mode only): bytes kept per memory
+// region. Cached .ast copies go to internal RAM or PSRAM (the PSRAM budget
+// applies only when PSRAM is found). Parsed spares live on the internal heap
+// and count against the internal budget; one is built only while the
+// internal heap keeps PROGRAM_CACHE_HEAP_RESERVE bytes free besides it.
+#define PROGRAM_CACHE_INTERNAL_BYTES (48 * 1024)
+#define PROGRAM_CACHE_PSRAM_BYTES (1024 * 1024)
+#define PROGRAM_CACHE_HEAP_RESERVE (32 * 1024)
+
 // LED pin for Blink program
 #define BLINK_LED LED_BUILTIN
 
@@ -281,6 +290,8 @@ enum AppExecutionState {
 #include "CommandExecutor.h"
 #include "ESP32DataProvider.h"
 #include "SerialMenu.h"
+#include <mutex>
+#include "esp_heap_caps.h"
 #endif
 
 #include "FS.h"
@@ -357,7 +368,8 @@ CommandExecutor executor;
 ImmediateCommandExecutor immediateExecutor(&executor);  // Zero-copy command execution
 ESP32DataProvider dataProvider;
 ASTInterpreter* interpreter = nullptr;
-uint8_t* astBuffer = nullptr;
+ProgramCache* programCache = nullptr;   // Parsed programs kept resident between switches
+std::mutex programCacheMutex;           // Web handlers switch programs from their own task
 #endif
 
 // Network and Configuration
@@ -409,6 +421,94 @@ uint8_t* readASTFromFile(const char* path, size_t* size) {
     Serial.println("✓ File read successfully");
     return buffer;
 }
+
+// ============================================================================
+// PROGRAM CACHE
+// ============================================================================
+
+InterpreterOptions sketchInterpreterOptions() {
+    InterpreterOptions opts;
+    opts.verbose = false;     // Status-only mode (no command stream to Serial)
+    opts.debug = false;
+    opts.maxLoopIterations = 1;  // Run ONE iteration per call (parent controls repetition)
+    opts.enforceLoopLimitsOnInternalLoops = false;  // Allow unlimited for/while/do-while loops
+    opts.syncMode = true;
+    return opts;
+}
+
+void* programCacheAllocate(size_t size, MemoryRegion region) {
+    uint32_t caps = region == MemoryRegion::PSRAM ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL;
+    return heap_caps_malloc(size, caps | MALLOC_CAP_8BIT);
+}
+
+void programCacheRelease(void* data, MemoryRegion) {
+    heap_caps_free(data);
+}
+
+size_t programCacheFreeHeap() {
+    return heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+void initProgramCache() {
+    #if USE_FILESYSTEM
+    ProgramCacheOptions cacheOptions;
+    cacheOptions.internalBudget = PROGRAM_CACHE_INTERNAL_BYTES;
+    cacheOptions.psramBudget = psramFound() ? PROGRAM_CACHE_PSRAM_BYTES : 0;
+    cacheOptions.allocate = programCacheAllocate;
+    cacheOptions.release = programCacheRelease;
+    cacheOptions.freeHeap = programCacheFreeHeap;
+    cacheOptions.heapReserve = PROGRAM_CACHE_HEAP_RESERVE;
+    programCache = new ProgramCache(cacheOptions, sketchInterpreterOptions());
+    #endif
+}
+
+bool isProgramCached(const char* filename) {
+    std::lock_guard<std::mutex> lock(programCacheMutex);
+    return programCache && programCache->contains(filename);
+}
+
+/**
+ * Drop a cached program whose file changed (called by WebAPI on upload/delete)
+ */
+void forgetCachedProgram(const char* filename) {
+    std::lock_guard<std::mutex> lock(programCacheMutex);
+    if (programCache) {
+        programCache->invalidate(filename);
+    }
+}
+
+/**
+ * Create an interpreter for an .ast file. A cached program comes back
+ * without reading the file (and without parsing when its spare is ready);
+ * any other file is read from LittleFS and cached for the next switch.
+ */
+ASTInterpreter* createInterpreterFor(const char* filename) {
+    std::lock_guard<std::mutex> lock(programCacheMutex);
+    if (programCache) {
+        std::unique_ptr<ASTInterpreter> cached = programCache->take(filename);
+        if (cached) {
+            Serial.println("  Using cached program");
+            return cached.release();
+        }
+    }
+
+    size_t astSize = 0;
+    uint8_t* buffer = readASTFromFile(filename, &astSize);
+    if (!buffer) {
+        return nullptr;
+    }
+
+    ASTInterpreter* created = nullptr;
+    if (programCache && programCache->insert(filename, buffer, astSize)) {
+        created = programCache->take(filename).release();
+    } else {
+        created = new ASTInterpreter(buffer, astSize, sketchInterpreterOptions());
+    }
+
+    // Free filesystem buffer (interpreter and cache have their own copies)
+    free(buffer);
+    return created;
+}
 #endif // USE_INTERPRETER
 
 // ============================================================================
@@ -428,16 +528,19 @@ bool loadASTFile(const char* filename) {
     return false;
     #else
 
-    // Check if filesystem is initialized
-    if (!initFilesystem()) {
-        Serial.println("✗ ERROR: Filesystem initialization failed");
-        return false;
-    }
+    // A cached program is switched to without touching the filesystem
+    if (!isProgramCached(filename)) {
+        // Check if filesystem is initialized
+        if (!initFilesystem()) {
+            Serial.println("✗ ERROR: Filesystem initialization failed");
+            return false;
+        }
 
-    // Check if file exists
-    if (!LittleFS.exists(filename)) {
-        Serial.println("✗ ERROR: File not found");
-        return false;
+        // Check if file exists
+        if (!LittleFS.exists(filename)) {
+            Serial.println("✗ ERROR: File not found");
+            return false;
+        }
     }
 
     // Stop current execution
@@ -452,50 +555,21 @@ bool loadASTFile(const char* filename) {
         interpreter = nullptr;
     }
 
-    // Free old AST buffer
-    if (astBuffer) {
-        free(astBuffer);
-        astBuffer = nullptr;
-    }
-
     // Reset statistics
     immediateExecutor.resetStats();
     loopIteration = 0;
     commandsExecuted = 0;
     startTime = millis();
 
-    // Load new AST file
-    size_t astSize = 0;
-    astBuffer = readASTFromFile(filename, &astSize);
-
-    if (!astBuffer) {
-        Serial.println("✗ ERROR: Failed to read AST file");
-        return false;
-    }
-
-    // Configure interpreter options
-    InterpreterOptions opts;
-    opts.verbose = false;     // Status-only mode
-    opts.debug = false;
-    opts.maxLoopIterations = 1;  // Run ONE iteration per call
-    opts.enforceLoopLimitsOnInternalLoops = false;  // Allow unlimited for/while/do-while loops
-    opts.syncMode = true;
-
-    // Create new interpreter
+    // Create new interpreter (from the program cache when possible)
     Serial.println("  Creating interpreter...");
-    interpreter = new ASTInterpreter(astBuffer, astSize, opts);
+    interpreter = createInterpreterFor(filename);
 
     if (!interpreter) {
-        Serial.println("✗ ERROR: Failed to create interpreter");
-        free(astBuffer);
-        astBuffer = nullptr;
+        Serial.println("✗ ERROR: Failed to load AST file");
         return false;
     }
 
-    // Free filesystem buffer (interpreter has internal copy)
-    free(astBuffer);
-    astBuffer = nullptr;
-
     // Connect providers
     interpreter->setSyncDataProvider(&dataProvider);
     interpreter->setCommandCallback(&immediateExecutor);
@@ -519,61 +593,32 @@ void resetInterpreter() {
     commandsExecuted = 0;
     startTime = millis();
 
-    // Configure interpreter options
-    InterpreterOptions opts;
-    opts.verbose = false;     // Status-only mode (no command stream to Serial)
-    opts.debug = false;
-    opts.maxLoopIterations = 1;  // Run ONE iteration per call (parent controls repetition)
-    opts.enforceLoopLimitsOnInternalLoops = false;  // Allow unlimited for/while/do-while loops
-    opts.syncMode = true;
-
-    const uint8_t* astData = nullptr;
-    size_t astSize = 0;
-    bool useFilesystem = USE_FILESYSTEM;
-
-    // Load AST from filesystem or embedded
+    // Load AST from filesystem (through the program cache) or embedded
     #if USE_FILESYSTEM
     {
-        if (astBuffer) {
-            free(astBuffer);
-            astBuffer = nullptr;
-        }
-
         // Use configured default file instead of hardcoded constant
         String defaultFile = configManager.getDefaultFile();
         Serial.print("[RESET] Loading configured default file: ");
         Serial.println(defaultFile);
 
-        astBuffer = readASTFromFile(defaultFile.c_str(), &astSize);
-        if (astBuffer) {
-            astData = astBuffer;
-        } else {
+        Serial.println("Creating interpreter...");
+        interpreter = createInterpreterFor(defaultFile.c_str());
+        if (!interpreter) {
             Serial.println("⚠ WARNING: Falling back to embedded mode");
-            useFilesystem = false;
         }
     }
     #endif
 
-    if (!useFilesystem) {
-        astData = astBinary;
-        astSize = sizeof(astBinary);
+    if (!interpreter) {
+        Serial.println("Creating interpreter...");
+        interpreter = new ASTInterpreter(astBinary, sizeof(astBinary), sketchInterpreterOptions());
     }
 
-    // Create interpreter
-    Serial.println("Creating interpreter...");
-    interpreter = new ASTInterpreter(astData, astSize, opts);
-
     if (!interpreter) {
         Serial.println("✗ ERROR: Failed to create interpreter");
         return;
     }
 
-    // Free filesystem buffer (interpreter has internal copy)
-    if (useFilesystem && astBuffer) {
-        free(astBuffer);
-        astBuffer = nullptr;
-    }
-
     // Connect providers
     interpreter->setSyncDataProvider(&dataProvider);
     interpreter->setCommandCallback(&immediateExecutor);
@@ -650,6 +695,7 @@ void resumeExecution() {}
 void resetInterpreter() {}
 void executeOneCommand() {}
 bool loadASTFile(const char* filename) { return false; }
+void forgetCachedProgram(const char* filename) {}
 #endif
 
 // ============================================================================ 
@@ -764,6 +810,7 @@ void setup() {
 
 #if USE_INTERPRETER
     // Initialize interpreter
+    initProgramCache();
     resetInterpreter();
 
     // Check for auto-start
@@ -790,8 +837,9 @@ void loop() {
     // Maintain WiFi connection
     wifiManager.maintain();
 
-    // Broadcast status updates via WebSocket
+    // Broadcast status updates via WebSocket, then send each client what it can take
     webSocket.broadcastStatus();
+    webSocket.deliver();
 
     // Cleanup disconnected WebSocket clients (every 5 seconds)
     static unsigned long lastCleanup = 0;
@@ -854,6 +902,16 @@ void loop() {
             break;
     }
 
+    // Rebuild one missing spare per pass between sketches, so the parse
+    // happens here instead of during the next switch and never stalls a
+    // running sketch
+    if (state == STATE_STOPPED) {
+        std::lock_guard<std::mutex> lock(programCacheMutex);
+        if (programCache) {
+            programCache->refill();
+        }
+    }
+
     // Process execution based on state
     if (state == STATE_RUNNING) {
         // With immediate execution, just call resume()
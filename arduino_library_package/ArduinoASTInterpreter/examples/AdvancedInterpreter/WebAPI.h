@@ -47,6 +47,7 @@ extern void resetInterpreter();
 extern void executeOneCommand();
 extern bool loadASTFile(const char* filename);
 #endif
+extern void forgetCachedProgram(const char* filename);
 
 // ============================================================================
 // WEB API CLASS
@@ -414,6 +415,7 @@ private:
 
         Serial.print("[API] Deleted file: ");
         Serial.println(filename);
+        forgetCachedProgram(filename.c_str());
 
         auto response = request->beginResponse(200, "application/json",
                                               createSuccessJSON("File deleted: " + filename));
@@ -456,6 +458,9 @@ private:
 
             Serial.print("[API] Uploading file: ");
             Serial.println(currentUploadFilename_);
+
+            // The cached copy of the old content is stale from here on
+            forgetCachedProgram(currentUploadFilename_.c_str());
         }
 
         // If upload already failed, skip processing
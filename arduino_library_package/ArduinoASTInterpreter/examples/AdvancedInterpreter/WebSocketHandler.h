@@ -6,6 +6,9 @@
  *
  * Features:
  * - Real-time status broadcasts to all connected clients
+ * - Broadcasts are published once to a CommandBroadcastHub; each client reads
+ *   them through its own subscription, so a slow client drops its oldest
+ *   messages instead of holding up the others
  * - Event-driven architecture
  * - Automatic client management
  * - Connection/disconnection tracking
@@ -24,6 +27,10 @@
 #include <Arduino.h>
 #include <AsyncWebSocket.h>
 #include <ArduinoJson.h>
+#include <ArduinoASTInterpreter.h>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #if USE_INTERPRETER
 // Forward declarations
@@ -43,6 +50,9 @@ namespace WebSocketConfig {
     const size_t MAX_CLIENTS = 4;                       // Maximum concurrent clients
     const unsigned long STATUS_BROADCAST_INTERVAL = 500; // Broadcast interval (ms)
     const size_t MAX_MESSAGE_SIZE = 1024;               // Maximum message size
+    const size_t BROADCAST_LOG_SIZE = 32;               // Broadcasts kept for clients that fall behind
+    const size_t BROADCAST_CHUNK_BYTES = 4096;          // Broadcast hub arena chunk size
+    const size_t MAX_SENDS_PER_DELIVER = 4;             // Broadcasts handed to one client per deliver()
 }
 
 // ============================================================================
@@ -59,6 +69,11 @@ private:
     uint32_t connectedClients_;
     bool autoStatusBroadcast_;
 
+    // Broadcasts: one hub, one subscription (read cursor) per client
+    CommandBroadcastHub hub_;
+    std::map<uint32_t, CommandBroadcastHub::SubscriberId> subscriptions_;   // By client id
+    std::mutex subscriptionsMutex_;   // Events arrive on the async_tcp task, deliver() runs in loop()
+
 #if USE_INTERPRETER
     /**
      * Get state as string
@@ -131,6 +146,10 @@ private:
         switch (type) {
             case WS_EVT_CONNECT: {
                 connectedClients_++;
+                {
+                    std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+                    subscriptions_[client->id()] = hub_.subscribe(BackpressurePolicy::DROP_OLDEST);
+                }
                 Serial.print("[WebSocket] Client connected: ");
                 Serial.print(client->id());
                 Serial.print(" (");
@@ -155,6 +174,14 @@ private:
 
             case WS_EVT_DISCONNECT: {
                 connectedClients_--;
+                {
+                    std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+                    auto subscription = subscriptions_.find(client->id());
+                    if (subscription != subscriptions_.end()) {
+                        hub_.unsubscribe(subscription->second);
+                        subscriptions_.erase(subscription);
+                    }
+                }
                 Serial.print("[WebSocket] Client disconnected: ");
                 Serial.print(client->id());
                 Serial.print(" - Total clients: ");
@@ -251,12 +278,20 @@ private:
         }
     }
 
+    /**
+     * Queue a message for every connected client; deliver() sends it
+     */
+    void publish(const String& message) {
+        hub_.publish(std::string_view(message.c_str(), message.length()));
+    }
+
 public:
     WebSocketHandler() :
         ws_(nullptr),
         lastBroadcast_(0),
         connectedClients_(0),
-        autoStatusBroadcast_(true) {}
+        autoStatusBroadcast_(true),
+        hub_(WebSocketConfig::BROADCAST_LOG_SIZE, WebSocketConfig::BROADCAST_CHUNK_BYTES) {}
 
     /**
      * Initialize WebSocket handler
@@ -312,8 +347,40 @@ public:
 
         lastBroadcast_ = now;
 
-        String statusJSON = createStatusUpdate();
-        ws_->textAll(statusJSON);
+        publish(createStatusUpdate());
+    }
+
+    /**
+     * Send each client the broadcasts it has not read yet, as far as its
+     * send queue allows. Call this from loop()
+     */
+    void deliver() {
+        if (!ws_ || connectedClients_ == 0) {
+            return;
+        }
+
+        // Snapshot the subscriptions: sending must not hold up connect/disconnect events
+        std::vector<std::pair<uint32_t, CommandBroadcastHub::SubscriberId>> readers;
+        {
+            std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+            readers.assign(subscriptions_.begin(), subscriptions_.end());
+        }
+
+        std::vector<BroadcastMessage> messages;
+        for (const auto& reader : readers) {
+            AsyncWebSocketClient* client = ws_->client(reader.first);
+            if (!client) {
+                continue;
+            }
+            // Read only what the client can take now; the rest waits in the hub
+            for (size_t sent = 0; sent < WebSocketConfig::MAX_SENDS_PER_DELIVER && client->canSend(); sent++) {
+                messages.clear();
+                if (hub_.poll(reader.second, messages, 1) == 0) {
+                    break;
+                }
+                client->text(messages[0].text.data(), messages[0].text.size());
+            }
+        }
     }
 
     /**
@@ -334,7 +401,7 @@ public:
 
         String output;
         serializeJson(doc, output);
-        ws_->textAll(output);
+        publish(output);
     }
 
     /**
@@ -352,7 +419,7 @@ public:
 
         String output;
         serializeJson(doc, output);
-        ws_->textAll(output);
+        publish(output);
     }
 
     /**
@@ -409,6 +476,8 @@ public:
         Serial.print("  Last Broadcast: ");
         Serial.print((millis() - lastBroadcast_) / 1000);
         Serial.println(" seconds ago");
+        Serial.print("  Broadcasts Published: ");
+        Serial.println((unsigned long)hub_.getPublished());
         Serial.println("=====================================");
         Serial.println();
     }
@@ -21,10 +21,16 @@
 // Wrap in IIFE to avoid global scope conflicts with ArduinoParser.js
 (function() {
 
+// Header flag: a source position section follows the node data
+const FLAG_SOURCE_POSITIONS = 0x0001;
+
 /**
  * Export an AST as CompactAST binary format
  * @param {Object} ast - The AST root node
  * @param {Object} options - Export options
+ * @param {boolean} [options.sourcePositions=false] - Write the source position section
+ *        from node.loc (parse(code, { sourcePositions: true }))
+ * @param {string} [options.sourceFile] - File name recorded for those positions
  * @returns {ArrayBuffer} - Binary AST data
  */
 const exportCompactAST = function(ast, options = {}) {
@@ -37,9 +43,15 @@ class CompactASTExporter {
         this.options = {
             version: 0x0100,
             flags: 0x0000,
+            sourcePositions: false,
+            sourceFile: '',
             ...options
         };
         
+        // Source position section: [nodeIndex, fileId, line, column] per node with loc
+        this.positions = [];
+        this.fileIndices = [];
+        
         // String table for deduplication
         this.stringTable = new Map();
         this.strings = [];
@@ -118,12 +130,16 @@ class CompactASTExporter {
         
         // Phase 1: Collect all nodes and build string table
         this.collectNodes(ast);
+        if (this.options.sourcePositions) {
+            this.collectSourcePositions();
+        }
 
         // Phase 2: Calculate buffer size
         const headerSize = 16;
         const stringTableSize = this.calculateStringTableSize();
         const nodeDataSize = this.calculateNodeDataSize();
-        const totalSize = headerSize + stringTableSize + nodeDataSize + 1024; // Add 1KB safety margin
+        const positionsSize = this.calculateSourcePositionsSize();
+        const totalSize = headerSize + stringTableSize + nodeDataSize + positionsSize + 1024; // Add 1KB safety margin
         
         // Phase 3: Write binary data
         const buffer = new ArrayBuffer(totalSize);
@@ -137,11 +153,57 @@ class CompactASTExporter {
         offset = this.writeStringTable(view, offset);
         
         // Write node data
-        this.writeNodeData(view, offset);
+        offset = this.writeNodeData(view, offset);
+        
+        // Write source positions (optional section, see FLAG_SOURCE_POSITIONS)
+        if (this.options.sourcePositions) {
+            this.writeSourcePositions(view, offset);
+        }
         
         return buffer;
     }
     
+    collectSourcePositions() {
+        if (this.options.sourceFile) {
+            this.fileIndices.push(this.addString(this.options.sourceFile));
+        }
+        const clamp = (n) => Math.max(0, Math.min(0xFFFF, n | 0));
+        this.nodes.forEach((node, index) => {
+            if (node && node.loc && index <= 0xFFFF) {
+                this.positions.push([index, 0, clamp(node.loc.line), clamp(node.loc.column)]);
+            }
+        });
+    }
+    
+    calculateSourcePositionsSize() {
+        if (!this.options.sourcePositions) return 0;
+        return 2 + this.fileIndices.length * 2 + 4 + this.positions.length * 8;
+    }
+    
+    /**
+     * Section layout (little-endian, follows the last node):
+     *   uint16 fileCount, fileCount x uint16 string index (file names)
+     *   uint32 entryCount, entryCount x { uint16 nodeIndex, uint16 fileId, uint16 line, uint16 column }
+     * Entries are in ascending node index order
+     */
+    writeSourcePositions(view, offset) {
+        view.setUint16(offset, this.fileIndices.length, true);
+        offset += 2;
+        for (const stringIndex of this.fileIndices) {
+            view.setUint16(offset, stringIndex, true);
+            offset += 2;
+        }
+        view.setUint32(offset, this.positions.length, true);
+        offset += 4;
+        for (const entry of this.positions) {
+            for (const field of entry) {
+                view.setUint16(offset, field, true);
+                offset += 2;
+            }
+        }
+        return offset;
+    }
+    
     collectNodes(node, index = 0) {
         if (!node) return index;
 
@@ -163,6 +225,9 @@ class CompactASTExporter {
         if (node.name && typeof node.name === 'string') {
             this.addString(node.name);
         }
+        if (node.type === 'CastExpression' && typeof node.castType === 'string') {
+            this.addString(node.castType);
+        }
         
         let nextIndex = index + 1;
         
@@ -405,7 +470,8 @@ class CompactASTExporter {
     writeHeader(view, offset, stringTableSize) {
         view.setUint32(offset, 0x50545341, true); // Magic 'ASTP' - little-endian to match C++ expectation
         view.setUint16(offset + 4, this.options.version, true);
-        view.setUint16(offset + 6, this.options.flags, true);
+        const flags = this.options.flags | (this.options.sourcePositions ? FLAG_SOURCE_POSITIONS : 0);
+        view.setUint16(offset + 6, flags, true);
         view.setUint32(offset + 8, this.nodes.length, true);
         view.setUint32(offset + 12, stringTableSize, true);
         return offset + 16;
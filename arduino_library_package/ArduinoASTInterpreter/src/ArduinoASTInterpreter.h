@@ -26,12 +26,20 @@
 #include "cpp/ArduinoDataTypes.hpp"
 #include "cpp/PlatformAbstraction.hpp"
 #include "cpp/SyncDataProvider.hpp"
+#include "cpp/ProgramCache.hpp"
+#include "cpp/CommandBroadcastHub.hpp"
 
 // Bring interpreter namespace into scope for convenience
 using arduino_interpreter::ASTInterpreter;
 using arduino_interpreter::InterpreterOptions;
 using arduino_interpreter::SyncDataProvider;
 using arduino_interpreter::CommandCallback;
+using arduino_interpreter::ProgramCache;
+using arduino_interpreter::ProgramCacheOptions;
+using arduino_interpreter::MemoryRegion;
+using arduino_interpreter::CommandBroadcastHub;
+using arduino_interpreter::BackpressurePolicy;
+using arduino_interpreter::BroadcastMessage;
 
 // Version information
 #define ARDUINO_AST_INTERPRETER_VERSION "22.0.0"
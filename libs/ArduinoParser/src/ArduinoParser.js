@@ -213,10 +213,11 @@ class ArduinoPreprocessor {
     }
     
     processIncludes(code) { const includeRegex = /#include\s*[<"]([^>"]+)[>"]/g; let processedCode = code; let match; includeRegex.lastIndex = 0; while ((match = includeRegex.exec(code)) !== null) { const includeFile = match[1]; const fullInclude = match[0]; if (LIBRARY_INCLUDES[includeFile]) { const config = LIBRARY_INCLUDES[includeFile]; if (config.activate && config.library) { this.activeLibraries.add(config.library); } Object.entries(config.constants || {}).forEach(([name, value]) => { this.macros.set(name, value); this.libraryConstants.set(name, value); }); } processedCode = processedCode.replace(fullInclude, ''); } return processedCode; }
-    processDefines(code) { const lines = code.split('\n'); const processedLines = []; for (let i = 0; i < lines.length; i++) { const line = lines[i]; const trimmed = line.trim(); if (trimmed.startsWith('#define')) { this.processDefineDirective(trimmed); } else if (trimmed.startsWith('#undef')) { this.processUndefDirective(trimmed); } else { processedLines.push(line); } } return processedLines.join('\n'); }
+    // Directive and skipped lines become blank lines, so parser line numbers match the source
+    processDefines(code) { const lines = code.split('\n'); const processedLines = []; for (let i = 0; i < lines.length; i++) { const line = lines[i]; const trimmed = line.trim(); if (trimmed.startsWith('#define')) { this.processDefineDirective(trimmed); processedLines.push(''); } else if (trimmed.startsWith('#undef')) { this.processUndefDirective(trimmed); processedLines.push(''); } else { processedLines.push(line); } } return processedLines.join('\n'); }
     processDefineDirective(defineLine) { const content = defineLine.substring(7).trim(); const functionMacroMatch = content.match(/^([A-Z_][A-Z0-9_]*)\s*\(([^)]*)\)\s+(.+)$/i); if (functionMacroMatch) { const name = functionMacroMatch[1]; const paramsStr = functionMacroMatch[2].trim(); const body = functionMacroMatch[3].trim(); const params = paramsStr ? paramsStr.split(',').map(p => p.trim()) : []; this.functionMacros.set(name, { params: params, body: body }); } else { const parts = content.match(/^([A-Z_][A-Z0-9_]*)\s+(.+)$/i); if (parts) { const name = parts[1]; const value = parts[2].trim(); this.macros.set(name, value); } else { const nameMatch = content.match(/^([A-Z_][A-Z0-9_]*)$/i); if (nameMatch) { const name = nameMatch[1]; this.macros.set(name, '1'); } } } }
     processUndefDirective(undefLine) { const macroName = undefLine.substring(6).trim(); if (this.macros.has(macroName)) { this.macros.delete(macroName); } if (this.functionMacros.has(macroName)) { this.functionMacros.delete(macroName); } }
-    processConditionals(code) { const lines = code.split('\n'); const processedLines = []; let skipLines = false; let conditionalDepth = 0; for (let i = 0; i < lines.length; i++) { const line = lines[i]; const trimmed = line.trim(); if (trimmed.startsWith('#ifdef')) { const macro = trimmed.substring(6).trim(); conditionalDepth++; skipLines = !this.macros.has(macro); } else if (trimmed.startsWith('#ifndef')) { const macro = trimmed.substring(7).trim(); conditionalDepth++; skipLines = this.macros.has(macro); } else if (trimmed.startsWith('#endif')) { conditionalDepth--; if (conditionalDepth === 0) { skipLines = false; } } else if (trimmed.startsWith('#else')) { skipLines = !skipLines; } else if (trimmed.startsWith('#if ')) { const expression = trimmed.substring(3).trim(); conditionalDepth++; try { let evalExpression = expression; evalExpression = evalExpression.replace(/defined\s*\(\s*([A-Za-z_][A-Za-z0-9_]*)\s*\)/g, (match, macroName) => { return this.macros.has(macroName) ? '1' : '0'; }); for (const [macro, value] of this.macros) { const regex = new RegExp(`\\b${macro}\\b`, 'g'); evalExpression = evalExpression.replace(regex, value); } evalExpression = evalExpression.replace(/\b[A-Za-z_][A-Za-z0-9_]*\b/g, (match) => { if (/^[0-9]/.test(match) || ['&&', '||', '==', '!=', '>', '<', '>=', '<='].includes(match)) { return match; } return '0'; }); const result = eval(evalExpression); skipLines = !result; } catch (error) { skipLines = false; } } else { if (!skipLines) { processedLines.push(line); } } } return processedLines.join('\n'); }
+    processConditionals(code) { const lines = code.split('\n'); const processedLines = []; let skipLines = false; let conditionalDepth = 0; for (let i = 0; i < lines.length; i++) { const line = lines[i]; const trimmed = line.trim(); if (trimmed.startsWith('#ifdef')) { const macro = trimmed.substring(6).trim(); conditionalDepth++; skipLines = !this.macros.has(macro); } else if (trimmed.startsWith('#ifndef')) { const macro = trimmed.substring(7).trim(); conditionalDepth++; skipLines = this.macros.has(macro); } else if (trimmed.startsWith('#endif')) { conditionalDepth--; if (conditionalDepth === 0) { skipLines = false; } } else if (trimmed.startsWith('#else')) { skipLines = !skipLines; } else if (trimmed.startsWith('#if ')) { const expression = trimmed.substring(3).trim(); conditionalDepth++; try { let evalExpression = expression; evalExpression = evalExpression.replace(/defined\s*\(\s*([A-Za-z_][A-Za-z0-9_]*)\s*\)/g, (match, macroName) => { return this.macros.has(macroName) ? '1' : '0'; }); for (const [macro, value] of this.macros) { const regex = new RegExp(`\\b${macro}\\b`, 'g'); evalExpression = evalExpression.replace(regex, value); } evalExpression = evalExpression.replace(/\b[A-Za-z_][A-Za-z0-9_]*\b/g, (match) => { if (/^[0-9]/.test(match) || ['&&', '||', '==', '!=', '>', '<', '>=', '<='].includes(match)) { return match; } return '0'; }); const result = eval(evalExpression); skipLines = !result; } catch (error) { skipLines = false; } } else { processedLines.push(skipLines ? '' : line); continue; } processedLines.push(''); } return processedLines.join('\n'); }
     performMacroSubstitution(code) { let substitutedCode = code; for (const [macroName, macroValue] of this.macros) { const regex = new RegExp(`\\b${macroName}\\b`, 'g'); substitutedCode = substitutedCode.replace(regex, macroValue); } for (const [macroName, macroInfo] of this.functionMacros) { const { params, body } = macroInfo; const regex = new RegExp(`\\b${macroName}\\s*\\(([^)]*)\\)`, 'g'); substitutedCode = substitutedCode.replace(regex, (match, argsStr) => { const args = argsStr ? argsStr.split(',').map(arg => arg.trim()) : []; let expandedBody = body; for (let i = 0; i < params.length && i < args.length; i++) { const paramRegex = new RegExp(`\\b${params[i]}\\b`, 'g'); expandedBody = expandedBody.replace(paramRegex, args[i]); } return expandedBody; }); } return substitutedCode; }
     getStats() { return { version: PREPROCESSOR_VERSION, macros: this.macros.size, functionMacros: this.functionMacros.size, activeLibraries: this.activeLibraries.size, libraryConstants: this.libraryConstants.size }; }
 }
@@ -1089,6 +1090,22 @@ class Parser {
     }
 
     parseStatement() {
+        return this.withSourcePosition(() => this.parseStatementNode());
+    }
+
+    // With options.sourcePositions, statement nodes carry `loc: { line, column }`
+    // of their first token (exportCompactAST's source position section)
+    withSourcePosition(parseNode) {
+        if (!this.options.sourcePositions) return parseNode();
+        const { line, column } = this.currentToken;
+        const node = parseNode();
+        if (node && typeof node === 'object' && !node.loc) {
+            node.loc = { line, column };
+        }
+        return node;
+    }
+
+    parseStatementNode() {
         // Preprocessor directives are now handled before parsing
         // Any remaining preprocessor tokens indicate an error in the preprocessing stage
         if (this.currentToken.type === 'PreprocessorDirective') {
@@ -2474,6 +2491,10 @@ class Parser {
                     type: 'NumberNode', 
                     value: token.value
                 };
+                // C type of a floating literal (exportCompactAST writes it as the value type)
+                if (token.type === 'FLOAT_NUMBER') {
+                    node.numberType = /[fF]/.test(token.suffix || '') ? 'float' : 'double';
+                }
                 // Add position info only if requested (for backwards compatibility)
                 if (this.options.includePositions) {
                     node.line = token.line;
@@ -3892,6 +3913,10 @@ class Parser {
      *              Handles: functions, variables, classes, structs, typedefs, enums, templates, etc.
      */
     parseTopLevelStatement() {
+        return this.withSourcePosition(() => this.parseTopLevelStatementNode());
+    }
+
+    parseTopLevelStatementNode() {
         const currentType = this.currentToken.type;
         const peekType = this.peekToken.type;
         const peek2Type = this.peekToken2.type;
@@ -4409,6 +4434,7 @@ class Parser {
  * @param {boolean} [options.throwOnError=false] - Throw errors instead of graceful recovery  
  * @param {boolean} [options.includePreprocessor=false] - Include preprocessor directives in AST
  * @param {boolean} [options.recognizeArduinoFunctions=false] - Recognize Arduino-specific functions
+ * @param {boolean} [options.sourcePositions=false] - Record statement line/column as node.loc
  * @returns {Object} Abstract Syntax Tree (AST) representing the parsed code
  * @description Primary entry point for parsing Arduino/C++ code. Provides error recovery,
  *              detailed analysis when verbose is enabled, and comprehensive Arduino support.
@@ -11,6 +11,8 @@
 #include "../../src/cpp/ASTCast.hpp"  // v21.0.0: Conditional RTTI support
 #include <cstring>
 #include <algorithm>
+#include <cmath>
+#include <type_traits>
 #include <sstream>
 #include <iomanip>
 #include <iostream>
@@ -73,6 +75,9 @@ ASTNodePtr CompactASTReader::parse() {
     
     if (!nodesRead_) {
         parseNodesInternal();
+        if (header_.flags & COMPACT_AST_FLAG_SOURCE_POSITIONS) {
+            parseSourcePositionsInternal();   // Needs nodes_ before linking moves them
+        }
     }
     
     // Link parent-child relationships
@@ -168,6 +173,33 @@ void CompactASTReader::parseNodesInternal() {
     nodesRead_ = true;
 }
 
+void CompactASTReader::parseSourcePositionsInternal() {
+    sourcePositions_ = SourcePositionMap();
+
+    validatePosition(2);
+    uint16_t fileCount = convertFromLittleEndian16(readUint16());
+    for (uint16_t i = 0; i < fileCount; ++i) {
+        validatePosition(2);
+        uint16_t stringIndex = convertFromLittleEndian16(readUint16());
+        sourcePositions_.addFile(stringIndex < stringTable_.size() ? stringTable_[stringIndex] : "");
+    }
+
+    validatePosition(4);
+    uint32_t entryCount = convertFromLittleEndian32(readUint32());
+    validatePosition(static_cast<size_t>(entryCount) * 8);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        uint16_t nodeIndex = convertFromLittleEndian16(readUint16());
+        SourcePosition position;
+        position.fileId = convertFromLittleEndian16(readUint16());
+        position.line = convertFromLittleEndian16(readUint16());
+        position.column = convertFromLittleEndian16(readUint16());
+        if (nodeIndex < nodes_.size() && nodes_[nodeIndex]) {
+            sourcePositions_.add(nodes_[nodeIndex].get(), position);
+        }
+    }
+    sourcePositions_.finalize();
+}
+
 ASTNodePtr CompactASTReader::parseNode(size_t nodeIndex) {
 
     validatePosition(4); // NodeType + Flags + DataSize
@@ -356,6 +388,15 @@ ASTNodePtr CompactASTReader::parseNode(size_t nodeIndex) {
     
     // Parse value if present
     if (flags & static_cast<uint8_t>(ASTNodeFlags::HAS_VALUE)) {
+        // A number literal's value type is its C type (exportCompactAST)
+        if (nodeType == ASTNodeType::NUMBER_LITERAL && position_ < bufferSize_) {
+            auto* number = static_cast<NumberNode*>(node.get());
+            switch (static_cast<ValueType>(buffer_[position_])) {
+                case ValueType::FLOAT32_VAL: number->setKind(NumberNode::Kind::FLOAT); break;
+                case ValueType::FLOAT64_VAL: number->setKind(NumberNode::Kind::DOUBLE); break;
+                default: number->setKind(NumberNode::Kind::INTEGER); break;
+            }
+        }
         ASTValue value = parseValue();
         node->setValue(value);
     }
@@ -913,7 +954,8 @@ void CompactASTReader::linkNodeChildren() {
                     // ParamNode: ['paramType', 'declarator', 'defaultValue']
                     if (childType == ASTNodeType::TYPE_NODE && !paramNode->getParamType()) {
                         paramNode->setParamType(std::move(nodes_[childIndex]));
-                    } else if ((childType == ASTNodeType::DECLARATOR_NODE || childType == ASTNodeType::FUNCTION_POINTER_DECLARATOR) && !paramNode->getDeclarator()) {
+                    } else if ((childType == ASTNodeType::DECLARATOR_NODE || childType == ASTNodeType::FUNCTION_POINTER_DECLARATOR ||
+                                childType == ASTNodeType::ARRAY_DECLARATOR) && !paramNode->getDeclarator()) {
                         paramNode->setDeclarator(std::move(nodes_[childIndex]));
                     } else {
                         parentNode->addChild(std::move(nodes_[childIndex]));
@@ -1152,6 +1194,432 @@ CompactASTReader::MemoryStats CompactASTReader::getMemoryStats() const {
     return stats;
 }
 
+// =============================================================================
+// COMPACT AST WRITER IMPLEMENTATION
+// =============================================================================
+
+namespace {
+
+/**
+ * Children of `node` in the order CompactASTReader::linkNodeChildren() puts
+ * them back: typed slots first, then generic children. StructMemberNode keeps
+ * its declarator as a name only, so one is synthesized for it.
+ */
+void linkOrder(const ASTNode& node, std::vector<const ASTNode*>& out, std::vector<ASTNodePtr>& synthesized) {
+    auto one = [&out](const ASTNode* child) {
+        if (child) out.push_back(child);
+    };
+    auto all = [&out](const std::vector<ASTNodePtr>& nodes) {
+        for (const auto& child : nodes) {
+            if (child) out.push_back(child.get());
+        }
+    };
+
+    switch (node.getType()) {
+        case ASTNodeType::FUNC_DEF:
+            if (auto* n = AST_CONST_CAST(FuncDefNode, &node)) {
+                one(n->getReturnType());
+                one(n->getDeclarator());
+                all(n->getParameters());
+                one(n->getBody());
+            }
+            break;
+        case ASTNodeType::VAR_DECL:
+            if (auto* n = AST_CONST_CAST(VarDeclNode, &node)) {
+                one(n->getVarType());
+                all(n->getDeclarations());
+            }
+            break;
+        case ASTNodeType::EXPRESSION_STMT:
+            if (auto* n = AST_CONST_CAST(ExpressionStatement, &node)) one(n->getExpression());
+            break;
+        case ASTNodeType::FUNC_CALL:
+            if (auto* n = AST_CONST_CAST(FuncCallNode, &node)) {
+                one(n->getCallee());
+                all(n->getArguments());
+            }
+            break;
+        case ASTNodeType::CONSTRUCTOR_CALL:
+            if (auto* n = AST_CONST_CAST(ConstructorCallNode, &node)) {
+                one(n->getCallee());
+                all(n->getArguments());
+            }
+            break;
+        case ASTNodeType::TERNARY_EXPR:
+            if (auto* n = AST_CONST_CAST(TernaryExpressionNode, &node)) {
+                one(n->getCondition());
+                one(n->getTrueExpression());
+                one(n->getFalseExpression());
+            }
+            break;
+        case ASTNodeType::ARRAY_ACCESS:
+            if (auto* n = AST_CONST_CAST(ArrayAccessNode, &node)) {
+                one(n->getIdentifier());
+                one(n->getIndex());
+            }
+            break;
+        case ASTNodeType::DESIGNATED_INITIALIZER:
+            if (auto* n = AST_CONST_CAST(DesignatedInitializerNode, &node)) {
+                one(n->getField());
+                one(n->getValue());
+            }
+            break;
+        case ASTNodeType::STRUCT_MEMBER:
+            if (auto* n = AST_CONST_CAST(StructMemberNode, &node)) {
+                one(n->getMemberType());
+                if (n->getMemberType()) {
+                    synthesized.push_back(std::make_unique<DeclaratorNode>(n->getMemberName()));
+                    out.push_back(synthesized.back().get());
+                }
+            }
+            break;
+        case ASTNodeType::CAST_EXPR:
+            if (auto* n = AST_CONST_CAST(CastExpression, &node)) one(n->getOperand());
+            break;
+        case ASTNodeType::ARRAY_DECLARATOR:
+            if (auto* n = AST_CONST_CAST(ArrayDeclaratorNode, &node)) {
+                one(n->getIdentifier());
+                one(n->getSize());
+                all(n->getDimensions());
+            }
+            break;
+        case ASTNodeType::FUNCTION_POINTER_DECLARATOR:
+            if (auto* n = AST_CONST_CAST(FunctionPointerDeclaratorNode, &node)) one(n->getIdentifier());
+            break;
+        case ASTNodeType::MEMBER_ACCESS:
+            if (auto* n = AST_CONST_CAST(MemberAccessNode, &node)) {
+                one(n->getObject());
+                one(n->getProperty());
+            }
+            break;
+        case ASTNodeType::IF_STMT:
+            if (auto* n = AST_CONST_CAST(IfStatement, &node)) {
+                one(n->getCondition());
+                one(n->getConsequent());
+                one(n->getAlternate());
+            }
+            break;
+        case ASTNodeType::WHILE_STMT:
+            if (auto* n = AST_CONST_CAST(WhileStatement, &node)) {
+                one(n->getCondition());
+                one(n->getBody());
+            }
+            break;
+        case ASTNodeType::DO_WHILE_STMT:
+            if (auto* n = AST_CONST_CAST(DoWhileStatement, &node)) {
+                one(n->getBody());
+                one(n->getCondition());
+            }
+            break;
+        case ASTNodeType::FOR_STMT:
+            if (auto* n = AST_CONST_CAST(ForStatement, &node)) {
+                one(n->getInitializer());
+                one(n->getCondition());
+                one(n->getIncrement());
+                one(n->getBody());
+            }
+            break;
+        case ASTNodeType::SWITCH_STMT:
+            if (auto* n = AST_CONST_CAST(SwitchStatement, &node)) one(n->getCondition());
+            break;
+        case ASTNodeType::CASE_STMT:
+            if (auto* n = AST_CONST_CAST(CaseStatement, &node)) {
+                // The reader wraps the statements after the label in a CompoundStmt
+                one(n->getLabel());
+                const ASTNode* body = n->getBody();
+                if (body && body->getType() == ASTNodeType::COMPOUND_STMT) {
+                    all(body->getChildren());
+                } else {
+                    one(body);
+                }
+            }
+            break;
+        case ASTNodeType::BINARY_OP:
+            if (auto* n = AST_CONST_CAST(BinaryOpNode, &node)) {
+                one(n->getLeft());
+                one(n->getRight());
+            }
+            break;
+        case ASTNodeType::ASSIGNMENT:
+            if (auto* n = AST_CONST_CAST(AssignmentNode, &node)) {
+                one(n->getLeft());
+                one(n->getRight());
+            }
+            break;
+        case ASTNodeType::UNARY_OP:
+            if (auto* n = AST_CONST_CAST(UnaryOpNode, &node)) one(n->getOperand());
+            break;
+        case ASTNodeType::POSTFIX_EXPRESSION:
+            if (auto* n = AST_CONST_CAST(PostfixExpressionNode, &node)) one(n->getOperand());
+            break;
+        case ASTNodeType::SIZEOF_EXPR:
+            if (auto* n = AST_CONST_CAST(SizeofExpressionNode, &node)) one(n->getOperand());
+            break;
+        case ASTNodeType::PARAM_NODE:
+            if (auto* n = AST_CONST_CAST(ParamNode, &node)) {
+                one(n->getParamType());
+                one(n->getDeclarator());
+            }
+            break;
+        case ASTNodeType::RETURN_STMT:
+            if (auto* n = AST_CONST_CAST(ReturnStatement, &node)) one(n->getReturnValue());
+            break;
+        default:
+            break;
+    }
+
+    all(node.getChildren());
+}
+
+// Operators set through setOperator() are not in the value field
+ASTValue valueToWrite(const ASTNode& node) {
+    const ASTValue& value = node.getValue();
+    if (!std::holds_alternative<std::monostate>(value)) return value;
+
+    switch (node.getType()) {
+        case ASTNodeType::BINARY_OP:
+            if (auto* n = AST_CONST_CAST(BinaryOpNode, &node)) return n->getOperator();
+            break;
+        case ASTNodeType::UNARY_OP:
+            if (auto* n = AST_CONST_CAST(UnaryOpNode, &node)) return n->getOperator();
+            break;
+        case ASTNodeType::ASSIGNMENT:
+            if (auto* n = AST_CONST_CAST(AssignmentNode, &node)) return n->getOperator();
+            break;
+        case ASTNodeType::POSTFIX_EXPRESSION:
+            if (auto* n = AST_CONST_CAST(PostfixExpressionNode, &node)) return n->getOperator();
+            break;
+        case ASTNodeType::MEMBER_ACCESS:
+            if (auto* n = AST_CONST_CAST(MemberAccessNode, &node)) {
+                return std::string(n->getAccessOperator() == "->" ? "ARROW" : "DOT");
+            }
+            break;
+        default:
+            break;
+    }
+    return value;
+}
+
+} // anonymous namespace
+
+CompactASTWriter::CompactASTWriter(uint16_t version, uint16_t flags)
+    : version_(version), flags_(flags) {}
+
+std::vector<uint8_t> CompactASTWriter::write(const ASTNode* rootNode) {
+    if (!rootNode) {
+        throw InvalidFormatException("No root node to write");
+    }
+
+    buffer_.clear();
+    stringTable_.clear();
+    strings_.clear();
+    nodes_.clear();
+    childIndices_.clear();
+    values_.clear();
+    synthesized_.clear();
+
+    collectStringsAndNodes(rootNode);
+
+    uint32_t stringTableSize = 4;
+    for (const auto& str : strings_) {
+        stringTableSize += 2 + static_cast<uint32_t>(str.size()) + 1;
+    }
+    stringTableSize = (stringTableSize + 3) & ~3u;
+
+    writeHeader(static_cast<uint32_t>(nodes_.size()), stringTableSize);
+    writeStringTable();
+    writeNodes(rootNode);
+
+    synthesized_.clear();
+    return buffer_;
+}
+
+void CompactASTWriter::collectStringsAndNodes(const ASTNode* node) {
+    // Child indices are 16-bit
+    if (nodes_.size() > 0xFFFF) {
+        throw InvalidFormatException("Too many nodes for the compact format (limit 65536)");
+    }
+
+    const size_t index = nodes_.size();
+    nodes_.push_back(node);
+    values_.push_back(valueToWrite(*node));
+    childIndices_.emplace_back();
+    if (const auto* str = std::get_if<std::string>(&values_[index])) {
+        addString(*str);
+    }
+
+    std::vector<const ASTNode*> children;
+    linkOrder(*node, children, synthesized_);
+    for (const ASTNode* child : children) {
+        childIndices_[index].push_back(static_cast<uint16_t>(nodes_.size()));
+        collectStringsAndNodes(child);
+    }
+}
+
+void CompactASTWriter::writeHeader(uint32_t nodeCount, uint32_t stringTableSize) {
+    writeUint32(COMPACT_AST_MAGIC);
+    writeUint16(version_);
+    writeUint16(flags_ & static_cast<uint16_t>(~COMPACT_AST_FLAG_SOURCE_POSITIONS));   // No position section
+    writeUint32(nodeCount);
+    writeUint32(stringTableSize);
+}
+
+void CompactASTWriter::writeStringTable() {
+    writeUint32(static_cast<uint32_t>(strings_.size()));
+    for (const auto& str : strings_) {
+        writeString(str);
+    }
+    while (buffer_.size() % 4 != 0) {
+        writeUint8(0);
+    }
+}
+
+void CompactASTWriter::writeNodes(const ASTNode* rootNode) {
+    (void)rootNode;   // nodes_ was collected from it
+    constexpr uint16_t kept = static_cast<uint16_t>(ASTNodeFlags::IS_POINTER) |
+                              static_cast<uint16_t>(ASTNodeFlags::IS_REFERENCE) |
+                              static_cast<uint16_t>(ASTNodeFlags::IS_CONST);
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        const ASTNode* node = nodes_[i];
+        const ASTValue& value = values_[i];
+        const auto& children = childIndices_[i];
+        const bool hasValue = !std::holds_alternative<std::monostate>(value);
+
+        uint8_t flags = static_cast<uint8_t>(static_cast<uint16_t>(node->getFlags()) & kept);
+        if (hasValue) flags |= static_cast<uint8_t>(ASTNodeFlags::HAS_VALUE);
+        if (!children.empty()) flags |= static_cast<uint8_t>(ASTNodeFlags::HAS_CHILDREN);
+
+        writeUint8(static_cast<uint8_t>(node->getType()));
+        writeUint8(flags);
+        const size_t sizeAt = buffer_.size();
+        writeUint16(0);   // Data size, patched below
+
+        const size_t dataStart = buffer_.size();
+        if (hasValue && node->getType() == ASTNodeType::NUMBER_LITERAL) {
+            writeNumberLiteral(*static_cast<const NumberNode*>(node), value);
+        } else if (hasValue) {
+            writeValue(value);
+        }
+        for (uint16_t child : children) {
+            writeUint16(child);
+        }
+
+        const size_t dataSize = buffer_.size() - dataStart;
+        if (dataSize > 0xFFFF) {
+            throw InvalidFormatException("Node data too large for the compact format");
+        }
+        buffer_[sizeAt] = static_cast<uint8_t>(dataSize & 0xFF);
+        buffer_[sizeAt + 1] = static_cast<uint8_t>(dataSize >> 8);
+    }
+}
+
+/**
+ * Numbers use the narrowest type the reader turns back into the same double;
+ * INT8/INT32 are avoided (the reader returns int32_t / reads them unsigned).
+ */
+void CompactASTWriter::writeValue(const ASTValue& value) {
+    if (const auto* str = std::get_if<std::string>(&value)) {
+        writeUint8(static_cast<uint8_t>(ValueType::STRING_VAL));
+        writeUint16(addString(*str));
+        return;
+    }
+    if (const auto* flag = std::get_if<bool>(&value)) {
+        writeUint8(static_cast<uint8_t>(ValueType::BOOL_VAL));
+        writeUint8(*flag ? 1 : 0);
+        return;
+    }
+
+    double number = std::visit([](const auto& v) -> double {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_arithmetic_v<T>) return static_cast<double>(v);
+        return 0.0;
+    }, value);
+
+    if (number == std::floor(number) && number >= 0 && number <= 0xFF) {
+        writeUint8(static_cast<uint8_t>(ValueType::UINT8_VAL));
+        writeUint8(static_cast<uint8_t>(number));
+    } else if (number == std::floor(number) && number >= INT16_MIN && number <= INT16_MAX) {
+        writeUint8(static_cast<uint8_t>(ValueType::INT16_VAL));
+        writeUint16(static_cast<uint16_t>(static_cast<int16_t>(number)));
+    } else if (number == std::floor(number) && number >= 0 && number <= 0xFFFF) {
+        writeUint8(static_cast<uint8_t>(ValueType::UINT16_VAL));
+        writeUint16(static_cast<uint16_t>(number));
+    } else {
+        writeUint8(static_cast<uint8_t>(ValueType::FLOAT64_VAL));
+        writeFloat64(number);
+    }
+}
+
+// Floating literals keep their C type in the value type, as exportCompactAST writes them
+void CompactASTWriter::writeNumberLiteral(const NumberNode& node, const ASTValue& value) {
+    switch (node.getKind()) {
+        case NumberNode::Kind::FLOAT: {
+            float number = static_cast<float>(node.getNumber());
+            uint32_t bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            writeUint8(static_cast<uint8_t>(ValueType::FLOAT32_VAL));
+            writeUint32(bits);
+            break;
+        }
+        case NumberNode::Kind::DOUBLE:
+            writeUint8(static_cast<uint8_t>(ValueType::FLOAT64_VAL));
+            writeFloat64(node.getNumber());
+            break;
+        default:
+            writeValue(value);
+            break;
+    }
+}
+
+uint16_t CompactASTWriter::addString(const std::string& str) {
+    auto found = stringTable_.find(str);
+    if (found != stringTable_.end()) {
+        return found->second;
+    }
+    if (strings_.size() > 0xFFFF) {
+        throw InvalidFormatException("Too many strings for the compact format (limit 65536)");
+    }
+    if (str.size() > 0xFFFF) {
+        throw InvalidFormatException("String too long for the compact format");
+    }
+    uint16_t index = static_cast<uint16_t>(strings_.size());
+    stringTable_.emplace(str, index);
+    strings_.push_back(str);
+    return index;
+}
+
+// Little-endian regardless of host byte order
+void CompactASTWriter::writeUint8(uint8_t value) {
+    buffer_.push_back(value);
+}
+
+void CompactASTWriter::writeUint16(uint16_t value) {
+    buffer_.push_back(static_cast<uint8_t>(value & 0xFF));
+    buffer_.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void CompactASTWriter::writeUint32(uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        buffer_.push_back(static_cast<uint8_t>((value >> shift) & 0xFF));
+    }
+}
+
+void CompactASTWriter::writeFloat64(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int shift = 0; shift < 64; shift += 8) {
+        buffer_.push_back(static_cast<uint8_t>((bits >> shift) & 0xFF));
+    }
+}
+
+// uint16 length, bytes, NUL
+void CompactASTWriter::writeString(const std::string& str) {
+    writeUint16(static_cast<uint16_t>(str.size()));
+    buffer_.insert(buffer_.end(), str.begin(), str.end());
+    writeUint8(0);
+}
+
 // =============================================================================
 // UTILITY FUNCTIONS
 // =============================================================================
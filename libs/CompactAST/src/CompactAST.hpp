@@ -47,6 +47,15 @@ struct CompactASTHeader {
 
 static_assert(sizeof(CompactASTHeader) == 16, "Header size must be 16 bytes");
 
+/**
+ * Header flag: a source position section follows the node data
+ * (exportCompactAST(ast, { sourcePositions: true })):
+ *   uint16 fileCount, fileCount x uint16 string index
+ *   uint32 entryCount, entryCount x { uint16 nodeIndex, uint16 fileId, uint16 line, uint16 column }
+ * Readers that ignore the flag ignore the section.
+ */
+static constexpr uint16_t COMPACT_AST_FLAG_SOURCE_POSITIONS = 0x0001;
+
 // =============================================================================
 // EXCEPTIONS
 // =============================================================================
@@ -97,6 +106,7 @@ private:
     std::vector<std::string> stringTable_;
     std::vector<ASTNodePtr> nodes_;
     std::map<size_t, std::vector<uint16_t>> childIndices_; // nodeIndex -> child indices
+    SourcePositionMap sourcePositions_;
     
     // Reading state
     bool headerRead_;
@@ -142,6 +152,12 @@ public:
      */
     const std::vector<ASTNodePtr>& getNodes() const { return nodes_; }
     
+    /**
+     * Move out the source position side table (after parsing); empty if the
+     * buffer has no source position section
+     */
+    SourcePositionMap takeSourcePositions() { return std::move(sourcePositions_); }
+    
     /**
      * Get memory usage statistics
      */
@@ -179,6 +195,7 @@ private:
     void parseHeaderInternal();
     void parseStringTableInternal();
     void parseNodesInternal();
+    void parseSourcePositionsInternal();
     
     ASTNodePtr parseNode(size_t nodeIndex);
     ASTValue parseValue();
@@ -197,12 +214,22 @@ private:
 };
 
 // =============================================================================
-// COMPACT AST WRITER (Future Extension)
+// COMPACT AST WRITER
 // =============================================================================
 
 /**
  * Writes C++ AST nodes to binary format
- * For future bidirectional compatibility
+ *
+ * The inverse of CompactASTReader: nodes are numbered in pre-order (root at
+ * index 0) and each node lists its children in the order linkNodeChildren()
+ * assigns them back to typed slots (e.g. IfStatement: condition, consequent,
+ * alternate), followed by its generic children. Operators kept outside the
+ * value field (BinaryOpNode::setOperator(), MemberAccessNode "." / "->") are
+ * written as the value, the way exportCompactAST() does.
+ *
+ * Limits of the format: at most 65536 nodes and strings (16-bit indices);
+ * numbers come back as double; a ForStatement with an empty slot reads back
+ * with the later slots shifted; load-time flags are not written.
  */
 class CompactASTWriter {
 private:
@@ -212,6 +239,11 @@ private:
     uint16_t version_;
     uint16_t flags_;
     
+    std::vector<const ASTNode*> nodes_;                 // Pre-order
+    std::vector<std::vector<uint16_t>> childIndices_;   // Per node, in link order
+    std::vector<ASTValue> values_;                      // Per node, as written
+    std::vector<ASTNodePtr> synthesized_;               // StructMember declarators
+    
 public:
     explicit CompactASTWriter(uint16_t version = 0x0100, uint16_t flags = 0x0000);
     
@@ -219,6 +251,7 @@ public:
      * Write AST to binary format
      * @param rootNode Root of AST to write
      * @return Binary data
+     * @throws InvalidFormatException if the tree exceeds the format's limits
      */
     std::vector<uint8_t> write(const ASTNode* rootNode);
     
@@ -232,6 +265,8 @@ private:
     void writeStringTable();
     void writeNodes(const ASTNode* rootNode);
     void collectStringsAndNodes(const ASTNode* node);
+    void writeValue(const ASTValue& value);
+    void writeNumberLiteral(const NumberNode& node, const ASTValue& value);
     
     uint16_t addString(const std::string& str);
     void writeUint8(uint8_t value);
@@ -89,9 +89,15 @@ echo "🏗️  Compiling C++ sources to WebAssembly..."
 emcc \
     src/cpp/ASTInterpreter.cpp \
     src/cpp/ASTNodes.cpp \
+    src/cpp/ASTCanonicalizer.cpp \
+    src/cpp/DebugSession.cpp \
+    src/cpp/FunctionTiers.cpp \
+    src/cpp/ReadPrefetcher.cpp \
+    src/cpp/IntegerModel.cpp \
     src/cpp/ArduinoDataTypes.cpp \
     src/cpp/ArduinoLibraryRegistry.cpp \
     src/cpp/EnhancedInterpreter.cpp \
+    src/cpp/CommandEmitter.cpp \
     src/cpp/ExecutionTracer.cpp \
     src/cpp/wasm_bridge.cpp \
     libs/CompactAST/src/CompactAST.cpp \
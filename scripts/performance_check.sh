@@ -5,6 +5,10 @@
 #
 # Usage: ./scripts/performance_check.sh [test_range] [runs]
 # Example: ./scripts/performance_check.sh 0-10 5
+#
+# Wall time is noisy on shared machines. For exact, per-counter work units
+# (nodes visited, scope lookups, allocations, ...) against a checked-in
+# baseline, run ./work_counters ../test_data --check ../tests/work_counters_baseline.txt
 
 set -e
 
@@ -0,0 +1,281 @@
+/**
+ * ASTCanonicalizer.cpp - Load-time normalization of parser quirks
+ *
+ * Version: 1.0
+ */
+
+#include "ASTCanonicalizer.hpp"
+#include "ASTCast.hpp"
+#include <set>
+#include <string>
+
+namespace arduino_ast {
+
+namespace {
+
+// Every child that can hold a statement or an expression (type and
+// declarator-name nodes never contain either)
+template<typename Fn>
+void forEachChild(ASTNode& node, Fn&& fn) {
+    for (const auto& child : node.getChildren()) fn(child.get());
+
+    auto all = [&fn](const std::vector<ASTNodePtr>& nodes) {
+        for (const auto& child : nodes) fn(child.get());
+    };
+
+    switch (node.getType()) {
+        case ASTNodeType::EXPRESSION_STMT:
+            if (auto* n = AST_CAST(ExpressionStatement, &node)) fn(n->getExpression());
+            break;
+        case ASTNodeType::IF_STMT:
+            if (auto* n = AST_CAST(IfStatement, &node)) {
+                fn(n->getCondition());
+                fn(n->getConsequent());
+                fn(n->getAlternate());
+            }
+            break;
+        case ASTNodeType::WHILE_STMT:
+            if (auto* n = AST_CAST(WhileStatement, &node)) {
+                fn(n->getCondition());
+                fn(n->getBody());
+            }
+            break;
+        case ASTNodeType::DO_WHILE_STMT:
+            if (auto* n = AST_CAST(DoWhileStatement, &node)) {
+                fn(n->getBody());
+                fn(n->getCondition());
+            }
+            break;
+        case ASTNodeType::FOR_STMT:
+            if (auto* n = AST_CAST(ForStatement, &node)) {
+                fn(n->getInitializer());
+                fn(n->getCondition());
+                fn(n->getIncrement());
+                fn(n->getBody());
+            }
+            break;
+        case ASTNodeType::RANGE_FOR_STMT:
+            if (auto* n = AST_CAST(RangeBasedForStatement, &node)) {
+                fn(n->getIterable());
+                fn(n->getBody());
+            }
+            break;
+        case ASTNodeType::SWITCH_STMT:
+            if (auto* n = AST_CAST(SwitchStatement, &node)) {
+                fn(n->getCondition());
+                fn(n->getBody());
+            }
+            break;
+        case ASTNodeType::CASE_STMT:
+            if (auto* n = AST_CAST(CaseStatement, &node)) {
+                fn(n->getLabel());
+                fn(n->getBody());
+            }
+            break;
+        case ASTNodeType::RETURN_STMT:
+            if (auto* n = AST_CAST(ReturnStatement, &node)) fn(n->getReturnValue());
+            break;
+        case ASTNodeType::VAR_DECL:
+            if (auto* n = AST_CAST(VarDeclNode, &node)) all(n->getDeclarations());
+            break;
+        case ASTNodeType::FUNC_DEF:
+            if (auto* n = AST_CAST(FuncDefNode, &node)) fn(n->getBody());
+            break;
+        case ASTNodeType::BINARY_OP:
+            if (auto* n = AST_CAST(BinaryOpNode, &node)) {
+                fn(n->getLeft());
+                fn(n->getRight());
+            }
+            break;
+        case ASTNodeType::UNARY_OP:
+            if (auto* n = AST_CAST(UnaryOpNode, &node)) fn(n->getOperand());
+            break;
+        case ASTNodeType::ASSIGNMENT:
+            if (auto* n = AST_CAST(AssignmentNode, &node)) {
+                fn(n->getLeft());
+                fn(n->getRight());
+            }
+            break;
+        case ASTNodeType::FUNC_CALL:
+            if (auto* n = AST_CAST(FuncCallNode, &node)) {
+                fn(n->getCallee());
+                all(n->getArguments());
+            }
+            break;
+        case ASTNodeType::CONSTRUCTOR_CALL:
+            if (auto* n = AST_CAST(ConstructorCallNode, &node)) all(n->getArguments());
+            break;
+        case ASTNodeType::MEMBER_ACCESS:
+            if (auto* n = AST_CAST(MemberAccessNode, &node)) fn(n->getObject());
+            break;
+        case ASTNodeType::ARRAY_ACCESS:
+            if (auto* n = AST_CAST(ArrayAccessNode, &node)) {
+                fn(n->getIdentifier());
+                fn(n->getIndex());
+            }
+            break;
+        case ASTNodeType::CAST_EXPR:
+            if (auto* n = AST_CAST(CastExpression, &node)) fn(n->getOperand());
+            break;
+        case ASTNodeType::SIZEOF_EXPR:
+            if (auto* n = AST_CAST(SizeofExpressionNode, &node)) fn(n->getOperand());
+            break;
+        case ASTNodeType::TERNARY_EXPR:
+            if (auto* n = AST_CAST(TernaryExpressionNode, &node)) {
+                fn(n->getCondition());
+                fn(n->getTrueExpression());
+                fn(n->getFalseExpression());
+            }
+            break;
+        case ASTNodeType::POSTFIX_EXPRESSION:
+            if (auto* n = AST_CAST(PostfixExpressionNode, &node)) fn(n->getOperand());
+            break;
+        case ASTNodeType::DESIGNATED_INITIALIZER:
+            if (auto* n = AST_CAST(DesignatedInitializerNode, &node)) fn(n->getValue());
+            break;
+        default:
+            break;
+    }
+}
+
+class Canonicalizer {
+public:
+    explicit Canonicalizer(SourcePositionMap* positions) : positions_(positions) {}
+
+    CanonicalizationStats run(ASTNode* root) {
+        walk(root);
+        for (FuncCallNode* call : identifierCalls_) {
+            bool isStatic = staticFunctions_.count(call->getCallee()->getValueAs<std::string>()) > 0;
+            setFlag(*call, ASTNodeFlags::STATIC_FUNCTION_CALL, isStatic);
+            if (isStatic) stats_.staticFunctionCalls++;
+        }
+        return stats_;
+    }
+
+private:
+    void walk(ASTNode* node) {
+        if (!node) return;
+
+        foldStructDeclarations(*node);
+
+        switch (node->getType()) {
+            case ASTNodeType::FUNC_CALL: {
+                auto* call = AST_CAST(FuncCallNode, node);
+                if (call) rewritePrintCharArguments(*call);
+                if (call && call->getCallee() && call->getCallee()->getType() == ASTNodeType::IDENTIFIER) {
+                    identifierCalls_.push_back(call);
+                } else {
+                    setFlag(*node, ASTNodeFlags::STATIC_FUNCTION_CALL, false);
+                }
+                break;
+            }
+            case ASTNodeType::VAR_DECL:
+                collectStaticFunction(*AST_CAST(VarDeclNode, node));
+                break;
+            default:
+                break;
+        }
+
+        forEachChild(*node, [this](const ASTNode* child) { walk(const_cast<ASTNode*>(child)); });
+    }
+
+    // StructType followed by ExpressionStatement(name | name, name, ...)
+    void foldStructDeclarations(ASTNode& parent) {
+        for (size_t i = 0; i + 1 < parent.getChildren().size(); i++) {
+            ASTNode* structType = parent.getChildren()[i].get();
+            ASTNode* next = parent.getChildren()[i + 1].get();
+            if (!structType || structType->getType() != ASTNodeType::STRUCT_TYPE ||
+                !structType->getChildren().empty() ||
+                !next || next->getType() != ASTNodeType::EXPRESSION_STMT) {
+                continue;
+            }
+            auto* statement = AST_CAST(ExpressionStatement, next);
+            const ASTNode* names = statement ? statement->getExpression() : nullptr;
+            if (!names) continue;
+
+            if (names->getType() == ASTNodeType::IDENTIFIER) {
+                structType->addChild(statement->releaseExpression());
+            } else if (names->getType() == ASTNodeType::COMMA_EXPRESSION) {
+                // Anything but a name in the list was never evaluated - drop it with the statement
+                auto* list = const_cast<ASTNode*>(names);
+                for (size_t j = 0; j < list->getChildren().size();) {
+                    const ASTNode* name = list->getChildren()[j].get();
+                    if (name && name->getType() == ASTNodeType::IDENTIFIER) {
+                        structType->addChild(list->removeChild(j));
+                    } else {
+                        j++;
+                    }
+                }
+            } else {
+                continue;
+            }
+            if (positions_) positions_->forget(next);   // Its address may be reused
+            parent.removeChild(i + 1);
+            stats_.structDeclarations++;
+        }
+    }
+
+    // Serial.print('A') prints the code in quotes, unlike every other char use -
+    // nested calls (int n = Serial.print('A')) included, as in the JavaScript interpreter
+    void rewritePrintCharArguments(FuncCallNode& call) {
+        const ASTNode* callee = call.getCallee();
+        if (!callee || callee->getType() != ASTNodeType::MEMBER_ACCESS) return;
+        const auto* member = AST_CONST_CAST(MemberAccessNode, callee);
+        if (!member || !member->getObject() || !member->getProperty() ||
+            member->getObject()->getType() != ASTNodeType::IDENTIFIER ||
+            member->getProperty()->getType() != ASTNodeType::IDENTIFIER ||
+            member->getObject()->getValueAs<std::string>() != "Serial" ||
+            member->getProperty()->getValueAs<std::string>() != "print") {
+            return;
+        }
+
+        for (size_t i = 0; i < call.getArguments().size(); i++) {
+            const ASTNode* arg = call.getArguments()[i].get();
+            if (!arg || arg->getType() != ASTNodeType::CHAR_LITERAL) continue;
+            std::string charStr = arg->getValueAs<std::string>();
+            char value = charStr.empty() ? '\0' : charStr[0];
+            std::string printed = "'" + std::to_string(static_cast<int32_t>(value)) + "'";
+            call.setArgument(i, std::make_unique<StringLiteralNode>(printed));
+            stats_.printCharArguments++;
+        }
+    }
+
+    // `static void f() {...}` parses as VarDecl(type "static void", f = ConstructorCall("static void"))
+    // and its body is lost. Flagging calls by this structural match (not by name)
+    // keeps the interpreter's Test 127 fallback off every call with a real definition
+    void collectStaticFunction(const VarDeclNode& decl) {
+        const ASTNode* typeNode = decl.getVarType();
+        std::string typeName = typeNode ? typeNode->getValueAs<std::string>() : "";
+        if (typeName.find("static") == std::string::npos) return;
+
+        for (const auto& declarator : decl.getDeclarations()) {
+            if (!declarator || declarator->getType() != ASTNodeType::DECLARATOR_NODE) continue;
+            const auto& children = declarator->getChildren();
+            if (children.empty() || !children[0] || children[0]->getType() != ASTNodeType::CONSTRUCTOR_CALL) continue;
+            const auto* ctor = AST_CONST_CAST(ConstructorCallNode, children[0].get());
+            const ASTNode* callee = ctor ? ctor->getCallee() : nullptr;
+            if (callee && callee->getType() == ASTNodeType::IDENTIFIER &&
+                callee->getValueAs<std::string>() == typeName) {
+                staticFunctions_.insert(declarator->getValueAs<std::string>());
+            }
+        }
+    }
+
+    static void setFlag(ASTNode& node, ASTNodeFlags flag, bool on) {
+        if (on) node.addFlag(flag);
+        else node.removeFlag(flag);
+    }
+
+    SourcePositionMap* positions_;
+    CanonicalizationStats stats_;
+    std::set<std::string> staticFunctions_;
+    std::vector<FuncCallNode*> identifierCalls_;
+};
+
+} // anonymous namespace
+
+CanonicalizationStats canonicalizeAST(ASTNode* root, SourcePositionMap* positions) {
+    return Canonicalizer(positions).run(root);
+}
+
+} // namespace arduino_ast
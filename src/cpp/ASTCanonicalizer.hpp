@@ -0,0 +1,46 @@
+/**
+ * ASTCanonicalizer.hpp - Load-time normalization of parser quirks
+ *
+ * The JavaScript parser emits a few shapes the interpreter used to untangle
+ * on every execution. canonicalizeAST() rewrites them once, right after
+ * CompactASTReader::parse(), so the visitors only ever see the normal form:
+ *
+ * - `struct Point p1, p2;` arrives as a StructType statement followed by an
+ *   ExpressionStatement holding the names; the names become the StructType's
+ *   children and the ExpressionStatement is dropped
+ * - Char literal arguments of Serial.print() calls, wherever the call
+ *   appears, become the string literal the command stream shows for them
+ *   ('A' -> "'65'")
+ * - Calls to `static` functions the parser turned into variable declarations
+ *   get ASTNodeFlags::STATIC_FUNCTION_CALL. Both parsers drop the body of
+ *   such a function, so there is nothing to run; the JavaScript reference
+ *   interpreter substitutes a hardcoded body for the one known case
+ *   (incrementCounter, test 127) and ASTInterpreter mirrors it. The flag
+ *   limits that by-name lookup to calls that cannot reach a real definition
+ *
+ * Running the pass twice is harmless.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ASTNodes.hpp"
+#include <cstdint>
+
+namespace arduino_ast {
+
+struct CanonicalizationStats {
+    uint32_t structDeclarations = 0;    // StructType + name statement pairs folded
+    uint32_t printCharArguments = 0;    // Serial.print('c') arguments rewritten
+    uint32_t staticFunctionCalls = 0;   // Calls flagged STATIC_FUNCTION_CALL
+};
+
+/**
+ * Rewrite parser quirks under `root` into their canonical form (see above)
+ * @param positions Source positions of `root`'s nodes; entries of dropped nodes are removed
+ * @return what was rewritten
+ */
+CanonicalizationStats canonicalizeAST(ASTNode* root, SourcePositionMap* positions = nullptr);
+
+} // namespace arduino_ast
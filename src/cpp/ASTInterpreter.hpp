@@ -18,12 +18,20 @@
 #include "ArduinoLibraryRegistry.hpp"
 #include "InterpreterConfig.hpp"
 #include "SyncDataProvider.hpp"
+#include "CommandEmitter.hpp"
+#include "TaskScheduler.hpp"
+#include "FunctionTiers.hpp"
+#include "ReadPrefetcher.hpp"
+#include "IntegerModel.hpp"
+#include "WorkCounters.hpp"
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <stack>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <optional>
 #include <functional>
 #include <chrono>
 #include <queue>
@@ -39,6 +47,9 @@ class ASTInterpreter;
 class ScopeManager;
 class ArduinoLibraryInterface;
 class EnhancedScopeManager;
+class DebugCallback;
+struct DebugSession;
+struct DebugStop;
 
 // =============================================================================
 // COMMAND CALLBACK INTERFACE
@@ -78,6 +89,18 @@ public:
 // INTERPRETER CONFIGURATION
 // =============================================================================
 
+/**
+ * Width of the floating-point types. Values are always held as double; the
+ * 32-bit models round every float result and store to single precision, which
+ * reproduces float32 arithmetic exactly for + - * / (double carries more than
+ * 2 * 24 + 2 significand bits).
+ */
+enum class FloatModel : uint8_t {
+    HOST_DOUBLE = 0,   // float and double are 64-bit (JavaScript reference semantics)
+    FLOAT32 = 1,       // float is 32-bit, double 64-bit (ESP32, ARM)
+    AVR = 2            // float and double are both 32-bit (AVR)
+};
+
 /**
  * Interpreter configuration options matching JavaScript implementation
  */
@@ -91,9 +114,43 @@ struct InterpreterOptions {
     bool enablePins = true;         // Enable pin operations
     bool syncMode = false;          // Test mode: immediate sync responses for digitalRead/analogRead
     bool enforceLoopLimitsOnInternalLoops = true;  // Apply maxLoopIterations to for/while/do-while loops (default true for test parity)
+    bool asyncEmission = false;     // Host only: format/deliver commands on a worker thread (same byte stream)
+    size_t emissionQueueCapacity = Config::DEFAULT_EMISSION_QUEUE_CAPACITY;  // Records queued before emit blocks
+    bool greenThreads = false;      // Host only: run xTaskCreate() tasks as cooperative green threads (syncMode)
+    FloatModel floatModel = FloatModel::HOST_DOUBLE;  // Precision of float/double arithmetic and storage
+    IntModel intModel = IntModel::HOST;  // Widths of char/short/int/long (wrap-around of stores and int arithmetic)
+    uint32_t tierUpThreshold = Config::DEFAULT_TIER_UP_THRESHOLD;  // Calls + back-edges before a function is prepared (0 = never)
+    bool speculativePrefetch = false;  // Request each loop() iteration's reads up front, predicted from the previous one (READ_PREFETCH)
+    uint32_t prefetchMaxAgeMicros = Config::DEFAULT_PREFETCH_MAX_AGE_US;  // Staleness limit for prefetched values (0 = none)
     std::string version = "22.0.0";  // Interpreter version
 };
 
+/**
+ * Data model of a target board: integer widths and float precision together
+ */
+enum class TargetProfile : uint8_t {
+    HOST = 0,    // JavaScript reference semantics
+    ESP32 = 1,   // 32-bit int, 32-bit float, 64-bit double (also ARM)
+    AVR = 2      // 16-bit int, float and double both 32-bit
+};
+
+inline void applyTargetProfile(InterpreterOptions& options, TargetProfile target) {
+    switch (target) {
+        case TargetProfile::HOST:
+            options.intModel = IntModel::HOST;
+            options.floatModel = FloatModel::HOST_DOUBLE;
+            break;
+        case TargetProfile::ESP32:
+            options.intModel = IntModel::ILP32;
+            options.floatModel = FloatModel::FLOAT32;
+            break;
+        case TargetProfile::AVR:
+            options.intModel = IntModel::AVR;
+            options.floatModel = FloatModel::AVR;
+            break;
+    }
+}
+
 /**
  * Variable representation matching JavaScript dynamic typing
  */
@@ -106,6 +163,11 @@ struct Variable {
     bool isGlobal = false;
     std::string templateType = "";  // For template instantiations like vector<int>
     Variable* referenceTarget = nullptr;  // For reference variables
+    bool watched = false;  // Watchpoint on this storage slot (owned by ScopeManager, not copied)
+    mutable IntKind intKind = IntKind::UNRESOLVED;  // Integer width of `type` (array: element), resolved on first use
+#if ENABLE_WORK_COUNTERS
+    CopyCounter copies;  // Copying a Variable is counted work
+#endif
     
     Variable() : value(std::monostate{}), type("undefined") {}
     
@@ -141,6 +203,7 @@ struct Variable {
             return;
         }
         
+        countWork(WorkUnit::VALUE_COPIES);
         value = val;
     }
     
@@ -215,6 +278,20 @@ class ScopeManager {
 private:
     std::vector<std::unordered_map<std::string, Variable>> scopes_;
     std::unordered_map<std::string, Variable> staticVariables_;  // Static variables persist across scopes
+    std::unordered_set<std::string> watchedGlobals_;  // Globals/statics watched as soon as they are declared
+    // Advanced whenever the library object a name resolves to may have
+    // changed, so bound obj.method() call sites know to resolve again
+    uint64_t objectEpoch_ = 0;
+    bool localObjects_ = false;   // A library object was stored in a local scope
+
+    static bool isLibraryObject(const CommandValue& value) {
+        const auto* text = std::get_if<std::string>(&value);
+        return text && text->compare(0, 17, "__library_object_") == 0;
+    }
+
+    void localScopesChanged() {
+        if (localObjects_) objectEpoch_++;
+    }
     
 public:
     ScopeManager() {
@@ -229,11 +306,20 @@ public:
     void popScope() {
         if (scopes_.size() > 1) { // Keep global scope
             scopes_.pop_back();
+            localScopesChanged();
         }
     }
+
+    uint64_t getObjectEpoch() const { return objectEpoch_; }
+
+    /** The current local scope was overwritten in place (StateGuard) */
+    void localScopeRestored() { localScopesChanged(); }
     
     void setVariable(const std::string& name, const Variable& var) {
+        countWork(WorkUnit::SCOPE_LOOKUPS);
         Variable newVar = var;
+        bool storesObject = isLibraryObject(newVar.value);
+        if (storesObject) objectEpoch_++;
 
         // Mark as global if we're in global scope
         if (scopes_.size() == 1) {
@@ -242,6 +328,10 @@ public:
 
         if (newVar.isStatic) {
             // Static variables go in special storage
+            auto found = staticVariables_.find(name);
+            newVar.watched = found != staticVariables_.end() ? found->second.watched
+                                                              : watchedGlobals_.count(name) > 0;
+            if (found != staticVariables_.end() && isLibraryObject(found->second.value)) objectEpoch_++;
             staticVariables_[name] = newVar;
         } else {
             // CRITICAL FIX: Search parent scopes first and update if found
@@ -250,16 +340,38 @@ public:
                 auto found = it->find(name);
                 if (found != it->end()) {
                     // Variable exists in this scope - update it
+                    newVar.watched = found->second.watched;
+                    if (!storesObject && isLibraryObject(found->second.value)) objectEpoch_++;
                     found->second = newVar;
                     return;
                 }
             }
             // Variable doesn't exist anywhere - create in current scope
+            newVar.watched = scopes_.size() == 1 && !watchedGlobals_.empty() && watchedGlobals_.count(name) > 0;
+            if (storesObject && scopes_.size() > 1) localObjects_ = true;
             scopes_.back()[name] = newVar;
         }
     }
+
+    /**
+     * Watch (or stop watching) the slot currently visible as `name`. Global and
+     * static names are also remembered, so a slot declared later is watched
+     * from creation. @return false if no slot exists yet (only the name is kept)
+     */
+    bool setWatched(const std::string& name, bool on) {
+        Variable* var = getVariable(name);
+        bool lasting = !var || var->isGlobal || var->isStatic;
+        if (var) var->watched = on;
+        if (lasting) {
+            if (on) watchedGlobals_.insert(name);
+            else watchedGlobals_.erase(name);
+        }
+        return var != nullptr;
+    }
     
     Variable* getVariable(const std::string& name) {
+        countWork(WorkUnit::SCOPE_LOOKUPS);
+
         // First check static variables
         auto staticFound = staticVariables_.find(name);
         if (staticFound != staticVariables_.end()) {
@@ -277,6 +389,8 @@ public:
     }
     
     bool hasVariable(const std::string& name) const {
+        countWork(WorkUnit::SCOPE_LOOKUPS);
+
         // Check static variables first
         if (staticVariables_.find(name) != staticVariables_.end()) {
             return true;
@@ -299,6 +413,8 @@ public:
 
     // TEST 43 ULTRATHINK FIX: Check if variable exists in parent scopes (not current scope)
     bool hasVariableInParentScope(const std::string& name) const {
+        countWork(WorkUnit::SCOPE_LOOKUPS);
+
         // Check static variables first
         if (staticVariables_.find(name) != staticVariables_.end()) {
             return true;
@@ -328,11 +444,23 @@ public:
     
     bool isGlobalScope() const { return scopes_.size() == 1; }
 
+    /**
+     * Exchange every scope above the global one with `locals`, whose first
+     * element is a placeholder for the global scope. O(1): green threads keep
+     * their own locals while the global scope stays in place.
+     */
+    void swapLocalScopes(std::vector<std::unordered_map<std::string, Variable>>& locals) {
+        scopes_.swap(locals);
+        scopes_.front().swap(locals.front());
+        localScopesChanged();
+    }
+
     // Reset to only global scope (for resume() between iterations)
     void resetToGlobalScope() {
         while (scopes_.size() > 1) {
             scopes_.pop_back();
         }
+        localScopesChanged();
     }
 
     void markCurrentScopeAsGlobal() {
@@ -369,6 +497,52 @@ public:
         scopes_.clear();
         staticVariables_.clear();
         pushScope(); // Global scope
+        objectEpoch_++;
+    }
+
+    // Global + static state captured for fast reset between direct function calls
+    struct GlobalSnapshot {
+        std::unordered_map<std::string, Variable> globals;
+        std::unordered_map<std::string, Variable> statics;
+    };
+
+    const std::unordered_map<std::string, Variable>& getGlobalScope() const { return scopes_.front(); }
+    const std::unordered_map<std::string, Variable>& getStaticVariables() const { return staticVariables_; }
+
+    GlobalSnapshot captureGlobals() const {
+        GlobalSnapshot snapshot{scopes_.front(), staticVariables_};
+        detachStructs(snapshot.globals);
+        detachStructs(snapshot.statics);
+        return snapshot;
+    }
+
+    // Assigns in place so Variable* / reference targets into the global scope stay valid
+    void restoreGlobals(const GlobalSnapshot& snapshot) {
+        resetToGlobalScope();
+        restoreInto(scopes_.front(), snapshot.globals);
+        restoreInto(staticVariables_, snapshot.statics);
+        objectEpoch_++;
+    }
+
+private:
+    // Structs are shared_ptr values - copy them so the snapshot is not mutated through aliases
+    static void detachStructs(std::unordered_map<std::string, Variable>& vars) {
+        for (auto& [name, var] : vars) {
+            if (auto* s = std::get_if<std::shared_ptr<arduino_interpreter::ArduinoStruct>>(&var.value)) {
+                if (*s) var.value = std::make_shared<arduino_interpreter::ArduinoStruct>(**s);
+            }
+        }
+    }
+
+    static void restoreInto(std::unordered_map<std::string, Variable>& target,
+                            const std::unordered_map<std::string, Variable>& source) {
+        for (auto it = target.begin(); it != target.end(); ) {
+            it = source.count(it->first) ? std::next(it) : target.erase(it);
+        }
+        for (const auto& [name, var] : source) {
+            target[name] = var;
+        }
+        detachStructs(target);
     }
 };
 
@@ -393,6 +567,7 @@ private:
     CommandValue savedReturnValue_;
     std::unordered_map<std::string, Variable> savedScope_;
     bool hasScope_;
+    FunctionTier* savedActiveTier_;
 
 public:
     StateGuard(class ASTInterpreter* interp);
@@ -419,6 +594,7 @@ class ASTInterpreter : public arduino_ast::ASTVisitor {
 private:
     // Core state
     arduino_ast::ASTNodePtr ast_;
+    std::unique_ptr<arduino_ast::SourcePositionMap> sourcePositions_;  // Null without a source position section
     InterpreterOptions options_;
     ExecutionState state_;
     
@@ -427,11 +603,45 @@ private:
     std::unique_ptr<EnhancedScopeManager> enhancedScopeManager_;
     std::unique_ptr<ArduinoLibraryInterface> libraryInterface_;  // Legacy - to be deprecated
     std::unique_ptr<ArduinoLibraryRegistry> libraryRegistry_;    // New comprehensive system
+    uint32_t libraryObjectSerial_ = 0;                           // Last library object ID suffix
+
+    // obj.method() call sites resolved to a library object method; stale
+    // once ScopeManager's object epoch has moved on
+    struct LibraryCallSite {
+        uint64_t epoch = 0;
+        LibraryMethodBinding method;
+    };
+    std::unordered_map<const arduino_ast::FuncCallNode*, LibraryCallSite> libraryCallSites_;
     
     // Command handling
     ResponseHandler* responseHandler_;
     SyncDataProvider* dataProvider_;  // Parent app provides external data (hardware, test data, etc.)
     CommandCallback* commandCallback_;  // Parent app receives commands (optional - if not set, uses OUTPUT_STREAM)
+#ifndef PLATFORM_WASM
+    std::unique_ptr<AsyncCommandEmitter> asyncEmitter_;  // Created by start() when options_.asyncEmission
+#endif
+    std::vector<std::string>* commandCapture_ = nullptr;  // callFunction(): collect instead of delivering
+
+    // Debugging (DebugSession.hpp) - null until a breakpoint, watchpoint or callback is set
+    std::unique_ptr<DebugSession> debug_;
+    bool stepPending_ = false;  // step(): stop before the next statement
+
+    // Tiered execution (FunctionTiers.hpp) - null when options_.tierUpThreshold == 0
+    std::unique_ptr<FunctionTiers> tiers_;
+    FunctionTier* activeTier_ = nullptr;  // Function whose body is running; counts its back-edges
+    // Set when the sketch first takes a function's address. Until then no
+    // variable can hold a FunctionPointer, so calls by name skip the scope
+    // lookup for one that shadows the function.
+    bool functionPointerTaken_ = false;
+
+    // Speculative read prefetch (ReadPrefetcher.hpp) - null unless options_.speculativePrefetch
+    std::unique_ptr<ReadPrefetcher> prefetcher_;
+
+    // Direct function invocation state
+    bool globalsInitialized_ = false;
+    std::string globalsError_;   // Set when initialization failed; reported by every later call
+    ScopeManager::GlobalSnapshot globalSnapshot_;
+    std::unordered_map<std::string, const arduino_ast::FuncDefNode*> callableFunctions_;
 
     // ULTRATHINK FIX: Context-Aware Execution Control Stack
     class ExecutionControlStack {
@@ -520,6 +730,31 @@ private:
     // Switch statement state management
     CommandValue currentSwitchValue_;
     bool inSwitchFallthrough_ = false;
+    // Every case label seen, by label node: its JSON if it is constant (literals,
+    // const globals), nullopt if it has to be evaluated and serialized each time
+    std::unordered_map<const arduino_ast::ASTNode*, std::optional<std::string>> caseLabelJson_;
+
+#if HAS_GREEN_THREADS
+    // Green threads (InterpreterOptions::greenThreads): the running task's
+    // execution state lives in the members above, every other task's here
+    struct TaskFrame {
+        std::vector<std::unordered_map<std::string, Variable>> scopes{1};  // [0] = global placeholder
+        std::vector<std::string> callStack;
+        ExecutionControlStack executionControl;
+        arduino_ast::ASTNode* currentFunction = nullptr;
+        uint32_t recursionDepth = 0;
+        bool shouldContinueExecution = true;
+        bool shouldBreak = false;
+        bool shouldContinue = false;
+        bool shouldReturn = false;
+        bool inSwitchFallthrough = false;
+        CommandValue returnValue;
+        CommandValue currentSwitchValue;
+        CommandValue lastExpressionResult;
+    };
+    std::unique_ptr<TaskScheduler> taskScheduler_;  // Created by start() when options_.greenThreads
+    std::unordered_map<TaskScheduler::TaskId, TaskFrame> taskFrames_;
+#endif
 
     // Continuation-based execution system (unused in syncMode, but kept for architecture compatibility)
     arduino_ast::ASTNode* suspendedNode_;
@@ -541,6 +776,8 @@ private:
     uint32_t requestIdCounter_;            // For generateRequestId()
     std::vector<std::string> callStack_;   // Function call stack tracking
     int allocationCounter_;                // malloc allocation counter
+    std::unordered_map<std::string, int> serialAvailableCalls_;  // Serial*.available() calls per port
+    int enumCounter_ = 0;                  // Next implicit enum member value
 
     // Test 127 WORKAROUND: Static function implementations for parser bug
     // Matches JavaScript workaround (ASTInterpreter.js lines 2986-3035)
@@ -549,7 +786,15 @@ private:
     int mallocCounter_;                    // malloc request counter
     std::unordered_map<std::string, StructDefinition> structTypes_;  // Struct type registry
     std::unordered_map<std::string, std::string> typeAliases_;       // Type alias registry (typedef support - Test 116)
-    std::string pendingStructType_;        // For handling parser bug: struct Type var; creates separate nodes
+
+    // Buffer builtins (memcpy, strcpy, sprintf, ...) write through their pointer arguments.
+    // The call site records which variable (and element offset) each argument names,
+    // since the evaluated CommandValue is only a copy of the array contents.
+    struct BufferArgRef {
+        std::string name;                  // Target variable, empty if argument is not addressable
+        int32_t offset = 0;                // Element offset for &buf[i] / buf + i forms
+    };
+    std::vector<BufferArgRef> bufferArgRefs_;
 
     // =============================================================================
     // PERFORMANCE TRACKING & STATISTICS
@@ -607,6 +852,7 @@ private:
     uint32_t maxRecursionDepth_;
     uint32_t timeoutOccurrences_;
     uint32_t memoryAllocations_;
+    WorkCounters workCounters_;            // Not reset by resetStatistics()
     
     // Enhanced error handling state
     bool safeMode_;
@@ -665,7 +911,9 @@ public:
     void resume();
     
     /**
-     * Execute single step (for debugging)
+     * From a debugger stop: run to the start of the next statement and stop
+     * there again (DebugStopReason::STEP)
+     * @return false if not paused
      */
     bool step();
     
@@ -684,6 +932,59 @@ public:
      */
     ExecutionState getState() const { return state_; }
 
+    // =============================================================================
+    // DEBUGGING (see DebugSession.hpp)
+    // =============================================================================
+
+    /**
+     * Stop before statement `statement` of user function `function` (numbered
+     * as in DebugSession::findStatement; only statements inside { } blocks)
+     * @param condition e.g. "i == 5 && ready", compiled once here
+     * @return breakpoint id, or -1 with `error` set
+     */
+    int addBreakpoint(const std::string& function, size_t statement, const std::string& condition = "",
+                      std::string* error = nullptr);
+    bool removeBreakpoint(int id);
+    void clearBreakpoints();
+
+    /**
+     * Stop after each write to the slot currently visible as `name`. Globals
+     * and statics can be watched before the program declares them.
+     */
+    void addWatchpoint(const std::string& name);
+    void removeWatchpoint(const std::string& name);
+
+    /**
+     * Receives every stop (breakpoint, watchpoint, step) on the interpreter thread
+     */
+    void setDebugCallback(DebugCallback* callback);
+
+    // =============================================================================
+    // TIERED EXECUTION (see FunctionTiers.hpp)
+    // =============================================================================
+
+    /**
+     * Per-function counters, tiers and promotions; null when tierUpThreshold is 0
+     */
+    const FunctionTiers* getFunctionTiers() const { return tiers_.get(); }
+
+    // =============================================================================
+    // SOURCE POSITIONS
+    // =============================================================================
+
+    /**
+     * Statement positions from the CompactAST source position section
+     * (exportCompactAST(ast, { sourcePositions: true })); nullptr without one
+     */
+    const arduino_ast::SourcePositionMap* getSourcePositions() const { return sourcePositions_.get(); }
+
+    /**
+     * Position of the innermost statement running in a { } block, as ERROR
+     * commands report it
+     * @return false without source positions or outside a block statement
+     */
+    bool getCurrentSourcePosition(arduino_ast::SourcePosition& out) const;
+
     /**
      * Get library registry for library object method calls
      */
@@ -764,7 +1065,15 @@ public:
      *
      * @param callback Pointer to CommandCallback implementation (or nullptr to disable)
      */
-    void setCommandCallback(CommandCallback* callback) { commandCallback_ = callback; }
+    void setCommandCallback(CommandCallback* callback) { flushCommands(); commandCallback_ = callback; }
+
+    /**
+     * Block until every emitted command has been delivered
+     *
+     * Only meaningful with InterpreterOptions::asyncEmission; start(), resume()
+     * and stop() already flush before returning.
+     */
+    void flushCommands();
 
     /**
      * Handle response from external system
@@ -776,11 +1085,72 @@ public:
      */
     void queueResponse(const std::string& requestId, const CommandValue& value);
 
+    /**
+     * Answer a READ_PREFETCH command: values[i] for its reads[i], in order.
+     * May be called from any thread while the iteration runs.
+     * @return false if prefetch is off or the batch is no longer current
+     */
+    bool handlePrefetchResponse(const std::string& requestId, const std::vector<int32_t>& values);
+
+    /**
+     * Prefetch hits, mispredicts, late and stale values (zero when prefetch is off)
+     */
+    PrefetchStats getPrefetchStats() const;
+
     /**
      * Process queued responses (called by executeLoop())
      */
     void processResponseQueue();
 
+    // =============================================================================
+    // DIRECT FUNCTION INVOCATION (unit testing sketch helpers)
+    // =============================================================================
+
+    /**
+     * Outcome of a direct call: return value plus only the commands that call emitted
+     */
+    struct FunctionCallResult {
+        CommandValue value = std::monostate{};
+        std::vector<std::string> commands;
+        bool success = false;   // false if the function is unknown, threw, or emitted an ERROR
+        std::string error;
+    };
+
+    /**
+     * Run global declarations/initializers once (no setup() or loop()) and take
+     * the snapshot used by resetGlobals(). Called implicitly by callFunction().
+     * If an initializer fails, no snapshot is taken and this call and every
+     * later one (callFunction() included) fail with the same error.
+     * @return commands emitted while initializing globals
+     */
+    FunctionCallResult initializeGlobals();
+
+    /**
+     * Invoke a user-defined sketch function by name via executeUserFunction()
+     * @param resetFirst restore globals/statics to their post-initialization values first
+     */
+    FunctionCallResult callFunction(const std::string& name, const std::vector<CommandValue>& args = {},
+                                    bool resetFirst = false);
+
+    /**
+     * Restore globals/statics to the snapshot taken by initializeGlobals()
+     */
+    void resetGlobals();
+
+    /**
+     * Globals/statics at some point between calls, for rolling back to it
+     * later (state-space exploration). Locals never survive a callFunction().
+     */
+    using StateSnapshot = ScopeManager::GlobalSnapshot;
+    StateSnapshot captureState() const { return scopeManager_->captureGlobals(); }
+    void restoreState(const StateSnapshot& snapshot) { scopeManager_->restoreGlobals(snapshot); }
+
+    /**
+     * Hash of every global and static (name and value). Independent of map
+     * order, so equal states hash equally however they were reached.
+     */
+    uint64_t hashState() const;
+
     // =============================================================================
     // VISITOR PATTERN IMPLEMENTATION
     // =============================================================================
@@ -960,6 +1330,27 @@ public:
     };
     
     ErrorStats getErrorStats() const;
+
+    /**
+     * Current sizes of the interpreter's growable containers (soak testing)
+     *
+     * Each should level off after a few loop() iterations; one that keeps
+     * growing with the iteration count is a leak.
+     */
+    struct ContainerSize {
+        const char* name;
+        size_t size;
+    };
+
+    std::vector<ContainerSize> getContainerSizes() const;
+
+    /**
+     * Deterministic work units per phase since construction or the last
+     * resetWorkCounters() (see WorkCounters.hpp; all zero unless built with
+     * ENABLE_WORK_COUNTERS)
+     */
+    const WorkCounters& getWorkCounters() const { return workCounters_; }
+    void resetWorkCounters() { workCounters_.clear(); }
     
     /**
      * Reset all performance statistics
@@ -1028,22 +1419,91 @@ private:
     CommandValue evaluateComparison(const std::string& op, const CommandValue& left, const CommandValue& right);
     CommandValue evaluateLogical(const std::string& op, const CommandValue& left, const CommandValue& right);
 
+    // In-place fast paths for =, +=, -=, |=, &=, <<=, ++ and -- on scalar
+    // variables and 1D array elements; false = use the general visitor code
+    bool tryFastAssignment(const arduino_ast::AssignmentNode& node, const CommandValue& rightValue);
+    bool tryFastIncrement(const arduino_ast::ASTNode* operand, bool increment, bool prefix, CommandValue& result);
+
+    // Case labels whose JSON is kept in caseLabelJson_ (asked once per label)
+    bool isConstantCaseLabel(const arduino_ast::ASTNode* label);
+
+    // Debugger slow paths - reached only through a BREAKPOINT flag, a pending
+    // step or an active watchpoint
+    DebugSession& debugSession();
+    void onStatementTrap(arduino_ast::ASTNode* statement);
+    void checkWatchpoint(const std::string& variable);
+    void debugStop(DebugStop& stop);
+    bool releaseDebugStop(ExecutionState next, bool stepAfter = false);
+
+    // Tiered execution: a loop iteration in the running function's body, and
+    // binding a user-function call site inside a tier 1 body to its callee
+    void countBackEdge() { if (activeTier_) activeTier_->backEdges++; }
+    void bindCallSite(const arduino_ast::ASTNode& callSite, const std::string& name,
+                      const arduino_ast::FuncDefNode* definition);
+
+    // The library object method an obj.method() call site was bound to by
+    // executeArduinoFunction, or null if unbound or stale
+    const LibraryMethodBinding* boundLibraryMethod(const arduino_ast::FuncCallNode& node) const;
+
+    // Speculative prefetch: a read answered from the current READ_PREFETCH batch
+    bool takePrefetched(ExternalRead kind, int32_t pin, int32_t& value) {
+        return prefetcher_ && prefetcher_->take(PredictedRead{kind, pin}, value);
+    }
+    void emitReadPrefetch(const std::string& requestId, const std::vector<PredictedRead>& reads);
+
+    // Single-precision semantics for FloatModel::FLOAT32 / AVR
+    enum class FloatRank : uint8_t { INTEGER, FLOAT, DOUBLE };
+    bool isFloat32Type(std::string_view typeName) const;
+    FloatRank floatRank(const arduino_ast::ASTNode* expr, bool& fixed);
+    std::unordered_map<const arduino_ast::ASTNode*, FloatRank> floatRanks_;   // BinaryOp nodes whose operands all resolved
+    CommandValue roundFloat32(CommandValue value) const;
+
+    // Integer widths for IntModel::ILP32 / AVR (HOST: every integer type is 32-bit)
+    IntKind intKindOf(const Variable& var) const;
+    IntKind intRank(const arduino_ast::ASTNode* expr);
+    IntKind declaredIntKind(const arduino_ast::ASTNode* node, std::string_view typeName);
+    std::unordered_map<const arduino_ast::ASTNode*, IntKind> intKinds_;   // BinaryOps, declarations and casts, computed once
+    CommandValue convertForStore(const CommandValue& value, const Variable& var);
+    bool targetIntegers() const { return options_.intModel != IntModel::HOST; }
+
     // sizeof operator support
     CommandValue visitSizeofExpression(arduino_ast::SizeofExpressionNode& node);
     int32_t getSizeofType(const std::string& typeName);
     int32_t getSizeofValue(const CommandValue& value);
 
     // Arduino function handling
-    CommandValue executeArduinoFunction(const std::string& name, const std::vector<CommandValue>& args);
-    CommandValue executeUserFunction(const std::string& name, const arduino_ast::FuncDefNode* funcDef, const std::vector<CommandValue>& args);
+    CommandValue executeArduinoFunction(const std::string& name, const std::vector<CommandValue>& args,
+                                        const arduino_ast::FuncCallNode* callSite = nullptr);
+    CommandValue executeUserFunction(const std::string& name, const arduino_ast::FuncDefNode* funcDef, const std::vector<CommandValue>& args,
+                                     FunctionTier* tier = nullptr);
     CommandValue handlePinOperation(const std::string& function, const std::vector<CommandValue>& args);
     CommandValue handleTimingOperation(const std::string& function, const std::vector<CommandValue>& args);
 
-    static void resetStaticTimingCounters();
+    void resetStaticTimingCounters();
+
+    // FreeRTOS task API on green threads (no-ops unless options_.greenThreads)
+    bool isTaskFunction(const std::string& name) const;
+    CommandValue handleTaskOperation(const std::string& function, const std::vector<CommandValue>& args);
+    void taskYield(uint64_t delayMicros);
+#if HAS_GREEN_THREADS
+    void swapTaskFrame(TaskFrame& frame);
+    void emitTaskSwitch();
+    void emitTaskEnd(TaskScheduler::TaskId task);
+#endif
     CommandValue handleSerialOperation(const std::string& function, const std::vector<CommandValue>& args);
     CommandValue handleMultipleSerialOperation(const std::string& portName, const std::string& methodName, const std::vector<CommandValue>& args);
     CommandValue handleKeyboardOperation(const std::string& function, const std::vector<CommandValue>& args);
 
+    // libc / AVR-libc buffer builtins operating directly on interpreted array storage
+    bool isBufferBuiltin(const std::string& name) const;
+    bool isBufferBuiltinCall(arduino_ast::FuncCallNode& node, const std::string& name);
+    std::vector<CommandValue> evaluateBufferArguments(const std::vector<arduino_ast::ASTNodePtr>& argNodes);
+    CommandValue handleBufferOperation(const std::string& function, const std::vector<CommandValue>& args);
+    std::string formatPrintf(const std::string& format, const std::vector<CommandValue>& args,
+                             const std::vector<BufferArgRef>& refs, size_t firstArg);
+    std::string bufferToCString(const CommandValue& value, int32_t offset = 0);
+    bool writeBuffer(const BufferArgRef& ref, const std::vector<int32_t>& cells, const std::string& function);
+
     // Helper methods for Serial system
     std::string generateRequestId(const std::string& prefix);
     
@@ -1059,6 +1519,8 @@ private:
     
     // JSON emission (replacing FlexibleCommand)
     void emitJSON(const std::string& jsonString);
+    void emitRecord(CommandRecord&& record);
+    void deliverCommand(const std::string& jsonString);
     void emitVersionInfo(const std::string& component, const std::string& version, const std::string& status);
     void emitProgramStart();
     void emitProgramEnd(const std::string& message);
@@ -1106,6 +1568,7 @@ private:
 
     // Variable operations
     void emitVarSet(const std::string& variable, const std::string& value);
+    void emitVarSetValue(const std::string& variable, const CommandValue& value);
     void emitVarSetConst(const std::string& variable, const std::string& value, const std::string& type);
     void emitVarSetConstString(const std::string& varName, const std::string& stringVal);
     void emitVarSetArduinoString(const std::string& varName, const std::string& stringVal);
@@ -1136,7 +1599,7 @@ private:
     void emitNoTone(int pin);
 
     // Additional emission methods to replace ALL FlexibleCommandFactory calls
-    void emitIfStatement(const std::string& condition, const std::string& conditionDisplay, const std::string& branch);
+    void emitIfStatement(const CommandValue& condition, bool taken);
     void emitWhileLoopIteration(int iteration);
     void emitDoWhileLoopStart();
     void emitDoWhileLoopIteration(int iteration);
@@ -1197,6 +1660,7 @@ private:
     
     // Type conversion utilities
     CommandValue convertToType(const CommandValue& value, const std::string& typeName);
+    CommandValue convertToType(const CommandValue& value, const std::string& typeName, IntKind kind);
     
     // MEMORY SAFE: AST tree traversal to find function definitions
     arduino_ast::ASTNode* findFunctionInAST(const std::string& functionName);
@@ -1249,6 +1713,23 @@ private:
  */
 std::string commandValueToJsonString(const CommandValue& value);
 
+/**
+ * Append the JSON representation of a CommandValue to `out` - same bytes as
+ * commandValueToJsonString without the temporary string
+ */
+void appendCommandValueJson(std::string& out, const CommandValue& value);
+
+/**
+ * Escape backslashes, quotes and control characters for a JSON string body
+ */
+std::string escapeJsonString(const std::string& str);
+
+/**
+ * Serial/Keyboard message argument: bare for numbers, char literals and
+ * booleans, quoted otherwise (matches JavaScript formatArgumentForDisplay)
+ */
+std::string formatArgumentForDisplay(const std::string& data);
+
 /**
  * Helper function to convert EnhancedCommandValue to JSON string representation
  * Handles ArduinoStruct serialization with proper JSON formatting
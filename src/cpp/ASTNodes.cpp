@@ -10,6 +10,9 @@
 
 #include "ASTNodes.hpp"
 #include "PlatformAbstraction.hpp"
+#include "WorkCounters.hpp"
+#include <algorithm>
+#include <functional>
 
 namespace arduino_ast {
 
@@ -47,191 +50,242 @@ std::string ASTNode::toString() const {
 // VISITOR IMPLEMENTATIONS
 // =============================================================================
 
+// Every dispatch is a work unit of whichever interpreter is running (WorkCounters.hpp)
+using arduino_interpreter::countWork;
+using arduino_interpreter::WorkUnit;
+
 void ProgramNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ErrorNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void CommentNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void CompoundStmtNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ExpressionStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void IfStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void WhileStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void DoWhileStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ForStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ReturnStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void BreakStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ContinueStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void BinaryOpNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void UnaryOpNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void SizeofExpressionNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void FuncCallNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ConstructorCallNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void MemberAccessNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void NumberNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void StringLiteralNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void IdentifierNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void VarDeclNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void FuncDefNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void TypeNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void DeclaratorNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ParamNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void EmptyStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void AssignmentNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void CharLiteralNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void PostfixExpressionNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void SwitchStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void CaseStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void RangeBasedForStatement::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ArrayAccessNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void TernaryExpressionNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ConstantNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ArrayInitializerNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void FunctionPointerDeclaratorNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void StructDeclaration::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void StructMemberNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void TypedefDeclaration::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void CommaExpression::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void StructType::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void ArrayDeclaratorNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void PointerDeclaratorNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void DesignatedInitializerNode::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
 void CastExpression::accept(ASTVisitor& visitor) {
+    countWork(WorkUnit::NODES_VISITED);
     visitor.visit(*this);
 }
 
@@ -411,6 +465,47 @@ std::string valueTypeToString(ValueType type) {
     }
 }
 
+// =============================================================================
+// SOURCE POSITION MAP
+// =============================================================================
+
+namespace {
+bool positionEntryLess(const std::pair<const ASTNode*, SourcePosition>& entry, const ASTNode* node) {
+    return std::less<const ASTNode*>()(entry.first, node);
+}
+} // anonymous namespace
+
+const SourcePosition* SourcePositionMap::find(const ASTNode* node) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), node, positionEntryLess);
+    return it != entries_.end() && it->first == node ? &it->second : nullptr;
+}
+
+const std::string& SourcePositionMap::fileName(uint16_t fileId) const {
+    static const std::string none;
+    return fileId < files_.size() ? files_[fileId] : none;
+}
+
+std::string SourcePositionMap::format(const SourcePosition& position) const {
+    const std::string& file = fileName(position.fileId);
+    std::string text = std::to_string(position.line) + ":" + std::to_string(position.column);
+    return file.empty() ? text : file + ":" + text;
+}
+
+void SourcePositionMap::add(const ASTNode* node, const SourcePosition& position) {
+    entries_.emplace_back(node, position);
+}
+
+void SourcePositionMap::forget(const ASTNode* node) {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), node, positionEntryLess);
+    if (it != entries_.end() && it->first == node) entries_.erase(it);
+}
+
+void SourcePositionMap::finalize() {
+    std::sort(entries_.begin(), entries_.end(),
+              [](const auto& a, const auto& b) { return std::less<const ASTNode*>()(a.first, b.first); });
+    entries_.shrink_to_fit();
+}
+
 size_t estimateNodeMemoryUsage(const ASTNode* node) {
     if (!node) return 0;
     
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <cmath>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -126,7 +127,7 @@ enum class ASTNodeType : uint8_t {
 /**
  * Node flags for additional properties
  */
-enum class ASTNodeFlags : uint8_t {
+enum class ASTNodeFlags : uint16_t {
     NONE = 0x00,
     HAS_CHILDREN = 0x01,
     HAS_VALUE = 0x02,
@@ -134,16 +135,23 @@ enum class ASTNodeFlags : uint8_t {
     IS_POINTER = 0x08,
     IS_REFERENCE = 0x10,
     IS_CONST = 0x20,
+    // Load-time annotations from canonicalizeAST() (ASTCanonicalizer.hpp);
+    // reserved in the binary format, so a compact AST never carries them
     RESERVED1 = 0x40,
-    RESERVED2 = 0x80
+    STATIC_FUNCTION_CALL = 0x80, // FuncCallNode: callee is a misparsed static function
+    // Runtime only, set by ASTInterpreter::addBreakpoint()
+    BREAKPOINT = 0x100,          // Statement: stop before executing it
+    // Runtime only, set by ASTInterpreter on a call's first execution
+    BUFFER_CALL_RESOLVED = 0x200, // FuncCallNode: BUFFER_BUILTIN_CALL is decided
+    BUFFER_BUILTIN_CALL = 0x400   // FuncCallNode: callee is a libc buffer builtin
 };
 
 inline ASTNodeFlags operator|(ASTNodeFlags a, ASTNodeFlags b) {
-    return static_cast<ASTNodeFlags>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
+    return static_cast<ASTNodeFlags>(static_cast<uint16_t>(a) | static_cast<uint16_t>(b));
 }
 
 inline bool operator&(ASTNodeFlags a, ASTNodeFlags b) {
-    return (static_cast<uint8_t>(a) & static_cast<uint8_t>(b)) != 0;
+    return (static_cast<uint16_t>(a) & static_cast<uint16_t>(b)) != 0;
 }
 
 /**
@@ -207,6 +215,9 @@ public:
     ASTNodeFlags getFlags() const { return flags_; }
     void setFlags(ASTNodeFlags flags) { flags_ = flags; }
     void addFlag(ASTNodeFlags flag) { flags_ = flags_ | flag; }
+    void removeFlag(ASTNodeFlags flag) {
+        flags_ = static_cast<ASTNodeFlags>(static_cast<uint16_t>(flags_) & ~static_cast<uint16_t>(flag));
+    }
     bool hasFlag(ASTNodeFlags flag) const { return flags_ & flag; }
     
     // Value access
@@ -231,6 +242,11 @@ public:
         addFlag(ASTNodeFlags::HAS_CHILDREN);
     }
     void reserveChildren(size_t count) { children_.reserve(count); }
+    ASTNodePtr removeChild(size_t index) {
+        ASTNodePtr child = std::move(children_[index]);
+        children_.erase(children_.begin() + static_cast<std::ptrdiff_t>(index));
+        return child;
+    }
     
     // Visitor pattern
     virtual void accept(ASTVisitor& visitor) = 0;
@@ -293,6 +309,7 @@ public:
     ExpressionStatement() : ASTNode(ASTNodeType::EXPRESSION_STMT) {}
     
     void setExpression(ASTNodePtr expr) { expression_ = std::move(expr); }
+    ASTNodePtr releaseExpression() { return std::move(expression_); }
     const ASTNode* getExpression() const { return expression_.get(); }
     
     void accept(ASTVisitor& visitor) override;
@@ -489,6 +506,7 @@ public:
     
     void setCallee(ASTNodePtr callee) { callee_ = std::move(callee); }
     void addArgument(ASTNodePtr arg) { arguments_.push_back(std::move(arg)); }
+    void setArgument(size_t index, ASTNodePtr arg) { arguments_[index] = std::move(arg); }
     void reserveArguments(size_t count) { arguments_.reserve(count); }
     
     const ASTNode* getCallee() const { return callee_.get(); }
@@ -541,12 +559,21 @@ public:
 
 class NumberNode : public ASTNode {
 public:
+    // C type of the literal as written: 2 is int, 2.0 double, 2.0f float
+    enum class Kind : uint8_t { INTEGER, DOUBLE, FLOAT };
+
     explicit NumberNode(double value) : ASTNode(ASTNodeType::NUMBER_LITERAL) {
         setValue(value);
+        kind_ = std::floor(value) == value ? Kind::INTEGER : Kind::DOUBLE;
     }
     
     double getNumber() const { return getValueAs<double>(); }
+    Kind getKind() const { return kind_; }
+    void setKind(Kind kind) { kind_ = kind; }   // CompactAST: from the value type
     void accept(ASTVisitor& visitor) override;
+
+private:
+    Kind kind_;
 };
 
 class StringLiteralNode : public ASTNode {
@@ -681,7 +708,7 @@ public:
     
     const ASTNode* getLeft() const { return left_.get(); }
     const ASTNode* getRight() const { return right_.get(); }
-    std::string getOperator() const { return operator_; }
+    const std::string& getOperator() const { return operator_; }
 
     // CRITICAL FIX: Override setValue to extract operator string from ASTValue
     // This matches the pattern used by BinaryOpNode and UnaryOpNode
@@ -724,7 +751,7 @@ public:
     }
     
     const ASTNode* getOperand() const { return operand_.get(); }
-    std::string getOperator() const { return operator_; }
+    const std::string& getOperator() const { return operator_; }
 
     // CRITICAL FIX: Override setValue to extract operator string from ASTValue
     void setValue(const ASTValue& value) override {
@@ -917,7 +944,8 @@ public:
     void accept(ASTVisitor& visitor) override;
 };
 
-// Struct type node
+// Struct type node; after canonicalization its children are the IdentifierNodes
+// of the variables it declares (struct Point p1, p2;)
 class StructType : public ASTNode {
 public:
     StructType() : ASTNode(ASTNodeType::STRUCT_TYPE) {}
@@ -1296,6 +1324,56 @@ public:
     void accept(ASTVisitor& visitor) override;
 };
 
+// =============================================================================
+// SOURCE POSITIONS
+// =============================================================================
+
+/**
+ * Line/column of a node's first token in the .ino source (1-based)
+ */
+struct SourcePosition {
+    uint16_t line = 0;
+    uint16_t column = 0;
+    uint16_t fileId = 0;      // Index into SourcePositionMap::fileName()
+};
+
+/**
+ * Node -> source position side table, filled from the optional CompactAST
+ * source position section (CompactASTReader::takeSourcePositions()). Only
+ * nodes the parser tagged (statements and top-level declarations) have an
+ * entry; nodes themselves carry no position.
+ */
+class SourcePositionMap {
+public:
+    bool empty() const { return entries_.empty(); }
+    size_t size() const { return entries_.size(); }
+
+    /**
+     * @return position of `node`, or nullptr if it has none
+     */
+    const SourcePosition* find(const ASTNode* node) const;
+
+    /**
+     * @return file name for `fileId`, "" if the exporter recorded none
+     */
+    const std::string& fileName(uint16_t fileId) const;
+
+    /**
+     * "file:line:column", or "line:column" without a file name
+     */
+    std::string format(const SourcePosition& position) const;
+
+    // Loading (CompactASTReader) and load-time rewrites (canonicalizeAST)
+    void addFile(std::string name) { files_.push_back(std::move(name)); }
+    void add(const ASTNode* node, const SourcePosition& position);
+    void forget(const ASTNode* node);
+    void finalize();
+
+private:
+    std::vector<std::string> files_;
+    std::vector<std::pair<const ASTNode*, SourcePosition>> entries_;   // Sorted by node after finalize()
+};
+
 // =============================================================================
 // VISITOR PATTERN
 // =============================================================================
@@ -642,8 +642,10 @@ FunctionPointer::FunctionPointer(const std::string& name, ASTInterpreter* interp
     // Simple random suffix (not cryptographically secure, but sufficient for IDs)
     int random_suffix = (millis * 31 + std::hash<std::string>{}(name)) % 100000;
 
+    // Fixed width: the length of output carrying the id must not depend on the clock
+    std::string suffix = std::to_string(random_suffix);
     StringBuildStream ss;
-    ss << "fptr_" << millis << "_" << random_suffix;
+    ss << "fptr_" << millis << "_" << std::string(5 - suffix.size(), '0') << suffix;
     pointerId = ss.str();
 }
 
@@ -12,6 +12,11 @@
 #include "PlatformAbstraction.hpp"
 #include <cmath>
 
+#if HAS_NATIVE_LIBRARIES
+#include "NativeLibraryABI.h"
+#include <dlfcn.h>
+#endif
+
 namespace arduino_interpreter {
 
 // Helper conversion functions
@@ -69,14 +74,22 @@ CommandValue ArduinoLibraryObject::callMethod(const std::string& methodName,
         return std::monostate{};
     }
 
-    auto registry = interpreter->getLibraryRegistry();
-    if (!registry) {
-        return std::monostate{};
+    const LibraryDefinition* libDef = definition.get();
+    if (!libDef) {
+        auto registry = interpreter->getLibraryRegistry();
+        if (!registry) {
+            return std::monostate{};
+        }
+        libDef = registry->getLibraryDefinition(libraryName);
+        if (!libDef) {
+            return std::monostate{};
+        }
     }
 
-    const LibraryDefinition* libDef = registry->getLibraryDefinition(libraryName);
-    if (!libDef) {
-        return std::monostate{};
+    // Check if this is an OBJECT method (computed locally from this object's state)
+    auto objectIt = libDef->objectMethods.find(methodName);
+    if (objectIt != libDef->objectMethods.end()) {
+        return objectIt->second(state, args, interpreter);
     }
 
     // Check if this is an INTERNAL method (executed locally, returns value immediately)
@@ -99,6 +112,12 @@ CommandValue ArduinoLibraryObject::callMethod(const std::string& methodName,
     return std::monostate{};
 }
 
+CommandValue LibraryMethodBinding::call(const std::vector<CommandValue>& args, ASTInterpreter* interpreter) const {
+    if (objectMethod) return (*objectMethod)(object->state, args, interpreter);
+    if (internalMethod) return (*internalMethod)(args, interpreter);
+    return std::monostate{};   // External methods return undefined (see callMethod)
+}
+
 // =============================================================================
 // ARDUINO LIBRARY REGISTRY IMPLEMENTATION
 // =============================================================================
@@ -348,7 +367,7 @@ void ArduinoLibraryRegistry::registerEEPROMLibrary() {
 }
 
 void ArduinoLibraryRegistry::registerLibrary(const LibraryDefinition& library) {
-    libraries_[library.libraryName] = library;
+    libraries_[library.libraryName] = std::make_shared<const LibraryDefinition>(library);
 }
 
 std::shared_ptr<ArduinoLibraryObject> ArduinoLibraryRegistry::createLibraryObject(
@@ -360,6 +379,10 @@ std::shared_ptr<ArduinoLibraryObject> ArduinoLibraryRegistry::createLibraryObjec
     }
 
     auto object = std::make_shared<ArduinoLibraryObject>(libraryName, args);
+    object->definition = libraries_.at(libraryName);
+    if (object->definition->createState) {
+        object->state = object->definition->createState(args, interpreter_);
+    }
 
     // Store object with provided unique ID (NOT generated - must match ASTInterpreter's ID!)
     libraryObjects_[objectId] = object;
@@ -367,6 +390,166 @@ std::shared_ptr<ArduinoLibraryObject> ArduinoLibraryRegistry::createLibraryObjec
     return object;
 }
 
+// =============================================================================
+// NATIVE LIBRARIES (shared objects, NativeLibraryABI.h)
+// =============================================================================
+
+#if HAS_NATIVE_LIBRARIES
+
+namespace {
+
+// Argument strings point into `value`, which outlives the call
+ArduinoNativeValue toNativeValue(const CommandValue& value) {
+    ArduinoNativeValue out{ARDUINO_NATIVE_VOID, 0, 0.0, nullptr};
+    if (std::holds_alternative<bool>(value)) {
+        out.type = ARDUINO_NATIVE_BOOL;
+        out.asInt = std::get<bool>(value) ? 1 : 0;
+    } else if (std::holds_alternative<int32_t>(value)) {
+        out.type = ARDUINO_NATIVE_INT;
+        out.asInt = std::get<int32_t>(value);
+    } else if (std::holds_alternative<uint32_t>(value)) {
+        out.type = ARDUINO_NATIVE_INT;
+        out.asInt = static_cast<int32_t>(std::get<uint32_t>(value));
+    } else if (std::holds_alternative<double>(value)) {
+        out.type = ARDUINO_NATIVE_DOUBLE;
+        out.asDouble = std::get<double>(value);
+    } else if (std::holds_alternative<std::string>(value)) {
+        out.type = ARDUINO_NATIVE_STRING;
+        out.asString = std::get<std::string>(value).c_str();
+    }
+    return out;
+}
+
+CommandValue fromNativeValue(const ArduinoNativeValue& value) {
+    switch (value.type) {
+        case ARDUINO_NATIVE_BOOL: return value.asInt != 0;
+        case ARDUINO_NATIVE_INT: return value.asInt;
+        case ARDUINO_NATIVE_DOUBLE: return value.asDouble;
+        case ARDUINO_NATIVE_STRING: return std::string(value.asString ? value.asString : "");
+        default: return std::monostate{};
+    }
+}
+
+int32_t hostSensorValue(void* context, const char* library, const char* method, int32_t arg) {
+    auto* interpreter = static_cast<ASTInterpreter*>(context);
+    if (!interpreter || !interpreter->getSyncDataProvider()) return -1;
+    return interpreter->getSyncDataProvider()->getLibrarySensorValue(library ? library : "",
+                                                                     method ? method : "", arg);
+}
+
+ArduinoNativeHost makeHost(ASTInterpreter* interpreter) {
+    return ArduinoNativeHost{ARDUINO_NATIVE_ABI_VERSION, interpreter, &hostSensorValue};
+}
+
+// Arguments are converted into a fixed buffer; sketches rarely pass more
+constexpr size_t INLINE_NATIVE_ARGS = 8;
+
+CommandValue callNative(ArduinoNativeFunction function, void* state,
+                        const std::vector<CommandValue>& args, ASTInterpreter* interpreter) {
+    ArduinoNativeValue inlineArgs[INLINE_NATIVE_ARGS];
+    std::vector<ArduinoNativeValue> heapArgs;
+    ArduinoNativeValue* native = inlineArgs;
+    if (args.size() > INLINE_NATIVE_ARGS) {
+        heapArgs.resize(args.size());
+        native = heapArgs.data();
+    }
+    for (size_t i = 0; i < args.size(); ++i) native[i] = toNativeValue(args[i]);
+
+    ArduinoNativeHost host = makeHost(interpreter);
+    ArduinoNativeValue result{ARDUINO_NATIVE_VOID, 0, 0.0, nullptr};
+    function(state, native, static_cast<uint32_t>(args.size()), &result, &host);
+    return fromNativeValue(result);
+}
+
+// Every function pointer is bound here; `module` keeps the shared object loaded
+LibraryDefinition makeNativeDefinition(const ArduinoNativeLibrary& lib, const std::shared_ptr<void>& module) {
+    LibraryDefinition definition;
+    definition.libraryName = lib.name;
+
+    for (uint32_t i = 0; i < lib.methodCount; ++i) {
+        ArduinoNativeFunction function = lib.methods[i].function;
+        if (!lib.methods[i].name || !function) continue;
+        definition.objectMethods[lib.methods[i].name] =
+            [function, module](void* state, const std::vector<CommandValue>& args, ASTInterpreter* interpreter) {
+                return callNative(function, state, args, interpreter);
+            };
+    }
+    for (uint32_t i = 0; i < lib.staticMethodCount; ++i) {
+        ArduinoNativeFunction function = lib.staticMethods[i].function;
+        if (!lib.staticMethods[i].name || !function) continue;
+        definition.staticMethods[lib.staticMethods[i].name] =
+            [function, module](const std::vector<CommandValue>& args, ASTInterpreter* interpreter) {
+                return callNative(function, nullptr, args, interpreter);
+            };
+    }
+    for (uint32_t i = 0; i < lib.externalMethodCount; ++i) {
+        if (lib.externalMethods[i]) definition.externalMethods.insert(lib.externalMethods[i]);
+    }
+    for (uint32_t i = 0; i < lib.constructorArgCount; ++i) {
+        definition.constructorArgs.push_back(lib.constructorArgs[i] ? lib.constructorArgs[i] : "");
+    }
+
+    if (lib.create) {
+        auto create = lib.create;
+        definition.createState = [create, module](const std::vector<CommandValue>& args, ASTInterpreter* interpreter) {
+            std::vector<ArduinoNativeValue> native;
+            native.reserve(args.size());
+            for (const auto& arg : args) native.push_back(toNativeValue(arg));
+            ArduinoNativeHost host = makeHost(interpreter);
+            return create(native.data(), static_cast<uint32_t>(native.size()), &host);
+        };
+    }
+    if (lib.destroy) {
+        auto destroy = lib.destroy;
+        definition.destroyState = [destroy, module](void* state) { destroy(state); };
+    }
+    return definition;
+}
+
+} // anonymous namespace
+
+bool ArduinoLibraryRegistry::loadNativeLibrary(const std::string& path, std::string* error) {
+    auto fail = [&](const std::string& reason) {
+        if (error) *error = path + ": " + reason;
+        return false;
+    };
+
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        const char* reason = dlerror();
+        if (error) *error = reason ? reason : path + ": cannot be loaded";
+        return false;
+    }
+    std::shared_ptr<void> module(handle, [](void* h) { dlclose(h); });
+
+    auto entry = reinterpret_cast<ArduinoNativeEntry>(dlsym(handle, ARDUINO_NATIVE_ENTRY_SYMBOL));
+    if (!entry) return fail("no " ARDUINO_NATIVE_ENTRY_SYMBOL "() entry point");
+
+    const ArduinoNativeModule* table = entry(ARDUINO_NATIVE_ABI_VERSION);
+    if (!table) return fail("plugin does not support ABI version " + std::to_string(ARDUINO_NATIVE_ABI_VERSION));
+    if (table->abiVersion != ARDUINO_NATIVE_ABI_VERSION) {
+        return fail("built for ABI version " + std::to_string(table->abiVersion) +
+                    ", host is " + std::to_string(ARDUINO_NATIVE_ABI_VERSION));
+    }
+
+    // Validate every table before registering any, so a bad plugin changes nothing
+    std::vector<LibraryDefinition> definitions;
+    for (uint32_t i = 0; i < table->libraryCount; ++i) {
+        const ArduinoNativeLibrary& lib = table->libraries[i];
+        if (lib.structSize < sizeof(ArduinoNativeLibrary)) return fail("library table " + std::to_string(i) + " is truncated");
+        if (!lib.name || !*lib.name) return fail("library table " + std::to_string(i) + " has no name");
+        definitions.push_back(makeNativeDefinition(lib, module));
+    }
+    if (definitions.empty()) return fail("exports no libraries");
+
+    for (const auto& definition : definitions) {
+        registerLibrary(definition);
+    }
+    return true;
+}
+
+#endif // HAS_NATIVE_LIBRARIES
+
 CommandValue ArduinoLibraryRegistry::callStaticMethod(const std::string& libraryName, 
                                                      const std::string& methodName,
                                                      const std::vector<CommandValue>& args) {
@@ -375,8 +558,8 @@ CommandValue ArduinoLibraryRegistry::callStaticMethod(const std::string& library
         return std::monostate{};  // Library not found
     }
     
-    auto methodIt = it->second.staticMethods.find(methodName);
-    if (methodIt == it->second.staticMethods.end()) {
+    auto methodIt = it->second->staticMethods.find(methodName);
+    if (methodIt == it->second->staticMethods.end()) {
         return std::monostate{};  // Method not found
     }
 
@@ -402,6 +585,28 @@ CommandValue ArduinoLibraryRegistry::callObjectMethod(const std::string& objectI
     return libraryObject->callMethod(methodName, args, interpreter_);
 }
 
+LibraryMethodBinding ArduinoLibraryRegistry::bindObjectMethod(const std::string& objectId,
+                                                              const std::string& methodName) const {
+    LibraryMethodBinding binding;
+    auto it = libraryObjects_.find(objectId);
+    if (it == libraryObjects_.end() || !it->second || !it->second->definition) {
+        return binding;
+    }
+
+    binding.object = it->second;
+    const LibraryDefinition& definition = *binding.object->definition;
+    auto objectIt = definition.objectMethods.find(methodName);
+    if (objectIt != definition.objectMethods.end()) {
+        binding.objectMethod = &objectIt->second;
+        return binding;
+    }
+    auto internalIt = definition.internalMethods.find(methodName);
+    if (internalIt != definition.internalMethods.end()) {
+        binding.internalMethod = &internalIt->second;
+    }
+    return binding;
+}
+
 bool ArduinoLibraryRegistry::hasLibrary(const std::string& libraryName) const {
     return libraries_.find(libraryName) != libraries_.end();
 }
@@ -413,12 +618,12 @@ bool ArduinoLibraryRegistry::hasStaticMethod(const std::string& libraryName,
         return false;
     }
     
-    return it->second.staticMethods.find(methodName) != it->second.staticMethods.end();
+    return it->second->staticMethods.find(methodName) != it->second->staticMethods.end();
 }
 
 const LibraryDefinition* ArduinoLibraryRegistry::getLibraryDefinition(const std::string& libraryName) const {
     auto it = libraries_.find(libraryName);
-    return (it != libraries_.end()) ? &it->second : nullptr;
+    return (it != libraries_.end()) ? it->second.get() : nullptr;
 }
 
 LibraryObjectMetadata ArduinoLibraryRegistry::getLibraryObjectMetadata(const std::string& objectId) const {
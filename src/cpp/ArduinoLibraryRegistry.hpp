@@ -11,6 +11,7 @@
 #pragma once
 
 #include "ArduinoDataTypes.hpp"
+#include "PlatformAbstraction.hpp"
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -18,6 +19,13 @@
 #include <string>
 #include <functional>
 
+// Libraries loaded from shared objects (NativeLibraryABI.h) - POSIX hosts only
+#if defined(PLATFORM_LINUX) && !defined(_WIN32)
+#define HAS_NATIVE_LIBRARIES 1
+#else
+#define HAS_NATIVE_LIBRARIES 0
+#endif
+
 namespace arduino_interpreter {
 
 // Forward declarations
@@ -48,6 +56,12 @@ struct ExternalMethodInfo {
  */
 using StaticMethod = std::function<CommandValue(const std::vector<CommandValue>&, class ASTInterpreter*)>;
 
+/**
+ * Object method signature - like InternalMethod, plus the object's own state
+ * (see LibraryDefinition::createState)
+ */
+using ObjectMethod = std::function<CommandValue(void* state, const std::vector<CommandValue>&, class ASTInterpreter*)>;
+
 /**
  * Library object metadata for emission
  */
@@ -76,8 +90,16 @@ struct LibraryDefinition {
     // Static methods - class-level methods (e.g., Adafruit_NeoPixel.Color)
     std::unordered_map<std::string, StaticMethod> staticMethods;
     
+    // Object methods - calculated locally from per-object state (native libraries)
+    std::unordered_map<std::string, ObjectMethod> objectMethods;
+
     // Constructor parameter names for object creation
     std::vector<std::string> constructorArgs;
+
+    // Per-object state (optional) - created with the constructor arguments,
+    // destroyed when the object is released
+    std::function<void*(const std::vector<CommandValue>&, class ASTInterpreter*)> createState = nullptr;
+    std::function<void(void*)> destroyState = nullptr;
     
     // Library-specific initialization function (optional)
     std::function<void()> initFunction = nullptr;
@@ -95,11 +117,22 @@ public:
     std::string libraryName;
     std::vector<CommandValue> constructorArgs;
     std::unordered_map<std::string, CommandValue> properties;
+    // Set by the registry at creation; kept alive (with a native library's
+    // module) for as long as the object, even if the library is re-registered
+    std::shared_ptr<const LibraryDefinition> definition;
+    void* state = nullptr;                           // LibraryDefinition::createState result
     
     ArduinoLibraryObject(const std::string& name, const std::vector<CommandValue>& args)
         : libraryName(name), constructorArgs(args) {
         initializeLibraryProperties();
     }
+
+    ~ArduinoLibraryObject() {
+        if (state && definition && definition->destroyState) definition->destroyState(state);
+    }
+
+    ArduinoLibraryObject(const ArduinoLibraryObject&) = delete;
+    ArduinoLibraryObject& operator=(const ArduinoLibraryObject&) = delete;
     
     /**
      * Call a method on this library object
@@ -111,6 +144,20 @@ private:
     void initializeLibraryProperties();
 };
 
+/**
+ * An object method resolved once, for a call site to keep (ASTInterpreter
+ * binds obj.method() calls). The method pointers point into the object's
+ * definition, which the object keeps alive.
+ */
+struct LibraryMethodBinding {
+    std::shared_ptr<ArduinoLibraryObject> object;
+    const ObjectMethod* objectMethod = nullptr;
+    const InternalMethod* internalMethod = nullptr;   // External and unknown methods: neither
+
+    explicit operator bool() const { return object != nullptr; }
+    CommandValue call(const std::vector<CommandValue>& args, ASTInterpreter* interpreter) const;
+};
+
 // =============================================================================
 // ARDUINO LIBRARY REGISTRY
 // =============================================================================
@@ -122,7 +169,7 @@ private:
 class ArduinoLibraryRegistry {
 private:
     ASTInterpreter* interpreter_;
-    std::unordered_map<std::string, LibraryDefinition> libraries_;
+    std::unordered_map<std::string, std::shared_ptr<const LibraryDefinition>> libraries_;
     std::unordered_map<std::string, std::shared_ptr<ArduinoLibraryObject>> libraryObjects_;
     
 public:
@@ -134,9 +181,20 @@ public:
     void registerStandardLibraries();
     
     /**
-     * Register a custom library definition
+     * Register a custom library definition. Replacing a library leaves objects
+     * created earlier on the definition they were created with.
      */
     void registerLibrary(const LibraryDefinition& library);
+
+#if HAS_NATIVE_LIBRARIES
+    /**
+     * Load a shared object implementing NativeLibraryABI.h and register every
+     * library it exports (replacing built-ins of the same name). The object
+     * stays loaded while any of its libraries or objects is alive.
+     * @return false with a reason in *error if nothing was registered
+     */
+    bool loadNativeLibrary(const std::string& path, std::string* error = nullptr);
+#endif
     
     /**
      * Create a library object instance
@@ -158,6 +216,12 @@ public:
                                   const std::string& methodName,
                                   const std::vector<CommandValue>& args);
 
+    /**
+     * Resolve a method on a library object instance for repeated calls
+     * @return an empty binding if there is no such object
+     */
+    LibraryMethodBinding bindObjectMethod(const std::string& objectId, const std::string& methodName) const;
+
     /**
      * Check if a library is registered
      */
@@ -0,0 +1,260 @@
+/**
+ * CommandBroadcastHub.cpp - One command stream, many independent readers
+ *
+ * Version: 1.0
+ */
+
+#include "CommandBroadcastHub.hpp"
+
+#ifndef PLATFORM_WASM
+
+#include <algorithm>
+#include <cstring>
+
+namespace arduino_interpreter {
+
+// Append-only: bytes below `used` never change once a command is published,
+// so readers use them without the lock
+struct CommandBroadcastHub::Chunk {
+    std::unique_ptr<char[]> bytes;
+    size_t size = 0;
+    size_t used = 0;
+
+    explicit Chunk(size_t bytesNeeded) : bytes(new char[bytesNeeded]), size(bytesNeeded) {}
+};
+
+CommandBroadcastHub::CommandBroadcastHub(size_t capacity, size_t chunkBytes)
+    : capacity_(capacity > 0 ? capacity : 1), chunkBytes_(chunkBytes > 0 ? chunkBytes : 1) {}
+
+uint64_t CommandBroadcastHub::coalesceKey(std::string_view json) {
+    static constexpr std::string_view TYPE_PREFIX = "{\"type\":\"";
+    if (json.substr(0, TYPE_PREFIX.size()) != TYPE_PREFIX) return 0;
+    size_t typeEnd = json.find('"', TYPE_PREFIX.size());
+    if (typeEnd == std::string_view::npos) return 0;
+    std::string_view type = json.substr(TYPE_PREFIX.size(), typeEnd - TYPE_PREFIX.size());
+
+    std::string_view field;
+    if (type == "DIGITAL_WRITE" || type == "ANALOG_WRITE" || type == "PIN_MODE") {
+        field = "\"pin\":";
+    } else if (type == "VAR_SET") {
+        field = "\"variable\":\"";
+    } else {
+        return 0;
+    }
+
+    size_t start = json.find(field, typeEnd);
+    if (start == std::string_view::npos) return 0;
+    start += field.size();
+    size_t end = json.find_first_of(",}\"", start);
+    if (end == std::string_view::npos) return 0;
+
+    std::hash<std::string_view> hash;
+    uint64_t key = hash(type) * 1000003u ^ hash(json.substr(start, end - start));
+    return key != 0 ? key : 1;
+}
+
+std::string_view CommandBroadcastHub::store(std::string_view text, std::shared_ptr<const Chunk>& chunk) {
+    std::shared_ptr<Chunk> target;
+    if (text.size() > chunkBytes_) {
+        target = std::make_shared<Chunk>(text.size());   // Oversized: own chunk, tail stays
+    } else {
+        if (!tail_ || tail_->size - tail_->used < text.size()) {
+            tail_ = std::make_shared<Chunk>(chunkBytes_);
+        }
+        target = tail_;
+    }
+
+    char* dest = target->bytes.get() + target->used;
+    if (!text.empty()) std::memcpy(dest, text.data(), text.size());
+    target->used += text.size();
+    chunk = target;
+    return std::string_view(dest, text.size());
+}
+
+bool CommandBroadcastHub::blockedByReader() const {
+    uint64_t oldest = oldestSeq();
+    if (lowestCursor_ > oldest) return false;
+    for (const auto& entry : subscribers_) {
+        if (entry.second.policy == BackpressurePolicy::BLOCK && entry.second.cursor <= oldest) return true;
+    }
+    return false;
+}
+
+void CommandBroadcastHub::retireOldest() {
+    uint64_t oldest = oldestSeq();
+    const Entry& entry = log_.front();
+
+    if (lowestCursor_ <= oldest) {
+        uint64_t lowest = nextSeq_;
+        for (auto& item : subscribers_) {
+            Subscriber& sub = item.second;
+            if (sub.cursor <= oldest) {
+                if (sub.policy == BackpressurePolicy::COALESCE && entry.key != 0) {
+                    auto& slot = sub.retired[entry.key];
+                    if (slot.second.chunk) sub.stats.coalesced++;
+                    slot = {oldest, entry};
+                } else {
+                    sub.stats.dropped++;   // BLOCK only gets here after close()
+                }
+                sub.cursor = oldest + 1;
+            }
+            lowest = std::min(lowest, sub.cursor);
+        }
+        lowestCursor_ = lowest;
+    }
+    if (entry.key != 0) {
+        auto newest = newestByKey_.find(entry.key);
+        if (newest != newestByKey_.end() && newest->second == oldest) newestByKey_.erase(newest);
+    }
+    log_.pop_front();
+}
+
+uint64_t CommandBroadcastHub::publish(std::string_view jsonCommand) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (log_.size() >= capacity_) {
+        if (!closed_ && blockedByReader()) {
+            publisherWaits_++;
+            publisherBlocked_ = true;
+            consumed_.wait(lock, [this] { return closed_ || !blockedByReader(); });
+            publisherBlocked_ = false;
+        }
+        while (log_.size() >= capacity_) retireOldest();
+    }
+
+    Entry entry;
+    entry.text = store(jsonCommand, entry.chunk);
+    entry.key = coalesceKey(entry.text);
+    uint64_t seq = nextSeq_++;
+    if (entry.key != 0) newestByKey_[entry.key] = seq;
+    log_.push_back(std::move(entry));
+
+    if (waitingReaders_ > 0) published_.notify_all();
+    return seq;
+}
+
+CommandBroadcastHub::SubscriberId CommandBroadcastHub::subscribe(BackpressurePolicy policy, bool fromOldest) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SubscriberId id = nextSubscriber_++;
+    Subscriber& sub = subscribers_[id];
+    sub.policy = policy;
+    sub.cursor = fromOldest ? oldestSeq() : nextSeq_;
+    lowestCursor_ = std::min(lowestCursor_, sub.cursor);
+    return id;
+}
+
+void CommandBroadcastHub::unsubscribe(SubscriberId subscriber) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.erase(subscriber);
+    if (publisherBlocked_) consumed_.notify_one();
+    published_.notify_all();   // A reader waiting on this id returns
+}
+
+size_t CommandBroadcastHub::collect(Subscriber& sub, std::vector<BroadcastMessage>& out, size_t max) {
+    size_t count = 0;
+    uint64_t oldest = oldestSeq();
+    auto deliver = [&](uint64_t seq, const Entry& entry) {
+        out.push_back(BroadcastMessage{seq, entry.text, entry.chunk});
+        count++;
+    };
+
+    if (sub.policy == BackpressurePolicy::COALESCE) {
+        // A keyed command is superseded once a newer one with its key is published
+        auto superseded = [this](uint64_t seq, uint64_t key) {
+            auto newest = newestByKey_.find(key);
+            return newest != newestByKey_.end() && newest->second > seq;
+        };
+
+        if (!sub.retired.empty()) {
+            std::vector<std::pair<uint64_t, Entry>> held;
+            held.reserve(sub.retired.size());
+            for (auto& item : sub.retired) held.push_back(std::move(item.second));
+            sub.retired.clear();
+            std::sort(held.begin(), held.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            for (auto& item : held) {
+                if (superseded(item.first, item.second.key)) {
+                    sub.stats.coalesced++;
+                } else if (count < max) {
+                    deliver(item.first, item.second);
+                } else {
+                    sub.retired[item.second.key] = std::move(item);   // Next read
+                }
+            }
+        }
+
+        for (; sub.cursor < nextSeq_ && count < max; ++sub.cursor) {
+            const Entry& entry = log_[sub.cursor - oldest];
+            if (entry.key != 0 && superseded(sub.cursor, entry.key)) {
+                sub.stats.coalesced++;
+                continue;
+            }
+            deliver(sub.cursor, entry);
+        }
+    } else {
+        for (; sub.cursor < nextSeq_ && count < max; ++sub.cursor) {
+            deliver(sub.cursor, log_[sub.cursor - oldest]);
+        }
+    }
+
+    sub.stats.delivered += count;
+    if (sub.policy == BackpressurePolicy::BLOCK && publisherBlocked_) consumed_.notify_one();
+    return count;
+}
+
+size_t CommandBroadcastHub::poll(SubscriberId subscriber, std::vector<BroadcastMessage>& out, size_t max) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscribers_.find(subscriber);
+    if (it == subscribers_.end()) return 0;
+    return collect(it->second, out, max);
+}
+
+size_t CommandBroadcastHub::wait(SubscriberId subscriber, std::vector<BroadcastMessage>& out,
+                                 std::chrono::milliseconds timeout, size_t max) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto unread = [this, subscriber] {
+        auto it = subscribers_.find(subscriber);
+        return it == subscribers_.end() || it->second.cursor < nextSeq_ || !it->second.retired.empty();
+    };
+
+    if (!unread()) {
+        waitingReaders_++;
+        published_.wait_for(lock, timeout, [&] { return closed_ || unread(); });
+        waitingReaders_--;
+    }
+
+    auto it = subscribers_.find(subscriber);   // Looked up again: the map may have changed while waiting
+    if (it == subscribers_.end()) return 0;
+    return collect(it->second, out, max);
+}
+
+void CommandBroadcastHub::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    published_.notify_all();
+    consumed_.notify_all();
+}
+
+SubscriberStats CommandBroadcastHub::getStats(SubscriberId subscriber) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscribers_.find(subscriber);
+    if (it == subscribers_.end()) return SubscriberStats{};
+    SubscriberStats stats = it->second.stats;
+    stats.lag = (nextSeq_ - it->second.cursor) + it->second.retired.size();
+    return stats;
+}
+
+uint64_t CommandBroadcastHub::getPublished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextSeq_;
+}
+
+uint64_t CommandBroadcastHub::getPublisherWaits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return publisherWaits_;
+}
+
+} // namespace arduino_interpreter
+
+#endif // PLATFORM_WASM
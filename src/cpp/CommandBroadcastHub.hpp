@@ -0,0 +1,171 @@
+/**
+ * CommandBroadcastHub.hpp - One command stream, many independent readers
+ *
+ * The hub is a CommandCallback: each command is copied once into an
+ * append-only arena of shared chunks and recorded in a bounded log. Every
+ * subscriber (UI, recorder, monitor, network client) owns a read cursor
+ * into that log and receives string_views into the shared bytes - no
+ * per-subscriber copies, and readers never block each other.
+ *
+ * When the log is full, the oldest entry is retired and each subscriber
+ * that has not read it yet is handled by its own policy:
+ *
+ * - BLOCK:       lossless; the publisher waits until the subscriber has
+ *                read the entry (the only policy that can slow the
+ *                interpreter, and only when that subscriber is a full log
+ *                behind)
+ * - DROP_OLDEST: the cursor skips the retired entry (counted as dropped)
+ * - COALESCE:    only the newest command per coalescing key is delivered
+ *                (pin for DIGITAL_WRITE / ANALOG_WRITE / PIN_MODE, variable
+ *                for VAR_SET); superseded commands are skipped, retired
+ *                keyed commands are held per subscriber until read, and
+ *                retired unkeyed commands are dropped
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ASTInterpreter.hpp"
+#include "PlatformAbstraction.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifndef PLATFORM_WASM
+
+#include <condition_variable>
+#include <mutex>
+
+namespace arduino_interpreter {
+
+enum class BackpressurePolicy : uint8_t {
+    BLOCK,
+    DROP_OLDEST,
+    COALESCE
+};
+
+/**
+ * A delivered command. `text` points into the hub's shared arena and stays
+ * valid as long as the message (its `hold` reference) is alive.
+ */
+struct BroadcastMessage {
+    uint64_t seq = 0;                    // Position in the command stream, from 0
+    std::string_view text;
+    std::shared_ptr<const void> hold;
+};
+
+struct SubscriberStats {
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;                // Retired before they were read
+    uint64_t coalesced = 0;              // Skipped for a newer command with the same key
+    uint64_t lag = 0;                    // Commands published but not read yet
+};
+
+class CommandBroadcastHub : public CommandCallback {
+public:
+    using SubscriberId = uint32_t;
+
+    /**
+     * @param capacity   Commands kept in the log
+     * @param chunkBytes Arena chunk size; larger commands get a chunk of their own
+     */
+    explicit CommandBroadcastHub(size_t capacity = 4096, size_t chunkBytes = 64 * 1024);
+
+    CommandBroadcastHub(const CommandBroadcastHub&) = delete;
+    CommandBroadcastHub& operator=(const CommandBroadcastHub&) = delete;
+
+    void onCommand(const std::string& jsonCommand) override { publish(jsonCommand); }
+
+    /**
+     * Append a command; may wait only for BLOCK subscribers (see above)
+     * @return its sequence number
+     */
+    uint64_t publish(std::string_view jsonCommand);
+
+    /**
+     * @param fromOldest Start at the oldest command still in the log instead
+     *                   of the next one published
+     */
+    SubscriberId subscribe(BackpressurePolicy policy, bool fromOldest = false);
+    void unsubscribe(SubscriberId subscriber);
+
+    /**
+     * Append up to `max` unread commands to `out` without waiting
+     * @return number appended
+     */
+    size_t poll(SubscriberId subscriber, std::vector<BroadcastMessage>& out, size_t max = SIZE_MAX);
+
+    /**
+     * Like poll(), but waits up to `timeout` for a command when none is
+     * unread. Returns 0 on timeout, after close() or for an unknown subscriber.
+     */
+    size_t wait(SubscriberId subscriber, std::vector<BroadcastMessage>& out,
+                std::chrono::milliseconds timeout, size_t max = SIZE_MAX);
+
+    /** No more commands: wakes waiting readers and a blocked publisher */
+    void close();
+
+    SubscriberStats getStats(SubscriberId subscriber) const;
+
+    uint64_t getPublished() const;
+
+    /** Number of publish() calls that waited for a BLOCK subscriber */
+    uint64_t getPublisherWaits() const;
+
+    /** Key COALESCE subscribers group commands by (0 = never coalesced) */
+    static uint64_t coalesceKey(std::string_view jsonCommand);
+
+private:
+    struct Chunk;
+
+    struct Entry {
+        std::shared_ptr<const Chunk> chunk;
+        std::string_view text;
+        uint64_t key = 0;
+    };
+
+    struct Subscriber {
+        BackpressurePolicy policy = BackpressurePolicy::DROP_OLDEST;
+        uint64_t cursor = 0;
+        SubscriberStats stats;
+        // COALESCE only: retired keyed commands not read yet, newest per key
+        std::unordered_map<uint64_t, std::pair<uint64_t, Entry>> retired;
+    };
+
+    uint64_t oldestSeq() const { return nextSeq_ - log_.size(); }
+    std::string_view store(std::string_view text, std::shared_ptr<const Chunk>& chunk);
+    bool blockedByReader() const;
+    void retireOldest();
+    size_t collect(Subscriber& subscriber, std::vector<BroadcastMessage>& out, size_t max);
+
+    size_t capacity_;
+    size_t chunkBytes_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable published_;  // Readers waiting for commands
+    std::condition_variable consumed_;   // Publisher waiting for a BLOCK subscriber
+    std::deque<Entry> log_;
+    std::shared_ptr<Chunk> tail_;        // Chunk new commands are appended to
+    uint64_t nextSeq_ = 0;
+    // Newest logged command per coalescing key, kept on publish so COALESCE
+    // reads never rescan the unread log
+    std::unordered_map<uint64_t, uint64_t> newestByKey_;
+    uint64_t lowestCursor_ = 0;          // Lower bound of all cursors
+    uint64_t publisherWaits_ = 0;
+    size_t waitingReaders_ = 0;
+    bool publisherBlocked_ = false;
+    bool closed_ = false;
+
+    std::unordered_map<SubscriberId, Subscriber> subscribers_;
+    SubscriberId nextSubscriber_ = 1;
+};
+
+} // namespace arduino_interpreter
+
+#endif // PLATFORM_WASM
@@ -0,0 +1,307 @@
+/**
+ * CommandEmitter.cpp - Deferred command formatting pipeline
+ *
+ * Version: 1.0
+ */
+
+#include "CommandEmitter.hpp"
+#include "ASTInterpreter.hpp"
+#include <cctype>
+
+namespace arduino_interpreter {
+
+// =============================================================================
+// RECORD FORMATTING
+// =============================================================================
+
+// Serial.print(data): numbers, char literals and booleans are shown bare, other
+// text quoted; a char literal's data field drops the quotes
+static void appendSerialPrint(std::string& out, const std::string& data) {
+    bool isNumeric = false;
+    if (!data.empty()) {
+        try {
+            size_t pos;
+            std::stod(data, &pos);
+            isNumeric = (pos == data.length());
+        } catch (...) {
+            isNumeric = false;
+        }
+    }
+
+    bool isCharLiteral = (data.length() >= 3 && data[0] == '\'' && data[data.length()-1] == '\'');
+    bool quoted = !isCharLiteral && !isNumeric &&
+        (data.find(' ') != std::string::npos || data.find('\t') != std::string::npos ||
+         data.find('=') != std::string::npos || data.find(',') != std::string::npos ||
+         (!data.empty() && !std::isdigit(static_cast<unsigned char>(data[0])) && data != "true" && data != "false"));
+
+    out += "{\"type\":\"FUNCTION_CALL\",\"timestamp\":0,\"function\":\"Serial.print\",\"arguments\":[";
+    if (quoted) out += '"';
+    out += data;
+    if (quoted) out += '"';
+    out += "],\"data\":\"";
+    out += escapeJsonString(isCharLiteral ? data.substr(1, data.length() - 2) : data);
+    out += "\",\"message\":\"Serial.print(";
+    if (quoted) out += '"';
+    out += data;
+    if (quoted) out += '"';
+    out += ")\"}";
+}
+
+// Must stay byte-identical with the StringBuildStream output of the emit*
+// methods these records replace (integers via std::to_string, values via
+// appendCommandValueJson).
+void formatCommandRecord(const CommandRecord& record, std::string& out) {
+    switch (record.kind) {
+        case CommandRecord::Kind::PREFORMATTED:
+            out += record.text;
+            break;
+
+        case CommandRecord::Kind::DIGITAL_WRITE:
+            out += "{\"type\":\"DIGITAL_WRITE\",\"timestamp\":0,\"pin\":";
+            out += std::to_string(record.a);
+            out += ",\"value\":";
+            out += std::to_string(record.b);
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::ANALOG_WRITE:
+            out += "{\"type\":\"ANALOG_WRITE\",\"timestamp\":0,\"pin\":";
+            out += std::to_string(record.a);
+            out += ",\"value\":";
+            out += std::to_string(record.b);
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::PIN_MODE:
+            out += "{\"type\":\"PIN_MODE\",\"timestamp\":0,\"pin\":";
+            out += std::to_string(record.a);
+            out += ",\"mode\":";
+            out += std::to_string(record.b);
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::DELAY:
+            out += "{\"type\":\"DELAY\",\"timestamp\":0,\"duration\":";
+            out += std::to_string(record.a);
+            out += ",\"actualDelay\":";
+            out += std::to_string(record.a);
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::DELAY_MICROSECONDS:
+            out += "{\"type\":\"DELAY_MICROSECONDS\",\"timestamp\":0,\"duration\":";
+            out += std::to_string(record.a);
+            out += ",\"actualDelay\":";
+            out += std::to_string(record.a);
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::VAR_SET:
+            out += "{\"type\":\"VAR_SET\",\"timestamp\":0,\"variable\":\"";
+            out += record.text;
+            out += "\",\"value\":";
+            if (record.values.empty()) {
+                out += "null";
+            } else {
+                appendCommandValueJson(out, record.values[0]);
+            }
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::FUNCTION_CALL:
+            out += "{\"type\":\"FUNCTION_CALL\",\"timestamp\":0,\"function\":\"";
+            out += record.text;
+            out += "\",\"arguments\":[";
+            for (size_t i = 0; i < record.values.size(); i++) {
+                if (i > 0) out += ",";
+                appendCommandValueJson(out, record.values[i]);
+            }
+            out += "]}";
+            break;
+
+        case CommandRecord::Kind::SERIAL_BEGIN: {
+            std::string baud = std::to_string(record.a);
+            out += "{\"type\":\"FUNCTION_CALL\",\"timestamp\":0,\"function\":\"Serial.begin\",\"arguments\":[";
+            out += baud;
+            out += "],\"baudRate\":";
+            out += baud;
+            out += ",\"message\":\"Serial.begin(";
+            out += baud;
+            out += ")\"}";
+            break;
+        }
+
+        case CommandRecord::Kind::SERIAL_PRINT:
+            appendSerialPrint(out, record.text);
+            break;
+
+        case CommandRecord::Kind::SERIAL_PRINTLN: {
+            std::string escaped = escapeJsonString(record.text);
+            out += "{\"type\":\"FUNCTION_CALL\",\"timestamp\":0,\"function\":\"Serial.println\",\"arguments\":[\"";
+            out += escaped;
+            out += "\"],\"data\":\"";
+            out += escaped;
+            out += "\",\"message\":\"Serial.println(";
+            out += formatArgumentForDisplay(escaped);
+            out += ")\"}";
+            break;
+        }
+
+        case CommandRecord::Kind::LOOP_START:
+            if (record.b) {
+                out += "{\"type\":\"LOOP_START\",\"timestamp\":0,\"message\":\"Starting loop() execution\"}";
+            } else {
+                out += "{\"type\":\"LOOP_START\",\"timestamp\":0,\"message\":\"Starting loop iteration ";
+                out += std::to_string(record.a);
+                out += "\"}";
+            }
+            break;
+
+        case CommandRecord::Kind::LOOP_CALL:
+            out += "{\"type\":\"FUNCTION_CALL\",\"timestamp\":0,\"function\":\"loop\",\"message\":\"";
+            out += record.b ? "Completed" : "Executing";
+            out += " loop() iteration ";
+            out += std::to_string(record.a);
+            out += "\",\"iteration\":";
+            out += std::to_string(record.a);
+            if (record.b) {
+                out += ",\"completed\":true";
+            }
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::IF_STATEMENT: {
+            // conditionDisplay repeats the condition JSON unescaped, as emitted before
+            std::string condition;
+            if (record.values.empty()) {
+                condition = "null";
+            } else {
+                appendCommandValueJson(condition, record.values[0]);
+            }
+            out += "{\"type\":\"IF_STATEMENT\",\"timestamp\":0,\"condition\":";
+            out += condition;
+            out += ",\"conditionDisplay\":\"";
+            out += condition;
+            out += "\",\"branch\":\"";
+            out += record.b ? "then" : "else";
+            out += "\"}";
+            break;
+        }
+
+        case CommandRecord::Kind::WHILE_ITERATION:
+            out += "{\"type\":\"WHILE_LOOP\",\"timestamp\":0,\"phase\":\"iteration\",\"iteration\":";
+            out += std::to_string(record.a);
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::DO_WHILE_ITERATION:
+            out += "{\"type\":\"DO_WHILE_LOOP\",\"timestamp\":0,\"phase\":\"iteration\",\"iteration\":";
+            out += std::to_string(record.a);
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::FOR_ITERATION:
+            out += "{\"type\":\"FOR_LOOP\",\"timestamp\":0,\"phase\":\"iteration\",\"iteration\":";
+            out += std::to_string(record.a);
+            out += "}";
+            break;
+
+        case CommandRecord::Kind::ANALOG_READ_REQUEST:
+        case CommandRecord::Kind::DIGITAL_READ_REQUEST:
+            out += record.kind == CommandRecord::Kind::ANALOG_READ_REQUEST
+                ? "{\"type\":\"ANALOG_READ_REQUEST\",\"timestamp\":0,\"pin\":"
+                : "{\"type\":\"DIGITAL_READ_REQUEST\",\"timestamp\":0,\"pin\":";
+            out += std::to_string(record.a);
+            out += ",\"requestId\":\"";
+            out += record.text;
+            out += "\"}";
+            break;
+    }
+}
+
+#ifndef PLATFORM_WASM
+
+// =============================================================================
+// ASYNC COMMAND EMITTER
+// =============================================================================
+
+AsyncCommandEmitter::AsyncCommandEmitter(Sink sink, size_t capacity, Formatter formatter)
+    : sink_(std::move(sink)),
+      formatter_(formatter ? std::move(formatter) : Formatter(formatCommandRecord)),
+      capacity_(capacity > 0 ? capacity : 1) {
+    worker_ = std::thread(&AsyncCommandEmitter::run, this);
+}
+
+AsyncCommandEmitter::~AsyncCommandEmitter() {
+    stop();
+}
+
+void AsyncCommandEmitter::submit(CommandRecord&& record) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+        // Worker is gone - deliver inline so nothing is lost after stop()
+        lock.unlock();
+        std::string json;
+        formatter_(record, json);
+        sink_(json);
+        return;
+    }
+    if (queue_.size() >= capacity_) {
+        backpressureWaits_++;
+        notFull_.wait(lock, [this] { return queue_.size() < capacity_; });
+    }
+    queue_.push_back(std::move(record));
+    submitted_++;
+    lock.unlock();
+    notEmpty_.notify_one();
+}
+
+void AsyncCommandEmitter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [this] { return delivered_ == submitted_; });
+}
+
+void AsyncCommandEmitter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    notEmpty_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void AsyncCommandEmitter::run() {
+    std::string json;
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;  // stopping_ and fully drained
+        }
+        CommandRecord record = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        notFull_.notify_one();
+
+        json.clear();
+        formatter_(record, json);
+        if (record.kind != CommandRecord::Kind::PREFORMATTED) {
+            formattedBytes_[static_cast<size_t>(record.phase)] += json.size();
+        }
+        sink_(json);
+
+        lock.lock();
+        delivered_++;
+        if (delivered_ == submitted_) {
+            lock.unlock();
+            drained_.notify_all();
+        }
+    }
+}
+
+#endif // PLATFORM_WASM
+
+} // namespace arduino_interpreter
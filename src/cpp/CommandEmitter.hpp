@@ -0,0 +1,147 @@
+/**
+ * CommandEmitter.hpp - Deferred command formatting pipeline
+ *
+ * The interpreter thread appends compact CommandRecord entries to a bounded
+ * queue; a worker thread formats them (JSON by default) and delivers them in
+ * submission order. Formatting goes through formatCommandRecord() on both the
+ * synchronous and asynchronous paths, so the command stream is byte-identical
+ * whichever path produced it.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ArduinoDataTypes.hpp"
+#include "PlatformAbstraction.hpp"
+#include "WorkCounters.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifndef PLATFORM_WASM
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace arduino_interpreter {
+
+// =============================================================================
+// COMMAND RECORDS
+// =============================================================================
+
+/**
+ * Compact, unformatted command event.
+ *
+ * Hot commands carry their operands; everything else arrives PREFORMATTED
+ * with the finished JSON in `text`. Values must not reference interpreter
+ * state (pointers, structs) because they are formatted on another thread.
+ */
+struct CommandRecord {
+    enum class Kind : uint8_t {
+        PREFORMATTED,           // text = complete JSON command
+        DIGITAL_WRITE,          // a = pin, b = value
+        ANALOG_WRITE,           // a = pin, b = value
+        PIN_MODE,               // a = pin, b = mode
+        DELAY,                  // a = duration
+        DELAY_MICROSECONDS,     // a = duration
+        VAR_SET,                // text = variable, values[0] = value
+        FUNCTION_CALL,          // text = function, values = arguments
+        SERIAL_BEGIN,           // a = baud rate
+        SERIAL_PRINT,           // text = printed data
+        SERIAL_PRINTLN,         // text = printed data
+        LOOP_START,             // a = iteration, b = 1 for the main loop
+        LOOP_CALL,              // a = iteration, b = 1 once completed
+        IF_STATEMENT,           // values[0] = condition, b = 1 if "then"
+        WHILE_ITERATION,        // a = iteration
+        DO_WHILE_ITERATION,     // a = iteration
+        FOR_ITERATION,          // a = iteration
+        ANALOG_READ_REQUEST,    // a = pin, text = request id
+        DIGITAL_READ_REQUEST    // a = pin, text = request id
+    };
+
+    Kind kind = Kind::PREFORMATTED;
+    WorkPhase phase = WorkPhase::PROGRAM;  // BYTES_FORMATTED phase of the worker's output
+    int32_t a = 0;
+    int32_t b = 0;
+    std::string text;
+    std::vector<CommandValue> values;
+
+    CommandRecord() = default;
+    CommandRecord(Kind k, int32_t first, int32_t second = 0) : kind(k), a(first), b(second) {}
+};
+
+/**
+ * Append the JSON encoding of a record to `out` (JSON formatter used by default)
+ */
+void formatCommandRecord(const CommandRecord& record, std::string& out);
+
+// =============================================================================
+// ASYNC COMMAND EMITTER
+// =============================================================================
+
+#ifndef PLATFORM_WASM
+
+/**
+ * Bounded single-producer queue drained by a formatting worker thread.
+ *
+ * - submit() blocks while the queue is full (backpressure)
+ * - flush() returns once every submitted record has been delivered
+ * - stop() flushes, then joins the worker; the destructor calls stop()
+ */
+class AsyncCommandEmitter {
+public:
+    using Formatter = std::function<void(const CommandRecord&, std::string&)>;
+    using Sink = std::function<void(const std::string&)>;
+
+    AsyncCommandEmitter(Sink sink, size_t capacity, Formatter formatter = formatCommandRecord);
+    ~AsyncCommandEmitter();
+
+    AsyncCommandEmitter(const AsyncCommandEmitter&) = delete;
+    AsyncCommandEmitter& operator=(const AsyncCommandEmitter&) = delete;
+
+    void submit(CommandRecord&& record);
+    void flush();
+    void stop();
+
+    /**
+     * Bytes of non-PREFORMATTED records of `phase` formatted since the last
+     * call (the producer already counted the size of preformatted ones)
+     */
+    size_t takeFormattedBytes(WorkPhase phase) {
+        return formattedBytes_[static_cast<size_t>(phase)].exchange(0);
+    }
+
+    /** Number of submit() calls that had to wait for queue space */
+    uint64_t getBackpressureWaits() const { return backpressureWaits_.load(); }
+
+    size_t getCapacity() const { return capacity_; }
+
+private:
+    void run();
+
+    Sink sink_;
+    Formatter formatter_;
+    size_t capacity_;
+
+    std::deque<CommandRecord> queue_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::condition_variable drained_;
+    uint64_t submitted_ = 0;
+    uint64_t delivered_ = 0;
+    bool stopping_ = false;
+
+    std::atomic<size_t> formattedBytes_[WORK_PHASE_COUNT] = {};
+    std::atomic<uint64_t> backpressureWaits_{0};
+    std::thread worker_;
+};
+
+#endif // PLATFORM_WASM
+
+} // namespace arduino_interpreter
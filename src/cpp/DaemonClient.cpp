@@ -0,0 +1,198 @@
+/**
+ * DaemonClient.cpp - Client library for InterpreterDaemon
+ *
+ * Version: 1.0
+ */
+
+#include "DaemonClient.hpp"
+
+#if HAS_INTERPRETER_DAEMON
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace arduino_interpreter {
+
+namespace {
+
+// Buffered reads over the connection; `buffer` keeps unread bytes between calls
+class SocketReader {
+public:
+    SocketReader(int fd, std::string& buffer) : fd_(fd), buffer_(buffer) {}
+
+    bool read(void* out, size_t size) {
+        if (!fill(size)) return false;
+        std::memcpy(out, buffer_.data() + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    bool readString(std::string& out, size_t size) {
+        if (!fill(size)) return false;
+        out.assign(buffer_, pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    bool readLine(std::string& out) {
+        size_t end;
+        while ((end = buffer_.find('\n', pos_)) == std::string::npos) {
+            if (!more()) return false;
+        }
+        out.assign(buffer_, pos_, end - pos_);
+        pos_ = end + 1;
+        return true;
+    }
+
+    ~SocketReader() { buffer_.erase(0, pos_); }
+
+private:
+    bool fill(size_t size) {
+        while (buffer_.size() - pos_ < size) {
+            if (!more()) return false;
+        }
+        return true;
+    }
+
+    bool more() {
+        char chunk[64 * 1024];
+        ssize_t n;
+        do {
+            n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) return false;
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+        buffer_.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    int fd_;
+    std::string& buffer_;
+    size_t pos_ = 0;
+};
+
+DaemonStatus statusFromName(const std::string& name) {
+    for (auto status : {DaemonStatus::OK, DaemonStatus::FAILED, DaemonStatus::UNKNOWN_AST}) {
+        if (name == daemonStatusName(status)) return status;
+    }
+    return DaemonStatus::BAD_REQUEST;
+}
+
+} // anonymous namespace
+
+bool DaemonClient::connect() {
+    if (fd_ >= 0) return true;
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath_.size() >= sizeof(address.sun_path)) return false;
+    std::strncpy(address.sun_path, socketPath_.c_str(), sizeof(address.sun_path) - 1);
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) return false;
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+void DaemonClient::disconnect() {
+    if (fd_ >= 0) close(fd_);
+    fd_ = -1;
+    readBuffer_.clear();
+}
+
+DaemonRunResult DaemonClient::run(const uint8_t* ast, size_t size, const DaemonRunOptions& options) {
+    DaemonRunResult result;
+    if (!connect()) {
+        result.error = "Cannot connect to " + socketPath_ + ": " + std::strerror(errno);
+        return result;
+    }
+
+    DaemonRequest request;
+    request.encoding = options.encoding;
+    request.astHash = daemon_protocol::hashAST(ast, size);
+    request.maxLoopIterations = options.maxLoopIterations;
+    request.syncMode = options.syncMode;
+    request.enforceLoopLimitsOnInternalLoops = options.enforceLoopLimitsOnInternalLoops;
+    request.inputs = options.inputs;
+
+    // Hash first; upload only on a cache miss
+    if (!send(request, result) || !receive(request.encoding, result)) return result;
+    if (result.status == DaemonStatus::UNKNOWN_AST) {
+        request.ast.assign(ast, ast + size);
+        result.commands.clear();
+        result.uploaded = true;
+        if (!send(request, result)) return result;
+        receive(request.encoding, result);
+    }
+    return result;
+}
+
+bool DaemonClient::send(const DaemonRequest& request, DaemonRunResult& result) {
+    requestBuffer_.clear();
+    daemon_protocol::encodeRequest(request, requestBuffer_);
+
+    const uint8_t* bytes = requestBuffer_.data();
+    size_t remaining = requestBuffer_.size();
+    while (remaining > 0) {
+        ssize_t n = ::send(fd_, bytes, remaining, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            result.error = std::string("send: ") + std::strerror(errno);
+            disconnect();
+            return false;
+        }
+        bytes += n;
+        remaining -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool DaemonClient::receive(DaemonEncoding encoding, DaemonRunResult& result) {
+    bool ok = false;
+    {
+        SocketReader reader(fd_, readBuffer_);
+        if (encoding == DaemonEncoding::BINARY) {
+            uint32_t length = 0;
+            while (reader.read(&length, sizeof(length))) {
+                if (length == daemon_protocol::END_OF_STREAM) {
+                    uint8_t status = 0;
+                    uint64_t count = 0;
+                    ok = reader.read(&status, sizeof(status)) && reader.read(&count, sizeof(count));
+                    result.status = static_cast<DaemonStatus>(status);
+                    break;
+                }
+                result.commands.emplace_back();
+                if (!reader.readString(result.commands.back(), length)) break;
+            }
+        } else {
+            static const std::string END_PREFIX = "{\"type\":\"DAEMON_END\",\"status\":\"";
+            std::string line;
+            while (reader.readLine(line)) {
+                if (line.compare(0, END_PREFIX.size(), END_PREFIX) == 0) {
+                    size_t end = line.find('"', END_PREFIX.size());
+                    result.status = statusFromName(line.substr(END_PREFIX.size(), end - END_PREFIX.size()));
+                    ok = true;
+                    break;
+                }
+                result.commands.push_back(std::move(line));
+            }
+        }
+    }
+
+    if (!ok) {
+        result.error = "Connection closed before the end of the response";
+        disconnect();
+    }
+    return ok;
+}
+
+} // namespace arduino_interpreter
+
+#endif // HAS_INTERPRETER_DAEMON
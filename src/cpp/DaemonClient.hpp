@@ -0,0 +1,69 @@
+/**
+ * DaemonClient.hpp - Client library for InterpreterDaemon
+ *
+ * Keeps one connection open across runs. run() refers to the program by its
+ * content hash and only uploads the CompactAST when the daemon does not have
+ * it cached yet.
+ *
+ * Usage:
+ *   DaemonClient client("/tmp/asti.sock");
+ *   auto result = client.run(ast.data(), ast.size());
+ *   for (const auto& json : result.commands) { ... }
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "InterpreterDaemon.hpp"
+
+#if HAS_INTERPRETER_DAEMON
+
+#include <string>
+#include <vector>
+
+namespace arduino_interpreter {
+
+struct DaemonRunOptions {
+    DaemonEncoding encoding = DaemonEncoding::BINARY;
+    uint32_t maxLoopIterations = Config::TEST_MAX_LOOP_ITERATIONS;
+    bool syncMode = true;
+    bool enforceLoopLimitsOnInternalLoops = true;
+    std::vector<DaemonInput> inputs;
+};
+
+struct DaemonRunResult {
+    DaemonStatus status = DaemonStatus::BAD_REQUEST;
+    std::vector<std::string> commands;
+    bool uploaded = false;    // The AST had to be sent (daemon cache miss)
+    std::string error;        // Transport errors (connection lost, bad framing)
+};
+
+class DaemonClient {
+public:
+    explicit DaemonClient(const std::string& socketPath) : socketPath_(socketPath) {}
+    ~DaemonClient() { disconnect(); }
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+
+    /** Connect now; run() also connects on demand */
+    bool connect();
+    void disconnect();
+    bool isConnected() const { return fd_ >= 0; }
+
+    DaemonRunResult run(const uint8_t* ast, size_t size, const DaemonRunOptions& options = DaemonRunOptions{});
+
+private:
+    bool send(const DaemonRequest& request, DaemonRunResult& result);
+    bool receive(DaemonEncoding encoding, DaemonRunResult& result);
+
+    std::string socketPath_;
+    int fd_ = -1;
+    std::vector<uint8_t> requestBuffer_;
+    std::string readBuffer_;
+};
+
+} // namespace arduino_interpreter
+
+#endif // HAS_INTERPRETER_DAEMON
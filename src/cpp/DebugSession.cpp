@@ -0,0 +1,181 @@
+/**
+ * DebugSession.cpp - Breakpoint conditions and statement numbering
+ *
+ * Version: 1.0
+ */
+
+#include "DebugSession.hpp"
+#include "ASTCast.hpp"
+#include <cctype>
+#include <cstdlib>
+
+namespace arduino_interpreter {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(start, end - start + 1);
+}
+
+bool isIdentifier(const std::string& text) {
+    if (text.empty() || !(std::isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_')) return false;
+    for (char c : text) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+    }
+    return true;
+}
+
+bool parseOperand(const std::string& text, double& out) {
+    if (text == "true") { out = 1.0; return true; }
+    if (text == "false") { out = 0.0; return true; }
+    if (text.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+bool numericValue(const CommandValue& value, double& out) {
+    if (auto* v = std::get_if<int32_t>(&value)) { out = *v; return true; }
+    if (auto* v = std::get_if<uint32_t>(&value)) { out = *v; return true; }
+    if (auto* v = std::get_if<double>(&value)) { out = *v; return true; }
+    if (auto* v = std::get_if<bool>(&value)) { out = *v ? 1.0 : 0.0; return true; }
+    return false;
+}
+
+// Preorder over the statements of every { } block under `node`
+arduino_ast::ASTNode* findInBlocks(arduino_ast::ASTNode* node, size_t index, size_t& seen) {
+    using namespace arduino_ast;
+    if (!node) return nullptr;
+
+    auto descend = [&](const ASTNode* child) {
+        return findInBlocks(const_cast<ASTNode*>(child), index, seen);
+    };
+
+    switch (node->getType()) {
+        case ASTNodeType::COMPOUND_STMT:
+            for (const auto& child : node->getChildren()) {
+                if (!child) continue;
+                if (seen++ == index) return child.get();
+                if (auto* found = descend(child.get())) return found;
+            }
+            return nullptr;
+        case ASTNodeType::IF_STMT:
+            if (auto* stmt = AST_CAST(IfStatement, node)) {
+                if (auto* found = descend(stmt->getConsequent())) return found;
+                return descend(stmt->getAlternate());
+            }
+            return nullptr;
+        case ASTNodeType::WHILE_STMT:
+            if (auto* stmt = AST_CAST(WhileStatement, node)) return descend(stmt->getBody());
+            return nullptr;
+        case ASTNodeType::DO_WHILE_STMT:
+            if (auto* stmt = AST_CAST(DoWhileStatement, node)) return descend(stmt->getBody());
+            return nullptr;
+        case ASTNodeType::FOR_STMT:
+            if (auto* stmt = AST_CAST(ForStatement, node)) return descend(stmt->getBody());
+            return nullptr;
+        case ASTNodeType::RANGE_FOR_STMT:
+            if (auto* stmt = AST_CAST(RangeBasedForStatement, node)) return descend(stmt->getBody());
+            return nullptr;
+        case ASTNodeType::SWITCH_STMT:
+            if (auto* stmt = AST_CAST(SwitchStatement, node)) {
+                if (auto* found = descend(stmt->getBody())) return found;
+                for (const auto& child : node->getChildren()) {
+                    if (auto* found = descend(child.get())) return found;
+                }
+            }
+            return nullptr;
+        case ASTNodeType::CASE_STMT:
+            if (auto* stmt = AST_CAST(CaseStatement, node)) return descend(stmt->getBody());
+            return nullptr;
+        default:
+            return nullptr;
+    }
+}
+
+} // anonymous namespace
+
+bool BreakpointCondition::compile(const std::string& text, BreakpointCondition& out, std::string* error) {
+    out.clauses_.clear();
+    if (trim(text).empty()) return true;
+
+    auto fail = [&](const std::string& message) {
+        if (error) *error = message;
+        out.clauses_.clear();
+        return false;
+    };
+
+    static const std::pair<const char*, Op> OPERATORS[] = {
+        {"==", Op::EQ}, {"!=", Op::NE}, {"<=", Op::LE}, {">=", Op::GE}, {"<", Op::LT}, {">", Op::GT}
+    };
+
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find("&&", start);
+        std::string clauseText = trim(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+
+        Clause clause;
+        size_t opPos = std::string::npos;
+        size_t opLength = 0;
+        for (const auto& candidate : OPERATORS) {
+            size_t pos = clauseText.find(candidate.first);
+            if (pos != std::string::npos) {
+                opPos = pos;
+                opLength = std::char_traits<char>::length(candidate.first);
+                clause.op = candidate.second;
+                break;
+            }
+        }
+
+        if (opPos == std::string::npos) {
+            clause.variable = clauseText;
+        } else {
+            clause.variable = trim(clauseText.substr(0, opPos));
+            if (!parseOperand(trim(clauseText.substr(opPos + opLength)), clause.operand)) {
+                return fail("Expected a number after the operator in '" + clauseText + "'");
+            }
+        }
+        if (!isIdentifier(clause.variable)) {
+            return fail("Expected a variable name in '" + clauseText + "'");
+        }
+        out.clauses_.push_back(std::move(clause));
+
+        if (end == std::string::npos) break;
+        start = end + 2;
+    }
+    return true;
+}
+
+bool BreakpointCondition::evaluate(ScopeManager& scopes) const {
+    for (const auto& clause : clauses_) {
+        Variable* var = scopes.getVariable(clause.variable);
+        if (!var) return false;
+        const CommandValue& value = var->isReference && var->referenceTarget ? var->referenceTarget->value : var->value;
+
+        double number = 0.0;
+        if (!numericValue(value, number)) return false;
+
+        bool holds = false;
+        switch (clause.op) {
+            case Op::NONZERO: holds = number != 0.0; break;
+            case Op::EQ: holds = number == clause.operand; break;
+            case Op::NE: holds = number != clause.operand; break;
+            case Op::LT: holds = number < clause.operand; break;
+            case Op::LE: holds = number <= clause.operand; break;
+            case Op::GT: holds = number > clause.operand; break;
+            case Op::GE: holds = number >= clause.operand; break;
+        }
+        if (!holds) return false;
+    }
+    return true;
+}
+
+arduino_ast::ASTNode* DebugSession::findStatement(arduino_ast::ASTNode* body, size_t index) {
+    size_t seen = 0;
+    return findInBlocks(body, index, seen);
+}
+
+} // namespace arduino_interpreter
@@ -0,0 +1,129 @@
+/**
+ * DebugSession.hpp - Breakpoints, watchpoints and single-stepping
+ *
+ * Nothing here runs until a breakpoint or watchpoint is set:
+ *
+ * - A breakpoint is ASTNodeFlags::BREAKPOINT on a statement node. The
+ *   statement loop already reads the node; only flagged statements (or a
+ *   pending step()) take the slow path that looks the breakpoint up and
+ *   evaluates its condition. Conditions are compiled once, when the
+ *   breakpoint is added.
+ * - A watchpoint is Variable::watched on one storage slot. VAR_SET emission
+ *   checks that bit, so a write to a local that shadows a watched global
+ *   does not stop.
+ *
+ * A stop sets ExecutionState::PAUSED and calls DebugCallback::onStop() on
+ * the interpreter thread, with the whole call stack still live: variables
+ * can be read with getVariableValue(). The callback (or another thread)
+ * picks what happens next with resume(), step() or stop(); if the callback
+ * returns while still paused, the interpreter thread waits for one of them.
+ * WASM has no second thread, so a stop still paused after the callback
+ * resumes.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ASTInterpreter.hpp"
+#include "PlatformAbstraction.hpp"
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifndef PLATFORM_WASM
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace arduino_interpreter {
+
+enum class DebugStopReason : uint8_t {
+    BREAKPOINT,   // Before a statement with an enabled breakpoint whose condition holds
+    WATCHPOINT,   // After a write to a watched variable slot
+    STEP          // Before the next statement after step()
+};
+
+struct DebugStop {
+    DebugStopReason reason = DebugStopReason::BREAKPOINT;
+    int breakpointId = -1;                              // BREAKPOINT
+    uint32_t hitCount = 0;                              // BREAKPOINT: stops so far, this one included
+    const arduino_ast::ASTNode* statement = nullptr;    // BREAKPOINT / STEP: about to run
+    std::string variable;                               // WATCHPOINT
+    CommandValue value;                                 // WATCHPOINT: value just written
+    std::string function;                               // Innermost function, "" in global initializers
+};
+
+class DebugCallback {
+public:
+    virtual ~DebugCallback() = default;
+
+    /**
+     * Called on the interpreter thread while it is paused at `stop`
+     */
+    virtual void onStop(ASTInterpreter& interpreter, const DebugStop& stop) = 0;
+};
+
+/**
+ * Breakpoint condition, compiled once: clauses joined by `&&`, each either
+ * `name` (non-zero) or `name <op> number` with op one of == != < <= > >=.
+ * `true`/`false` are accepted as 1/0. Variables resolve in the paused frame;
+ * a missing variable makes the condition false.
+ */
+class BreakpointCondition {
+public:
+    /**
+     * @return false (and `error`) if `text` is not a valid condition
+     */
+    static bool compile(const std::string& text, BreakpointCondition& out, std::string* error = nullptr);
+
+    bool isAlways() const { return clauses_.empty(); }
+    bool evaluate(ScopeManager& scopes) const;
+
+private:
+    enum class Op : uint8_t { NONZERO, EQ, NE, LT, LE, GT, GE };
+
+    struct Clause {
+        std::string variable;
+        Op op = Op::NONZERO;
+        double operand = 0.0;
+    };
+
+    std::vector<Clause> clauses_;
+};
+
+struct Breakpoint {
+    int id = 0;
+    std::string function;
+    size_t statement = 0;
+    arduino_ast::ASTNode* node = nullptr;
+    BreakpointCondition condition;
+    uint32_t hits = 0;
+};
+
+/**
+ * Debugger state, created by the first breakpoint/watchpoint/callback
+ */
+struct DebugSession {
+    std::map<int, Breakpoint> breakpoints;
+    int nextBreakpointId = 1;
+    std::set<std::string> watchpoints;                     // VAR_SET checks slots only when non-empty
+    DebugCallback* callback = nullptr;
+    bool stopped = false;                                  // Interpreter thread is inside a stop
+    ExecutionState resumeState = ExecutionState::RUNNING;  // State the stop interrupted
+#ifndef PLATFORM_WASM
+    std::mutex mutex;
+    std::condition_variable released;
+#endif
+
+    /**
+     * Statement `index` of a function body: every statement of every { }
+     * block, numbered from 0 in source order (a block's own statements
+     * before the next statement of its parent)
+     */
+    static arduino_ast::ASTNode* findStatement(arduino_ast::ASTNode* body, size_t index);
+};
+
+} // namespace arduino_interpreter
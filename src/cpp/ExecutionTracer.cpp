@@ -7,6 +7,6 @@
 namespace arduino_interpreter {
 
 // Global tracer instance
-ExecutionTracer g_tracer;
+thread_local ExecutionTracer g_tracer;
 
 } // namespace arduino_interpreter
\ No newline at end of file
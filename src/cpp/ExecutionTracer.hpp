@@ -74,7 +74,7 @@ public:
     void logExit(const std::string& event, const std::string& detail = "") {
         if (!enabled_) return;
         
-        depth_--;
+        if (depth_ > 0) depth_--;   // Scopes entered before a clear() still exit
         std::string indent(depth_ * 2, ' ');
         trace_.emplace_back(indent + "← " + event, detail, currentContext_);
     }
@@ -195,8 +195,8 @@ public:
     }
 };
 
-// Global tracer instance
-extern ExecutionTracer g_tracer;
+// Global tracer instance (one per thread so concurrent interpreters don't share a trace)
+extern thread_local ExecutionTracer g_tracer;
 
 // Convenience macros for tracing
 #define TRACE_ENABLE() g_tracer.enable()
@@ -263,7 +263,7 @@ public:
 };
 
 // Global tracer instance (stub version)
-extern ExecutionTracer g_tracer;
+extern thread_local ExecutionTracer g_tracer;
 
 // Convenience macros (become no-ops)
 #define TRACE_ENABLE()
@@ -0,0 +1,113 @@
+/**
+ * FunctionTiers.cpp - Tier-up bookkeeping and parameter preparation
+ *
+ * Version: 1.0
+ */
+
+#include "FunctionTiers.hpp"
+#include "ASTCast.hpp"
+#include <algorithm>
+
+namespace arduino_interpreter {
+
+void PreparedFunction::prepare(const arduino_ast::FuncDefNode& definition, IntModel model, PreparedFunction& out) {
+    using namespace arduino_ast;
+
+    out.parameters.clear();
+    out.requiredParameters = 0;
+    out.returnType = "void";
+    out.returnIntKind = IntKind::NONE;
+
+    for (const auto& param : definition.getParameters()) {
+        PreparedParameter prepared;
+        if (param->getType() != ASTNodeType::PARAM_NODE) {
+            out.parameters.push_back(std::move(prepared));
+            continue;
+        }
+        const auto* paramNode = AST_CONST_CAST(ParamNode, param.get());
+        const auto& defaults = paramNode->getChildren();
+        if (defaults.empty()) {
+            out.requiredParameters++;
+        } else {
+            prepared.defaultValue = defaults[0].get();
+        }
+
+        const auto* declarator = paramNode->getDeclarator();
+        if (!declarator) {
+            // Unnamed parameter (e.g. prototype-style "int") - nothing to bind
+        } else if (declarator->getType() == ASTNodeType::DECLARATOR_NODE) {
+            prepared.name = AST_CONST_CAST(DeclaratorNode, declarator)->getName();
+        } else if (declarator->getType() == ASTNodeType::FUNCTION_POINTER_DECLARATOR) {
+            // int (*funcPtr)(int, int): the name is the identifier property
+            const auto* identifierNode = AST_CONST_CAST(FunctionPointerDeclaratorNode, declarator)->getIdentifier();
+            if (identifierNode) {
+                try {
+                    prepared.name = identifierNode->getValueAs<std::string>();
+                } catch (...) {
+                    prepared.name.clear();
+                }
+            }
+        } else if (declarator->getType() == ASTNodeType::ARRAY_DECLARATOR) {
+            // int buf[] binds like a pointer/array argument
+            const auto* identifierNode = AST_CONST_CAST(ArrayDeclaratorNode, declarator)->getIdentifier();
+            if (identifierNode && identifierNode->getType() == ASTNodeType::IDENTIFIER) {
+                prepared.name = AST_CONST_CAST(IdentifierNode, identifierNode)->getName();
+            }
+        }
+
+        prepared.bound = !prepared.name.empty();
+        if (prepared.bound && paramNode->getParamType()) {
+            try {
+                prepared.type = paramNode->getParamType()->getValueAs<std::string>();
+            } catch (...) {
+                prepared.type = "auto";
+            }
+            prepared.intKind = intKindOf(stripTypeQualifiers(prepared.type), model);
+        }
+        out.parameters.push_back(std::move(prepared));
+    }
+
+    const auto* returnTypeNode = definition.getReturnType();
+    if (returnTypeNode && returnTypeNode->getType() == ASTNodeType::TYPE_NODE) {
+        out.returnType = AST_CONST_CAST(TypeNode, returnTypeNode)->getTypeName();
+        out.returnIntKind = intKindOf(stripTypeQualifiers(out.returnType), model);
+    }
+}
+
+FunctionTier& FunctionTiers::get(const std::string& name, const arduino_ast::FuncDefNode* definition) {
+    auto found = functions_.find(name);
+    if (found == functions_.end()) {
+        found = functions_.emplace(name, FunctionTier()).first;
+        found->second.name = name;
+        found->second.definition = definition;
+    }
+    return found->second;
+}
+
+void FunctionTiers::promote(FunctionTier& function, uint32_t loopIteration) {
+    if (function.tier != 0) return;
+    if (function.definition) PreparedFunction::prepare(*function.definition, model_, function.prepared);
+    function.tier = 1;
+
+    TierPromotion promotion;
+    promotion.function = function.name;
+    promotion.calls = function.calls;
+    promotion.backEdges = function.backEdges;
+    promotion.loopIteration = loopIteration;
+    promotions_.push_back(std::move(promotion));
+}
+
+void FunctionTiers::bind(const arduino_ast::ASTNode* callSite, FunctionTier& caller, FunctionTier& callee) {
+    if (callSites_.emplace(callSite, &callee).second) caller.boundCallSites++;
+}
+
+std::vector<const FunctionTier*> FunctionTiers::functions() const {
+    std::vector<const FunctionTier*> result;
+    result.reserve(functions_.size());
+    for (const auto& entry : functions_) result.push_back(&entry.second);
+    std::sort(result.begin(), result.end(),
+              [](const FunctionTier* a, const FunctionTier* b) { return a->name < b->name; });
+    return result;
+}
+
+} // namespace arduino_interpreter
@@ -0,0 +1,115 @@
+/**
+ * FunctionTiers.hpp - Tiered execution of hot user functions
+ *
+ * Every user function starts in tier 0, plain tree walking: each call finds
+ * the definition by name (findFunctionInAST() searches the whole tree) and
+ * decodes the ParamNodes again. Calls and loop back-edges are counted per
+ * function; once they reach InterpreterOptions::tierUpThreshold the function
+ * is promoted to tier 1 at its next call:
+ *
+ * - Parameters (names, types, defaults) and the return type are decoded once
+ *   into a PreparedFunction, with the IntKind each type converts to
+ * - Each user-function call site that runs inside a tier 1 body is bound to its
+ *   callee the first time it runs, so later calls skip the name lookup and the
+ *   tree search
+ *
+ * loop() counts one call per iteration and is promoted between iterations,
+ * never in the middle of its body. Tiers change how a call is dispatched, not
+ * what it does: both tiers emit the same commands.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ASTNodes.hpp"
+#include "IntegerModel.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace arduino_interpreter {
+
+struct PreparedParameter {
+    bool bound = false;                                   // PARAM_NODE with a name; others only count
+    std::string name;
+    std::string type = "auto";
+    IntKind intKind = IntKind::NONE;                      // Of `type` under the interpreter's IntModel
+    const arduino_ast::ASTNode* defaultValue = nullptr;
+};
+
+/**
+ * What a call needs from a FuncDefNode besides its body
+ */
+struct PreparedFunction {
+    std::vector<PreparedParameter> parameters;            // One per declared parameter
+    size_t requiredParameters = 0;                        // Parameters without a default
+    std::string returnType = "void";                      // "void": result is not converted
+    IntKind returnIntKind = IntKind::NONE;
+
+    static void prepare(const arduino_ast::FuncDefNode& definition, IntModel model, PreparedFunction& out);
+};
+
+struct FunctionTier {
+    std::string name;
+    const arduino_ast::FuncDefNode* definition = nullptr;
+    uint8_t tier = 0;
+    uint32_t calls = 0;
+    uint32_t backEdges = 0;                               // for/while/do-while iterations in its body
+    uint32_t boundCallSites = 0;                          // Call sites in its body bound so far (tier 1)
+    PreparedFunction prepared;                            // Tier 1 only
+};
+
+/**
+ * One tier-up, with the counters and loop() iteration at which it happened
+ */
+struct TierPromotion {
+    std::string function;
+    uint32_t calls = 0;
+    uint32_t backEdges = 0;
+    uint32_t loopIteration = 0;                           // 0 = before the first loop() iteration
+};
+
+class FunctionTiers {
+public:
+    FunctionTiers(uint32_t threshold, IntModel model) : threshold_(threshold), model_(model) {}
+
+    /**
+     * Counters of `name`, created in tier 0 on first use (references stay valid)
+     */
+    FunctionTier& get(const std::string& name, const arduino_ast::FuncDefNode* definition);
+
+    bool shouldPromote(const FunctionTier& function) const {
+        return function.tier == 0 && threshold_ != 0 && function.calls + function.backEdges >= threshold_;
+    }
+
+    void promote(FunctionTier& function, uint32_t loopIteration);
+
+    /**
+     * Callee bound to `callSite`, or nullptr
+     */
+    FunctionTier* boundCallee(const arduino_ast::ASTNode* callSite) const {
+        if (callSites_.empty()) return nullptr;
+        auto found = callSites_.find(callSite);
+        return found != callSites_.end() ? found->second : nullptr;
+    }
+
+    void bind(const arduino_ast::ASTNode* callSite, FunctionTier& caller, FunctionTier& callee);
+
+    const std::vector<TierPromotion>& promotions() const { return promotions_; }
+
+    /**
+     * Counters of every function called so far, by name
+     */
+    std::vector<const FunctionTier*> functions() const;
+
+private:
+    uint32_t threshold_;
+    IntModel model_;
+    std::unordered_map<std::string, FunctionTier> functions_;
+    std::unordered_map<const arduino_ast::ASTNode*, FunctionTier*> callSites_;
+    std::vector<TierPromotion> promotions_;
+};
+
+} // namespace arduino_interpreter
@@ -0,0 +1,112 @@
+/**
+ * IntegerModel.cpp - Integer kinds of type names, promotions, target sizes
+ *
+ * Version: 1.0
+ */
+
+#include "IntegerModel.hpp"
+#include <cmath>
+
+namespace arduino_interpreter {
+
+namespace {
+
+// Qualifiers that don't change a type's width, in any order
+std::string_view stripAllQualifiers(std::string_view typeName) {
+    static const std::string_view qualifiers[] = {"const ", "volatile ", "static ", "register ", "extern "};
+    bool stripped = true;
+    while (stripped) {
+        stripped = false;
+        for (std::string_view qualifier : qualifiers) {
+            if (typeName.substr(0, qualifier.size()) == qualifier) {
+                typeName.remove_prefix(qualifier.size());
+                stripped = true;
+            }
+        }
+    }
+    return typeName;
+}
+
+IntKind intKind(IntModel model) { return model == IntModel::AVR ? IntKind::I16 : IntKind::I32; }
+IntKind unsignedKind(IntModel model) { return model == IntModel::AVR ? IntKind::U16 : IntKind::U32; }
+
+} // namespace
+
+IntKind intKindOf(std::string_view typeName, IntModel model) {
+    if (model == IntModel::HOST) {
+        if (typeName == "unsigned int" || typeName == "unsigned long" || typeName == "uint32_t" ||
+            typeName == "uint16_t" || typeName == "uint8_t" || typeName == "byte") {
+            return IntKind::U32;
+        }
+        if (typeName == "int" || typeName == "long" || typeName == "int32_t" || typeName == "int16_t" ||
+            typeName == "int8_t") {
+            return IntKind::I32;
+        }
+        return IntKind::NONE;
+    }
+
+    typeName = stripAllQualifiers(typeName);
+    if (typeName == "int" || typeName == "signed" || typeName == "signed int") return intKind(model);
+    if (typeName == "unsigned" || typeName == "unsigned int") return unsignedKind(model);
+    if (typeName == "uint8_t" || typeName == "byte" || typeName == "unsigned char") return IntKind::U8;
+    if (typeName == "char") return model == IntModel::AVR ? IntKind::I8 : IntKind::U8;   // Unsigned on Xtensa/ARM
+    if (typeName == "int8_t" || typeName == "signed char") return IntKind::I8;
+    if (typeName == "uint16_t" || typeName == "word" || typeName == "unsigned short" ||
+        typeName == "unsigned short int") {
+        return IntKind::U16;
+    }
+    if (typeName == "int16_t" || typeName == "short" || typeName == "short int" || typeName == "signed short") {
+        return IntKind::I16;
+    }
+    if (typeName == "uint32_t" || typeName == "unsigned long" || typeName == "unsigned long int") return IntKind::U32;
+    if (typeName == "int32_t" || typeName == "long" || typeName == "long int" || typeName == "signed long") {
+        return IntKind::I32;
+    }
+    if (typeName == "size_t") return unsignedKind(model);
+    return IntKind::NONE;
+}
+
+IntKind literalKind(double value, IntModel model) {
+    if (value != std::floor(value)) return IntKind::NONE;
+    if (model == IntModel::AVR && value >= INT16_MIN && value <= INT16_MAX) return IntKind::I16;
+    if (value >= INT32_MIN && value <= INT32_MAX) return IntKind::I32;
+    if (value >= 0 && value <= UINT32_MAX) return IntKind::U32;
+    return IntKind::NONE;
+}
+
+IntKind promoteKind(IntKind kind, IntModel model) {
+    if (!isIntegerKind(kind)) return kind;
+    return intKindBits(kind) < intKindBits(intKind(model)) ? intKind(model) : kind;
+}
+
+IntKind commonKind(IntKind left, IntKind right, IntModel model) {
+    if (!isIntegerKind(left) || !isIntegerKind(right)) return IntKind::NONE;
+    left = promoteKind(left, model);
+    right = promoteKind(right, model);
+    if (left == right) return left;
+    if (isSignedKind(left) == isSignedKind(right)) {
+        return intKindBits(left) >= intKindBits(right) ? left : right;
+    }
+    IntKind unsignedSide = isSignedKind(left) ? right : left;
+    IntKind signedSide = isSignedKind(left) ? left : right;
+    // A wider signed type holds every value of the unsigned one
+    return intKindBits(unsignedSide) >= intKindBits(signedSide) ? unsignedSide : signedSide;
+}
+
+int32_t targetSizeofType(std::string_view typeName, IntModel model) {
+    if (model == IntModel::HOST) return 0;
+
+    typeName = stripAllQualifiers(typeName);
+    if (!typeName.empty() && typeName.back() == '*') return model == IntModel::AVR ? 2 : 4;
+    if (typeName == "long long" || typeName == "unsigned long long" || typeName == "int64_t" ||
+        typeName == "uint64_t") {
+        return 8;
+    }
+    if (typeName == "bool" || typeName == "boolean") return 1;
+    if (typeName == "float") return 4;
+
+    IntKind kind = intKindOf(typeName, model);
+    return isIntegerKind(kind) ? static_cast<int32_t>(intKindBits(kind) / 8) : 0;
+}
+
+} // namespace arduino_interpreter
@@ -0,0 +1,132 @@
+/**
+ * IntegerModel.hpp - Target integer widths and width-exact kernels
+ *
+ * Integer values are held as int32_t (signed types) or uint32_t (unsigned
+ * types). IntModel::HOST keeps the JavaScript reference behaviour, where
+ * every integer type is 32 bits wide. ILP32 and AVR give char, short, int and
+ * long their target widths:
+ *
+ * - A declared type resolves once to an IntKind (width + signedness), which
+ *   Variable caches, so a store is a switch on the kind instead of a chain of
+ *   type-name comparisons
+ * - narrowInt() wraps a value to its kind, so a byte counter rolls over at
+ *   256 and an AVR int at 32767
+ * - promoteKind()/commonKind() implement the integral promotions and usual
+ *   arithmetic conversions, which decide the width an operation wraps at
+ *
+ * long long and the 64-bit fixed-width types have no kind; they keep the
+ * 32-bit representation in every model.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ArduinoDataTypes.hpp"
+#include <cstdint>
+#include <string_view>
+
+namespace arduino_interpreter {
+
+enum class IntModel : uint8_t {
+    HOST = 0,    // Every integer type is 32-bit (JavaScript reference semantics)
+    ILP32 = 1,   // char 8, short 16, int and long 32 bits (ESP32, ARM)
+    AVR = 2      // char 8, short and int 16, long 32 bits (AVR)
+};
+
+enum class IntKind : uint8_t {
+    UNRESOLVED = 0,   // Not looked up yet (Variable's cached kind)
+    NONE,             // Not an integer type
+    I8, U8, I16, U16, I32, U32
+};
+
+inline bool isIntegerKind(IntKind kind) { return kind >= IntKind::I8; }
+
+inline bool isSignedKind(IntKind kind) {
+    return kind == IntKind::I8 || kind == IntKind::I16 || kind == IntKind::I32;
+}
+
+inline unsigned intKindBits(IntKind kind) {
+    switch (kind) {
+        case IntKind::I8: case IntKind::U8: return 8;
+        case IntKind::I16: case IntKind::U16: return 16;
+        case IntKind::I32: case IntKind::U32: return 32;
+        default: return 0;
+    }
+}
+
+/** Strip "const ", "volatile ", "static " (in that order) from a declared type */
+inline std::string_view stripTypeQualifiers(std::string_view typeName) {
+    if (typeName.substr(0, 6) == "const ") {
+        typeName.remove_prefix(6);
+    }
+    if (typeName.substr(0, 9) == "volatile ") {
+        typeName.remove_prefix(9);
+    }
+    if (typeName.substr(0, 7) == "static ") {
+        typeName.remove_prefix(7);
+    }
+    return typeName;
+}
+
+/**
+ * Kind of a type name that has had stripTypeQualifiers() applied. HOST only
+ * knows the names convertToType() always converted (all 32-bit); the target
+ * models strip any remaining qualifiers and know every integer spelling.
+ */
+IntKind intKindOf(std::string_view typeName, IntModel model);
+
+/** Kind of an integral literal: int if it fits, else long, else unsigned long */
+IntKind literalKind(double value, IntModel model);
+
+/** Integral promotion: kinds narrower than int become int */
+IntKind promoteKind(IntKind kind, IntModel model);
+
+/** Usual arithmetic conversions of two promoted operands (NONE if either is not integral) */
+IntKind commonKind(IntKind left, IntKind right, IntModel model);
+
+/** sizeof(typeName) on the target, 0 if the model doesn't decide it (HOST, double, structs) */
+int32_t targetSizeofType(std::string_view typeName, IntModel model);
+
+/** Truncate a 32-bit pattern to `kind`, sign- or zero-extending it back */
+inline uint32_t wrapBits(uint32_t bits, IntKind kind) {
+    switch (kind) {
+        case IntKind::I8: return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(bits)));
+        case IntKind::U8: return static_cast<uint8_t>(bits);
+        case IntKind::I16: return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(bits)));
+        case IntKind::U16: return static_cast<uint16_t>(bits);
+        default: return bits;
+    }
+}
+
+/**
+ * Convert a value to an integer kind, wrapping like the target. 32-bit kinds
+ * convert exactly as convertToType() always did; other values (strings,
+ * arrays, null) pass through unchanged.
+ */
+inline CommandValue narrowInt(const CommandValue& value, IntKind kind) {
+    if (!isIntegerKind(kind)) return value;
+
+    uint32_t bits;
+    if (const auto* i = std::get_if<int32_t>(&value)) {
+        if (kind == IntKind::I32) return value;
+        bits = static_cast<uint32_t>(*i);
+    } else if (const auto* u = std::get_if<uint32_t>(&value)) {
+        if (kind == IntKind::U32) return value;
+        bits = *u;
+    } else if (const auto* d = std::get_if<double>(&value)) {
+        if (kind == IntKind::I32) return static_cast<int32_t>(*d);
+        if (kind == IntKind::U32) return static_cast<uint32_t>(*d);
+        bits = static_cast<uint32_t>(static_cast<int64_t>(*d));
+    } else if (const auto* b = std::get_if<bool>(&value)) {
+        bits = *b ? 1u : 0u;
+    } else {
+        return value;
+    }
+
+    bits = wrapBits(bits, kind);
+    if (isSignedKind(kind)) return static_cast<int32_t>(bits);
+    return bits;
+}
+
+} // namespace arduino_interpreter
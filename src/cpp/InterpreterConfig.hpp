@@ -45,6 +45,33 @@ namespace Config {
     /** Test timeout for quick operations (in milliseconds) */
     constexpr uint32_t TEST_TIMEOUT_MS = 1000;
 
+    // =============================================================================
+    // COMMAND EMISSION
+    // =============================================================================
+
+    /** Command records buffered by the async emitter before the interpreter blocks */
+    constexpr size_t DEFAULT_EMISSION_QUEUE_CAPACITY = 1024;
+
+    /** Calls + loop back-edges before a user function is promoted to tier 1 (FunctionTiers.hpp) */
+    constexpr uint32_t DEFAULT_TIER_UP_THRESHOLD = 100;
+
+    // =============================================================================
+    // GREEN THREADS
+    // =============================================================================
+
+    /** Native stack reserved per sketch task (committed lazily as it is used) */
+    constexpr size_t GREEN_THREAD_STACK_SIZE = 8 * 1024 * 1024;
+
+    // =============================================================================
+    // SPECULATIVE READ PREFETCH
+    // =============================================================================
+
+    /** Prefetched read values older than this are read again (0 = any age within the iteration) */
+    constexpr uint32_t DEFAULT_PREFETCH_MAX_AGE_US = 50000;
+
+    /** Reads of one loop() iteration recorded for the next prefetch batch */
+    constexpr size_t MAX_PREFETCH_READS = 64;
+
     // =============================================================================
     // DEBUG AND LOGGING
     // =============================================================================
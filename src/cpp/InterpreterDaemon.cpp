@@ -0,0 +1,509 @@
+/**
+ * InterpreterDaemon.cpp - Long-running interpreter service on a UNIX socket
+ *
+ * Version: 1.0
+ */
+
+#include "InterpreterDaemon.hpp"
+
+#if HAS_INTERPRETER_DAEMON
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace arduino_interpreter {
+
+// =============================================================================
+// PROTOCOL HELPERS
+// =============================================================================
+
+namespace daemon_protocol {
+
+uint64_t hashAST(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <typename T>
+static void put(std::vector<uint8_t>& out, T value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void encodeRequest(const DaemonRequest& request, std::vector<uint8_t>& out) {
+    put<uint32_t>(out, MAGIC);
+    put<uint8_t>(out, VERSION);
+    put<uint8_t>(out, static_cast<uint8_t>(request.encoding));
+    put<uint8_t>(out, request.ast.empty() ? 0 : AST_ATTACHED);
+    put<uint8_t>(out, 0);
+    put<uint64_t>(out, request.astHash);
+    put<uint32_t>(out, request.maxLoopIterations);
+    put<uint8_t>(out, request.syncMode ? 1 : 0);
+    put<uint8_t>(out, request.enforceLoopLimitsOnInternalLoops ? 1 : 0);
+    put<uint16_t>(out, 0);
+    put<uint32_t>(out, static_cast<uint32_t>(request.inputs.size()));
+    for (const auto& input : request.inputs) {
+        put<uint8_t>(out, static_cast<uint8_t>(input.kind));
+        put<int32_t>(out, input.pin);
+        put<int64_t>(out, input.value);
+    }
+    if (!request.ast.empty()) {
+        put<uint32_t>(out, static_cast<uint32_t>(request.ast.size()));
+        out.insert(out.end(), request.ast.begin(), request.ast.end());
+    }
+}
+
+} // namespace daemon_protocol
+
+const char* daemonStatusName(DaemonStatus status) {
+    switch (status) {
+        case DaemonStatus::OK:          return "ok";
+        case DaemonStatus::FAILED:      return "failed";
+        case DaemonStatus::UNKNOWN_AST: return "unknown_ast";
+        case DaemonStatus::BAD_REQUEST: return "bad_request";
+    }
+    return "bad_request";
+}
+
+namespace {
+
+bool readFully(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::recv(fd, bytes, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+template <typename T>
+bool readValue(int fd, T& value) {
+    return readFully(fd, &value, sizeof(T));
+}
+
+enum class ReadResult { OK, CLOSED, MALFORMED };
+
+ReadResult readRequest(int fd, DaemonRequest& request) {
+    using namespace daemon_protocol;
+
+    uint32_t magic = 0;
+    if (!readValue(fd, magic)) return ReadResult::CLOSED;
+
+    uint8_t version = 0, encoding = 0, flags = 0, pad8 = 0, syncMode = 0, enforce = 0;
+    uint16_t pad16 = 0;
+    uint32_t inputCount = 0;
+    if (!readValue(fd, version) || !readValue(fd, encoding) || !readValue(fd, flags) || !readValue(fd, pad8) ||
+        !readValue(fd, request.astHash) || !readValue(fd, request.maxLoopIterations) ||
+        !readValue(fd, syncMode) || !readValue(fd, enforce) || !readValue(fd, pad16) ||
+        !readValue(fd, inputCount)) {
+        return ReadResult::CLOSED;
+    }
+    if (magic != MAGIC || version != VERSION || encoding > static_cast<uint8_t>(DaemonEncoding::BINARY) ||
+        inputCount > MAX_INPUTS) {
+        return ReadResult::MALFORMED;
+    }
+    request.encoding = static_cast<DaemonEncoding>(encoding);
+    request.syncMode = syncMode != 0;
+    request.enforceLoopLimitsOnInternalLoops = enforce != 0;
+
+    request.inputs.resize(inputCount);
+    for (auto& input : request.inputs) {
+        uint8_t kind = 0;
+        if (!readValue(fd, kind) || !readValue(fd, input.pin) || !readValue(fd, input.value)) {
+            return ReadResult::CLOSED;
+        }
+        input.kind = static_cast<InputQuery::Kind>(kind);
+    }
+
+    request.ast.clear();
+    if (flags & AST_ATTACHED) {
+        uint32_t size = 0;
+        if (!readValue(fd, size)) return ReadResult::CLOSED;
+        if (size == 0 || size > MAX_AST_SIZE) return ReadResult::MALFORMED;
+        request.ast.resize(size);
+        if (!readFully(fd, request.ast.data(), size)) return ReadResult::CLOSED;
+    }
+    return ReadResult::OK;
+}
+
+/**
+ * Answers each data request from the values queued for it in the request's
+ * input trace, falling back to the daemon's provider once those run out
+ */
+class TraceDataProvider : public SyncDataProvider {
+public:
+    TraceDataProvider(const std::vector<DaemonInput>& inputs, std::unique_ptr<SyncDataProvider> fallback)
+        : fallback_(std::move(fallback)) {
+        for (const auto& input : inputs) {
+            queues_[key(input.kind, input.pin)].push_back(input.value);
+        }
+    }
+
+    int32_t getAnalogReadValue(int32_t pin) override {
+        int64_t value = 0;
+        if (next(InputQuery::Kind::ANALOG_READ, pin, value)) return static_cast<int32_t>(value);
+        return fallback_ ? fallback_->getAnalogReadValue(pin) : 0;
+    }
+
+    int32_t getDigitalReadValue(int32_t pin) override {
+        int64_t value = 0;
+        if (next(InputQuery::Kind::DIGITAL_READ, pin, value)) return static_cast<int32_t>(value);
+        return fallback_ ? fallback_->getDigitalReadValue(pin) : 0;
+    }
+
+    uint32_t getMillisValue() override {
+        int64_t value = 0;
+        if (next(InputQuery::Kind::MILLIS, 0, value)) return static_cast<uint32_t>(value);
+        return fallback_ ? fallback_->getMillisValue() : 0;
+    }
+
+    uint32_t getMicrosValue() override {
+        int64_t value = 0;
+        if (next(InputQuery::Kind::MICROS, 0, value)) return static_cast<uint32_t>(value);
+        return fallback_ ? fallback_->getMicrosValue() : 0;
+    }
+
+    uint32_t getPulseInValue(int32_t pin, int32_t state, uint32_t timeout) override {
+        int64_t value = 0;
+        if (next(InputQuery::Kind::PULSE_IN, pin, value)) return static_cast<uint32_t>(value);
+        return fallback_ ? fallback_->getPulseInValue(pin, state, timeout) : 0;
+    }
+
+    int32_t getLibrarySensorValue(const std::string& libraryName, const std::string& methodName,
+                                  int32_t arg = 0) override {
+        int64_t value = 0;
+        if (next(InputQuery::Kind::LIBRARY_SENSOR, arg, value)) return static_cast<int32_t>(value);
+        return fallback_ ? fallback_->getLibrarySensorValue(libraryName, methodName, arg) : 0;
+    }
+
+private:
+    static uint64_t key(InputQuery::Kind kind, int32_t pin) {
+        bool pinless = kind == InputQuery::Kind::MILLIS || kind == InputQuery::Kind::MICROS;
+        return (static_cast<uint64_t>(kind) << 32) | static_cast<uint32_t>(pinless ? 0 : pin);
+    }
+
+    bool next(InputQuery::Kind kind, int32_t pin, int64_t& value) {
+        auto it = queues_.find(key(kind, pin));
+        if (it == queues_.end() || it->second.empty()) return false;
+        value = it->second.front();
+        it->second.pop_front();
+        return true;
+    }
+
+    std::map<uint64_t, std::deque<int64_t>> queues_;
+    std::unique_ptr<SyncDataProvider> fallback_;
+};
+
+/**
+ * Encodes commands straight into an output buffer that is written to the
+ * client in large chunks while the sketch runs
+ */
+class StreamingCallback : public CommandCallback {
+public:
+    StreamingCallback(int fd, DaemonEncoding encoding) : fd_(fd), encoding_(encoding) {
+        buffer_.reserve(FLUSH_THRESHOLD + 4096);
+    }
+
+    void onCommand(const std::string& jsonCommand) override {
+        count_++;
+        if (encoding_ == DaemonEncoding::BINARY) {
+            uint32_t length = static_cast<uint32_t>(jsonCommand.size());
+            buffer_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            buffer_ += jsonCommand;
+        } else {
+            buffer_ += jsonCommand;
+            buffer_ += '\n';
+        }
+        if (buffer_.size() >= FLUSH_THRESHOLD) flush();
+    }
+
+    bool finish(DaemonStatus status) {
+        if (encoding_ == DaemonEncoding::BINARY) {
+            uint32_t marker = daemon_protocol::END_OF_STREAM;
+            uint8_t code = static_cast<uint8_t>(status);
+            buffer_.append(reinterpret_cast<const char*>(&marker), sizeof(marker));
+            buffer_.append(reinterpret_cast<const char*>(&code), sizeof(code));
+            buffer_.append(reinterpret_cast<const char*>(&count_), sizeof(count_));
+        } else {
+            buffer_ += "{\"type\":\"DAEMON_END\",\"status\":\"";
+            buffer_ += daemonStatusName(status);
+            buffer_ += "\",\"commands\":";
+            buffer_ += std::to_string(count_);
+            buffer_ += "}\n";
+        }
+        flush();
+        return ok_;
+    }
+
+private:
+    static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+    void flush() {
+        if (ok_ && !buffer_.empty()) ok_ = writeFully(fd_, buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+
+    int fd_;
+    DaemonEncoding encoding_;
+    std::string buffer_;
+    uint64_t count_ = 0;
+    bool ok_ = true;
+};
+
+} // anonymous namespace
+
+// =============================================================================
+// LIFECYCLE
+// =============================================================================
+
+InterpreterDaemon::InterpreterDaemon(const DaemonOptions& options) : options_(options) {
+    if (options_.workers == 0) options_.workers = std::max(1u, std::thread::hardware_concurrency());
+    if (options_.cachedPrograms == 0) options_.cachedPrograms = 1;
+}
+
+InterpreterDaemon::~InterpreterDaemon() {
+    stop();
+}
+
+bool InterpreterDaemon::start() {
+    if (running_) return true;
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options_.socketPath.empty() || options_.socketPath.size() >= sizeof(address.sun_path)) {
+        lastError_ = "Invalid socket path: '" + options_.socketPath + "'";
+        return false;
+    }
+    std::strncpy(address.sun_path, options_.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        lastError_ = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+
+    unlink(options_.socketPath.c_str());
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd_, 64) != 0) {
+        lastError_ = "bind/listen " + options_.socketPath + ": " + std::strerror(errno);
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    for (size_t i = 0; i < options_.workers; i++) {
+        workers_.emplace_back(&InterpreterDaemon::workerLoop, this);
+    }
+    acceptThread_ = std::thread(&InterpreterDaemon::acceptLoop, this);
+    return true;
+}
+
+void InterpreterDaemon::stop() {
+    if (!running_.exchange(false)) return;
+
+    // Unblock accept() and every recv() a worker is parked in
+    shutdown(listenFd_, SHUT_RDWR);
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        for (int fd : activeConnections_) shutdown(fd, SHUT_RDWR);
+    }
+    connectionReady_.notify_all();
+
+    if (acceptThread_.joinable()) acceptThread_.join();
+    for (auto& worker : workers_) worker.join();
+    workers_.clear();
+
+    for (int fd : pendingConnections_) close(fd);
+    pendingConnections_.clear();
+    close(listenFd_);
+    listenFd_ = -1;
+    unlink(options_.socketPath.c_str());
+}
+
+void InterpreterDaemon::acceptLoop() {
+    while (running_) {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        if (!running_) {
+            close(fd);
+            break;
+        }
+        pendingConnections_.push_back(fd);
+        connectionReady_.notify_one();
+    }
+}
+
+void InterpreterDaemon::workerLoop() {
+    while (true) {
+        int fd = -1;
+        {
+            std::unique_lock<std::mutex> lock(connectionMutex_);
+            connectionReady_.wait(lock, [this] { return !running_ || !pendingConnections_.empty(); });
+            if (!running_) return;
+            fd = pendingConnections_.front();
+            pendingConnections_.pop_front();
+            activeConnections_.insert(fd);
+        }
+
+        serveConnection(fd);
+
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        activeConnections_.erase(fd);
+        close(fd);
+    }
+}
+
+// =============================================================================
+// REQUEST HANDLING
+// =============================================================================
+
+void InterpreterDaemon::serveConnection(int fd) {
+    DaemonRequest request;
+    while (running_) {
+        ReadResult result = readRequest(fd, request);
+        if (result == ReadResult::CLOSED) return;
+        if (result == ReadResult::MALFORMED) {
+            // Framing is lost - answer once and drop the connection
+            StreamingCallback(fd, request.encoding).finish(DaemonStatus::BAD_REQUEST);
+            return;
+        }
+        if (!serveRequest(fd, request)) return;
+    }
+}
+
+bool InterpreterDaemon::serveRequest(int fd, const DaemonRequest& request) {
+    StreamingCallback output(fd, request.encoding);
+
+    uint64_t hash = 0;
+    auto ast = lookupProgram(request, hash);
+    if (!ast) return output.finish(DaemonStatus::UNKNOWN_AST);
+
+    InterpreterOptions options;
+    options.verbose = false;
+    options.debug = false;
+    options.maxLoopIterations = request.maxLoopIterations;
+    options.syncMode = request.syncMode;
+    options.enforceLoopLimitsOnInternalLoops = request.enforceLoopLimitsOnInternalLoops;
+
+    std::string key = std::to_string(options.maxLoopIterations) + (options.syncMode ? ":s" : ":a") +
+                      (options.enforceLoopLimitsOnInternalLoops ? "e" : "n");
+
+    DaemonStatus status = DaemonStatus::FAILED;
+    try {
+        auto interpreter = takeInterpreter(hash, key, *ast, options);
+        TraceDataProvider provider(request.inputs, options_.fallbackProvider ? options_.fallbackProvider() : nullptr);
+        interpreter->setCommandCallback(&output);
+        interpreter->setSyncDataProvider(&provider);
+        if (interpreter->start()) status = DaemonStatus::OK;
+        interpreter->flushCommands();
+    } catch (const std::exception&) {
+        status = DaemonStatus::FAILED;
+    }
+
+    bool ok = output.finish(status);
+    requestsServed_++;
+
+    // Off the request's critical path: the client already has its answer
+    refillSpares(hash, key, ast, options);
+    return ok;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> InterpreterDaemon::lookupProgram(const DaemonRequest& request,
+                                                                          uint64_t& hash) {
+    // A reference is looked up by the client's hash; an upload is hashed once, here
+    hash = request.ast.empty() ? request.astHash
+                               : daemon_protocol::hashAST(request.ast.data(), request.ast.size());
+
+    std::lock_guard<std::mutex> lock(programMutex_);
+    auto it = programs_.find(hash);
+    if (it != programs_.end()) {
+        cacheHits_++;
+        programOrder_.remove(hash);
+        programOrder_.push_front(hash);
+        return it->second.ast;
+    }
+    if (request.ast.empty()) return nullptr;
+
+    while (programs_.size() >= options_.cachedPrograms && !programOrder_.empty()) {
+        programs_.erase(programOrder_.back());
+        programOrder_.pop_back();
+    }
+    Program& program = programs_[hash];
+    program.ast = std::make_shared<const std::vector<uint8_t>>(request.ast);
+    programOrder_.push_front(hash);
+    return program.ast;
+}
+
+std::unique_ptr<ASTInterpreter> InterpreterDaemon::takeInterpreter(uint64_t hash, const std::string& key,
+                                                                   const std::vector<uint8_t>& ast,
+                                                                   const InterpreterOptions& options) {
+    {
+        std::lock_guard<std::mutex> lock(programMutex_);
+        auto it = programs_.find(hash);
+        if (it != programs_.end()) {
+            auto& spares = it->second.spares[key];
+            if (!spares.empty()) {
+                auto interpreter = std::move(spares.back());
+                spares.pop_back();
+                warmStarts_++;
+                return interpreter;
+            }
+        }
+    }
+    return std::make_unique<ASTInterpreter>(ast.data(), ast.size(), options);
+}
+
+void InterpreterDaemon::refillSpares(uint64_t hash, const std::string& key,
+                                     const std::shared_ptr<const std::vector<uint8_t>>& ast,
+                                     const InterpreterOptions& options) {
+    if (options_.sparesPerProgram == 0) return;
+
+    while (running_) {
+        {
+            std::lock_guard<std::mutex> lock(programMutex_);
+            auto it = programs_.find(hash);
+            if (it == programs_.end() || it->second.spares[key].size() >= options_.sparesPerProgram) return;
+        }
+
+        auto spare = std::make_unique<ASTInterpreter>(ast->data(), ast->size(), options);
+
+        std::lock_guard<std::mutex> lock(programMutex_);
+        auto it = programs_.find(hash);
+        if (it == programs_.end()) return;   // Evicted meanwhile
+        auto& spares = it->second.spares[key];
+        if (spares.size() >= options_.sparesPerProgram) return;
+        spares.push_back(std::move(spare));
+    }
+}
+
+} // namespace arduino_interpreter
+
+#endif // HAS_INTERPRETER_DAEMON
@@ -0,0 +1,200 @@
+/**
+ * InterpreterDaemon.hpp - Long-running interpreter service on a UNIX socket
+ *
+ * Tools that would otherwise start a process per sketch run (load the AST
+ * file, parse it, build the library registry) send the CompactAST - or just
+ * its hash once the daemon has seen it - plus options and an input trace over
+ * a UNIX domain socket, and read the command stream back.
+ *
+ * - Parsed programs are cached by content hash (FNV-1a 64)
+ * - Each cached program keeps a few fully constructed interpreters on
+ *   standby; a request only pays for start(), and the spare it consumed is
+ *   rebuilt after the response has been sent
+ * - Requests are served by a fixed pool of worker threads, one connection
+ *   at a time per worker; a connection may carry any number of requests
+ *
+ * WIRE FORMAT (host byte order - the socket is local):
+ *   request:  u32 magic 'ASTD' | u8 version | u8 encoding | u8 flags | u8 0
+ *             u64 astHash | u32 maxLoopIterations | u8 syncMode
+ *             u8 enforceLoopLimitsOnInternalLoops | u16 0
+ *             u32 inputCount | inputCount x (u8 kind | i32 pin | i64 value)
+ *             [u32 astSize | astSize bytes]            (if flags & AST_ATTACHED)
+ *   response: DaemonEncoding::JSON   - one command per line, then
+ *                                      {"type":"DAEMON_END","status":"ok","commands":N}
+ *             DaemonEncoding::BINARY - (u32 length | bytes)* per command, then
+ *                                      u32 0xFFFFFFFF | u8 status | u64 commandCount
+ *
+ * Host only (POSIX sockets) - compiled out for WASM and ESP32.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ASTInterpreter.hpp"
+#include "SyncDataProvider.hpp"
+#include "PlatformAbstraction.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(PLATFORM_LINUX) && !defined(_WIN32)
+#define HAS_INTERPRETER_DAEMON 1
+#else
+#define HAS_INTERPRETER_DAEMON 0
+#endif
+
+#if HAS_INTERPRETER_DAEMON
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace arduino_interpreter {
+
+// =============================================================================
+// PROTOCOL
+// =============================================================================
+
+namespace daemon_protocol {
+    constexpr uint32_t MAGIC = 0x44545341;        // "ASTD"
+    constexpr uint8_t VERSION = 1;
+    constexpr uint8_t AST_ATTACHED = 0x01;
+    constexpr uint32_t END_OF_STREAM = 0xFFFFFFFFu;
+    constexpr uint32_t MAX_AST_SIZE = 64u * 1024 * 1024;
+    constexpr uint32_t MAX_INPUTS = 1u << 20;
+
+    /** Content hash used to refer to a cached CompactAST */
+    uint64_t hashAST(const uint8_t* data, size_t size);
+}
+
+enum class DaemonEncoding : uint8_t {
+    JSON = 0,     // Newline-delimited JSON, easy to consume from scripts
+    BINARY = 1    // Length-prefixed frames, no scanning for delimiters
+};
+
+enum class DaemonStatus : uint8_t {
+    OK = 0,
+    FAILED = 1,        // start() returned false or threw
+    UNKNOWN_AST = 2,   // Hash not cached - resend with the AST attached
+    BAD_REQUEST = 3
+};
+
+const char* daemonStatusName(DaemonStatus status);
+
+/**
+ * One recorded input: the Nth call of this kind on this pin returns the Nth
+ * value queued for it. Calls with nothing queued use the daemon's fallback.
+ */
+struct DaemonInput {
+    InputQuery::Kind kind = InputQuery::Kind::ANALOG_READ;
+    int32_t pin = 0;      // Ignored for MILLIS / MICROS
+    int64_t value = 0;
+};
+
+struct DaemonRequest {
+    DaemonEncoding encoding = DaemonEncoding::JSON;
+    uint64_t astHash = 0;
+    std::vector<uint8_t> ast;   // Empty = refer to a cached AST by astHash
+    uint32_t maxLoopIterations = Config::TEST_MAX_LOOP_ITERATIONS;
+    bool syncMode = true;
+    bool enforceLoopLimitsOnInternalLoops = true;
+    std::vector<DaemonInput> inputs;
+};
+
+namespace daemon_protocol {
+    /** Serialize a request in the wire format above */
+    void encodeRequest(const DaemonRequest& request, std::vector<uint8_t>& out);
+}
+
+// =============================================================================
+// SERVER
+// =============================================================================
+
+struct DaemonOptions {
+    std::string socketPath;
+    size_t workers = 0;          // 0 = std::thread::hardware_concurrency()
+    size_t cachedPrograms = 64;  // Least recently used programs are evicted
+    size_t sparesPerProgram = 2; // Constructed interpreters kept ready per program/options
+
+    /**
+     * Answers data requests the input trace does not cover (optional;
+     * without one they return 0). Called once per request.
+     */
+    std::function<std::unique_ptr<SyncDataProvider>()> fallbackProvider;
+};
+
+class InterpreterDaemon {
+public:
+    explicit InterpreterDaemon(const DaemonOptions& options);
+    ~InterpreterDaemon();
+
+    InterpreterDaemon(const InterpreterDaemon&) = delete;
+    InterpreterDaemon& operator=(const InterpreterDaemon&) = delete;
+
+    /**
+     * Bind the socket (replacing a stale socket file) and start serving
+     * @return false if the socket could not be bound; see getLastError()
+     */
+    bool start();
+
+    /** Stop accepting, close open connections and join every thread */
+    void stop();
+
+    const std::string& getLastError() const { return lastError_; }
+
+    // Statistics
+    uint64_t getRequestsServed() const { return requestsServed_.load(); }
+    uint64_t getWarmStarts() const { return warmStarts_.load(); }
+    uint64_t getProgramCacheHits() const { return cacheHits_.load(); }
+
+private:
+    struct Program {
+        std::shared_ptr<const std::vector<uint8_t>> ast;
+        std::unordered_map<std::string, std::vector<std::unique_ptr<ASTInterpreter>>> spares;  // Keyed by options
+    };
+
+    void acceptLoop();
+    void workerLoop();
+    void serveConnection(int fd);
+    bool serveRequest(int fd, const DaemonRequest& request);
+
+    /** Cached (or newly cached) AST of the request and its content hash; null if unknown */
+    std::shared_ptr<const std::vector<uint8_t>> lookupProgram(const DaemonRequest& request, uint64_t& hash);
+    std::unique_ptr<ASTInterpreter> takeInterpreter(uint64_t hash, const std::string& key,
+                                                    const std::vector<uint8_t>& ast,
+                                                    const InterpreterOptions& options);
+    void refillSpares(uint64_t hash, const std::string& key,
+                      const std::shared_ptr<const std::vector<uint8_t>>& ast,
+                      const InterpreterOptions& options);
+
+    DaemonOptions options_;
+    std::string lastError_;
+    int listenFd_ = -1;
+    std::atomic<bool> running_{false};
+
+    std::thread acceptThread_;
+    std::vector<std::thread> workers_;
+    std::deque<int> pendingConnections_;
+    std::set<int> activeConnections_;
+    std::mutex connectionMutex_;
+    std::condition_variable connectionReady_;
+
+    std::unordered_map<uint64_t, Program> programs_;
+    std::list<uint64_t> programOrder_;   // Most recently used first
+    std::mutex programMutex_;
+
+    std::atomic<uint64_t> requestsServed_{0};
+    std::atomic<uint64_t> warmStarts_{0};
+    std::atomic<uint64_t> cacheHits_{0};
+};
+
+} // namespace arduino_interpreter
+
+#endif // HAS_INTERPRETER_DAEMON
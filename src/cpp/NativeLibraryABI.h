@@ -0,0 +1,143 @@
+/**
+ * NativeLibraryABI.h - C ABI for natively implemented Arduino libraries
+ *
+ * A shared object that simulates one or more Arduino libraries exports
+ * ARDUINO_NATIVE_ENTRY_SYMBOL. ArduinoLibraryRegistry::loadNativeLibrary()
+ * dlopen()s it, calls the entry point once and registers every table it
+ * returns next to the built-in libraries. Each method is bound to its
+ * function pointer at that moment; a call never goes back through dlsym()
+ * and the plugin never sees a method name.
+ *
+ * Pure C so plugins can be built with any compiler:
+ *
+ *   static const ArduinoNativeMethod methods[] = {{"read", &counterRead}};
+ *   static const ArduinoNativeLibrary libs[] = {{
+ *       sizeof(ArduinoNativeLibrary), "Counter", NULL, 0,
+ *       &counterCreate, &counterDestroy, methods, 1, NULL, 0, NULL, 0}};
+ *   static const ArduinoNativeModule module = {ARDUINO_NATIVE_ABI_VERSION, 1, libs};
+ *
+ *   ARDUINO_NATIVE_EXPORT const ArduinoNativeModule*
+ *   arduino_native_module(uint32_t hostAbiVersion) { return &module; }
+ *
+ * Tables and the strings they point to must stay valid until the shared
+ * object is unloaded (static storage is the intended use).
+ *
+ * Version: 1.0
+ */
+
+#ifndef ARDUINO_NATIVE_LIBRARY_ABI_H
+#define ARDUINO_NATIVE_LIBRARY_ABI_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on every incompatible change; the host rejects other versions */
+#define ARDUINO_NATIVE_ABI_VERSION 1u
+
+#define ARDUINO_NATIVE_ENTRY_SYMBOL "arduino_native_module"
+
+#if defined(_WIN32)
+#define ARDUINO_NATIVE_EXPORT __declspec(dllexport)
+#else
+#define ARDUINO_NATIVE_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* =============================================================================
+ * VALUES
+ * ========================================================================== */
+
+typedef enum {
+    ARDUINO_NATIVE_VOID = 0,
+    ARDUINO_NATIVE_BOOL = 1,
+    ARDUINO_NATIVE_INT = 2,        /* int32_t in asInt */
+    ARDUINO_NATIVE_DOUBLE = 3,     /* asDouble */
+    ARDUINO_NATIVE_STRING = 4      /* NUL-terminated asString */
+} ArduinoNativeValueType;
+
+/**
+ * One argument or result. Argument strings are valid for the duration of the
+ * call; a result string must stay valid until the call returns (the host
+ * copies it before it calls into the plugin again).
+ */
+typedef struct {
+    int32_t type;                  /* ArduinoNativeValueType */
+    int32_t asInt;                 /* ARDUINO_NATIVE_BOOL and ARDUINO_NATIVE_INT */
+    double asDouble;
+    const char* asString;
+} ArduinoNativeValue;
+
+/* =============================================================================
+ * HOST SERVICES
+ * ========================================================================== */
+
+/**
+ * Passed to every call. Values a real board would read from hardware come
+ * from the interpreter's SyncDataProvider, like the built-in libraries'.
+ */
+typedef struct {
+    uint32_t abiVersion;
+    void* context;                 /* Opaque; pass back to the callbacks */
+
+    /* SyncDataProvider::getLibrarySensorValue(); -1 when no provider is set */
+    int32_t (*sensorValue)(void* context, const char* library, const char* method, int32_t arg);
+} ArduinoNativeHost;
+
+/* =============================================================================
+ * LIBRARY TABLES
+ * ========================================================================== */
+
+/**
+ * An instance method (state = the object's state from create) or a static
+ * method (state = NULL). Write the return value to *result, which starts as
+ * ARDUINO_NATIVE_VOID.
+ */
+typedef void (*ArduinoNativeFunction)(void* state, const ArduinoNativeValue* args, uint32_t argc,
+                                      ArduinoNativeValue* result, const ArduinoNativeHost* host);
+
+typedef struct {
+    const char* name;
+    ArduinoNativeFunction function;
+} ArduinoNativeMethod;
+
+typedef struct {
+    uint32_t structSize;           /* sizeof(ArduinoNativeLibrary) the plugin was built with */
+    const char* name;              /* Class name used in sketches, e.g. "Adafruit_BME280" */
+
+    const char* const* constructorArgs;        /* Parameter names (informational) */
+    uint32_t constructorArgCount;
+
+    /* Per-object state; both optional. create runs at construction with the
+     * constructor arguments, destroy when the interpreter releases the object */
+    void* (*create)(const ArduinoNativeValue* args, uint32_t argc, const ArduinoNativeHost* host);
+    void (*destroy)(void* state);
+
+    const ArduinoNativeMethod* methods;        /* Instance methods computed natively */
+    uint32_t methodCount;
+
+    const ArduinoNativeMethod* staticMethods;  /* Class-level methods */
+    uint32_t staticMethodCount;
+
+    const char* const* externalMethods;        /* Methods left to the parent app */
+    uint32_t externalMethodCount;
+} ArduinoNativeLibrary;
+
+typedef struct {
+    uint32_t abiVersion;           /* ARDUINO_NATIVE_ABI_VERSION the plugin was built with */
+    uint32_t libraryCount;
+    const ArduinoNativeLibrary* libraries;
+} ArduinoNativeModule;
+
+/**
+ * Entry point exported as ARDUINO_NATIVE_ENTRY_SYMBOL. Return NULL to refuse
+ * a host whose ABI version the plugin does not support.
+ */
+typedef const ArduinoNativeModule* (*ArduinoNativeEntry)(uint32_t hostAbiVersion);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARDUINO_NATIVE_LIBRARY_ABI_H */
@@ -0,0 +1,193 @@
+/**
+ * ProgramCache.cpp - Resident cache of parsed, ready-to-run programs
+ *
+ * Version: 1.0
+ */
+
+#include "ProgramCache.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace arduino_interpreter {
+
+ProgramCache::ProgramCache(const ProgramCacheOptions& options, const InterpreterOptions& interpreterOptions)
+    : options_(options), interpreterOptions_(interpreterOptions) {}
+
+ProgramCache::~ProgramCache() {
+    clear();
+}
+
+uint64_t ProgramCache::hashProgram(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;   // FNV-1a 64
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+size_t ProgramCache::budget(MemoryRegion region) const {
+    return region == MemoryRegion::INTERNAL ? options_.internalBudget : options_.psramBudget;
+}
+
+size_t ProgramCache::interpreterCost(size_t astSize) const {
+    return options_.interpreterBaseBytes + astSize * options_.interpreterBytesPerASTByte;
+}
+
+bool ProgramCache::hasSpare(const std::string& name) const {
+    auto it = entries_.find(name);
+    return it != entries_.end() && it->second.spare != nullptr;
+}
+
+void ProgramCache::touch(Entry& entry) {
+    order_.splice(order_.begin(), order_, entry.order);
+}
+
+/**
+ * Make `bytes` more fit in `region`: in internal RAM, drop least recently
+ * used spares first, then evict least recently used entries of the region.
+ * Nothing is dropped unless enough room can be made.
+ */
+bool ProgramCache::makeRoom(MemoryRegion region, size_t bytes) {
+    const size_t limit = budget(region);
+    size_t& used = used_[static_cast<size_t>(region)];
+    if (bytes > limit) return false;
+    if (used + bytes <= limit) return true;
+
+    std::vector<Entry*> spares;
+    std::vector<std::string> victims;
+    size_t freed = 0;
+    if (region == MemoryRegion::INTERNAL) {
+        for (auto it = order_.rbegin(); it != order_.rend() && used - freed + bytes > limit; ++it) {
+            Entry& entry = entries_.at(*it);
+            if (!entry.spare) continue;
+            spares.push_back(&entry);
+            freed += interpreterCost(entry.size);
+        }
+    }
+    for (auto it = order_.rbegin(); it != order_.rend() && used - freed + bytes > limit; ++it) {
+        const Entry& entry = entries_.at(*it);
+        if (entry.region != region) continue;
+        victims.push_back(*it);
+        freed += entry.size;   // Its spare, if any, is already counted above
+    }
+    if (used - freed + bytes > limit) return false;
+
+    for (Entry* entry : spares) {
+        dropSpare(*entry);
+        stats_.spareDrops++;
+    }
+    for (const auto& name : victims) {
+        erase(entries_.find(name));
+        stats_.evictions++;
+    }
+    return true;
+}
+
+void ProgramCache::dropSpare(Entry& entry) {
+    if (!entry.spare) return;
+    entry.spare.reset();
+    used_[static_cast<size_t>(MemoryRegion::INTERNAL)] -= interpreterCost(entry.size);
+}
+
+void ProgramCache::erase(std::unordered_map<std::string, Entry>::iterator it) {
+    Entry& entry = it->second;
+    dropSpare(entry);
+    used_[static_cast<size_t>(entry.region)] -= entry.size;
+    if (options_.release) {
+        options_.release(entry.data, entry.region);
+    } else {
+        std::free(entry.data);
+    }
+    order_.erase(entry.order);
+    entries_.erase(it);
+}
+
+bool ProgramCache::insert(const std::string& name, const uint8_t* data, size_t size) {
+    const uint64_t hash = hashProgram(data, size);
+    auto existing = entries_.find(name);
+    if (existing != entries_.end()) {
+        if (existing->second.hash == hash && existing->second.size == size) {
+            touch(existing->second);
+            return true;
+        }
+        erase(existing);   // Same file name, new content
+    }
+
+    // Internal RAM first, PSRAM if internal RAM is full but PSRAM is not
+    MemoryRegion region = MemoryRegion::INTERNAL;
+    if (used(MemoryRegion::INTERNAL) + size > options_.internalBudget &&
+        used(MemoryRegion::PSRAM) + size <= options_.psramBudget) {
+        region = MemoryRegion::PSRAM;
+    }
+    if (!makeRoom(region, size)) {
+        region = region == MemoryRegion::INTERNAL ? MemoryRegion::PSRAM : MemoryRegion::INTERNAL;
+        if (!makeRoom(region, size)) {
+            stats_.rejected++;
+            return false;
+        }
+    }
+
+    void* copy = options_.allocate ? options_.allocate(size, region) : std::malloc(size);
+    if (!copy) {
+        stats_.rejected++;
+        return false;
+    }
+    std::memcpy(copy, data, size);
+
+    order_.push_front(name);
+    Entry& entry = entries_[name];
+    entry.hash = hash;
+    entry.data = static_cast<uint8_t*>(copy);
+    entry.size = size;
+    entry.region = region;
+    entry.order = order_.begin();
+    used_[static_cast<size_t>(region)] += size;
+    return true;
+}
+
+std::unique_ptr<ASTInterpreter> ProgramCache::take(const std::string& name) {
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        stats_.misses++;
+        return nullptr;
+    }
+
+    Entry& entry = it->second;
+    touch(entry);
+    if (entry.spare) {
+        stats_.hits++;
+        used_[static_cast<size_t>(MemoryRegion::INTERNAL)] -= interpreterCost(entry.size);
+        return std::move(entry.spare);
+    }
+
+    stats_.warmHits++;
+    return std::make_unique<ASTInterpreter>(entry.data, entry.size, interpreterOptions_);
+}
+
+bool ProgramCache::refill() {
+    size_t& internal = used_[static_cast<size_t>(MemoryRegion::INTERNAL)];
+    for (const auto& name : order_) {
+        Entry& entry = entries_.at(name);
+        if (entry.spare) continue;
+        const size_t cost = interpreterCost(entry.size);
+        if (internal + cost > options_.internalBudget) continue;
+        if (options_.freeHeap && options_.freeHeap() < cost + options_.heapReserve) return false;
+        entry.spare = std::make_unique<ASTInterpreter>(entry.data, entry.size, interpreterOptions_);
+        internal += cost;
+        stats_.refills++;
+        return true;
+    }
+    return false;
+}
+
+void ProgramCache::invalidate(const std::string& name) {
+    auto it = entries_.find(name);
+    if (it != entries_.end()) erase(it);
+}
+
+void ProgramCache::clear() {
+    while (!entries_.empty()) erase(entries_.begin());
+}
+
+} // namespace arduino_interpreter
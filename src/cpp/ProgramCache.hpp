@@ -0,0 +1,140 @@
+/**
+ * ProgramCache.hpp - Resident cache of parsed, ready-to-run programs
+ *
+ * Switching sketches on the ESP32 used to mean reading the .ast file from
+ * LittleFS, parsing the CompactAST and building a new interpreter (library
+ * registry included) on the spot. The cache keeps recently used programs
+ * resident instead:
+ *
+ * - Entries are keyed by file name and hold a private copy of the CompactAST
+ *   plus its content hash (FNV-1a 64). Inserting the same name with different
+ *   content replaces the entry; the same content is just a use.
+ * - Each entry can hold one constructed, never-started interpreter. take()
+ *   hands it out without parsing or touching the filesystem; without one it
+ *   parses the cached copy. refill() rebuilds spares between sketches, the
+ *   way InterpreterDaemon keeps warm interpreters. A started interpreter is
+ *   not taken back: there is no reset to a never-started state (resetGlobals()
+ *   restores only what callFunction() snapshots).
+ * - A byte budget per memory region. An entry's AST copy goes to internal
+ *   RAM if it fits there, else to PSRAM, evicting least recently used
+ *   entries until it does, and is allocated from that region through the
+ *   allocator hooks. Spares are built on the platform heap, i.e. internal
+ *   RAM, so each is charged to the internal budget whatever the region of
+ *   its AST copy; making room there drops spares before evicting entries.
+ *   refill() also checks the heap itself through the freeHeap hook.
+ *   Interpreters handed out by take() belong to the caller and are outside
+ *   the budget.
+ *
+ * Interpreter footprint is an estimate (interpreterBaseBytes +
+ * interpreterBytesPerASTByte per AST byte); measure on the target and tune.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ASTInterpreter.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace arduino_interpreter {
+
+enum class MemoryRegion : uint8_t {
+    INTERNAL = 0,   // On-chip RAM: fast, small
+    PSRAM = 1       // External RAM: large, slower
+};
+
+struct ProgramCacheOptions {
+    size_t internalBudget = 64 * 1024;          // Bytes charged to internal RAM
+    size_t psramBudget = 0;                     // Bytes charged to PSRAM (0 = no PSRAM)
+    size_t interpreterBaseBytes = 16 * 1024;    // Estimated interpreter size without the tree
+    size_t interpreterBytesPerASTByte = 8;      // Estimated parsed tree bytes per CompactAST byte
+
+    // AST copies are allocated through these (nullptr = malloc/free)
+    void* (*allocate)(size_t size, MemoryRegion region) = nullptr;
+    void (*release)(void* data, MemoryRegion region) = nullptr;
+
+    // Free bytes of the heap spares are built on (nullptr = not checked);
+    // refill() builds a spare only while its estimate plus heapReserve fit
+    size_t (*freeHeap)() = nullptr;
+    size_t heapReserve = 0;
+};
+
+struct ProgramCacheStats {
+    uint64_t hits = 0;          // take() handed out a ready interpreter
+    uint64_t warmHits = 0;      // take() parsed the cached AST copy
+    uint64_t misses = 0;        // take() found no entry
+    uint64_t evictions = 0;
+    uint64_t refills = 0;       // Spares built by refill()
+    uint64_t spareDrops = 0;    // Spares dropped to make room in internal RAM
+    uint64_t rejected = 0;      // insert() of a program no region can hold
+};
+
+class ProgramCache {
+public:
+    ProgramCache(const ProgramCacheOptions& options, const InterpreterOptions& interpreterOptions);
+    ~ProgramCache();
+
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    static uint64_t hashProgram(const uint8_t* data, size_t size);
+
+    /**
+     * Cache a copy of `data` under `name` and mark it most recently used.
+     * @return false if the program fits in no region's budget (not cached)
+     */
+    bool insert(const std::string& name, const uint8_t* data, size_t size);
+
+    /**
+     * A fresh interpreter for `name`, or nullptr if it is not cached. The
+     * caller owns it; the entry stays cached and refill() builds its next
+     * spare.
+     */
+    std::unique_ptr<ASTInterpreter> take(const std::string& name);
+
+    /**
+     * Build one missing spare, most recently used entry first, if internal
+     * RAM has room for it. @return false when there is nothing to build
+     */
+    bool refill();
+
+    /** Drop `name` (e.g. the file was rewritten or deleted) */
+    void invalidate(const std::string& name);
+    void clear();
+
+    bool contains(const std::string& name) const { return entries_.count(name) != 0; }
+    bool hasSpare(const std::string& name) const;
+    size_t size() const { return entries_.size(); }
+    size_t used(MemoryRegion region) const { return used_[static_cast<size_t>(region)]; }
+    const ProgramCacheStats& getStats() const { return stats_; }
+
+private:
+    struct Entry {
+        uint64_t hash = 0;
+        uint8_t* data = nullptr;
+        size_t size = 0;
+        MemoryRegion region = MemoryRegion::INTERNAL;   // Of the AST copy
+        std::unique_ptr<ASTInterpreter> spare;          // Charged to INTERNAL while present
+        std::list<std::string>::iterator order;
+    };
+
+    size_t budget(MemoryRegion region) const;
+    size_t interpreterCost(size_t astSize) const;
+    void touch(Entry& entry);
+    bool makeRoom(MemoryRegion region, size_t bytes);
+    void dropSpare(Entry& entry);
+    void erase(std::unordered_map<std::string, Entry>::iterator it);
+
+    ProgramCacheOptions options_;
+    InterpreterOptions interpreterOptions_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> order_;   // Most recently used first
+    size_t used_[2] = {0, 0};
+    ProgramCacheStats stats_;
+};
+
+} // namespace arduino_interpreter
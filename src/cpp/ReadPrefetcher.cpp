@@ -0,0 +1,114 @@
+/**
+ * ReadPrefetcher.cpp - Read prediction, batch answers and staleness checks
+ *
+ * Version: 1.0
+ */
+
+#include "ReadPrefetcher.hpp"
+#include "InterpreterConfig.hpp"
+
+namespace arduino_interpreter {
+
+#ifndef PLATFORM_WASM
+#define PREFETCH_LOCK() std::lock_guard<std::mutex> lock(mutex_)
+#else
+#define PREFETCH_LOCK() do {} while (0)
+#endif
+
+bool ReadPrefetcher::beginIteration(uint32_t iteration, std::string& requestId, std::vector<PredictedRead>& reads) {
+    PREFETCH_LOCK();
+
+    std::vector<PredictedRead> prediction;
+    if (!recordingOverflowed_) prediction.swap(recorded_);
+    recorded_.clear();
+    recordingOverflowed_ = false;
+    inIteration_ = true;
+
+    slots_.clear();
+    position_ = 0;
+    diverged_ = false;
+    batchId_.clear();
+    if (prediction.empty()) return false;
+
+    slots_.resize(prediction.size());
+    for (size_t i = 0; i < prediction.size(); ++i) slots_[i].read = prediction[i];
+    batchId_ = "prefetch_" + std::to_string(iteration);
+    stats_.batches++;
+
+    requestId = batchId_;
+    reads = std::move(prediction);
+    return true;
+}
+
+void ReadPrefetcher::endIteration() {
+    PREFETCH_LOCK();
+    inIteration_ = false;
+}
+
+bool ReadPrefetcher::answer(const std::string& requestId, const std::vector<int32_t>& values) {
+    PREFETCH_LOCK();
+    if (batchId_.empty() || requestId != batchId_) return false;
+
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < values.size() && i < slots_.size(); ++i) {
+        slots_[i].answered = true;
+        slots_[i].value = values[i];
+        slots_[i].answeredAt = now;
+    }
+    return true;
+}
+
+bool ReadPrefetcher::take(const PredictedRead& read, int32_t& value) {
+    PREFETCH_LOCK();
+    if (!inIteration_) return false;
+
+    if (recorded_.size() < Config::MAX_PREFETCH_READS) {
+        recorded_.push_back(read);
+    } else {
+        recordingOverflowed_ = true;
+    }
+
+    if (slots_.empty() || diverged_) return false;
+    if (position_ >= slots_.size() || slots_[position_].read != read) {
+        diverged_ = true;
+        stats_.mispredicts++;
+        return false;
+    }
+
+    const Slot& slot = slots_[position_++];
+    if (!slot.answered) {
+        stats_.late++;
+        return false;
+    }
+    if (maxAgeMicros_ != 0) {
+        auto age = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - slot.answeredAt).count();
+        if (age > static_cast<int64_t>(maxAgeMicros_)) {
+            stats_.stale++;
+            return false;
+        }
+    }
+
+    value = slot.value;
+    stats_.hits++;
+    return true;
+}
+
+PrefetchStats ReadPrefetcher::stats() const {
+    PREFETCH_LOCK();
+    return stats_;
+}
+
+const char* ReadPrefetcher::functionName(ExternalRead kind) {
+    switch (kind) {
+        case ExternalRead::ANALOG_READ: return "analogRead";
+        case ExternalRead::DIGITAL_READ: return "digitalRead";
+        case ExternalRead::MILLIS: return "millis";
+        case ExternalRead::MICROS: return "micros";
+    }
+    return "";
+}
+
+#undef PREFETCH_LOCK
+
+} // namespace arduino_interpreter
@@ -0,0 +1,119 @@
+/**
+ * ReadPrefetcher.hpp - Speculative prefetch of loop() hardware reads
+ *
+ * Every analogRead/digitalRead/millis/micros normally costs a round-trip to
+ * the host: a blocking SyncDataProvider call in syncMode, a suspension
+ * (WAITING_FOR_RESPONSE) otherwise. With InterpreterOptions::speculativePrefetch
+ * the reads one loop() iteration made become the prediction for the next:
+ *
+ * - At the start of each iteration the interpreter emits one READ_PREFETCH
+ *   command listing the predicted reads in order. The host answers them all
+ *   at once with ASTInterpreter::handlePrefetchResponse(), from any thread,
+ *   while the sketch keeps running.
+ * - A read that matches the prediction at its position and whose value has
+ *   arrived and is no older than prefetchMaxAgeMicros uses that value.
+ * - Otherwise the read falls back to the normal request. A read that differs
+ *   from the prediction (the iteration took another path) is a mispredict and
+ *   drops the rest of the batch; a missing or stale value only affects itself.
+ * - In async mode a read resumed with its continuation result returns that
+ *   result without take(): each read consumes its slot once.
+ *
+ * Reads outside loop() (setup, serialEvent) are neither predicted nor recorded.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef PLATFORM_WASM
+#include <mutex>
+#endif
+
+namespace arduino_interpreter {
+
+enum class ExternalRead : uint8_t {
+    ANALOG_READ,
+    DIGITAL_READ,
+    MILLIS,
+    MICROS
+};
+
+struct PredictedRead {
+    ExternalRead kind = ExternalRead::ANALOG_READ;
+    int32_t pin = -1;                                    // -1 for millis/micros
+
+    bool operator==(const PredictedRead& other) const { return kind == other.kind && pin == other.pin; }
+    bool operator!=(const PredictedRead& other) const { return !(*this == other); }
+};
+
+struct PrefetchStats {
+    uint32_t batches = 0;       // READ_PREFETCH commands emitted
+    uint32_t hits = 0;          // Reads answered from a batch
+    uint32_t mispredicts = 0;   // Iterations whose reads left the predicted sequence
+    uint32_t late = 0;          // Predicted reads whose value had not arrived yet
+    uint32_t stale = 0;         // Predicted reads whose value was older than the limit
+};
+
+class ReadPrefetcher {
+public:
+    explicit ReadPrefetcher(uint32_t maxAgeMicros) : maxAgeMicros_(maxAgeMicros) {}
+
+    /**
+     * Start of a loop() iteration: the previous iteration's reads become this
+     * one's prediction
+     * @return false if there is nothing to prefetch; otherwise the batch's
+     *         request id and reads, to be emitted as READ_PREFETCH
+     */
+    bool beginIteration(uint32_t iteration, std::string& requestId, std::vector<PredictedRead>& reads);
+
+    /**
+     * End of the iteration body: later reads are not recorded
+     */
+    void endIteration();
+
+    /**
+     * Host answer for batch `requestId`: values[i] for reads[i] (thread-safe)
+     * @return false if the batch is no longer the current one
+     */
+    bool answer(const std::string& requestId, const std::vector<int32_t>& values);
+
+    /**
+     * The sketch is about to make `read`. Records it for the next prediction.
+     * @return true with `value` if the current batch holds a fresh answer for it
+     */
+    bool take(const PredictedRead& read, int32_t& value);
+
+    PrefetchStats stats() const;
+
+    static const char* functionName(ExternalRead kind);
+
+private:
+    struct Slot {
+        PredictedRead read;
+        bool answered = false;
+        int32_t value = 0;
+        std::chrono::steady_clock::time_point answeredAt;
+    };
+
+    uint32_t maxAgeMicros_;
+    bool inIteration_ = false;
+    std::vector<PredictedRead> recorded_;                // This iteration's reads so far
+    bool recordingOverflowed_ = false;                   // More than MAX_PREFETCH_READS: don't predict
+
+    std::string batchId_;                                // Empty when no batch is current
+    std::vector<Slot> slots_;
+    size_t position_ = 0;                                // Next predicted read
+    bool diverged_ = false;                              // Mispredicted: rest of the batch is unused
+
+    PrefetchStats stats_;
+#ifndef PLATFORM_WASM
+    mutable std::mutex mutex_;                           // answer() may come from the host's thread
+#endif
+};
+
+} // namespace arduino_interpreter
@@ -0,0 +1,414 @@
+/**
+ * SignalDataProvider.cpp - Waveform evaluation, pulse timing and config parsing
+ *
+ * Version: 1.0
+ */
+
+#include "SignalDataProvider.hpp"
+#include "StateHash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace arduino_interpreter {
+
+namespace {
+
+constexpr double TWO_PI = 6.283185307179586;
+
+bool parseNumber(const std::string& text, double& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+bool parsePin(const std::string& text, int32_t& pin) {
+    if (text.size() == 2 && (text[0] == 'A' || text[0] == 'a') && text[1] >= '0' && text[1] <= '7') {
+        pin = 14 + (text[1] - '0');
+        return true;
+    }
+    double number = 0.0;
+    if (!parseNumber(text, number) || number < 0 || number != std::floor(number)) return false;
+    pin = static_cast<int32_t>(number);
+    return true;
+}
+
+bool parseShape(const std::string& text, SignalShape& shape) {
+    static const std::pair<const char*, SignalShape> SHAPES[] = {
+        {"constant", SignalShape::CONSTANT}, {"sine", SignalShape::SINE}, {"square", SignalShape::SQUARE},
+        {"ramp", SignalShape::RAMP}, {"triangle", SignalShape::TRIANGLE}, {"noise", SignalShape::NOISE},
+        {"bounce", SignalShape::BOUNCE}, {"trace", SignalShape::TRACE}
+    };
+    for (const auto& candidate : SHAPES) {
+        if (text == candidate.first) {
+            shape = candidate.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::set<std::string>& allowedKeys(SignalShape shape) {
+    static const std::set<std::string> CONSTANT = {"value"};
+    static const std::set<std::string> SINE = {"amplitude", "offset", "period_ms", "period_us", "phase_ms", "phase_us"};
+    static const std::set<std::string> SQUARE = {"high", "low", "period_ms", "period_us", "duty", "width_us",
+                                                 "phase_ms", "phase_us"};
+    static const std::set<std::string> RAMP = {"from", "to", "period_ms", "period_us", "phase_ms", "phase_us"};
+    static const std::set<std::string> NOISE = {"mean", "amplitude", "seed", "interval_us"};
+    static const std::set<std::string> BOUNCE = {"initial", "final", "at_ms", "duration_ms", "edges"};
+    static const std::set<std::string> NONE;
+    switch (shape) {
+        case SignalShape::CONSTANT: return CONSTANT;
+        case SignalShape::SINE: return SINE;
+        case SignalShape::SQUARE: return SQUARE;
+        case SignalShape::RAMP:
+        case SignalShape::TRIANGLE: return RAMP;
+        case SignalShape::NOISE: return NOISE;
+        case SignalShape::BOUNCE: return BOUNCE;
+        case SignalShape::TRACE: return NONE;
+    }
+    return NONE;
+}
+
+// Builds `signal` from `key=value` (or, for traces, `t_ms:value`) tokens
+bool buildSignal(SignalShape shape, const std::vector<std::string>& tokens, Signal& signal, std::string& error) {
+    signal = Signal();
+    signal.shape = shape;
+
+    std::map<std::string, double> params;
+    for (const auto& token : tokens) {
+        if (shape == SignalShape::TRACE) {
+            size_t colon = token.find(':');
+            double timeMs = 0.0, value = 0.0;
+            if (colon == std::string::npos || !parseNumber(token.substr(0, colon), timeMs) ||
+                !parseNumber(token.substr(colon + 1), value) || timeMs < 0) {
+                error = "expected t_ms:value, got '" + token + "'";
+                return false;
+            }
+            signal.points.emplace_back(static_cast<uint64_t>(std::llround(timeMs * 1000.0)), value);
+            continue;
+        }
+        size_t equals = token.find('=');
+        double value = 0.0;
+        if (equals == std::string::npos || !parseNumber(token.substr(equals + 1), value)) {
+            error = "expected key=number, got '" + token + "'";
+            return false;
+        }
+        std::string key = token.substr(0, equals);
+        if (!allowedKeys(shape).count(key)) {
+            error = "unknown parameter '" + key + "'";
+            return false;
+        }
+        params[key] = value;
+    }
+
+    auto get = [&](const char* key, double fallback) {
+        auto found = params.find(key);
+        return found != params.end() ? found->second : fallback;
+    };
+    auto micros = [&](const char* msKey, const char* usKey, double fallbackUs) {
+        if (params.count(usKey)) return get(usKey, fallbackUs);
+        if (params.count(msKey)) return get(msKey, 0.0) * 1000.0;
+        return fallbackUs;
+    };
+
+    double period = micros("period_ms", "period_us", 1000000.0);
+    if (period < 1.0) {
+        error = "period must be at least 1us";
+        return false;
+    }
+    signal.periodUs = static_cast<uint64_t>(std::llround(period));
+    signal.phaseUs = static_cast<uint64_t>(std::llround(std::fmod(std::fabs(micros("phase_ms", "phase_us", 0.0)), period)));
+
+    switch (shape) {
+        case SignalShape::CONSTANT:
+            signal.value = get("value", 0.0);
+            break;
+        case SignalShape::SINE:
+            signal.amplitude = get("amplitude", 1.0);
+            signal.offset = get("offset", 0.0);
+            break;
+        case SignalShape::SQUARE: {
+            signal.high = get("high", 1.0);
+            signal.low = get("low", 0.0);
+            double width = params.count("width_us") ? get("width_us", 0.0) : get("duty", 0.5) * period;
+            if (width < 0 || width > period) {
+                error = "pulse width must lie within the period";
+                return false;
+            }
+            signal.widthUs = static_cast<uint64_t>(std::llround(width));
+            break;
+        }
+        case SignalShape::RAMP:
+        case SignalShape::TRIANGLE:
+            signal.from = get("from", 0.0);
+            signal.to = get("to", 1.0);
+            break;
+        case SignalShape::NOISE:
+            signal.offset = get("mean", 0.0);
+            signal.amplitude = get("amplitude", 1.0);
+            signal.seed = static_cast<uint64_t>(get("seed", 0.0));
+            signal.intervalUs = static_cast<uint64_t>(std::max(1.0, get("interval_us", 1000.0)));
+            break;
+        case SignalShape::BOUNCE: {
+            signal.from = get("initial", 0.0) >= 0.5 ? 1.0 : 0.0;
+            signal.to = get("final", 1.0) >= 0.5 ? 1.0 : 0.0;
+            signal.atUs = static_cast<uint64_t>(std::llround(get("at_ms", 0.0) * 1000.0));
+            signal.durationUs = static_cast<uint64_t>(std::llround(get("duration_ms", 0.0) * 1000.0));
+            double edges = get("edges", signal.from != signal.to ? 1.0 : 2.0);
+            if (edges < 1 || edges != std::floor(edges)) {
+                error = "edges must be a positive whole number";
+                return false;
+            }
+            signal.edges = static_cast<uint32_t>(edges);
+            if ((signal.edges % 2 == 1) != (signal.from != signal.to)) {
+                error = "an odd number of edges changes the level, an even number keeps it";
+                return false;
+            }
+            if (signal.edges > 1 && signal.durationUs == 0) {
+                error = "several edges need duration_ms > 0";
+                return false;
+            }
+            break;
+        }
+        case SignalShape::TRACE:
+            if (signal.points.empty()) {
+                error = "trace needs at least one t_ms:value point";
+                return false;
+            }
+            std::stable_sort(signal.points.begin(), signal.points.end(),
+                             [](const auto& a, const auto& b) { return a.first < b.first; });
+            break;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// SIGNAL
+// =============================================================================
+
+size_t Signal::segmentAt(uint64_t timeUs) const {
+    if (cursor_ >= points.size() || points[cursor_].first > timeUs) cursor_ = 0;
+    while (cursor_ + 1 < points.size() && points[cursor_ + 1].first <= timeUs) cursor_++;
+    return cursor_;
+}
+
+double Signal::sample(uint64_t timeUs) const {
+    uint64_t phase = (timeUs + phaseUs) % periodUs;
+    double fraction = static_cast<double>(phase) / static_cast<double>(periodUs);
+
+    switch (shape) {
+        case SignalShape::CONSTANT:
+            return value;
+        case SignalShape::SINE:
+            return offset + amplitude * std::sin(TWO_PI * fraction);
+        case SignalShape::SQUARE:
+            return phase < widthUs ? high : low;
+        case SignalShape::RAMP:
+            return from + (to - from) * fraction;
+        case SignalShape::TRIANGLE:
+            return from + (to - from) * (fraction < 0.5 ? 2.0 * fraction : 2.0 - 2.0 * fraction);
+        case SignalShape::NOISE: {
+            // One splitmix64 step of the interval index, so any sample can be
+            // computed without replaying the sequence before it
+            uint64_t interval = seed * 0x9E3779B97F4A7C15ULL + timeUs / intervalUs;
+            uint64_t bits = mixHash(interval + 0x9E3779B97F4A7C15ULL);
+            double uniform = static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);   // [0, 1)
+            return offset + amplitude * (2.0 * uniform - 1.0);
+        }
+        case SignalShape::BOUNCE: {
+            if (timeUs < atUs) return from;
+            uint64_t step = edges > 1 ? durationUs / (edges - 1) : 0;
+            uint64_t toggles = step == 0 ? edges : std::min<uint64_t>(edges, (timeUs - atUs) / step + 1);
+            return toggles % 2 == 0 ? from : 1.0 - from;
+        }
+        case SignalShape::TRACE: {
+            size_t at = segmentAt(timeUs);
+            const auto& point = points[at];
+            if (timeUs <= point.first || held || at + 1 >= points.size()) return point.second;
+            const auto& next = points[at + 1];
+            double t = static_cast<double>(timeUs - point.first) / static_cast<double>(next.first - point.first);
+            return point.second + (next.second - point.second) * t;
+        }
+    }
+    return 0.0;
+}
+
+uint64_t Signal::nextEdge(uint64_t timeUs) const {
+    switch (shape) {
+        case SignalShape::SQUARE: {
+            if (widthUs == 0 || widthUs >= periodUs || (high >= 0.5) == (low >= 0.5)) return NO_EDGE;
+            uint64_t phase = (timeUs + phaseUs) % periodUs;
+            return phase < widthUs ? timeUs + (widthUs - phase) : timeUs + (periodUs - phase);
+        }
+        case SignalShape::BOUNCE: {
+            uint64_t step = edges > 1 ? durationUs / (edges - 1) : 0;
+            if (timeUs < atUs) return atUs;
+            uint64_t toggles = step == 0 ? edges : std::min<uint64_t>(edges, (timeUs - atUs) / step + 1);
+            return toggles >= edges ? NO_EDGE : atUs + toggles * step;
+        }
+        case SignalShape::TRACE: {
+            bool current = level(timeUs);
+            for (size_t i = segmentAt(timeUs) + 1; i < points.size(); ++i) {
+                if (points[i].first > timeUs && (points[i].second >= 0.5) != current) return points[i].first;
+            }
+            return NO_EDGE;
+        }
+        default:
+            return NO_EDGE;
+    }
+}
+
+// =============================================================================
+// PROVIDER
+// =============================================================================
+
+bool SignalDataProvider::load(const std::string& text, std::string* error) {
+    std::map<int32_t, std::vector<Signal>> analog;
+    std::map<int32_t, Signal> digital;
+    uint32_t readCost = 100;
+    uint64_t start = 0;
+    int32_t analogMax = 1023;
+
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    auto fail = [&](const std::string& message) {
+        if (error) *error = "line " + std::to_string(lineNumber) + ": " + message;
+        return false;
+    };
+
+    while (std::getline(lines, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream words(line);
+        std::vector<std::string> tokens;
+        for (std::string word; words >> word;) tokens.push_back(word);
+        if (tokens.empty()) continue;
+
+        const std::string& directive = tokens[0];
+        double number = 0.0;
+        if (directive == "read_cost_us" || directive == "start_ms" || directive == "analog_max") {
+            if (tokens.size() != 2 || !parseNumber(tokens[1], number) || number < 0) {
+                return fail(directive + " expects one non-negative number");
+            }
+            if (directive == "read_cost_us") readCost = static_cast<uint32_t>(number);
+            else if (directive == "start_ms") start = static_cast<uint64_t>(std::llround(number * 1000.0));
+            else analogMax = static_cast<int32_t>(number);
+            continue;
+        }
+        if (directive != "analog" && directive != "digital") {
+            return fail("unknown directive '" + directive + "'");
+        }
+
+        int32_t pin = 0;
+        SignalShape shape = SignalShape::CONSTANT;
+        if (tokens.size() < 3 || !parsePin(tokens[1], pin)) return fail("expected " + directive + " <pin> <shape> ...");
+        if (!parseShape(tokens[2], shape)) return fail("unknown shape '" + tokens[2] + "'");
+
+        Signal signal;
+        std::string message;
+        if (!buildSignal(shape, std::vector<std::string>(tokens.begin() + 3, tokens.end()), signal, message)) {
+            return fail(message);
+        }
+        if (directive == "analog") {
+            analog[pin].push_back(std::move(signal));
+        } else {
+            if (digital.count(pin)) return fail("digital pin " + std::to_string(pin) + " already has a signal");
+            signal.held = true;
+            digital[pin] = std::move(signal);
+        }
+    }
+
+    analog_ = std::move(analog);
+    digital_ = std::move(digital);
+    readCostUs_ = readCost;
+    nowUs_ = start;
+    analogMax_ = analogMax;
+    return true;
+}
+
+bool SignalDataProvider::loadFile(const std::string& path, std::string* error) {
+    std::ifstream file(path);
+    if (!file) {
+        if (error) *error = "Cannot open " + path;
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return load(text.str(), error);
+}
+
+void SignalDataProvider::observe(const std::string& jsonCommand) {
+    bool millis = jsonCommand.find("\"type\":\"DELAY\"") != std::string::npos;
+    if (!millis && jsonCommand.find("\"type\":\"DELAY_MICROSECONDS\"") == std::string::npos) return;
+
+    size_t at = jsonCommand.find("\"duration\":");
+    if (at == std::string::npos) return;
+    long long duration = std::strtoll(jsonCommand.c_str() + at + 11, nullptr, 10);
+    if (duration > 0) advance(static_cast<uint64_t>(duration) * (millis ? 1000 : 1));
+}
+
+int32_t SignalDataProvider::getAnalogReadValue(int32_t pin) {
+    auto found = analog_.find(pin);
+    if (found == analog_.end()) return fallback_ ? fallback_->getAnalogReadValue(pin) : 0;
+
+    uint64_t at = take();
+    double sum = 0.0;
+    for (const auto& signal : found->second) sum += signal.sample(at);
+    long long value = std::llround(sum);
+    return static_cast<int32_t>(std::max<long long>(0, std::min<long long>(analogMax_, value)));
+}
+
+int32_t SignalDataProvider::getDigitalReadValue(int32_t pin) {
+    auto found = digital_.find(pin);
+    if (found == digital_.end()) return fallback_ ? fallback_->getDigitalReadValue(pin) : 0;
+    return found->second.level(take()) ? 1 : 0;
+}
+
+uint32_t SignalDataProvider::getMillisValue() {
+    return static_cast<uint32_t>(take() / 1000);
+}
+
+uint32_t SignalDataProvider::getMicrosValue() {
+    return static_cast<uint32_t>(take());
+}
+
+uint32_t SignalDataProvider::getPulseInValue(int32_t pin, int32_t state, uint32_t timeout) {
+    auto found = digital_.find(pin);
+    if (found == digital_.end()) return fallback_ ? fallback_->getPulseInValue(pin, state, timeout) : 0;
+    const Signal& signal = found->second;
+
+    // Like the Arduino core: let a pulse already in progress finish, wait for
+    // the next one to start, then time it - all within `timeout`
+    uint64_t start = take();
+    uint64_t limit = start + timeout;
+    bool wanted = state != 0;
+
+    uint64_t rise = start;
+    if (signal.level(rise) == wanted) rise = signal.nextEdge(rise);
+    if (rise != Signal::NO_EDGE) rise = signal.nextEdge(rise);
+    uint64_t fall = rise == Signal::NO_EDGE ? Signal::NO_EDGE : signal.nextEdge(rise);
+
+    if (fall == Signal::NO_EDGE || fall > limit) {
+        nowUs_ = std::max(nowUs_, limit);
+        return 0;
+    }
+    nowUs_ = std::max(nowUs_, fall);
+    return static_cast<uint32_t>(fall - rise);
+}
+
+int32_t SignalDataProvider::getLibrarySensorValue(const std::string& libraryName, const std::string& methodName,
+                                                  int32_t arg) {
+    return fallback_ ? fallback_->getLibrarySensorValue(libraryName, methodName, arg) : 0;
+}
+
+} // namespace arduino_interpreter
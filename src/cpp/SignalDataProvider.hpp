@@ -0,0 +1,152 @@
+/**
+ * SignalDataProvider.hpp - Analytic input waveforms as a SyncDataProvider
+ *
+ * Each configured pin carries a signal that is a closed-form function of
+ * virtual time, so a sample costs O(1) however long the run (traces keep a
+ * cursor and are O(1) for forward-moving time). The provider keeps its own
+ * clock in microseconds:
+ *
+ * - every provider call samples at the current time, then advances it by
+ *   read_cost_us (the cost of the read itself)
+ * - millis()/micros() return the clock
+ * - observe() advances it by the duration of DELAY / DELAY_MICROSECONDS
+ *   commands; call it from the CommandCallback
+ * - pulseIn() returns the width of the next pulse computed from the pin's
+ *   edges, and moves the clock to the end of that pulse (or by the timeout)
+ *
+ * Pins without a signal, and library sensors, are answered by the fallback
+ * provider (0 without one).
+ *
+ * CONFIG FILE (one directive per line, # starts a comment):
+ *   read_cost_us 100                 Clock advance per provider call (default 100)
+ *   start_ms 0                       Clock at the first read
+ *   analog_max 1023                  analogRead() is clamped to 0..analog_max
+ *   analog  <pin> <shape> key=value...
+ *   digital <pin> <shape> key=value...
+ *
+ * Pins are numbers or A0-A7. Several analog lines for one pin add up
+ * (e.g. sine + noise); a digital pin has one signal, HIGH while it is >= 0.5.
+ *
+ *   constant  value
+ *   sine      amplitude offset period_ms phase_ms
+ *   square    high low period_ms|period_us duty|width_us phase_ms|phase_us
+ *   ramp      from to period_ms phase_ms            (sawtooth)
+ *   triangle  from to period_ms phase_ms
+ *   noise     mean amplitude seed interval_us      (uniform, one value per interval)
+ *   bounce    initial final at_ms duration_ms edges (edges transitions, evenly spaced)
+ *   trace     t_ms:value t_ms:value ...            (linear for analog, held for digital)
+ *
+ * pulseIn() needs edges: square, bounce, trace or constant digital signals.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "SyncDataProvider.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace arduino_interpreter {
+
+enum class SignalShape : uint8_t {
+    CONSTANT,
+    SINE,
+    SQUARE,
+    RAMP,
+    TRIANGLE,
+    NOISE,
+    BOUNCE,
+    TRACE
+};
+
+/**
+ * One waveform; only the fields of its shape are used
+ */
+struct Signal {
+    static constexpr uint64_t NO_EDGE = UINT64_MAX;
+
+    SignalShape shape = SignalShape::CONSTANT;
+    bool held = false;                                    // Digital: traces hold values instead of interpolating
+    double value = 0.0;                                   // constant
+    double amplitude = 0.0;                               // sine, noise
+    double offset = 0.0;                                  // sine; noise mean
+    double high = 1.0, low = 0.0;                         // square
+    double from = 0.0, to = 0.0;                          // ramp, triangle; bounce initial/final
+    uint64_t periodUs = 1000000;
+    uint64_t phaseUs = 0;
+    uint64_t widthUs = 500000;                            // square: time spent at `high` per period
+    uint64_t seed = 0;                                    // noise
+    uint64_t intervalUs = 1000;                           // noise
+    uint64_t atUs = 0, durationUs = 0;                    // bounce
+    uint32_t edges = 1;                                   // bounce
+    std::vector<std::pair<uint64_t, double>> points;      // trace, sorted by time
+
+    double sample(uint64_t timeUs) const;
+
+    /**
+     * First time after `timeUs` at which the digital level changes, or
+     * NO_EDGE (also for shapes without closed-form edges)
+     */
+    uint64_t nextEdge(uint64_t timeUs) const;
+
+    bool level(uint64_t timeUs) const { return sample(timeUs) >= 0.5; }
+
+private:
+    size_t segmentAt(uint64_t timeUs) const;              // trace: last point at or before timeUs
+    mutable size_t cursor_ = 0;
+};
+
+class SignalDataProvider : public SyncDataProvider {
+public:
+    explicit SignalDataProvider(SyncDataProvider* fallback = nullptr) : fallback_(fallback) {}
+
+    /**
+     * Replace the configuration with `text` (format above)
+     * @return false (and `error`, with the line number) on a malformed line
+     */
+    bool load(const std::string& text, std::string* error = nullptr);
+    bool loadFile(const std::string& path, std::string* error = nullptr);
+
+    void setAnalogSignal(int32_t pin, const Signal& signal) { analog_[pin] = {signal}; }
+    void addAnalogSignal(int32_t pin, const Signal& signal) { analog_[pin].push_back(signal); }
+    void setDigitalSignal(int32_t pin, const Signal& signal) { digital_[pin] = signal; }
+
+    uint64_t now() const { return nowUs_; }
+    void setTime(uint64_t micros) { nowUs_ = micros; }
+    void advance(uint64_t micros) { nowUs_ += micros; }
+
+    /**
+     * Advance the clock by a DELAY / DELAY_MICROSECONDS command's duration
+     */
+    void observe(const std::string& jsonCommand);
+
+    // SyncDataProvider
+    int32_t getAnalogReadValue(int32_t pin) override;
+    int32_t getDigitalReadValue(int32_t pin) override;
+    uint32_t getMillisValue() override;
+    uint32_t getMicrosValue() override;
+    uint32_t getPulseInValue(int32_t pin, int32_t state, uint32_t timeout) override;
+    int32_t getLibrarySensorValue(const std::string& libraryName, const std::string& methodName,
+                                  int32_t arg = 0) override;
+    bool simulatesPulseIn() const override { return true; }
+
+private:
+    uint64_t take() {
+        uint64_t at = nowUs_;
+        nowUs_ += readCostUs_;
+        return at;
+    }
+
+    SyncDataProvider* fallback_;
+    std::map<int32_t, std::vector<Signal>> analog_;
+    std::map<int32_t, Signal> digital_;
+    uint64_t nowUs_ = 0;
+    uint32_t readCostUs_ = 100;
+    int32_t analogMax_ = 1023;
+};
+
+} // namespace arduino_interpreter
@@ -0,0 +1,244 @@
+/**
+ * StateExplorer.cpp - Bounded breadth-first exploration of a sketch's input space
+ *
+ * Version: 1.0
+ */
+
+#include "StateExplorer.hpp"
+#include "ExecutionTracer.hpp"
+#include "StateHash.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace arduino_interpreter {
+
+namespace {
+
+uint64_t hashPins(const std::map<int32_t, PinShadow>& pins) {
+    uint64_t h = 0;
+    for (const auto& [pin, shadow] : pins) {
+        h = mixHash(h ^ static_cast<uint32_t>(pin));
+        h = mixHash(h ^ (static_cast<uint64_t>(static_cast<uint32_t>(shadow.mode)) << 32 |
+                         static_cast<uint32_t>(shadow.value)));
+    }
+    return h;
+}
+
+// {"type":"DIGITAL_WRITE","timestamp":0,"pin":13,"value":1} -> 13, 1
+bool parsePinCommand(const std::string& command, const char* prefix, int32_t& pin, int32_t& value) {
+    size_t length = std::strlen(prefix);
+    if (command.compare(0, length, prefix) != 0) return false;
+    char* end = nullptr;
+    pin = static_cast<int32_t>(std::strtol(command.c_str() + length, &end, 10));
+    const char* colon = std::strchr(end, ':');
+    if (!colon) return false;
+    value = static_cast<int32_t>(std::strtol(colon + 1, nullptr, 10));
+    return true;
+}
+
+void applyPinCommands(const std::vector<std::string>& commands, std::map<int32_t, PinShadow>& pins) {
+    int32_t pin = 0, value = 0;
+    for (const auto& command : commands) {
+        if (parsePinCommand(command, "{\"type\":\"PIN_MODE\",\"timestamp\":0,\"pin\":", pin, value)) {
+            pins[pin].mode = value;
+        } else if (parsePinCommand(command, "{\"type\":\"DIGITAL_WRITE\",\"timestamp\":0,\"pin\":", pin, value) ||
+                   parsePinCommand(command, "{\"type\":\"ANALOG_WRITE\",\"timestamp\":0,\"pin\":", pin, value)) {
+            pins[pin].value = value;
+        }
+    }
+}
+
+InterpreterOptions explorerOptions(InterpreterOptions options) {
+    options.syncMode = true;   // Reads are answered by the ChoiceProvider
+    return options;
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// CHOICE PROVIDER
+// =============================================================================
+
+/**
+ * Answers the reads of one step from a vector of choice indices. Reads past
+ * the end of the vector take the first value of their domain; the domain
+ * sizes it records tell explore() which vector comes next.
+ */
+class StateExplorer::ChoiceProvider : public SyncDataProvider {
+public:
+    explicit ChoiceProvider(const ExplorationOptions& options) : options_(options) {}
+
+    void begin(const std::vector<uint32_t>& choices, uint32_t millis) {
+        choices_ = &choices;
+        millis_ = millis;
+        taken_.clear();
+        domains_.clear();
+        inputs_.clear();
+        truncated_ = false;
+    }
+
+    /**
+     * Advance `choices` to the next unexplored combination (odometer order,
+     * last choice point fastest). False when every combination has run.
+     */
+    bool next(std::vector<uint32_t>& choices) const {
+        for (size_t i = taken_.size(); i-- > 0;) {
+            if (taken_[i] + 1 < domains_[i]) {
+                choices.assign(taken_.begin(), taken_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+                choices[i]++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::vector<InputQuery>& inputs() const { return inputs_; }
+    bool truncated() const { return truncated_; }
+
+    int32_t getAnalogReadValue(int32_t pin) override {
+        auto found = options_.analogPinValues.find(pin);
+        const auto& values = found != options_.analogPinValues.end() ? found->second : options_.analogValues;
+        return choose(InputQuery::Kind::ANALOG_READ, pin, values);
+    }
+
+    int32_t getDigitalReadValue(int32_t pin) override {
+        return choose(InputQuery::Kind::DIGITAL_READ, pin, options_.digitalValues);
+    }
+
+    uint32_t getMillisValue() override { return millis_; }
+    uint32_t getMicrosValue() override { return millis_ * 1000u; }
+    uint32_t getPulseInValue(int32_t, int32_t, uint32_t) override { return 0; }
+    int32_t getLibrarySensorValue(const std::string&, const std::string&, int32_t = 0) override { return 0; }
+
+private:
+    int32_t choose(InputQuery::Kind kind, int32_t pin, const std::vector<int32_t>& values) {
+        if (values.empty()) return 0;
+
+        uint32_t pick = 0;
+        if (values.size() > 1) {
+            if (taken_.size() < options_.maxChoicesPerStep) {
+                size_t point = taken_.size();
+                pick = point < choices_->size() ? (*choices_)[point] : 0;
+                taken_.push_back(pick);
+                domains_.push_back(static_cast<uint32_t>(values.size()));
+            } else {
+                truncated_ = true;
+            }
+        }
+
+        InputQuery query;
+        query.kind = kind;
+        query.a = pin;
+        query.result = values[pick];
+        inputs_.push_back(query);
+        return values[pick];
+    }
+
+    const ExplorationOptions& options_;
+    const std::vector<uint32_t>* choices_ = nullptr;
+    uint32_t millis_ = 0;
+    std::vector<uint32_t> taken_;
+    std::vector<uint32_t> domains_;
+    std::vector<InputQuery> inputs_;
+    bool truncated_ = false;
+};
+
+// =============================================================================
+// STATE EXPLORER
+// =============================================================================
+
+StateExplorer::StateExplorer(const uint8_t* compactAST, size_t size, const InterpreterOptions& options)
+    : interpreter_(compactAST, size, explorerOptions(options)) {}
+
+ExplorationStats StateExplorer::explore(const ExplorationOptions& options) {
+    auto startTime = std::chrono::steady_clock::now();
+    options_ = options;
+    states_.clear();
+    seen_.clear();
+
+    ExplorationStats stats;
+    interpreter_.initializeGlobals();
+    interpreter_.resetGlobals();
+    states_.emplace_back();
+    states_.back().snapshot = interpreter_.captureState();
+
+    ChoiceProvider provider(options_);
+    interpreter_.setSyncDataProvider(&provider);
+
+    // states_ is in discovery order, which is breadth-first order
+    bool running = true;
+    size_t next = 0;
+    for (; running && next < states_.size(); next++) {
+        running = expand(next, provider, stats);
+    }
+    stats.complete = running && next == states_.size();
+
+    interpreter_.setSyncDataProvider(nullptr);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
+
+bool StateExplorer::expand(size_t index, ChoiceProvider& provider, ExplorationStats& stats) {
+    const bool initial = index == 0;
+    if (!initial && states_[index].depth >= options_.maxDepth) return true;
+
+    const uint32_t depth = initial ? 0 : states_[index].depth + 1;
+    const char* function = initial ? "setup" : "loop";
+    std::vector<uint32_t> choices;
+
+    do {
+        TRACE_CLEAR();   // One step's trace at a time, however long exploration runs
+        interpreter_.restoreState(states_[index].snapshot);
+        provider.begin(choices, depth * options_.millisPerStep);
+        ASTInterpreter::FunctionCallResult result = interpreter_.callFunction(function);
+        stats.transitions++;
+        if (provider.truncated()) stats.truncatedSteps++;
+
+        size_t to = ExploredState::NO_PARENT;
+        bool isNew = false;
+        if (!result.success) {
+            stats.failedSteps++;
+        } else {
+            std::map<int32_t, PinShadow> pins = states_[index].pins;
+            applyPinCommands(result.commands, pins);
+            uint64_t hash = mixHash(interpreter_.hashState() ^ hashPins(pins));
+
+            auto [found, inserted] = seen_.emplace(hash, states_.size());
+            to = found->second;
+            isNew = inserted;
+            if (inserted) {
+                ExploredState state;
+                state.snapshot = interpreter_.captureState();
+                state.pins = std::move(pins);
+                state.hash = hash;
+                state.parent = index;
+                state.depth = depth;
+                state.inputs = provider.inputs();
+                states_.push_back(std::move(state));
+                stats.states++;
+                if (depth > stats.maxDepthReached) stats.maxDepthReached = depth;
+            } else {
+                stats.pruned++;
+            }
+        }
+
+        if (callback_ && !callback_(Transition{index, to, isNew, provider.inputs(), result.commands, interpreter_})) {
+            stats.stopped = true;
+            return false;
+        }
+        if (stats.states >= options_.maxStates) return false;
+    } while (provider.next(choices));
+
+    return true;
+}
+
+std::vector<std::vector<InputQuery>> StateExplorer::pathTo(size_t index) const {
+    std::vector<std::vector<InputQuery>> path;
+    for (size_t at = index; at != 0 && at != ExploredState::NO_PARENT; at = states_[at].parent) {
+        path.push_back(states_[at].inputs);
+    }
+    return std::vector<std::vector<InputQuery>>(path.rbegin(), path.rend());
+}
+
+} // namespace arduino_interpreter
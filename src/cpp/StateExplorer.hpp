@@ -0,0 +1,125 @@
+/**
+ * StateExplorer.hpp - Bounded breadth-first exploration of a sketch's input space
+ *
+ * Every digitalRead()/analogRead() is a choice point with a small value
+ * domain (LOW/HIGH, a few analog levels). Starting after setup(), the
+ * explorer runs loop() once for every combination of answers to the reads
+ * that iteration makes, then hashes the resulting sketch-visible state:
+ * globals, statics, and the pin shadow (mode and last written value per pin,
+ * taken from the emitted commands). A state seen before is pruned; a new one
+ * is queued until the depth bound. Breadth-first order makes the input path
+ * to any state a shortest one.
+ *
+ * One interpreter does all the work. States are kept as global/static
+ * snapshots and restored before each step (ASTInterpreter::captureState()),
+ * so there is no re-execution from the start and no forking.
+ *
+ * Limits:
+ * - Time is not state: millis() is depth * millisPerStep, and two states that
+ *   differ only in when they were reached are the same state
+ * - State identity is a 64-bit hash (hash compaction); a collision prunes a
+ *   state that should have been explored
+ * - Library objects and Serial input are not part of the state
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ASTInterpreter.hpp"
+#include "SyncDataProvider.hpp"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace arduino_interpreter {
+
+struct ExplorationOptions {
+    uint32_t maxDepth = 8;                  // loop() iterations after setup()
+    size_t maxStates = 100000;              // Stop after this many distinct states
+    size_t maxChoicesPerStep = 12;          // Reads per step that branch; later reads take the first value
+    std::vector<int32_t> digitalValues = {0, 1};
+    std::vector<int32_t> analogValues = {0, 512, 1023};
+    std::map<int32_t, std::vector<int32_t>> analogPinValues;   // Per-pin override of analogValues
+    uint32_t millisPerStep = 10;            // Simulated time per step
+};
+
+struct PinShadow {
+    int32_t mode = -1;                      // -1 until pinMode()
+    int32_t value = -1;                     // Last digitalWrite()/analogWrite(), -1 if none
+};
+
+struct ExploredState {
+    static constexpr size_t NO_PARENT = static_cast<size_t>(-1);
+
+    ASTInterpreter::StateSnapshot snapshot;
+    std::map<int32_t, PinShadow> pins;
+    uint64_t hash = 0;
+    size_t parent = NO_PARENT;
+    uint32_t depth = 0;                     // loop() iterations run (0 = just after setup())
+    std::vector<InputQuery> inputs;         // Reads answered on the step from the parent
+};
+
+struct ExplorationStats {
+    size_t states = 0;                      // Distinct states reached (the pre-setup state excluded)
+    size_t transitions = 0;                 // Steps executed
+    size_t pruned = 0;                      // Steps that reached an already-seen state
+    size_t truncatedSteps = 0;              // Steps with more reads than maxChoicesPerStep
+    size_t failedSteps = 0;                 // Steps that threw or emitted an ERROR
+    uint32_t maxDepthReached = 0;
+    bool complete = false;                  // Every state within maxDepth was expanded
+    bool stopped = false;                   // The transition callback asked to stop
+    double seconds = 0.0;
+};
+
+class StateExplorer {
+public:
+    /**
+     * One executed step. `to` is the state it reached (new or already seen),
+     * or NO_PARENT if the step failed. The interpreter holds the post-step
+     * globals while the callback runs (getVariableValue() works).
+     */
+    struct Transition {
+        size_t from;
+        size_t to;
+        bool newState;
+        const std::vector<InputQuery>& inputs;
+        const std::vector<std::string>& commands;
+        ASTInterpreter& interpreter;
+    };
+
+    /** Return false to stop exploring (e.g. an invariant failed) */
+    using TransitionCallback = std::function<bool(const Transition&)>;
+
+    StateExplorer(const uint8_t* compactAST, size_t size, const InterpreterOptions& options);
+
+    void setTransitionCallback(TransitionCallback callback) { callback_ = std::move(callback); }
+
+    /**
+     * Explore from the initial state. States stay available until the next explore().
+     */
+    ExplorationStats explore(const ExplorationOptions& options = ExplorationOptions());
+
+    /** State 0 is the pre-setup state; every other state was reached by a step */
+    size_t getStateCount() const { return states_.size(); }
+    const ExploredState& getState(size_t index) const { return states_[index]; }
+
+    /** Reads answered on each step from the initial state to `index` (setup() first) */
+    std::vector<std::vector<InputQuery>> pathTo(size_t index) const;
+
+private:
+    class ChoiceProvider;
+
+    bool expand(size_t index, ChoiceProvider& provider, ExplorationStats& stats);
+
+    ASTInterpreter interpreter_;
+    ExplorationOptions options_;
+    TransitionCallback callback_;
+    std::vector<ExploredState> states_;
+    std::unordered_map<uint64_t, size_t> seen_;   // State hash -> index
+};
+
+} // namespace arduino_interpreter
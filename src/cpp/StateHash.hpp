@@ -0,0 +1,25 @@
+/**
+ * StateHash.hpp - Hash mixing shared by the state hashes
+ *
+ * ASTInterpreter::hashState() and StateExplorer's pin shadow hash combine
+ * with the same finalizer, so a state hash built from both stays well mixed.
+ * SignalDataProvider's noise waveform uses it as its splitmix64 output step.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace arduino_interpreter {
+
+inline uint64_t mixHash(uint64_t h) {   // splitmix64 finalizer
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+} // namespace arduino_interpreter
@@ -82,6 +82,15 @@ public:
      */
     virtual uint32_t getPulseInValue(int32_t pin, int32_t state, uint32_t timeout) = 0;
 
+    /**
+     * Whether pulseIn() should use getPulseInValue()
+     *
+     * Off by default: pulseIn() then returns the fixed 1500µs the JavaScript
+     * interpreter uses, keeping reference command streams comparable.
+     * Providers that model real pulses (SignalDataProvider) turn it on.
+     */
+    virtual bool simulatesPulseIn() const { return false; }
+
     /**
      * Get value for library sensor readings (CapacitiveSensor, etc.)
      *
@@ -97,4 +106,20 @@ public:
                                          int32_t arg = 0) = 0;
 };
 
+/**
+ * One SyncDataProvider call and the value it returned (recorded input
+ * sequences: InterpreterDaemon run inputs, StateExplorer paths)
+ */
+struct InputQuery {
+    enum class Kind : uint8_t { ANALOG_READ, DIGITAL_READ, MILLIS, MICROS, PULSE_IN, LIBRARY_SENSOR };
+
+    Kind kind = Kind::ANALOG_READ;
+    int32_t a = 0;            // pin / library argument
+    int32_t b = 0;            // pulseIn state
+    uint32_t c = 0;           // pulseIn timeout
+    std::string library;      // LIBRARY_SENSOR only
+    std::string method;       // LIBRARY_SENSOR only
+    int64_t result = 0;
+};
+
 } // namespace arduino_interpreter
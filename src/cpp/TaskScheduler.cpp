@@ -0,0 +1,232 @@
+/**
+ * TaskScheduler.cpp - Cooperative green threads for sketch-level tasks
+ *
+ * Version: 1.0
+ */
+
+#include "TaskScheduler.hpp"
+
+#if HAS_GREEN_THREADS
+
+#include <stdexcept>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+namespace arduino_interpreter {
+
+namespace {
+
+// Thrown at a task's suspension point to unwind a deleted task. Not a
+// std::exception, so interpreter handlers for runtime errors let it pass.
+struct TaskCancelled {};
+
+} // anonymous namespace
+
+struct TaskScheduler::Task {
+    TaskId id = MAIN_TASK;
+    std::string name;
+    int priority = 0;
+    Body body;
+    ucontext_t context{};
+    void* stack = nullptr;       // mmap'd, lowest page is a guard page
+    size_t stackSize = 0;
+    uint64_t queuedSeq = 0;      // Seq of the task's live run-queue entry
+    bool started = false;
+    bool finished = false;
+    bool cancelled = false;
+
+    ~Task() {
+        if (stack) munmap(stack, stackSize);
+    }
+};
+
+bool TaskScheduler::Entry::operator>(const Entry& other) const {
+    if (wake != other.wake) return wake > other.wake;
+    if (priority != other.priority) return priority < other.priority;
+    return seq > other.seq;
+}
+
+TaskScheduler::TaskScheduler(size_t stackSize, int mainPriority)
+    : stackSize_(stackSize), mainPriority_(mainPriority), main_(std::make_unique<Task>()) {
+    main_->name = "loopTask";
+    main_->priority = mainPriority;
+    main_->started = true;
+}
+
+TaskScheduler::~TaskScheduler() {
+    if (current_ == MAIN_TASK) shutdown();
+}
+
+const std::string& TaskScheduler::name(TaskId task) const {
+    if (task == MAIN_TASK) return main_->name;
+    auto it = tasks_.find(task);
+    if (it == tasks_.end()) throw std::out_of_range("No task " + std::to_string(task));
+    return it->second->name;
+}
+
+TaskScheduler::TaskId TaskScheduler::create(const std::string& name, int priority, Body body) {
+    auto task = std::make_unique<Task>();
+    task->id = nextId_++;
+    task->name = name;
+    task->priority = priority;
+    task->body = std::move(body);
+
+    // Reserve address space only; pages are committed as the stack grows
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    task->stackSize = (stackSize_ + page - 1) / page * page + page;
+    task->stack = mmap(nullptr, task->stackSize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (task->stack == MAP_FAILED) {
+        task->stack = nullptr;
+        throw std::runtime_error("Cannot allocate a stack for task " + name);
+    }
+    mprotect(task->stack, page, PROT_NONE);
+
+    TaskId id = task->id;
+    tasks_.emplace(id, std::move(task));
+    schedule(id, now_);
+    return id;
+}
+
+void TaskScheduler::schedule(TaskId task, uint64_t wake) {
+    Task& t = *tasks_.at(task);
+    t.queuedSeq = nextSeq_++;
+    runQueue_.push(Entry{wake, t.priority, t.queuedSeq, task});
+}
+
+void TaskScheduler::sleepUntil(uint64_t wakeMicros) {
+    if (wakeMicros < now_) wakeMicros = now_;
+
+    if (current_ != MAIN_TASK) {
+        schedule(current_, wakeMicros);
+        Entry next = runQueue_.top();
+        if (next.task == current_ && mainEntry_ > next) {
+            // Still first in line - keep running instead of a round trip through the main task
+            runQueue_.pop();
+            if (next.wake > now_) now_ = next.wake;
+            return;
+        }
+        suspendCurrent();
+        return;
+    }
+
+    Entry main{wakeMicros, mainPriority_, nextSeq_++, MAIN_TASK};
+    runUntil(main);
+    if (now_ < wakeMicros) now_ = wakeMicros;
+}
+
+void TaskScheduler::runUntil(const Entry& main) {
+    mainEntry_ = main;
+    while (!runQueue_.empty() && mainEntry_ > runQueue_.top()) {
+        Entry next = runQueue_.top();
+        runQueue_.pop();
+
+        auto it = tasks_.find(next.task);
+        if (it == tasks_.end() || it->second->queuedSeq != next.seq) continue;   // Stale entry
+
+        Task& task = *it->second;
+        if (task.cancelled && !task.started) {
+            tasks_.erase(it);
+            continue;
+        }
+        if (next.wake > now_) now_ = next.wake;
+
+        switchTo(task);
+
+        if (task.finished) {
+            TaskId id = task.id;
+            if (exitHook_) exitHook_(id, !task.cancelled && !taskError_);
+            tasks_.erase(id);
+        }
+        if (taskError_) {
+            std::exception_ptr error = taskError_;
+            taskError_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+void TaskScheduler::switchTo(Task& task) {
+    if (switchHook_) switchHook_(MAIN_TASK, task.id);
+    current_ = task.id;
+    if (!task.cancelled) switches_++;   // Unwinding a deleted task is not a switch
+
+    if (!task.started) {
+        getcontext(&task.context);
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        task.context.uc_stack.ss_sp = static_cast<char*>(task.stack) + page;
+        task.context.uc_stack.ss_size = task.stackSize - page;
+        task.context.uc_link = &main_->context;   // Body returned: resume the main task
+
+        // makecontext() only passes int arguments
+        uintptr_t self = reinterpret_cast<uintptr_t>(this);
+        makecontext(&task.context, reinterpret_cast<void (*)()>(&TaskScheduler::trampoline), 2,
+                    static_cast<uint32_t>(static_cast<uint64_t>(self) >> 32),
+                    static_cast<uint32_t>(self));
+        task.started = true;
+    }
+    swapcontext(&main_->context, &task.context);
+
+    current_ = MAIN_TASK;
+    if (switchHook_) switchHook_(task.id, MAIN_TASK);
+}
+
+void TaskScheduler::suspendCurrent() {
+    Task& task = *tasks_.at(current_);
+    swapcontext(&task.context, &main_->context);
+    if (task.cancelled) throw TaskCancelled{};
+}
+
+void TaskScheduler::trampoline(uint32_t high, uint32_t low) {
+    auto* self = reinterpret_cast<TaskScheduler*>((static_cast<uintptr_t>(high) << 32) | low);
+    Task& task = *self->tasks_.at(self->current_);
+    try {
+        task.body();
+    } catch (const TaskCancelled&) {
+        // Deleted - stack unwound
+    } catch (...) {
+        self->taskError_ = std::current_exception();
+    }
+    task.finished = true;
+}
+
+void TaskScheduler::remove(TaskId task) {
+    if (task == MAIN_TASK) return;
+    auto it = tasks_.find(task);
+    if (it == tasks_.end()) return;
+
+    it->second->cancelled = true;
+    if (task == current_) throw TaskCancelled{};
+    schedule(task, now_);   // Unwind at the next switch
+}
+
+void TaskScheduler::drain() {
+    while (!tasks_.empty() && !runQueue_.empty()) {
+        Entry main{UINT64_MAX, mainPriority_, UINT64_MAX, MAIN_TASK};
+        runUntil(main);
+    }
+}
+
+void TaskScheduler::shutdown() {
+    for (auto& entry : tasks_) entry.second->cancelled = true;
+    while (!tasks_.empty()) {
+        // Unwind started tasks one at a time; never-started ones are dropped
+        auto it = tasks_.begin();
+        Task& task = *it->second;
+        if (!task.started || task.finished) {
+            tasks_.erase(it);
+            continue;
+        }
+        switchTo(task);
+        TaskId id = task.id;
+        if (exitHook_) exitHook_(id, false);
+        tasks_.erase(id);
+    }
+    runQueue_ = {};
+    taskError_ = nullptr;
+}
+
+} // namespace arduino_interpreter
+
+#endif // HAS_GREEN_THREADS
@@ -0,0 +1,145 @@
+/**
+ * TaskScheduler.hpp - Cooperative green threads for sketch-level tasks
+ *
+ * FreeRTOS-style sketches split work into tasks (xTaskCreate) that hand the
+ * CPU back with vTaskDelay(), yield() or delay(). The interpreter walks the
+ * AST recursively, so each task runs on a native stack of its own (ucontext)
+ * and keeps its interpreter frame state next to it; a switch is a register
+ * swap plus the owner's frame swap - O(1) in the number of tasks and in the
+ * depth of either stack.
+ *
+ * - Time is virtual (microseconds) and only advances when the task that
+ *   runs next was asleep; a sleeping task never costs host time
+ * - The run queue orders tasks by wake time, then priority (higher first),
+ *   then FIFO, so a run is deterministic
+ * - The thread that owns the scheduler is the main task; other tasks only
+ *   run while it yields
+ *
+ * Host only (ucontext) - compiled out for WASM and ESP32.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "PlatformAbstraction.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#if defined(PLATFORM_LINUX) && !defined(_WIN32)
+#define HAS_GREEN_THREADS 1
+#else
+#define HAS_GREEN_THREADS 0
+#endif
+
+#if HAS_GREEN_THREADS
+
+#include <exception>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace arduino_interpreter {
+
+class TaskScheduler {
+public:
+    using TaskId = int32_t;
+    using Body = std::function<void()>;
+
+    /** The thread that owns the scheduler (setup()/loop() in the interpreter) */
+    static constexpr TaskId MAIN_TASK = 0;
+
+    /**
+     * Called on the main stack around every switch with the task losing and
+     * the task gaining the CPU, so the owner can swap per-task state
+     */
+    using SwitchHook = std::function<void(TaskId from, TaskId to)>;
+
+    /**
+     * Called on the main stack when a task is gone: `returned` if its body
+     * returned, false if it was deleted or failed
+     */
+    using ExitHook = std::function<void(TaskId task, bool returned)>;
+
+    explicit TaskScheduler(size_t stackSize, int mainPriority = 1);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void setSwitchHook(SwitchHook hook) { switchHook_ = std::move(hook); }
+    void setExitHook(ExitHook hook) { exitHook_ = std::move(hook); }
+
+    /**
+     * Create a task that becomes ready at the current virtual time
+     * @return its id (> MAIN_TASK)
+     */
+    TaskId create(const std::string& name, int priority, Body body);
+
+    /** Give up the CPU for `delayMicros` of virtual time (0 = round robin) */
+    void yield(uint64_t delayMicros) { sleepUntil(now_ + delayMicros); }
+
+    /** Give up the CPU until virtual time `wakeMicros` (no earlier than now) */
+    void sleepUntil(uint64_t wakeMicros);
+
+    /**
+     * Delete a task. Deleting the current (non-main) task unwinds it
+     * immediately; another task is unwound the next time it is due.
+     * Deleting MAIN_TASK is not possible - use drain() once the main task
+     * has nothing left to do.
+     */
+    void remove(TaskId task);
+
+    /** Main task only: run the other tasks until none is left */
+    void drain();
+
+    /** Main task only: unwind every remaining task and release its stack */
+    void shutdown();
+
+    TaskId current() const { return current_; }
+    uint64_t now() const { return now_; }
+    bool exists(TaskId task) const { return task == MAIN_TASK || tasks_.count(task) > 0; }
+    const std::string& name(TaskId task) const;
+    size_t taskCount() const { return tasks_.size(); }
+    uint64_t getSwitchCount() const { return switches_; }
+
+private:
+    struct Task;
+
+    // Run-queue entry; `seq` breaks ties FIFO and invalidates stale entries
+    struct Entry {
+        uint64_t wake;
+        int priority;
+        uint64_t seq;
+        TaskId task;
+
+        bool operator>(const Entry& other) const;   // Min-heap ordering
+    };
+
+    void schedule(TaskId task, uint64_t wake);
+    void runUntil(const Entry& main);
+    void switchTo(Task& task);
+    void suspendCurrent();
+    static void trampoline(uint32_t high, uint32_t low);
+
+    size_t stackSize_;
+    int mainPriority_;
+    std::unordered_map<TaskId, std::unique_ptr<Task>> tasks_;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> runQueue_;
+    std::unique_ptr<Task> main_;
+    Entry mainEntry_{};   // When the main task wants the CPU back
+    TaskId current_ = MAIN_TASK;
+    TaskId nextId_ = MAIN_TASK + 1;
+    uint64_t now_ = 0;
+    uint64_t nextSeq_ = 0;
+    uint64_t switches_ = 0;
+    std::exception_ptr taskError_;
+    SwitchHook switchHook_;
+    ExitHook exitHook_;
+};
+
+} // namespace arduino_interpreter
+
+#endif // HAS_GREEN_THREADS
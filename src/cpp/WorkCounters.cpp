@@ -0,0 +1,39 @@
+/**
+ * WorkCounters.cpp - Deterministic work-unit counters
+ *
+ * Version: 1.0
+ */
+
+#include "WorkCounters.hpp"
+
+namespace arduino_interpreter {
+
+#if ENABLE_WORK_COUNTERS
+namespace work_detail {
+    thread_local WorkCounters* activeCounters = nullptr;
+    thread_local WorkPhase activePhase = WorkPhase::PROGRAM;
+}
+#endif
+
+const char* workUnitName(WorkUnit unit) {
+    switch (unit) {
+        case WorkUnit::NODES_VISITED: return "nodesVisited";
+        case WorkUnit::SCOPE_LOOKUPS: return "scopeLookups";
+        case WorkUnit::VALUE_COPIES: return "valueCopies";
+        case WorkUnit::HEAP_ALLOCATIONS: return "heapAllocations";
+        case WorkUnit::BYTES_FORMATTED: return "bytesFormatted";
+        case WorkUnit::COMMANDS_EMITTED: return "commandsEmitted";
+        default: return "unknown";
+    }
+}
+
+const char* workPhaseName(WorkPhase phase) {
+    switch (phase) {
+        case WorkPhase::PROGRAM: return "program";
+        case WorkPhase::SETUP: return "setup";
+        case WorkPhase::LOOP: return "loop";
+        default: return "unknown";
+    }
+}
+
+} // namespace arduino_interpreter
@@ -0,0 +1,148 @@
+/**
+ * WorkCounters.hpp - Deterministic work-unit counters
+ *
+ * Wall time and RSS change from run to run; these counts don't. Counted per
+ * phase of the run that did the work:
+ * - nodesVisited: node dispatches, i.e. accept() calls plus
+ *   evaluateExpression() calls (a node evaluated through accept() counts in
+ *   both)
+ * - scopeLookups: ScopeManager get/has/set by name
+ * - valueCopies: Variable copies and value stores (setValue())
+ * - heapAllocations: operator new calls, if the host routes its operator new
+ *   to countHeapAllocation() (the library does not replace it)
+ * - bytesFormatted: JSON bytes formatted for emitted commands; bytes the async
+ *   emission worker formats are folded in by flushCommands()
+ * - commandsEmitted: commands handed to emission (sync or async)
+ *
+ * Counting follows the interpreter whose phase is active on the calling
+ * thread: start(), resume(), initializeGlobals() and callFunction() open one.
+ * The program phase is everything outside setup() and loop() (global
+ * declarations, PROGRAM_START/END); callFunction() counts "setup" as setup
+ * and any other function as loop. Construction is not counted.
+ *
+ * Compiled in with ENABLE_WORK_COUNTERS=1 (CMake option of the same name, off
+ * by default; the work_counters test target always has it); otherwise the
+ * counting functions are empty and all counts stay zero.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ENABLE_WORK_COUNTERS
+    #define ENABLE_WORK_COUNTERS 0  // Disabled unless the build asks for it
+#endif
+
+namespace arduino_interpreter {
+
+enum class WorkUnit : uint8_t {
+    NODES_VISITED = 0,
+    SCOPE_LOOKUPS,
+    VALUE_COPIES,
+    HEAP_ALLOCATIONS,
+    BYTES_FORMATTED,
+    COMMANDS_EMITTED,
+    COUNT
+};
+
+enum class WorkPhase : uint8_t {
+    PROGRAM = 0,    // Outside setup() and loop()
+    SETUP,
+    LOOP,
+    COUNT
+};
+
+constexpr size_t WORK_UNIT_COUNT = static_cast<size_t>(WorkUnit::COUNT);
+constexpr size_t WORK_PHASE_COUNT = static_cast<size_t>(WorkPhase::COUNT);
+
+const char* workUnitName(WorkUnit unit);     // "nodesVisited", ...
+const char* workPhaseName(WorkPhase phase);  // "program", "setup", "loop"
+
+struct WorkCounters {
+    uint64_t counts[WORK_PHASE_COUNT][WORK_UNIT_COUNT] = {};
+
+    uint64_t get(WorkPhase phase, WorkUnit unit) const {
+        return counts[static_cast<size_t>(phase)][static_cast<size_t>(unit)];
+    }
+
+    uint64_t total(WorkUnit unit) const {
+        uint64_t sum = 0;
+        for (size_t phase = 0; phase < WORK_PHASE_COUNT; phase++) sum += counts[phase][static_cast<size_t>(unit)];
+        return sum;
+    }
+
+    void clear() { *this = WorkCounters(); }
+};
+
+#if ENABLE_WORK_COUNTERS
+
+namespace work_detail {
+    extern thread_local WorkCounters* activeCounters;
+    extern thread_local WorkPhase activePhase;
+}
+
+inline void countWork(WorkUnit unit, uint64_t amount = 1) {
+    if (WorkCounters* counters = work_detail::activeCounters) {
+        counters->counts[static_cast<size_t>(work_detail::activePhase)][static_cast<size_t>(unit)] += amount;
+    }
+}
+
+/** Phase the calling thread is counting against */
+inline WorkPhase activeWorkPhase() { return work_detail::activePhase; }
+
+/**
+ * Makes `counters` and `phase` the calling thread's counting target until
+ * destroyed; the previous target is restored, so phases nest.
+ */
+class WorkPhaseScope {
+public:
+    WorkPhaseScope(WorkCounters& counters, WorkPhase phase)
+        : savedCounters_(work_detail::activeCounters), savedPhase_(work_detail::activePhase) {
+        work_detail::activeCounters = &counters;
+        work_detail::activePhase = phase;
+    }
+
+    ~WorkPhaseScope() {
+        work_detail::activeCounters = savedCounters_;
+        work_detail::activePhase = savedPhase_;
+    }
+
+    WorkPhaseScope(const WorkPhaseScope&) = delete;
+    WorkPhaseScope& operator=(const WorkPhaseScope&) = delete;
+
+private:
+    WorkCounters* savedCounters_;
+    WorkPhase savedPhase_;
+};
+
+/** Member whose owner's copies count as VALUE_COPIES; moves are not counted */
+struct CopyCounter {
+    CopyCounter() = default;
+    CopyCounter(const CopyCounter&) { countWork(WorkUnit::VALUE_COPIES); }
+    CopyCounter(CopyCounter&&) noexcept = default;
+    CopyCounter& operator=(const CopyCounter&) { countWork(WorkUnit::VALUE_COPIES); return *this; }
+    CopyCounter& operator=(CopyCounter&&) noexcept = default;
+};
+
+#else // !ENABLE_WORK_COUNTERS
+
+inline void countWork(WorkUnit, uint64_t = 1) {}
+
+inline WorkPhase activeWorkPhase() { return WorkPhase::PROGRAM; }
+
+class WorkPhaseScope {
+public:
+    WorkPhaseScope(WorkCounters&, WorkPhase) {}
+    WorkPhaseScope(const WorkPhaseScope&) = delete;
+    WorkPhaseScope& operator=(const WorkPhaseScope&) = delete;
+};
+
+#endif // ENABLE_WORK_COUNTERS
+
+/** For a host's operator new: counts one allocation against the active phase */
+inline void countHeapAllocation() { countWork(WorkUnit::HEAP_ALLOCATIONS); }
+
+} // namespace arduino_interpreter
@@ -0,0 +1,510 @@
+/**
+ * WorkerPool.cpp - Crash-isolated batch execution on forked worker processes
+ *
+ * Version: 1.0
+ */
+
+#include "WorkerPool.hpp"
+
+#if HAS_WORKER_POOL
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace arduino_interpreter {
+
+// =============================================================================
+// SHARED-MEMORY RING
+// =============================================================================
+
+// Records are [uint32 length][bytes], padded to 4 bytes and never split across
+// the end of the buffer, so the parent can hand out a view without copying.
+// A WRAP_MARKER length sends the reader back to offset 0.
+//
+// Each side raises its waiting flag, re-checks the indices and only then
+// blocks; the other side clears the flag after moving its index and, if it
+// was set, writes one byte to the matching pipe. With sequentially consistent
+// flags and indices at least one of the two sees the other's update, so a
+// wakeup cannot be lost.
+struct WorkerPool::Ring {
+    std::atomic<uint64_t> head{0};   // Bytes published by the worker
+    std::atomic<uint64_t> tail{0};   // Bytes consumed by the parent
+    std::atomic<uint32_t> readerWaiting{0};   // Parent is about to sleep in poll()
+    std::atomic<uint32_t> writerWaiting{0};   // Worker is blocked on a full ring
+    uint64_t capacity = 0;
+
+    uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Ring indices are shared between processes and must be lock-free");
+
+namespace {
+
+constexpr uint32_t WRAP_MARKER = 0xFFFFFFFFu;
+
+constexpr uint64_t recordSize(uint32_t length) {
+    return (sizeof(uint32_t) + length + 3u) & ~uint64_t(3);
+}
+
+// At most half the ring, so a record still fits after a wrap marker
+constexpr uint64_t maxRecordLength(uint64_t capacity) {
+    return capacity / 2 - 8;
+}
+
+void ringBell(int fd) {
+    const uint8_t byte = 1;
+    // Non-blocking: a full pipe already holds a pending wakeup
+    while (::write(fd, &byte, 1) < 0 && errno == EINTR) {}
+}
+
+void drainBell(int fd) {
+    uint8_t bytes[64];
+    while (::read(fd, bytes, sizeof(bytes)) > 0) {}
+}
+
+// Current address-space size, the figure RLIMIT_AS is checked against
+size_t addressSpaceBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    statm >> pages;
+    return pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+struct CompletionMessage {
+    uint32_t jobIndex = 0;
+    uint8_t status = 0;
+    char error[251] = {};
+};
+
+bool writeFully(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readFully(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::recv(fd, bytes, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * Worker-side CommandCallback: publishes each command into the ring,
+ * blocking on the space pipe while the parent makes room.
+ *
+ * A command too large for one record is not written: the interpreter is
+ * stopped, everything after it is dropped and overflowError() explains why.
+ */
+template <typename RingT>
+class RingCommandCallback : public CommandCallback {
+public:
+    RingCommandCallback(RingT* ring, int doorbell, int space)
+        : ring_(ring), doorbell_(doorbell), space_(space) {}
+
+    void setInterpreter(ASTInterpreter* interpreter) { interpreter_ = interpreter; }
+
+    bool overflowed() const { return overflowBytes_ > 0; }
+
+    std::string overflowError() const {
+        return "command of " + std::to_string(overflowBytes_) + " bytes exceeds the ring's " +
+               std::to_string(maxRecordLength(ring_->capacity)) + "-byte record limit";
+    }
+
+    void onCommand(const std::string& jsonCommand) override {
+        if (overflowed()) return;
+        const uint64_t capacity = ring_->capacity;
+        if (jsonCommand.size() > maxRecordLength(capacity)) {
+            overflowBytes_ = jsonCommand.size();
+            if (interpreter_) interpreter_->stop();
+            return;
+        }
+        uint32_t length = static_cast<uint32_t>(jsonCommand.size());
+        uint64_t need = recordSize(length);
+
+        uint64_t head = ring_->head.load(std::memory_order_relaxed);
+        uint64_t offset = head % capacity;
+        uint64_t skip = (capacity - offset < need) ? capacity - offset : 0;
+
+        while (!hasRoom(head, skip + need)) {
+            ring_->writerWaiting.store(1);
+            if (hasRoom(head, skip + need)) {
+                ring_->writerWaiting.store(0);
+                break;
+            }
+            uint8_t byte = 0;
+            ssize_t n = ::read(space_, &byte, 1);
+            if (n == 0) _exit(1);   // Parent is gone
+        }
+
+        uint8_t* data = ring_->data();
+        if (skip > 0) {
+            std::memcpy(data + offset, &WRAP_MARKER, sizeof(uint32_t));
+            head += skip;
+            offset = 0;
+        }
+        std::memcpy(data + offset, &length, sizeof(uint32_t));
+        std::memcpy(data + offset + sizeof(uint32_t), jsonCommand.data(), length);
+        ring_->head.store(head + need);
+        if (ring_->readerWaiting.exchange(0)) ringBell(doorbell_);
+    }
+
+private:
+    bool hasRoom(uint64_t head, uint64_t bytes) const {
+        return ring_->capacity - (head - ring_->tail.load()) >= bytes;
+    }
+
+    RingT* ring_;
+    int doorbell_;
+    int space_;
+    ASTInterpreter* interpreter_ = nullptr;
+    size_t overflowBytes_ = 0;
+};
+
+} // anonymous namespace
+
+// =============================================================================
+// POOL LIFECYCLE
+// =============================================================================
+
+WorkerPool::WorkerPool(const WorkerPoolOptions& options) : options_(options) {
+    size_t count = options_.workers ? options_.workers : std::max(1u, std::thread::hardware_concurrency());
+    size_t ringBytes = std::max<size_t>(4096, (options_.ringBytes + 3) & ~size_t(3));
+    options_.ringBytes = ringBytes;
+
+    workers_.resize(count);
+    for (auto& worker : workers_) {
+        void* memory = mmap(nullptr, sizeof(Ring) + ringBytes, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) throw std::bad_alloc();
+        worker.ring = new (memory) Ring();
+        worker.ring->capacity = ringBytes;
+        worker.recent.resize(options_.crashReportCommands);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    for (auto& worker : workers_) {
+        shutdown(worker);
+        worker.ring->~Ring();
+        munmap(worker.ring, sizeof(Ring) + options_.ringBytes);
+    }
+}
+
+void WorkerPool::spawn(Worker& worker, const std::vector<BatchJob>& jobs) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        throw std::runtime_error(std::string("WorkerPool: socketpair failed: ") + std::strerror(errno));
+    }
+    // The parent never blocks on either pipe; the worker blocks reading space
+    int doorbell[2];
+    int space[2];
+    if (pipe2(doorbell, O_NONBLOCK) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error(std::string("WorkerPool: pipe failed: ") + std::strerror(errno));
+    }
+    if (pipe(space) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        close(doorbell[0]);
+        close(doorbell[1]);
+        throw std::runtime_error(std::string("WorkerPool: pipe failed: ") + std::strerror(errno));
+    }
+    fcntl(space[1], F_SETFL, O_NONBLOCK);
+
+    worker.ring->head.store(0, std::memory_order_relaxed);
+    worker.ring->tail.store(0, std::memory_order_relaxed);
+    worker.ring->readerWaiting.store(0, std::memory_order_relaxed);
+    worker.ring->writerWaiting.store(0, std::memory_order_relaxed);
+
+    // Anything still buffered would otherwise be written twice
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        for (int fd : {fds[0], fds[1], doorbell[0], doorbell[1], space[0], space[1]}) close(fd);
+        throw std::runtime_error(std::string("WorkerPool: fork failed: ") + std::strerror(errno));
+    }
+
+    if (pid == 0) {
+        // Drop the other workers' descriptors so their EOF still means "parent closed"
+        for (auto& other : workers_) {
+            for (int fd : {other.channel, other.doorbell, other.space}) {
+                if (fd >= 0) close(fd);
+            }
+        }
+        close(fds[0]);
+        close(doorbell[0]);
+        close(space[1]);
+        worker.channel = fds[1];
+        worker.doorbell = doorbell[1];
+        worker.space = space[0];
+        workerMain(worker, jobs);
+        std::cout.flush();
+        std::fflush(nullptr);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    close(doorbell[1]);
+    close(space[0]);
+    worker.pid = pid;
+    worker.channel = fds[0];
+    worker.doorbell = doorbell[0];
+    worker.space = space[1];
+    worker.busy = false;
+}
+
+void WorkerPool::closeChannels(Worker& worker) {
+    // Worker sees EOF on the channel (or on the space pipe if it is blocked) and exits
+    for (int* fd : {&worker.channel, &worker.doorbell, &worker.space}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+}
+
+void WorkerPool::shutdown(Worker& worker) {
+    closeChannels(worker);
+    if (worker.pid > 0) {
+        if (worker.busy) kill(worker.pid, SIGKILL);
+        int status = 0;
+        while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {}
+        worker.pid = -1;
+    }
+    worker.busy = false;
+}
+
+// =============================================================================
+// WORKER PROCESS
+// =============================================================================
+
+void WorkerPool::workerMain(Worker& worker, const std::vector<BatchJob>& jobs) {
+    uint32_t jobIndex = 0;
+    while (readFully(worker.channel, &jobIndex, sizeof(jobIndex))) {
+        const BatchJob& job = jobs[jobIndex];
+
+        // RLIMIT_CPU counts the whole process, so each job's budget is added
+        // to what the worker has already used. Only the soft limit moves; a
+        // lowered hard limit could not be raised again for the next job.
+        uint32_t cpuSeconds = job.cpuLimitSeconds ? job.cpuLimitSeconds : options_.cpuLimitSeconds;
+        if (cpuSeconds > 0) {
+            rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+            rlimit limit{};
+            getrlimit(RLIMIT_CPU, &limit);
+            rlim_t used = static_cast<rlim_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + 1;
+            limit.rlim_cur = std::min<rlim_t>(used + cpuSeconds, limit.rlim_max);
+            setrlimit(RLIMIT_CPU, &limit);
+        }
+
+        // Likewise RLIMIT_AS: the job's budget on top of what the worker
+        // already maps, re-set per job so one job's limit is not the next's
+        size_t memoryBytes = job.memoryLimitBytes ? job.memoryLimitBytes : options_.memoryLimitBytes;
+        {
+            rlimit limit{};
+            getrlimit(RLIMIT_AS, &limit);
+            limit.rlim_cur = memoryBytes > 0
+                ? std::min<rlim_t>(addressSpaceBytes() + memoryBytes, limit.rlim_max)
+                : limit.rlim_max;
+            setrlimit(RLIMIT_AS, &limit);
+        }
+
+        CompletionMessage message;
+        message.jobIndex = jobIndex;
+        try {
+            RingCommandCallback<Ring> callback(worker.ring, worker.doorbell, worker.space);
+            ASTInterpreter interpreter(job.ast, job.astSize, job.options);
+            callback.setInterpreter(&interpreter);
+            interpreter.setCommandCallback(&callback);
+            if (job.dataProvider) interpreter.setSyncDataProvider(job.dataProvider);
+            bool started = interpreter.start();
+            interpreter.flushCommands();
+            if (callback.overflowed()) {
+                message.status = static_cast<uint8_t>(BatchResult::Status::FAILED);
+                std::strncpy(message.error, callback.overflowError().c_str(), sizeof(message.error) - 1);
+            } else {
+                message.status = static_cast<uint8_t>(started ? BatchResult::Status::COMPLETED
+                                                              : BatchResult::Status::FAILED);
+                if (!started) std::strncpy(message.error, "start() returned false", sizeof(message.error) - 1);
+            }
+        } catch (const std::exception& e) {
+            message.status = static_cast<uint8_t>(BatchResult::Status::FAILED);
+            std::strncpy(message.error, e.what(), sizeof(message.error) - 1);
+        }
+
+        if (!writeFully(worker.channel, &message, sizeof(message))) break;
+    }
+}
+
+// =============================================================================
+// PARENT SIDE
+// =============================================================================
+
+void WorkerPool::drain(Worker& worker, const CommandSink& sink) {
+    Ring* ring = worker.ring;
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = ring->head.load();
+    const uint8_t* data = ring->data();
+
+    while (tail < head) {
+        uint64_t offset = tail % ring->capacity;
+        uint32_t length = 0;
+        std::memcpy(&length, data + offset, sizeof(uint32_t));
+
+        if (length == WRAP_MARKER) {
+            tail += ring->capacity - offset;
+        } else {
+            std::string_view json(reinterpret_cast<const char*>(data + offset + sizeof(uint32_t)), length);
+            if (sink) sink(worker.jobIndex, json);
+            if (!worker.recent.empty()) {
+                worker.recent[worker.recentNext].assign(json.data(), json.size());
+                worker.recentNext = (worker.recentNext + 1) % worker.recent.size();
+            }
+            worker.commandCount++;
+            tail += recordSize(length);
+        }
+        ring->tail.store(tail);
+    }
+    if (ring->writerWaiting.exchange(0)) ringBell(worker.space);
+}
+
+BatchResult WorkerPool::reap(Worker& worker) {
+    BatchResult result;
+    result.commandCount = worker.commandCount;
+
+    int status = 0;
+    while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {}
+    worker.pid = -1;
+    closeChannels(worker);
+    worker.busy = false;
+
+    if (WIFSIGNALED(status)) {
+        result.signal = WTERMSIG(status);
+        result.status = result.signal == SIGXCPU ? BatchResult::Status::CPU_LIMIT
+                                                 : BatchResult::Status::CRASHED;
+        result.error = std::string("worker killed by signal ") + std::to_string(result.signal) +
+                       " (" + strsignal(result.signal) + ")";
+    } else {
+        result.status = BatchResult::Status::CRASHED;
+        result.error = "worker exited with status " + std::to_string(WEXITSTATUS(status));
+    }
+
+    // Oldest first
+    size_t kept = static_cast<size_t>(std::min<uint64_t>(worker.commandCount, worker.recent.size()));
+    for (size_t i = 0; i < kept; i++) {
+        size_t slot = (worker.recentNext + worker.recent.size() - kept + i) % worker.recent.size();
+        result.lastCommands.push_back(std::move(worker.recent[slot]));
+    }
+    return result;
+}
+
+std::vector<BatchResult> WorkerPool::run(const std::vector<BatchJob>& jobs, const CommandSink& sink) {
+    std::vector<BatchResult> results(jobs.size());
+    if (jobs.empty()) return results;
+
+    for (auto& worker : workers_) spawn(worker, jobs);
+
+    size_t nextJob = 0;
+    size_t remaining = jobs.size();
+    std::vector<pollfd> pollFds;
+    std::vector<Worker*> polled;
+
+    while (remaining > 0) {
+        // Hand out work to idle workers
+        for (auto& worker : workers_) {
+            if (worker.busy || nextJob >= jobs.size()) continue;
+            uint32_t index = static_cast<uint32_t>(nextJob);
+            if (!writeFully(worker.channel, &index, sizeof(index))) {
+                // Died between jobs - replace it and retry on the next pass
+                reap(worker);
+                workerRestarts_++;
+                spawn(worker, jobs);
+                continue;
+            }
+            worker.busy = true;
+            worker.jobIndex = nextJob++;
+            worker.commandCount = 0;
+            worker.recentNext = 0;
+        }
+
+        // Two entries per busy worker: completion channel, then doorbell.
+        // Records published before the flag was raised are not rung for,
+        // so any already waiting turn the poll into a non-blocking check.
+        pollFds.clear();
+        polled.clear();
+        bool pending = false;
+        for (auto& worker : workers_) {
+            if (!worker.busy) continue;
+            worker.ring->readerWaiting.store(1);
+            if (worker.ring->head.load() != worker.ring->tail.load(std::memory_order_relaxed)) pending = true;
+            pollFds.push_back({worker.channel, POLLIN, 0});
+            pollFds.push_back({worker.doorbell, POLLIN, 0});
+            polled.push_back(&worker);
+        }
+
+        int ready = poll(pollFds.data(), pollFds.size(), pending ? 0 : -1);
+        if (ready < 0 && errno != EINTR) {
+            throw std::runtime_error(std::string("WorkerPool: poll failed: ") + std::strerror(errno));
+        }
+
+        for (size_t i = 0; i < polled.size(); i++) {
+            Worker& worker = *polled[i];
+            if (ready > 0 && (pollFds[2 * i + 1].revents & POLLIN)) drainBell(worker.doorbell);
+            drain(worker, sink);
+            if (ready <= 0 || !(pollFds[2 * i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            CompletionMessage message;
+            if (readFully(worker.channel, &message, sizeof(message))) {
+                // Every record was published before the message was sent
+                drain(worker, sink);
+                BatchResult& result = results[worker.jobIndex];
+                result.status = static_cast<BatchResult::Status>(message.status);
+                result.commandCount = worker.commandCount;
+                result.error = message.error;
+                worker.busy = false;
+            } else {
+                drain(worker, sink);
+                results[worker.jobIndex] = reap(worker);
+                workerRestarts_++;
+                spawn(worker, jobs);
+            }
+            remaining--;
+        }
+    }
+
+    for (auto& worker : workers_) shutdown(worker);
+    return results;
+}
+
+} // namespace arduino_interpreter
+
+#endif // HAS_WORKER_POOL
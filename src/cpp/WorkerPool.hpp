@@ -0,0 +1,145 @@
+/**
+ * WorkerPool.hpp - Crash-isolated batch execution on forked worker processes
+ *
+ * A batch of sketches is spread over a pool of forked worker processes. Each
+ * worker runs its jobs on ordinary ASTInterpreter instances and writes the
+ * command stream into a shared-memory ring buffer; the parent hands every
+ * command to the caller as a string_view that points straight into the ring.
+ *
+ * A worker that crashes (segfault, abort) or exceeds its CPU/memory limit is
+ * reaped and replaced; the job it was running is reported with its signal and
+ * the last commands it emitted. Other jobs are unaffected.
+ *
+ * A single command may take at most half the ring (ringBytes / 2 - 8 bytes).
+ * A larger one stops its job, which is reported FAILED; the stream ends with
+ * the last command that fit, so every record the sink sees is whole.
+ *
+ * Neither side spins: a full ring blocks the worker on a pipe until the parent
+ * has drained it, and the parent sleeps in poll() until a worker publishes or
+ * finishes a job.
+ *
+ * Host only (POSIX fork/mmap/setrlimit) - compiled out for WASM and ESP32.
+ *
+ * Version: 1.0
+ */
+
+#pragma once
+
+#include "ASTInterpreter.hpp"
+#include "PlatformAbstraction.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(PLATFORM_LINUX) && !defined(_WIN32)
+#define HAS_WORKER_POOL 1
+#else
+#define HAS_WORKER_POOL 0
+#endif
+
+#if HAS_WORKER_POOL
+
+#include <sys/types.h>
+
+namespace arduino_interpreter {
+
+/**
+ * One sketch execution. Workers are forked from the caller, so everything a
+ * job points to (AST bytes, data provider) is read from the worker's
+ * copy-on-write image and must stay valid until run() returns.
+ */
+struct BatchJob {
+    const uint8_t* ast = nullptr;
+    size_t astSize = 0;
+    InterpreterOptions options;
+    SyncDataProvider* dataProvider = nullptr;   // Optional; mutations stay in the worker
+    uint32_t cpuLimitSeconds = 0;               // 0 = WorkerPoolOptions::cpuLimitSeconds
+    size_t memoryLimitBytes = 0;                // 0 = WorkerPoolOptions::memoryLimitBytes
+};
+
+struct BatchResult {
+    enum class Status : uint8_t {
+        COMPLETED,   // start() returned true
+        FAILED,      // start() returned false, threw or overflowed the ring; see error
+        CRASHED,     // worker died from a signal; see signal / lastCommands
+        CPU_LIMIT    // worker exceeded its CPU budget (SIGXCPU)
+    };
+
+    Status status = Status::FAILED;
+    int signal = 0;
+    uint64_t commandCount = 0;
+    std::vector<std::string> lastCommands;   // Crash report: tail of the stream (CRASHED/CPU_LIMIT only)
+    std::string error;
+};
+
+struct WorkerPoolOptions {
+    size_t workers = 0;                          // 0 = std::thread::hardware_concurrency()
+    size_t ringBytes = 1024 * 1024;              // Shared-memory ring per worker
+    uint32_t cpuLimitSeconds = 10;               // Per job; 0 = unlimited
+    size_t memoryLimitBytes = 1024u * 1024 * 1024;  // Per job, on top of the idle worker (RLIMIT_AS); 0 = unlimited
+    size_t crashReportCommands = 16;             // Commands kept for a crash report
+};
+
+/**
+ * Forked worker pool. Not thread-safe: call run() from one thread at a time,
+ * preferably before the caller starts threads of its own (fork copies only
+ * the calling thread).
+ */
+class WorkerPool {
+public:
+    /**
+     * Receives each command as it is read from a worker's ring. The view is
+     * only valid for the duration of the call.
+     */
+    using CommandSink = std::function<void(size_t jobIndex, std::string_view json)>;
+
+    explicit WorkerPool(const WorkerPoolOptions& options = WorkerPoolOptions{});
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Run every job and return one result per job, in job order.
+     * Workers are forked on entry and shut down before returning.
+     */
+    std::vector<BatchResult> run(const std::vector<BatchJob>& jobs, const CommandSink& sink = nullptr);
+
+    /** Workers replaced after a crash or limit kill, over the pool's lifetime */
+    uint64_t getWorkerRestarts() const { return workerRestarts_; }
+
+    size_t getWorkerCount() const { return workers_.size(); }
+
+private:
+    struct Ring;
+
+    struct Worker {
+        Ring* ring = nullptr;
+        pid_t pid = -1;
+        int channel = -1;    // socketpair: job indices out, completion messages back
+        int doorbell = -1;   // pipe: worker -> parent, "published while you were waiting"
+        int space = -1;      // pipe: parent -> worker, "drained while you were waiting"
+        bool busy = false;
+        size_t jobIndex = 0;
+        uint64_t commandCount = 0;
+        std::vector<std::string> recent;   // Circular crash-report buffer
+        size_t recentNext = 0;
+    };
+
+    void spawn(Worker& worker, const std::vector<BatchJob>& jobs);
+    void shutdown(Worker& worker);
+    void closeChannels(Worker& worker);
+    void drain(Worker& worker, const CommandSink& sink);
+    BatchResult reap(Worker& worker);
+    void workerMain(Worker& worker, const std::vector<BatchJob>& jobs);
+
+    WorkerPoolOptions options_;
+    std::vector<Worker> workers_;
+    uint64_t workerRestarts_ = 0;
+};
+
+} // namespace arduino_interpreter
+
+#endif // HAS_WORKER_POOL
@@ -0,0 +1,113 @@
+/**
+ * DriftDetector.hpp - Trend fitting for long soak runs
+ *
+ * A DriftSeries holds at most MAX_POINTS (iteration, value) samples. When it
+ * is full it drops every other point and doubles its stride, so a run of any
+ * length is summarised by evenly spaced samples in bounded memory.
+ *
+ * fit() is an ordinary least-squares line over the samples after the warm-up
+ * fraction. A series drifts when the line explains the data (r² >= MIN_R2)
+ * and either its slope exceeds maxSlope (units per iteration) or its growth
+ * across the fitted span exceeds maxRelative of its starting value. Noise
+ * has a low r², and a one-off step such as a hash table rehash adds almost
+ * nothing to the slope of a long run.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace arduino_interpreter {
+
+struct DriftFit {
+    double slope = 0.0;          // Units per iteration
+    double intercept = 0.0;
+    double r2 = 0.0;             // 0 for a flat series
+    double first = 0.0;          // Fitted value at the first/last fitted sample
+    double last = 0.0;
+    size_t points = 0;
+};
+
+class DriftSeries {
+public:
+    static constexpr size_t MAX_POINTS = 4096;
+    static constexpr double MIN_R2 = 0.5;
+
+    /**
+     * @param maxSlope    Allowed growth per iteration (0 = not checked)
+     * @param maxRelative Allowed growth over the fitted span as a fraction of
+     *                    the starting value (0 = not checked)
+     */
+    DriftSeries(std::string name, double maxSlope, double maxRelative = 0.0)
+        : name_(std::move(name)), maxSlope_(maxSlope), maxRelative_(maxRelative) {
+        points_.reserve(MAX_POINTS);   // Sampling must not show up in the heap it samples
+    }
+
+    const std::string& name() const { return name_; }
+
+    void add(uint64_t iteration, double value) {
+        if (offered_++ % stride_ != 0) return;
+        points_.emplace_back(static_cast<double>(iteration), value);
+        if (points_.size() < MAX_POINTS) return;
+        for (size_t i = 0; i < points_.size() / 2; ++i) points_[i] = points_[i * 2];
+        points_.resize(points_.size() / 2);
+        stride_ *= 2;
+    }
+
+    DriftFit fit(double warmupFraction) const {
+        DriftFit result;
+        size_t begin = static_cast<size_t>(points_.size() * warmupFraction);
+        size_t n = points_.size() - begin;
+        result.points = n;
+        if (n < 2) {
+            if (n == 1) result.first = result.last = result.intercept = points_.back().second;
+            return result;
+        }
+
+        double meanX = 0.0, meanY = 0.0;
+        for (size_t i = begin; i < points_.size(); ++i) {
+            meanX += points_[i].first;
+            meanY += points_[i].second;
+        }
+        meanX /= n;
+        meanY /= n;
+
+        double sxx = 0.0, sxy = 0.0, syy = 0.0;
+        for (size_t i = begin; i < points_.size(); ++i) {
+            double dx = points_[i].first - meanX;
+            double dy = points_[i].second - meanY;
+            sxx += dx * dx;
+            sxy += dx * dy;
+            syy += dy * dy;
+        }
+        if (sxx == 0.0) return result;
+
+        result.slope = sxy / sxx;
+        result.intercept = meanY - result.slope * meanX;
+        result.r2 = syy == 0.0 ? 0.0 : (sxy * sxy) / (sxx * syy);
+        result.first = result.intercept + result.slope * points_[begin].first;
+        result.last = result.intercept + result.slope * points_.back().first;
+        return result;
+    }
+
+    bool drifting(const DriftFit& fit) const {
+        if (fit.points < 2 || fit.slope <= 0.0 || fit.r2 < MIN_R2) return false;
+        if (maxSlope_ > 0.0 && fit.slope > maxSlope_) return true;
+        if (maxRelative_ > 0.0 && fit.first > 0.0 && (fit.last - fit.first) / fit.first > maxRelative_) return true;
+        return false;
+    }
+
+private:
+    std::string name_;
+    double maxSlope_;
+    double maxRelative_;
+    std::vector<std::pair<double, double>> points_;
+    uint64_t offered_ = 0;
+    uint64_t stride_ = 1;
+};
+
+} // namespace arduino_interpreter
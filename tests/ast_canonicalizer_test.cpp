@@ -0,0 +1,83 @@
+/**
+ * ast_canonicalizer_test.cpp
+ *
+ * Verifies canonicalizeAST(): each parser quirk is rewritten once at load,
+ * a second pass changes nothing, and the interpreter produces the same
+ * commands from the canonical tree as it did from the raw shapes.
+ *
+ * Usage: ./ast_canonicalizer_test
+ *
+ * TEST SKETCH: "ast_canonicalizer" in tests/unit_sketches.js, 1 loop iteration
+ *
+ * EXPECTED RESULTS:
+ * - One rewrite of each kind; none the second time (flags are re-derived)
+ * - a and b are struct variables, incrementCounter() runs the static-function
+ *   workaround, Serial.print('A') shows '65' - also as an initializer ('66');
+ *   the range-for body's print is rewritten too - and ledPin gets a plain VAR_SET
+ */
+
+#include "ASTInterpreter.hpp"
+#include "ASTCanonicalizer.hpp"
+#include "CompactAST.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> CANON_AST = loadFixture("ast_canonicalizer");
+
+static bool emitted(const std::vector<std::string>& commands, const std::string& fragment) {
+    for (const auto& cmd : commands) {
+        if (cmd.find(fragment) != std::string::npos) return true;
+    }
+    return false;
+}
+
+int main() {
+    int failures = 0;
+
+    arduino_ast::CompactASTReader reader(CANON_AST.data(), CANON_AST.size());
+    auto ast = reader.parse();
+    auto first = arduino_ast::canonicalizeAST(ast.get());
+    failures += check(first.structDeclarations == 1 && first.printCharArguments == 3 &&
+                      first.staticFunctionCalls == 1,
+                      "every quirk rewritten (statement, initializer and range-for prints)");
+    auto second = arduino_ast::canonicalizeAST(ast.get());
+    failures += check(second.structDeclarations == 0 && second.printCharArguments == 0 &&
+                      second.staticFunctionCalls == 1,
+                      "second pass is a no-op");
+
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+    opts.maxLoopIterations = 1;
+
+    CollectingCallback callback;
+    ASTInterpreter interpreter(CANON_AST.data(), CANON_AST.size(), opts);
+    interpreter.setCommandCallback(&callback);
+    interpreter.start();
+    const auto& commands = callback.commands;
+
+    failures += check(!emitted(commands, "\"type\":\"ERROR\""), "no errors");
+    failures += check(emitted(commands, "\"variable\":\"a\",\"value\":{\"structName\":\"Point\"") &&
+                      emitted(commands, "\"variable\":\"b\",\"value\":{\"structName\":\"Point\""),
+                      "struct declaration creates both variables");
+    failures += check(emitted(commands, "\"function\":\"incrementCounter\",\"arguments\":[]") &&
+                      emitted(commands, "\"variable\":\"global_counter\",\"value\":1"),
+                      "static function workaround");
+    failures += check(emitted(commands, "\"function\":\"Serial.print\",\"arguments\":['65']"),
+                      "Serial.print char literal");
+    failures += check(emitted(commands, "\"function\":\"Serial.print\",\"arguments\":['66']"),
+                      "nested Serial.print char literal");
+    failures += check(emitted(commands, "\"variable\":\"ledPin\",\"value\":13") &&
+                      !emitted(commands, "\"isConst\""),
+                      "no constness from a variable name");
+    failures += check(emitted(commands, "\"function\":\"Serial.println\",\"arguments\":[\"4\"]"),
+                      "struct fields usable");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+/**
+ * async_emission_test.cpp
+ *
+ * Verifies that InterpreterOptions::asyncEmission produces the same command
+ * stream as the synchronous emitter.
+ *
+ * Usage: ./async_emission_test [test_data_dir] [queue_capacity]
+ *
+ * TEST CASE: every test_data/testN_js.ast
+ * - Run once with synchronous emission, once through the worker thread
+ * - A small queue capacity forces the backpressure path
+ *
+ * EXPECTED RESULTS:
+ * - Identical command count and content, in the same order
+ *   (generated pointer/object ids are masked since they differ per run)
+ */
+
+#include "ASTInterpreter.hpp"
+#include "DeterministicDataProvider.hpp"
+#include "unit_test_helpers.hpp"
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static std::string maskGeneratedIds(const std::string& json) {
+    static const std::regex pointerIds("(f?ptr)_[0-9]+_[0-9a-z]+");
+    static const std::regex longNumbers("[0-9]{9,}");
+    return std::regex_replace(std::regex_replace(json, pointerIds, "$1"), longNumbers, "N");
+}
+
+static std::vector<std::string> runTest(const std::vector<uint8_t>& ast, bool async, size_t capacity) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = Config::TEST_MAX_LOOP_ITERATIONS;
+    opts.syncMode = true;
+    opts.asyncEmission = async;
+    opts.emissionQueueCapacity = capacity;
+
+    CollectingCallback callback;
+    DeterministicDataProvider dataProvider;
+    {
+        ASTInterpreter interpreter(ast.data(), ast.size(), opts);
+        interpreter.setCommandCallback(&callback);
+        interpreter.setSyncDataProvider(&dataProvider);
+        interpreter.start();
+    }
+
+    std::vector<std::string> masked;
+    masked.reserve(callback.commands.size());
+    for (const auto& cmd : callback.commands) masked.push_back(maskGeneratedIds(cmd));
+    return masked;
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDir = argc > 1 ? argv[1] : "test_data";
+    size_t capacity = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 8;
+
+    int tested = 0;
+    int failures = 0;
+    for (int n = 0; ; n++) {
+        auto ast = loadASTFile(dataDir + "/test" + std::to_string(n) + "_js.ast");
+        if (ast.empty()) break;
+        tested++;
+
+        auto expected = runTest(ast, false, capacity);
+        auto actual = runTest(ast, true, capacity);
+        if (expected == actual) continue;
+
+        failures++;
+        std::cout << "  FAIL  test" << n << ": " << expected.size() << " sync vs "
+                  << actual.size() << " async commands\n";
+        for (size_t i = 0; i < expected.size() && i < actual.size(); i++) {
+            if (expected[i] != actual[i]) {
+                std::cout << "    sync:  " << expected[i] << "\n"
+                          << "    async: " << actual[i] << "\n";
+                break;
+            }
+        }
+    }
+
+    if (tested == 0) {
+        std::cerr << "ERROR: No test ASTs found in " << dataDir << "\n";
+        return 1;
+    }
+
+    std::cout << tested - failures << "/" << tested << " command streams identical (queue capacity "
+              << capacity << ")\n";
+    return failures == 0 ? 0 : 1;
+}
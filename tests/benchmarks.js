@@ -0,0 +1,333 @@
+// Benchmark Sketch Suite Version: 1
+//
+// Performance corpus, kept apart from the parity corpus (examples.js,
+// old_test.js, neopixel.js): every sketch does enough work to expose how the
+// interpreter scales. Exported to benchmark_data/ by generate_benchmark_data.js
+// and run by sketch_benchmark. `loopIterations` is the loop() count each
+// sketch is run with.
+
+// -----------------------------------------------------------------------------
+// Synthetic programs
+// -----------------------------------------------------------------------------
+
+// `count` small functions, each called once from setup()
+function manyFunctions(count) {
+    const lines = ['// Synthetic: ' + count + ' functions', '', 'long total = 0;', ''];
+    for (let i = 0; i < count; i++) {
+        lines.push('int f' + i + '(int x) {');
+        lines.push('  int y = x * ' + ((i % 7) + 2) + ' + ' + i + ';');
+        lines.push('  if (y % 3 == 0) {');
+        lines.push('    y = y / 3;');
+        lines.push('  }');
+        lines.push('  return y - x;');
+        lines.push('}');
+        lines.push('');
+    }
+    lines.push('void setup() {');
+    lines.push('  Serial.begin(9600);');
+    for (let i = 0; i < count; i++) {
+        lines.push('  total += f' + i + '(' + (i % 50) + ');');
+    }
+    lines.push('  Serial.println(total);');
+    lines.push('}');
+    lines.push('');
+    lines.push('void loop() {');
+    lines.push('}');
+    return lines.join('\n') + '\n';
+}
+
+// One straight-line setup() of `statements` expression statements (~10 nodes each)
+function largeProgram(statements) {
+    const lines = ['// Synthetic: ' + statements + ' statement program', '',
+                   'int a = 1;', 'int b = 2;', 'int c = 3;', 'int d = 4;', '',
+                   'void setup() {', '  Serial.begin(9600);'];
+    const vars = ['a', 'b', 'c', 'd'];
+    for (let i = 0; i < statements; i++) {
+        const target = vars[i % 4];
+        const x = vars[(i + 1) % 4];
+        const y = vars[(i + 2) % 4];
+        lines.push('  ' + target + ' = (' + x + ' * ' + ((i % 5) + 1) + ' + ' + y + ' - ' + (i % 11) + ') % 1000;');
+        if (i % 250 === 249) lines.push('  Serial.println(' + target + ');');
+    }
+    lines.push('  Serial.println(a + b + c + d);');
+    lines.push('}');
+    lines.push('');
+    lines.push('void loop() {');
+    lines.push('}');
+    return lines.join('\n') + '\n';
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks
+// -----------------------------------------------------------------------------
+
+const benchmarkFiles = [
+  { "name": "ArithmeticLoops.ino", "loopIterations": 1, "content": `// Integer and float arithmetic in nested loops
+
+long checksum = 0;
+float accumulator = 0.0;
+
+void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  for (int i = 0; i < 100; i++) {
+    for (int j = 0; j < 40; j++) {
+      checksum = (checksum * 31 + i * j + 7) % 100003;
+      accumulator = accumulator + (i - j) * 0.5;
+    }
+  }
+  Serial.println(checksum);
+  Serial.println(accumulator);
+}
+` },
+  { "name": "CallHeavy.ino", "loopIterations": 1, "content": `// Many small calls: recursive fibonacci and helper chains
+
+int fib(int n) {
+  if (n < 2) {
+    return n;
+  }
+  return fib(n - 1) + fib(n - 2);
+}
+
+int square(int x) {
+  return x * x;
+}
+
+int addSquares(int x, int y) {
+  return square(x) + square(y);
+}
+
+void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  Serial.println(fib(15));
+  long total = 0;
+  for (int i = 0; i < 300; i++) {
+    total = total + addSquares(i % 17, i % 13);
+  }
+  Serial.println(total);
+}
+` },
+  { "name": "DeepRecursion.ino", "loopIterations": 1, "content": `// Deep recursion: every frame stays live until the bottom is reached
+// (90 levels - the interpreter stops at a call depth of 100)
+
+long sumTo(int n) {
+  if (n == 0) {
+    return 0;
+  }
+  return n + sumTo(n - 1);
+}
+
+int depth(int n, int acc) {
+  if (n == 0) {
+    return acc;
+  }
+  return depth(n - 1, acc + n % 3);
+}
+
+void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  Serial.println(sumTo(90));
+  Serial.println(depth(90, 0));
+}
+` },
+  { "name": "ArrayUpdates.ino", "loopIterations": 2, "content": `// Element writes into a large array (each one reports the array)
+
+const int SIZE = 200;
+int samples[SIZE];
+int histogram[16];
+
+void setup() {
+  Serial.begin(9600);
+  for (int i = 0; i < SIZE; i++) {
+    samples[i] = (i * 37 + 11) % 1024;
+  }
+}
+
+void loop() {
+  for (int i = 0; i < SIZE; i++) {
+    histogram[samples[i] / 64]++;
+  }
+  for (int i = 1; i < SIZE; i++) {
+    samples[i] = (samples[i] + samples[i - 1]) % 1024;
+  }
+  Serial.println(histogram[3]);
+  Serial.println(samples[SIZE - 1]);
+}
+` },
+  { "name": "StringBuilding.ino", "loopIterations": 1, "content": `// String concatenation growing one string
+
+String message = "";
+String line = "";
+
+void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  for (int i = 0; i < 150; i++) {
+    message += String(i % 10);
+    if (i % 25 == 0) {
+      line = line + "row" + String(i) + ";";
+    }
+  }
+  Serial.println(message.length());
+  Serial.println(line);
+}
+` },
+  { "name": "StructUpdates.ino", "loopIterations": 1, "content": `// Struct field reads and writes in a simulation step
+
+struct Particle {
+  int x;
+  int y;
+  int vx;
+  int vy;
+};
+
+struct Particle p1;
+struct Particle p2;
+
+void step(int bounds) {
+  p1.x = p1.x + p1.vx;
+  p1.y = p1.y + p1.vy;
+  if (p1.x < 0 || p1.x > bounds) {
+    p1.vx = -p1.vx;
+  }
+  if (p1.y < 0 || p1.y > bounds) {
+    p1.vy = -p1.vy;
+  }
+  p2.x = p2.x + p2.vx;
+  p2.y = p2.y + p2.vy;
+  if (p2.x < 0 || p2.x > bounds) {
+    p2.vx = -p2.vx;
+  }
+  if (p2.y < 0 || p2.y > bounds) {
+    p2.vy = -p2.vy;
+  }
+}
+
+void setup() {
+  Serial.begin(9600);
+  p1.x = 10;
+  p1.y = 20;
+  p1.vx = 3;
+  p1.vy = -2;
+  p2.x = 50;
+  p2.y = 5;
+  p2.vx = -1;
+  p2.vy = 4;
+}
+
+void loop() {
+  for (int i = 0; i < 150; i++) {
+    step(100);
+  }
+  Serial.println(p1.x + p1.y);
+  Serial.println(p2.x + p2.y);
+}
+` },
+  { "name": "SwitchStateMachine.ino", "loopIterations": 1, "content": `// Protocol parser style state machine driven by a switch
+
+const int IDLE = 0;
+const int HEADER = 1;
+const int LENGTH = 2;
+const int PAYLOAD = 3;
+const int CHECKSUM = 4;
+
+int state = IDLE;
+int remaining = 0;
+int sum = 0;
+int frames = 0;
+
+void feed(int value) {
+  switch (state) {
+    case IDLE:
+      if (value == 170) {
+        state = HEADER;
+      }
+      break;
+    case HEADER:
+      state = LENGTH;
+      break;
+    case LENGTH:
+      remaining = value % 8 + 1;
+      sum = 0;
+      state = PAYLOAD;
+      break;
+    case PAYLOAD:
+      sum = (sum + value) % 256;
+      remaining--;
+      if (remaining == 0) {
+        state = CHECKSUM;
+      }
+      break;
+    case CHECKSUM:
+      if (sum == value % 256) {
+        frames++;
+      }
+      state = IDLE;
+      break;
+    default:
+      state = IDLE;
+      break;
+  }
+}
+
+void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  for (int i = 0; i < 1200; i++) {
+    int value = (i * 73 + 29) % 256;
+    if (i % 12 == 0) {
+      value = 170;
+    }
+    feed(value);
+  }
+  Serial.println(frames);
+  Serial.println(state);
+}
+` },
+  { "name": "NeoPixelAnimation.ino", "loopIterations": 2, "content": `// Library-heavy LED code: per-pixel colors on a NeoPixel strip
+
+#include <Adafruit_NeoPixel.h>
+
+#define LED_PIN 6
+#define LED_COUNT 60
+
+Adafruit_NeoPixel strip = Adafruit_NeoPixel(LED_COUNT, LED_PIN, NEO_GRB + NEO_KHZ800);
+
+int offset = 0;
+
+void setup() {
+  strip.begin();
+  strip.setBrightness(50);
+  strip.show();
+}
+
+void loop() {
+  for (int i = 0; i < LED_COUNT; i++) {
+    int phase = (i * 4 + offset) % 256;
+    strip.setPixelColor(i, strip.Color(phase, 255 - phase, (phase * 2) % 256));
+  }
+  strip.show();
+  offset = (offset + 8) % 256;
+}
+` },
+  { "name": "Synthetic500Functions.ino", "loopIterations": 1, "content": manyFunctions(500) },
+  { "name": "Synthetic10kNodes.ino", "loopIterations": 1, "content": largeProgram(1200) }
+];
+
+if (typeof module !== 'undefined' && module.exports) {
+    module.exports = {
+        benchmarkFiles
+    };
+}
@@ -0,0 +1,282 @@
+/**
+ * broadcast_hub_test.cpp
+ *
+ * Verifies CommandBroadcastHub: commands are stored once and shared by all
+ * subscribers, each backpressure policy behaves as documented, and many
+ * slow or stalled clients never hold up the interpreter or each other.
+ *
+ * Usage: ./broadcast_hub_test [test_data_dir]
+ *
+ * TEST CASES:
+ * - Shared bytes: two subscribers see the same memory for one command
+ * - DROP_OLDEST: capacity 4, 10 commands unread -> the last 4, 6 dropped
+ * - COALESCE: superseded VAR_SET / DIGITAL_WRITE commands are skipped,
+ *   retired keyed commands are still delivered when nothing replaced them,
+ *   and polling one command at a time skips the same ones
+ * - BLOCK: a slow reader receives every command in order; the publisher
+ *   waited for it
+ * - every test_data/testN_js.ast through a 64-entry hub with a BLOCK reader
+ *   thread, a COALESCE reader thread and 32 DROP_OLDEST clients that never read
+ *
+ * EXPECTED RESULTS:
+ * - The BLOCK reader's stream equals a direct CommandCallback run
+ * - Idle clients only accumulate drops
+ */
+
+#include "CommandBroadcastHub.hpp"
+#include "DeterministicDataProvider.hpp"
+#include "unit_test_helpers.hpp"
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static std::string maskGeneratedIds(const std::string& json) {
+    static const std::regex pointerIds("(f?ptr)_[0-9]+_[0-9a-z]+");
+    static const std::regex longNumbers("[0-9]{9,}");
+    return std::regex_replace(std::regex_replace(json, pointerIds, "$1"), longNumbers, "N");
+}
+
+static InterpreterOptions testOptions() {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = Config::TEST_MAX_LOOP_ITERATIONS;
+    opts.syncMode = true;
+    return opts;
+}
+
+static std::string varSet(const std::string& name, int value) {
+    return "{\"type\":\"VAR_SET\",\"timestamp\":0,\"variable\":\"" + name + "\",\"value\":" + std::to_string(value) + "}";
+}
+
+static std::string digitalWrite(int pin, int value) {
+    return "{\"type\":\"DIGITAL_WRITE\",\"timestamp\":0,\"pin\":" + std::to_string(pin) +
+           ",\"value\":" + std::to_string(value) + "}";
+}
+
+static std::string print(const std::string& text) {
+    return "{\"type\":\"FUNCTION_CALL\",\"timestamp\":0,\"function\":\"Serial.print\",\"arguments\":[\"" + text + "\"]}";
+}
+
+static std::vector<std::string> texts(const std::vector<BroadcastMessage>& messages) {
+    std::vector<std::string> out;
+    for (const auto& message : messages) out.emplace_back(message.text);
+    return out;
+}
+
+static int testSharedBytes() {
+    CommandBroadcastHub hub(8);
+    auto a = hub.subscribe(BackpressurePolicy::DROP_OLDEST);
+    auto b = hub.subscribe(BackpressurePolicy::BLOCK);
+    hub.publish(print("shared"));
+
+    std::vector<BroadcastMessage> first, second;
+    hub.poll(a, first);
+    hub.poll(b, second);
+    return check(first.size() == 1 && second.size() == 1 && first[0].text.data() == second[0].text.data() &&
+                 first[0].text == print("shared"),
+                 "one copy of a command shared by all subscribers");
+}
+
+static int testDropOldest() {
+    CommandBroadcastHub hub(4);
+    auto sub = hub.subscribe(BackpressurePolicy::DROP_OLDEST);
+    for (int i = 0; i < 10; i++) hub.publish(varSet("v" + std::to_string(i), i));
+
+    std::vector<BroadcastMessage> messages;
+    hub.poll(sub, messages);
+    auto stats = hub.getStats(sub);
+    return check(messages.size() == 4 && messages.front().seq == 6 && messages.back().seq == 9 &&
+                 stats.dropped == 6 && stats.delivered == 4 && stats.lag == 0,
+                 "DROP_OLDEST keeps the newest commands");
+}
+
+static int testCoalesce() {
+    int failures = 0;
+    {
+        CommandBroadcastHub hub(4);
+        auto sub = hub.subscribe(BackpressurePolicy::COALESCE);
+        hub.publish(varSet("x", 1));
+        hub.publish(digitalWrite(13, 1));
+        hub.publish(varSet("x", 2));
+        hub.publish(print("a"));
+        hub.publish(varSet("x", 3));
+        hub.publish(digitalWrite(13, 0));
+        hub.publish(varSet("y", 1));
+
+        std::vector<BroadcastMessage> messages;
+        hub.poll(sub, messages);
+        auto stats = hub.getStats(sub);
+        std::vector<std::string> expected{print("a"), varSet("x", 3), digitalWrite(13, 0), varSet("y", 1)};
+        failures += check(texts(messages) == expected && stats.coalesced == 3 && stats.dropped == 0,
+                          "COALESCE delivers the newest command per key");
+    }
+    {
+        CommandBroadcastHub hub(2);
+        auto sub = hub.subscribe(BackpressurePolicy::COALESCE);
+        hub.publish(varSet("x", 1));
+        hub.publish(varSet("y", 1));
+        hub.publish(print("a"));
+        hub.publish(print("b"));
+        hub.publish(print("c"));
+
+        std::vector<BroadcastMessage> messages;
+        hub.poll(sub, messages);
+        auto stats = hub.getStats(sub);
+        std::vector<std::string> expected{varSet("x", 1), varSet("y", 1), print("b"), print("c")};
+        failures += check(texts(messages) == expected && stats.dropped == 1,
+                          "COALESCE keeps retired state, drops retired unkeyed commands");
+    }
+    {
+        CommandBroadcastHub hub(8);
+        auto sub = hub.subscribe(BackpressurePolicy::COALESCE);
+        hub.publish(varSet("x", 1));
+        hub.publish(digitalWrite(13, 1));
+        hub.publish(varSet("x", 2));
+        hub.publish(print("a"));
+
+        std::vector<BroadcastMessage> messages;
+        hub.poll(sub, messages, 1);
+        hub.publish(digitalWrite(13, 0));   // Supersedes a command already behind the cursor
+        while (hub.poll(sub, messages, 1) > 0) {}
+        auto stats = hub.getStats(sub);
+        std::vector<std::string> expected{digitalWrite(13, 1), varSet("x", 2), print("a"), digitalWrite(13, 0)};
+        failures += check(texts(messages) == expected && stats.coalesced == 1 && stats.lag == 0,
+                          "COALESCE one command per poll");
+    }
+    return failures;
+}
+
+static int testBlock() {
+    const int count = 200;
+    CommandBroadcastHub hub(4);
+    auto sub = hub.subscribe(BackpressurePolicy::BLOCK);
+
+    std::atomic<bool> done{false};
+    std::thread publisher([&] {
+        for (int i = 0; i < count; i++) hub.publish(varSet("v", i));
+        done = true;
+        hub.close();
+    });
+
+    std::vector<std::string> received;
+    std::vector<BroadcastMessage> batch;
+    while (true) {
+        batch.clear();
+        size_t got = hub.wait(sub, batch, std::chrono::milliseconds(100), 3);
+        for (const auto& message : batch) received.emplace_back(message.text);
+        if (got == 0 && done) break;
+        std::this_thread::sleep_for(std::chrono::microseconds(50));   // Slow consumer
+    }
+    publisher.join();
+
+    bool inOrder = received.size() == count;
+    for (int i = 0; inOrder && i < count; i++) inOrder = received[i] == varSet("v", i);
+    return check(inOrder && hub.getStats(sub).dropped == 0 && hub.getPublisherWaits() > 0,
+                 "BLOCK is lossless and holds the publisher");
+}
+
+static int testInterpreterFanOut(const std::string& dataDir) {
+    const size_t idleClients = 32;
+    int failures = 0;
+    size_t sketches = 0;
+
+    for (int n = 0; ; n++) {
+        auto ast = loadASTFile(dataDir + "/test" + std::to_string(n) + "_js.ast");
+        if (ast.empty()) break;
+        sketches++;
+
+        CollectingCallback direct;
+        {
+            DeterministicDataProvider provider;
+            ASTInterpreter interpreter(ast.data(), ast.size(), testOptions());
+            interpreter.setCommandCallback(&direct);
+            interpreter.setSyncDataProvider(&provider);
+            interpreter.start();
+        }
+
+        CommandBroadcastHub hub(64, 4096);
+        auto recorder = hub.subscribe(BackpressurePolicy::BLOCK);
+        auto monitor = hub.subscribe(BackpressurePolicy::COALESCE);
+        std::vector<CommandBroadcastHub::SubscriberId> idle;
+        for (size_t i = 0; i < idleClients; i++) idle.push_back(hub.subscribe(BackpressurePolicy::DROP_OLDEST));
+
+        // Readers stop once the run is over and nothing is left unread
+        std::atomic<bool> done{false};
+        std::vector<std::string> recorded;
+        std::thread recorderThread([&] {
+            std::vector<BroadcastMessage> batch;
+            while (true) {
+                batch.clear();
+                size_t got = hub.wait(recorder, batch, std::chrono::milliseconds(50));
+                for (const auto& message : batch) recorded.emplace_back(message.text);
+                if (got == 0 && done) break;
+            }
+        });
+        uint64_t monitored = 0;
+        std::thread monitorThread([&] {
+            std::vector<BroadcastMessage> batch;
+            while (true) {
+                batch.clear();
+                size_t got = hub.wait(monitor, batch, std::chrono::milliseconds(50), 16);
+                monitored += got;
+                if (got == 0 && done) break;
+            }
+        });
+
+        {
+            DeterministicDataProvider provider;
+            ASTInterpreter interpreter(ast.data(), ast.size(), testOptions());
+            interpreter.setCommandCallback(&hub);
+            interpreter.setSyncDataProvider(&provider);
+            interpreter.start();
+        }
+        done = true;
+        hub.close();
+        recorderThread.join();
+        monitorThread.join();
+
+        bool same = recorded.size() == direct.commands.size();
+        for (size_t i = 0; same && i < recorded.size(); i++) {
+            same = maskGeneratedIds(recorded[i]) == maskGeneratedIds(direct.commands[i]);
+        }
+        uint64_t published = hub.getPublished();
+        bool idleOk = true;
+        for (auto id : idle) {
+            auto stats = hub.getStats(id);
+            idleOk = idleOk && stats.delivered == 0 && stats.dropped + stats.lag == published;
+        }
+        if (!same || !idleOk || monitored == 0) {
+            failures++;
+            std::cout << "  FAIL  test" << n << ": " << recorded.size() << " recorded vs " << direct.commands.size()
+                      << " direct, idle clients " << (idleOk ? "ok" : "wrong") << ", monitor " << monitored << "\n";
+        }
+    }
+
+    if (sketches == 0) {
+        std::cerr << "ERROR: No test ASTs found in " << dataDir << "\n";
+        return 1;
+    }
+    std::cout << sketches - failures << "/" << sketches << " sketches fanned out to " << idleClients + 2
+              << " subscribers with identical recorded streams\n";
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDir = argc > 1 ? argv[1] : "test_data";
+
+    int failures = 0;
+    failures += testSharedBytes();
+    failures += testDropOldest();
+    failures += testCoalesce();
+    failures += testBlock();
+    failures += testInterpreterFanOut(dataDir);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/**
+ * buffer_builtins_test.cpp
+ *
+ * Regression test for the native libc buffer builtins (string.h, stdlib.h,
+ * stdio.h) that operate directly on interpreted arrays.
+ *
+ * TEST SKETCH: "buffer_builtins" in tests/unit_sketches.js
+ *
+ * EXPECTED RESULTS:
+ * - Each builtin writes its destination in place with a single VAR_SET
+ * - sprintf/snprintf/dtostrf format through the printf engine; a %s argument
+ *   is read from its offset (out + 3)
+ * - qsort calls the user comparator through pointer arguments; under FLOAT32
+ *   its scratch cells take the element type, so float elements sort unrounded
+ * - memset past the end of buf reports a BoundsError instead of writing;
+ *   so does strcpy past the terminator of a char* literal
+ * - A negative memset count is an error, not a no-op
+ * - strcpy/strcat return a char* to their destination
+ */
+
+#include "ASTInterpreter.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> BUFFER_BUILTINS_AST = loadFixture("buffer_builtins");
+
+int main() {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = 1;
+    opts.syncMode = true;
+
+    ASTInterpreter interpreter(BUFFER_BUILTINS_AST.data(), BUFFER_BUILTINS_AST.size(), opts);
+    CollectingCallback callback;
+    interpreter.setCommandCallback(&callback);
+
+    if (!interpreter.start()) {
+        std::cerr << "ERROR: Failed to start interpreter\n";
+        return 1;
+    }
+
+    struct Expectation {
+        const char* description;
+        std::string needle;
+    };
+
+    // 'a','b','c','d','e' = 97..101; "-42" = 45,52,50
+    // sprintf: "abcde| 3.14|ff  |A|007"; dtostrf: "  2.50" over the rest of out
+    const std::vector<Expectation> expectations = {
+        {"strcpy writes text and terminator", "\"variable\":\"buf\",\"value\":[97,98,99,0,0,0,0,0]"},
+        {"strcat appends in place", "\"variable\":\"buf\",\"value\":[97,98,99,100,101,0,0,0]"},
+        {"strlen counts up to the terminator", "\"variable\":\"l\",\"value\":3"},
+        {"sprintf formats every conversion",
+         "\"variable\":\"out\",\"value\":[97,98,99,100,101,124,32,51,46,49,52,124,102,102,32,32,124,65,124,48,48,55,0,"},
+        {"dtostrf pads to the width", "\"variable\":\"out\",\"value\":[32,32,50,46,53,48,0,51,"},
+        {"sprintf %s reads from the argument's offset", "\"variable\":\"tail\",\"value\":[46,53,48,0,"},
+        {"strcmp of equal strings is zero", "\"variable\":\"s\",\"value\":0"},
+        {"itoa writes signed decimal", "\"variable\":\"buf\",\"value\":[45,52,50,0,"},
+        {"atoi parses the buffer", "\"variable\":\"k\",\"value\":-42"},
+        {"qsort uses the user comparator", "\"variable\":\"v\",\"value\":[9,7,5,3,1]"},
+        {"snprintf truncates to n-1", "\"variable\":\"buf\",\"value\":[49,50,51,0,"},
+        {"memset reports out-of-range writes", "Array bounds error in array 'buf'"},
+        {"memcmp of identical ranges is zero", "\"variable\":\"c\",\"value\":0"},
+        {"strcat through the pointer strcpy returned", "\"variable\":\"buf\",\"value\":[111,107,33,0,"},
+        {"memset rejects a negative count", "memset: negative count -1"},
+        {"strcpy into a char* literal within its length", "\"variable\":\"lit\",\"value\":\"yo\""},
+        {"strcpy past a char* literal reports a BoundsError", "Array bounds error in array 'lit'"},
+    };
+
+    int failures = 0;
+    for (const auto& expectation : expectations) {
+        bool ok = contains(callback.commands, expectation.needle);
+        std::cout << (ok ? "  PASS  " : "  FAIL  ") << expectation.description << "\n";
+        if (!ok) failures++;
+    }
+
+    // HOST_DOUBLE keeps float arrays in int storage; FLOAT32 stores the fractions
+    InterpreterOptions floatOpts = opts;
+    floatOpts.floatModel = FloatModel::FLOAT32;
+    ASTInterpreter floatInterpreter(BUFFER_BUILTINS_AST.data(), BUFFER_BUILTINS_AST.size(), floatOpts);
+    CollectingCallback floatCallback;
+    floatInterpreter.setCommandCallback(&floatCallback);
+    floatInterpreter.start();
+    bool floatSorted = contains(floatCallback.commands, "\"variable\":\"w\",\"value\":[0.25,0.75,1.5,2.5]");
+    std::cout << (floatSorted ? "  PASS  " : "  FAIL  ") << "qsort sorts float elements through float scratch cells\n";
+    if (!floatSorted) failures++;
+
+    if (failures > 0) {
+        std::cout << "\nCommand stream:\n";
+        for (const auto& cmd : callback.commands) std::cout << cmd << "\n";
+        std::cout << "\n" << failures << " buffer builtin check(s) failed\n";
+        return 1;
+    }
+
+    std::cout << "\nAll buffer builtin checks passed\n";
+    return 0;
+}
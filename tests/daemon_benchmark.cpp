@@ -0,0 +1,145 @@
+/**
+ * daemon_benchmark.cpp - One process per run vs. the interpreter daemon
+ *
+ * Usage: ./daemon_benchmark <extract_cpp_commands> [project_root] [rounds]
+ * Example: ./build/daemon_benchmark ./build/extract_cpp_commands . 3
+ *
+ * Runs every project_root/test_data/testN_js.ast `rounds` times, first by
+ * launching extract_cpp_commands per run (process start, AST file read,
+ * parse, registry construction), then through an in-process
+ * InterpreterDaemon with a DaemonClient. Reports mean latency and throughput
+ * for both, with the daemon measured sequentially (latency) and with one
+ * client per hardware thread (throughput). extract_cpp_commands runs in a
+ * scratch directory so its testN_cpp.json outputs do not land in test_data.
+ */
+
+#include "DaemonClient.hpp"
+#include "DeterministicDataProvider.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace arduino_interpreter;
+
+static std::vector<uint8_t> loadASTFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) return {};
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> buffer(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(buffer.data()), size);
+    return buffer;
+}
+
+static void report(const std::string& label, size_t runs, double seconds) {
+    std::cout << std::left << std::setw(28) << label << std::right << std::fixed
+              << std::setw(10) << std::setprecision(1) << (seconds * 1e6 / runs) << " us/run"
+              << std::setw(12) << std::setprecision(0) << (runs / seconds) << " runs/s\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <extract_cpp_commands> [project_root] [rounds]" << std::endl;
+        return 1;
+    }
+    std::string extractTool = argv[1];
+    std::string root = argc > 2 ? argv[2] : ".";
+    int rounds = argc > 3 ? std::stoi(argv[3]) : 3;
+
+    std::vector<std::vector<uint8_t>> asts;
+    for (int n = 0; ; n++) {
+        auto ast = loadASTFile(root + "/test_data/test" + std::to_string(n) + "_js.ast");
+        if (ast.empty()) break;
+        asts.push_back(std::move(ast));
+    }
+    if (asts.empty()) {
+        std::cerr << "ERROR: No test ASTs found in " << root << "/test_data\n";
+        return 1;
+    }
+    const size_t runs = asts.size() * static_cast<size_t>(rounds);
+
+    namespace fs = std::filesystem;
+    fs::path scratch = fs::temp_directory_path() / ("asti_daemon_benchmark_" + std::to_string(getpid()));
+    fs::create_directories(scratch / "test_data");
+    for (size_t n = 0; n < asts.size(); n++) {
+        std::string name = "test" + std::to_string(n) + "_js.ast";
+        fs::create_symlink(fs::absolute(root + "/test_data/" + name), scratch / "test_data" / name);
+    }
+    std::string tool = fs::absolute(extractTool).string();
+    using Clock = std::chrono::steady_clock;
+
+    // One process per run
+    auto begin = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (size_t n = 0; n < asts.size(); n++) {
+            std::string command = "cd '" + scratch.string() + "' && '" + tool + "' " + std::to_string(n) + " >/dev/null 2>&1";
+            FILE* pipe = popen(command.c_str(), "r");
+            if (!pipe) {
+                std::cerr << "ERROR: Cannot run " << extractTool << "\n";
+                return 1;
+            }
+            pclose(pipe);
+        }
+    }
+    double processSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    fs::remove_all(scratch);
+
+    DaemonOptions options;
+    options.socketPath = "/tmp/asti_daemon_benchmark_" + std::to_string(getpid()) + ".sock";
+    options.cachedPrograms = asts.size();
+    options.fallbackProvider = [] { return std::make_unique<DeterministicDataProvider>(); };
+    InterpreterDaemon daemon(options);
+    if (!daemon.start()) {
+        std::cerr << "ERROR: " << daemon.getLastError() << "\n";
+        return 1;
+    }
+
+    // Warm the program cache and spares, as a long-running daemon would be
+    {
+        DaemonClient client(options.socketPath);
+        for (const auto& ast : asts) client.run(ast.data(), ast.size());
+    }
+
+    // Sequential: per-request latency
+    begin = Clock::now();
+    {
+        DaemonClient client(options.socketPath);
+        for (int round = 0; round < rounds; round++) {
+            for (const auto& ast : asts) client.run(ast.data(), ast.size());
+        }
+    }
+    double sequentialSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    // Parallel: throughput
+    size_t clients = std::max(2u, std::thread::hardware_concurrency());
+    begin = Clock::now();
+    {
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < clients; c++) {
+            threads.emplace_back([&, c] {
+                DaemonClient client(options.socketPath);
+                for (size_t i = c; i < runs; i += clients) {
+                    const auto& ast = asts[i % asts.size()];
+                    client.run(ast.data(), ast.size());
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+    }
+    double parallelSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    daemon.stop();
+
+    std::cout << runs << " runs (" << asts.size() << " sketches x " << rounds << ")\n";
+    report("process per run", runs, processSeconds);
+    report("daemon, 1 client", runs, sequentialSeconds);
+    report("daemon, " + std::to_string(clients) + " clients", runs, parallelSeconds);
+    return 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * daemon_test.cpp
+ *
+ * Verifies InterpreterDaemon and DaemonClient end to end over a UNIX socket.
+ *
+ * Usage: ./daemon_test [test_data_dir]
+ *
+ * TEST CASES:
+ * - every test_data/testN_js.ast through the daemon (JSON and binary
+ *   encodings) against an in-process run
+ * - the first run of a program uploads the AST; later runs send the hash only
+ * - an input trace overrides analogRead values
+ * - four clients on separate threads at once
+ *
+ * EXPECTED RESULTS:
+ * - Identical command streams (generated pointer/object ids masked)
+ * - Repeat runs start on spare interpreters
+ */
+
+#include "DaemonClient.hpp"
+#include "DeterministicDataProvider.hpp"
+#include "unit_test_helpers.hpp"
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static std::string maskGeneratedIds(const std::string& json) {
+    static const std::regex pointerIds("(f?ptr)_[0-9]+_[0-9a-z]+");
+    static const std::regex longNumbers("[0-9]{9,}");
+    return std::regex_replace(std::regex_replace(json, pointerIds, "$1"), longNumbers, "N");
+}
+
+static std::vector<std::string> masked(const std::vector<std::string>& commands) {
+    std::vector<std::string> result;
+    for (const auto& cmd : commands) result.push_back(maskGeneratedIds(cmd));
+    return result;
+}
+
+static std::vector<std::string> runInProcess(const std::vector<uint8_t>& ast) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = Config::TEST_MAX_LOOP_ITERATIONS;
+    opts.syncMode = true;
+
+    CollectingCallback callback;
+    DeterministicDataProvider dataProvider;
+    {
+        ASTInterpreter interpreter(ast.data(), ast.size(), opts);
+        interpreter.setCommandCallback(&callback);
+        interpreter.setSyncDataProvider(&dataProvider);
+        interpreter.start();
+    }
+    return masked(callback.commands);
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDir = argc > 1 ? argv[1] : "test_data";
+
+    std::vector<std::vector<uint8_t>> asts;
+    for (int n = 0; ; n++) {
+        auto ast = loadASTFile(dataDir + "/test" + std::to_string(n) + "_js.ast");
+        if (ast.empty()) break;
+        asts.push_back(std::move(ast));
+    }
+    if (asts.empty()) {
+        std::cerr << "ERROR: No test ASTs found in " << dataDir << "\n";
+        return 1;
+    }
+
+    DaemonOptions options;
+    options.socketPath = "/tmp/asti_daemon_test_" + std::to_string(getpid()) + ".sock";
+    options.workers = 4;
+    options.cachedPrograms = asts.size();
+    options.fallbackProvider = [] { return std::make_unique<DeterministicDataProvider>(); };
+
+    InterpreterDaemon daemon(options);
+    if (!daemon.start()) {
+        std::cerr << "ERROR: " << daemon.getLastError() << "\n";
+        return 1;
+    }
+
+    int failures = 0;
+    auto check = [&](const std::string& description, bool ok) {
+        std::cout << (ok ? "  PASS  " : "  FAIL  ") << description << "\n";
+        if (!ok) failures++;
+    };
+
+    DaemonClient client(options.socketPath);
+
+    // Corpus, both encodings; the first pass uploads, the second hits the cache
+    int mismatches = 0;
+    int uploads = 0;
+    for (auto encoding : {DaemonEncoding::JSON, DaemonEncoding::BINARY}) {
+        DaemonRunOptions runOptions;
+        runOptions.encoding = encoding;
+        for (size_t n = 0; n < asts.size(); n++) {
+            auto result = client.run(asts[n].data(), asts[n].size(), runOptions);
+            if (result.uploaded) uploads++;
+            if (!result.error.empty() || masked(result.commands) != runInProcess(asts[n])) {
+                mismatches++;
+                std::cout << "  FAIL  test" << n << " (" << (encoding == DaemonEncoding::JSON ? "json" : "binary")
+                          << "): " << daemonStatusName(result.status) << " " << result.error << "\n";
+            }
+        }
+    }
+    check(std::to_string(2 * asts.size() - mismatches) + "/" + std::to_string(2 * asts.size()) +
+          " daemon streams identical", mismatches == 0);
+    check("programs uploaded once, then referenced by hash", uploads == static_cast<int>(asts.size()));
+    check("repeat runs start on spare interpreters", daemon.getWarmStarts() > 0);
+
+    // Input trace: test data sketches read A0 = pin 14
+    {
+        DaemonRunOptions runOptions;
+        runOptions.inputs.push_back({InputQuery::Kind::ANALOG_READ, 14, 777});
+        bool found = false;
+        for (const auto& ast : asts) {
+            auto result = client.run(ast.data(), ast.size(), runOptions);
+            if (contains(result.commands, "\"value\":777")) {
+                found = true;
+                break;
+            }
+        }
+        check("input trace overrides analogRead", found);
+    }
+
+    // Concurrent clients
+    {
+        std::atomic<int> concurrentMismatches{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&, t] {
+                DaemonClient threadClient(options.socketPath);
+                for (size_t n = static_cast<size_t>(t); n < asts.size(); n += 4) {
+                    auto result = threadClient.run(asts[n].data(), asts[n].size());
+                    if (masked(result.commands) != runInProcess(asts[n])) concurrentMismatches++;
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        check("four concurrent clients", concurrentMismatches == 0);
+    }
+
+    client.disconnect();
+    daemon.stop();
+    std::cout << daemon.getRequestsServed() << " requests, " << daemon.getWarmStarts() << " warm starts\n";
+    return failures == 0 ? 0 : 1;
+}
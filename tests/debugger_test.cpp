@@ -0,0 +1,246 @@
+/**
+ * debugger_test.cpp
+ *
+ * Verifies breakpoints, conditional breakpoints, watchpoints and step()
+ * (DebugSession.hpp): stops happen where expected with the call stack
+ * intact, and a resumed run emits exactly the commands of an undebugged one.
+ *
+ * TEST SKETCH: "debugger" in tests/unit_sketches.js (statement indexes count
+ *   the statements of a function body: accumulate's `return sum;` is 3)
+ *
+ * EXPECTED RESULTS (5 loop iterations):
+ * - Breakpoint on `return sum;`: 5 stops in accumulate, sum = 0 1 3 6 10
+ * - "i == 2 && sum > 0" on `sum += i;`: 3 stops (n = 3, 4, 5), sum = 1
+ * - Watchpoint on total: 6 stops (declaration + 5 writes), last value 20
+ * - step() from a breakpoint on loop's statement 1 enters accumulate
+ * - Paused from another thread: resume() continues, stop() ends the run
+ * - Every fully resumed run emits the undebugged command stream
+ */
+
+#include "DebugSession.hpp"
+#include "unit_test_helpers.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> DEBUGGER_AST = loadFixture("debugger");
+
+class LambdaDebugCallback : public DebugCallback {
+public:
+    std::function<void(ASTInterpreter&, const DebugStop&)> handler;
+    void onStop(ASTInterpreter& interpreter, const DebugStop& stop) override { handler(interpreter, stop); }
+};
+
+static InterpreterOptions testOptions() {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = 5;
+    opts.enforceLoopLimitsOnInternalLoops = false;   // accumulate(5) runs its loop 5 times
+    opts.syncMode = true;
+    return opts;
+}
+
+static std::unique_ptr<ASTInterpreter> makeInterpreter(CollectingCallback& output) {
+    auto interpreter = std::make_unique<ASTInterpreter>(DEBUGGER_AST.data(), DEBUGGER_AST.size(), testOptions());
+    interpreter->setCommandCallback(&output);
+    return interpreter;
+}
+
+static int32_t intValue(ASTInterpreter& interpreter, const std::string& name) {
+    CommandValue value = interpreter.getVariableValue(name);
+    if (auto* v = std::get_if<int32_t>(&value)) return *v;
+    if (auto* v = std::get_if<double>(&value)) return static_cast<int32_t>(*v);
+    return -1;
+}
+
+static std::vector<std::string> baseline() {
+    CollectingCallback output;
+    makeInterpreter(output)->start();
+    return output.commands;
+}
+
+static int testBreakpoint(const std::vector<std::string>& expected) {
+    CollectingCallback output;
+    auto interpreter = makeInterpreter(output);
+    int id = interpreter->addBreakpoint("accumulate", 3);
+
+    std::vector<int32_t> sums;
+    std::vector<uint32_t> hits;
+    bool inFunction = true;
+    LambdaDebugCallback debugger;
+    debugger.handler = [&](ASTInterpreter& in, const DebugStop& stop) {
+        sums.push_back(intValue(in, "sum"));
+        hits.push_back(stop.hitCount);
+        inFunction = inFunction && stop.reason == DebugStopReason::BREAKPOINT && stop.breakpointId == id &&
+                     stop.function == "accumulate" && in.getState() == ExecutionState::PAUSED;
+        in.resume();
+    };
+    interpreter->setDebugCallback(&debugger);
+    interpreter->start();
+
+    return check(id > 0 && sums == std::vector<int32_t>{0, 1, 3, 6, 10} &&
+                 hits == std::vector<uint32_t>{1, 2, 3, 4, 5} && inFunction && output.commands == expected,
+                 "breakpoint stops with live locals, resumed stream unchanged");
+}
+
+static int testConditionalBreakpoint() {
+    CollectingCallback output;
+    auto interpreter = makeInterpreter(output);
+    std::string error;
+    int id = interpreter->addBreakpoint("accumulate", 2, "i == 2 && sum > 0", &error);
+
+    std::vector<int32_t> sums;
+    LambdaDebugCallback debugger;
+    debugger.handler = [&](ASTInterpreter& in, const DebugStop&) {
+        sums.push_back(intValue(in, "sum"));
+        in.resume();
+    };
+    interpreter->setDebugCallback(&debugger);
+    interpreter->start();
+
+    return check(id > 0 && sums == std::vector<int32_t>{1, 1, 1}, "conditional breakpoint stops only when it holds");
+}
+
+static int testWatchpoint(const std::vector<std::string>& expected) {
+    CollectingCallback output;
+    auto interpreter = makeInterpreter(output);
+    interpreter->addWatchpoint("total");   // Before the global is declared
+
+    std::vector<int32_t> values;
+    bool watchStops = true;
+    LambdaDebugCallback debugger;
+    debugger.handler = [&](ASTInterpreter& in, const DebugStop& stop) {
+        watchStops = watchStops && stop.reason == DebugStopReason::WATCHPOINT && stop.variable == "total";
+        auto* value = std::get_if<int32_t>(&stop.value);
+        values.push_back(value ? *value : -1);
+        in.resume();
+    };
+    interpreter->setDebugCallback(&debugger);
+    interpreter->start();
+
+    return check(watchStops && values == std::vector<int32_t>{0, 0, 1, 4, 10, 20} && output.commands == expected,
+                 "watchpoint stops after every write to the slot");
+}
+
+static int testStep() {
+    CollectingCallback output;
+    auto interpreter = makeInterpreter(output);
+    interpreter->addBreakpoint("loop", 1, "counter == 2");
+
+    std::vector<std::string> functions;
+    std::vector<DebugStopReason> reasons;
+    LambdaDebugCallback debugger;
+    debugger.handler = [&](ASTInterpreter& in, const DebugStop& stop) {
+        reasons.push_back(stop.reason);
+        functions.push_back(stop.function);
+        if (reasons.size() < 4) in.step();
+        else in.resume();
+    };
+    interpreter->setDebugCallback(&debugger);
+    interpreter->start();
+
+    // loop stmt 1 -> accumulate: `int sum = 0;` -> for -> `sum += i;`
+    std::vector<DebugStopReason> expectedReasons{DebugStopReason::BREAKPOINT, DebugStopReason::STEP,
+                                                 DebugStopReason::STEP, DebugStopReason::STEP};
+    std::vector<std::string> expectedFunctions{"loop", "accumulate", "accumulate", "accumulate"};
+    return check(reasons == expectedReasons && functions == expectedFunctions, "step() stops at the next statement");
+}
+
+static int testBadBreakpoints() {
+    CollectingCallback output;
+    auto interpreter = makeInterpreter(output);
+    std::string unknownFunction, noStatement, badCondition;
+    bool rejected = interpreter->addBreakpoint("missing", 0, "", &unknownFunction) == -1 &&
+                    interpreter->addBreakpoint("accumulate", 99, "", &noStatement) == -1 &&
+                    interpreter->addBreakpoint("accumulate", 0, "i ==", &badCondition) == -1;
+
+    // A removed breakpoint no longer stops
+    int stops = 0;
+    LambdaDebugCallback debugger;
+    debugger.handler = [&](ASTInterpreter& in, const DebugStop&) {
+        stops++;
+        in.resume();
+    };
+    interpreter->setDebugCallback(&debugger);
+    int id = interpreter->addBreakpoint("loop", 0);
+    bool removed = interpreter->removeBreakpoint(id) && !interpreter->removeBreakpoint(id);
+    interpreter->start();
+
+    return check(rejected && !unknownFunction.empty() && !noStatement.empty() && !badCondition.empty() &&
+                 removed && stops == 0,
+                 "invalid breakpoints rejected, removed breakpoints inert");
+}
+
+// The interpreter thread blocks at each stop until the controlling thread decides
+static int testPausedFromAnotherThread(const std::vector<std::string>& expected) {
+    int failures = 0;
+    for (bool stopEarly : {false, true}) {
+        CollectingCallback output;
+        auto interpreter = makeInterpreter(output);
+        interpreter->addBreakpoint("accumulate", 3);
+
+        std::mutex mutex;
+        std::condition_variable stopped;
+        int pending = 0;
+        LambdaDebugCallback debugger;
+        debugger.handler = [&](ASTInterpreter&, const DebugStop&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending++;
+            stopped.notify_one();
+        };
+        interpreter->setDebugCallback(&debugger);
+
+        std::atomic<bool> finished{false};
+        std::thread runner([&] {
+            interpreter->start();
+            finished = true;
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped.notify_one();
+        });
+
+        std::vector<int32_t> sums;
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopped.wait(lock, [&] { return pending > 0 || finished; });
+            if (pending == 0) break;
+            pending--;
+            lock.unlock();
+
+            sums.push_back(intValue(*interpreter, "sum"));
+            if (stopEarly && sums.size() == 2) interpreter->stop();
+            else interpreter->resume();
+        }
+        runner.join();
+
+        if (stopEarly) {
+            failures += check(sums == std::vector<int32_t>{0, 1} && output.commands.size() < expected.size(),
+                              "stop() from another thread ends a paused run");
+        } else {
+            failures += check(sums == std::vector<int32_t>{0, 1, 3, 6, 10} && output.commands == expected,
+                              "resume() from another thread continues a paused run");
+        }
+    }
+    return failures;
+}
+
+int main() {
+    std::vector<std::string> expected = baseline();
+
+    int failures = 0;
+    failures += testBreakpoint(expected);
+    failures += testConditionalBreakpoint();
+    failures += testWatchpoint(expected);
+    failures += testStep();
+    failures += testBadBreakpoints();
+    failures += testPausedFromAnotherThread(expected);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+/**
+ * direct_call_test.cpp
+ *
+ * Regression test for the direct invocation API (initializeGlobals /
+ * callFunction / resetGlobals) used to unit-test individual sketch functions.
+ *
+ * TEST SKETCH: "direct_call" in tests/unit_sketches.js
+ *
+ * EXPECTED RESULTS:
+ * - setup() and loop() never run (no PIN_MODE command)
+ * - Array arguments bind to array parameters and the return value comes back
+ * - Each result carries only the commands emitted by that call
+ * - Globals persist across calls unless a reset is requested
+ * - Unknown functions fail without throwing
+ * - "direct_call_bad_global": a failing global initializer fails
+ *   initializeGlobals() and every later callFunction(), without re-running it
+ */
+
+#include "ASTInterpreter.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> DIRECT_CALL_AST = loadFixture("direct_call");
+static const std::vector<uint8_t> BAD_GLOBAL_AST = loadFixture("direct_call_bad_global");
+
+static int32_t asInt(const CommandValue& value) {
+    if (auto* i = std::get_if<int32_t>(&value)) return *i;
+    if (auto* d = std::get_if<double>(&value)) return static_cast<int32_t>(*d);
+    return -1;
+}
+
+int main() {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+
+    ASTInterpreter interpreter(DIRECT_CALL_AST.data(), DIRECT_CALL_AST.size(), opts);
+    CollectingCallback callback;
+    interpreter.setCommandCallback(&callback);
+
+    int failures = 0;
+    auto check = [&](const char* description, bool ok) {
+        std::cout << (ok ? "  PASS  " : "  FAIL  ") << description << "\n";
+        if (!ok) failures++;
+    };
+
+    auto init = interpreter.initializeGlobals();
+    check("globals initialize", init.success);
+
+    auto checksum = interpreter.callFunction("computeChecksum",
+                                             {std::vector<int32_t>{100, 200, 3}, int32_t(3)});
+    check("array argument and return value", checksum.success && asInt(checksum.value) == 47);
+
+    auto blink = interpreter.callFunction("blink", {int32_t(7)});
+    check("call returns its own commands", blink.success &&
+          contains(blink.commands, "\"pin\":7,\"value\":1") &&
+          !contains(blink.commands, "computeChecksum"));
+
+    auto first = interpreter.callFunction("addToTotal", {int32_t(5)});
+    auto second = interpreter.callFunction("addToTotal", {int32_t(5)});
+    check("globals persist between calls", asInt(first.value) == 5 && asInt(second.value) == 10);
+
+    auto reset = interpreter.callFunction("addToTotal", {int32_t(5)}, true);
+    check("reset restores initialized globals", asInt(reset.value) == 5);
+
+    auto missing = interpreter.callFunction("doesNotExist");
+    check("unknown function fails cleanly", !missing.success && !missing.error.empty());
+
+    check("setup() and loop() never ran", !contains(callback.commands, "PIN_MODE") &&
+          !contains(init.commands, "PIN_MODE"));
+    check("call commands bypass the callback", !contains(callback.commands, "DIGITAL_WRITE"));
+
+    ASTInterpreter broken(BAD_GLOBAL_AST.data(), BAD_GLOBAL_AST.size(), opts);
+    broken.setCommandCallback(&callback);
+    auto badInit = broken.initializeGlobals();
+    check("failing global initializer fails initializeGlobals()",
+          !badInit.success && contains(badInit.commands, "\"type\":\"ERROR\""));
+    auto afterBadInit = broken.callFunction("readOk");
+    auto again = broken.initializeGlobals();
+    check("later calls report the initialization error",
+          !afterBadInit.success && afterBadInit.error.find("Global initialization failed") == 0 &&
+          !again.success && again.error == badInit.error && again.commands.empty());
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " direct call check(s) failed\n";
+        return 1;
+    }
+
+    std::cout << "\nAll direct call checks passed\n";
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * fast_assignment_test.cpp
+ *
+ * Verifies the in-place assignment and increment paths: compound operators
+ * and ++/-- on scalars and 1D array elements store the right value, emit one
+ * VAR_SET per store, and produce the same stream through the async emitter.
+ *
+ * Usage: ./fast_assignment_test
+ *
+ * TEST SKETCH: "fast_assignment" in tests/unit_sketches.js, 2 loop iterations
+ *
+ * EXPECTED RESULTS:
+ * - Printed: 12 4 3 4294967295 10 11 12, then 22 5 2 4294967294 82 33 34
+ * - Three full-array VAR_SETs of counts per iteration, no errors
+ * - asyncEmission = true yields the identical stream
+ *
+ * "fast_assignment_bounds" stores to counts[4], counts[-1] and levels[2]:
+ * - One BoundsError per store, no VAR_SET for them; counts[0] = 7 still lands
+ */
+
+#include "ASTInterpreter.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> FAST_AST = loadFixture("fast_assignment");
+static const std::vector<uint8_t> BOUNDS_AST = loadFixture("fast_assignment_bounds");
+
+static std::vector<std::string> run(bool asyncEmission, const std::vector<uint8_t>& ast = FAST_AST) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+    opts.maxLoopIterations = 2;
+    opts.asyncEmission = asyncEmission;
+
+    CollectingCallback callback;
+    {
+        ASTInterpreter interpreter(ast.data(), ast.size(), opts);
+        interpreter.setCommandCallback(&callback);
+        interpreter.start();
+        interpreter.flushCommands();
+    }
+    return callback.commands;
+}
+
+// Value of a field, or "" if absent
+static std::string field(const std::string& json, const std::string& name) {
+    std::string key = "\"" + name + "\":";
+    size_t pos = json.find(key);
+    if (pos == std::string::npos) return "";
+    pos += key.size();
+    if (json[pos] == '"') return json.substr(pos + 1, json.find('"', pos + 1) - pos - 1);
+    if (json[pos] == '[') return json.substr(pos, json.find(']', pos) - pos + 1);
+    return json.substr(pos, json.find_first_of(",}", pos) - pos);
+}
+
+int main() {
+    int failures = 0;
+
+    auto commands = run(false);
+    std::vector<std::string> printed;
+    std::vector<std::string> counts;
+    bool errors = false;
+    for (const auto& cmd : commands) {
+        if (field(cmd, "function") == "Serial.println") printed.push_back(field(cmd, "data"));
+        if (field(cmd, "type") == "VAR_SET" && field(cmd, "variable") == "counts") counts.push_back(field(cmd, "value"));
+        if (field(cmd, "type") == "ERROR") errors = true;
+    }
+
+    failures += check(!errors, "no errors");
+    failures += check(printed == std::vector<std::string>({"12", "4", "3", "4294967295", "10", "11", "12",
+                                                           "22", "5", "2", "4294967294", "82", "33", "34"}),
+                      "stored values");
+    failures += check(counts == std::vector<std::string>({"[1,2,3,4]", "[1,12,3,4]", "[1,12,4,4]", "[1,12,4,3]",
+                                                          "[1,22,4,3]", "[1,22,5,3]", "[1,22,5,2]"}),
+                      "one VAR_SET per array element store");
+#ifndef PLATFORM_WASM
+    failures += check(run(true) == commands, "async emission stream identical");
+#endif
+
+    std::vector<std::string> boundsErrors;
+    std::vector<std::string> boundsStores;
+    for (const auto& cmd : run(false, BOUNDS_AST)) {
+        if (field(cmd, "errorType") == "BoundsError") boundsErrors.push_back(field(cmd, "message"));
+        if (field(cmd, "type") == "VAR_SET" && field(cmd, "variable") != "i") boundsStores.push_back(field(cmd, "value"));
+    }
+    failures += check(boundsErrors == std::vector<std::string>({
+                          "Array bounds error in array 'counts': index 4 is out of bounds [0..3]",
+                          "Array bounds error in array 'counts': index -1 is out of bounds [0..3]",
+                          "Array bounds error in array 'levels': index 2 is out of bounds [0..1]"}),
+                      "out-of-bounds stores raise BoundsError");
+    failures += check(boundsStores.size() == 3 && boundsStores.back() == "[7,2,3,4]",
+                      "out-of-bounds stores leave the arrays unchanged");
+
+    return failures == 0 ? 0 : 1;
+}
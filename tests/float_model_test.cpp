@@ -0,0 +1,80 @@
+/**
+ * float_model_test.cpp
+ *
+ * Verifies InterpreterOptions::floatModel: FLOAT32 rounds float variables,
+ * float arrays and float-ranked arithmetic to single precision while double
+ * keeps 64 bits; AVR makes double single precision as well; HOST_DOUBLE
+ * keeps the existing behaviour.
+ *
+ * Usage: ./float_model_test
+ *
+ * TEST SKETCH: "float_model" in tests/unit_sketches.js, 1 loop iteration
+ *
+ * EXPECTED RESULTS:
+ * - FLOAT32: 0 -1.490116 0.531250 1.125000 8 4.470348 11.920929 (2^24 + 1
+ *   is not a float; 0.1 as float and as double differ; f * 3.0 stays double,
+ *   0.1f * 3 rounds to float)
+ * - AVR: 0 0 0.531250 1.125000 4 0 0 (double is float)
+ * - HOST_DOUBLE: 1 0 ... (doubles throughout)
+ */
+
+#include "ASTInterpreter.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> FLOAT_AST = loadFixture("float_model");
+
+// Value of a field, or "" if absent
+static std::string field(const std::string& json, const std::string& name) {
+    std::string key = "\"" + name + "\":";
+    size_t pos = json.find(key);
+    if (pos == std::string::npos) return "";
+    pos += key.size();
+    if (json[pos] == '"') return json.substr(pos + 1, json.find('"', pos + 1) - pos - 1);
+    return json.substr(pos, json.find_first_of(",}", pos) - pos);
+}
+
+// Serial.println output of one run; "ERROR" marks an error command
+static std::vector<std::string> run(FloatModel model) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+    opts.maxLoopIterations = 1;
+    opts.floatModel = model;
+
+    CollectingCallback callback;
+    ASTInterpreter interpreter(FLOAT_AST.data(), FLOAT_AST.size(), opts);
+    interpreter.setCommandCallback(&callback);
+    interpreter.start();
+
+    std::vector<std::string> printed;
+    for (const auto& cmd : callback.commands) {
+        if (field(cmd, "function") == "Serial.println") printed.push_back(field(cmd, "data"));
+        if (field(cmd, "type") == "ERROR") printed.push_back("ERROR");
+    }
+    return printed;
+}
+
+int main() {
+    int failures = 0;
+
+    auto float32 = run(FloatModel::FLOAT32);
+    failures += check(float32 == std::vector<std::string>({"0", "-1.490116", "0.531250", "1.125000", "8", "4.470348", "11.920929"}),
+                      "FLOAT32: float is single precision, double is not");
+
+    auto avr = run(FloatModel::AVR);
+    failures += check(avr == std::vector<std::string>({"0", "0", "0.531250", "1.125000", "4", "0", "0"}),
+                      "AVR: double is single precision");
+
+    auto host = run(FloatModel::HOST_DOUBLE);
+    failures += check(host.size() == 7 && host[0] == "1" && host[1] == "0",
+                      "HOST_DOUBLE: double precision throughout");
+
+    return failures == 0 ? 0 : 1;
+}
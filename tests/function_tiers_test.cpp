@@ -0,0 +1,190 @@
+/**
+ * function_tiers_test.cpp
+ *
+ * Verifies tiered execution (FunctionTiers.hpp): hot user functions are
+ * promoted once calls + loop back-edges reach tierUpThreshold, loop() only
+ * changes tier between iterations, call sites inside tier 1 bodies are bound
+ * to their callees, and the command stream is the same for every threshold.
+ *
+ * TEST SKETCH: "function_tiers" in tests/unit_sketches.js
+ *
+ * int scale(int v, int factor = 2) {
+ *   return v * factor;
+ * }
+ *
+ * int add(int a, int b) {
+ *   return a + b;
+ * }
+ *
+ * void accumulate(int n) {
+ *   for (int i = 0; i < n; i++) {
+ *     total = add(total, scale(i));
+ *   }
+ * }
+ *
+ * void setup() {
+ *   Serial.begin(9600);
+ * }
+ *
+ * void loop() {
+ *   accumulate(3);
+ *   Serial.println(total);
+ * }
+ *
+ * EXPECTED RESULTS (4 loop iterations, threshold 4):
+ * - total prints 6, 12, 18, 24 in every configuration
+ * - accumulate (2 calls + 3 back-edges), scale and add (4 calls each) are
+ *   promoted in iteration 2; loop() at the start of iteration 4
+ * - accumulate binds its add() and scale() call sites, loop() its accumulate()
+ * - Threshold 0: no tier bookkeeping at all
+ *
+ * TEST SKETCH: "function_tiers_shadow" - step() declares a local function
+ * pointer `add` = &mul, then calls add() directly and again through bump()
+ * and twice(), whose add() call sites were bound before the pointer existed
+ *
+ * EXPECTED RESULTS (1 loop iteration):
+ * - Calls through the pointer reach mul at every threshold, bound call sites
+ *   included; total prints 36
+ * - step() binds its four bump() and twice() call sites, not its add() calls
+ */
+
+#include "ASTInterpreter.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> TIERS_AST = loadFixture("function_tiers");
+static const std::vector<uint8_t> SHADOW_AST = loadFixture("function_tiers_shadow");
+
+static InterpreterOptions testOptions(uint32_t threshold) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = 4;
+    opts.syncMode = true;
+    opts.tierUpThreshold = threshold;
+    return opts;
+}
+
+static std::vector<std::string> run(ASTInterpreter& interpreter) {
+    CollectingCallback output;
+    interpreter.setCommandCallback(&output);
+    interpreter.start();
+    return output.commands;
+}
+
+static const FunctionTier* findTier(const FunctionTiers& tiers, const std::string& name) {
+    for (const auto* function : tiers.functions()) {
+        if (function->name == name) return function;
+    }
+    return nullptr;
+}
+
+static const TierPromotion* findPromotion(const FunctionTiers& tiers, const std::string& name) {
+    for (const auto& promotion : tiers.promotions()) {
+        if (promotion.function == name) return &promotion;
+    }
+    return nullptr;
+}
+
+static int testIdenticalStreams(std::vector<std::string>& baseline) {
+    ASTInterpreter untiered(TIERS_AST.data(), TIERS_AST.size(), testOptions(0));
+    baseline = run(untiered);
+
+    ASTInterpreter eager(TIERS_AST.data(), TIERS_AST.size(), testOptions(1));
+    ASTInterpreter byDefault(TIERS_AST.data(), TIERS_AST.size(), testOptions(Config::DEFAULT_TIER_UP_THRESHOLD));
+
+    size_t printed = 0;
+    for (const auto& command : baseline) {
+        if (command.find("Serial.println") != std::string::npos) printed++;
+    }
+
+    int failures = 0;
+    failures += check(untiered.getFunctionTiers() == nullptr, "threshold 0 keeps no tier state");
+    failures += check(printed == 4 && baseline.back().find("PROGRAM_END") != std::string::npos,
+                      "untiered run completes all iterations");
+    failures += check(run(eager) == baseline, "threshold 1 (every function tier 1) emits the same commands");
+    failures += check(run(byDefault) == baseline, "default threshold emits the same commands");
+    return failures;
+}
+
+static int testPromotions(const std::vector<std::string>& baseline) {
+    ASTInterpreter interpreter(TIERS_AST.data(), TIERS_AST.size(), testOptions(4));
+    std::vector<std::string> commands = run(interpreter);
+    const FunctionTiers* tiers = interpreter.getFunctionTiers();
+    if (!tiers) return check(false, "tier state exists");
+
+    const TierPromotion* accumulate = findPromotion(*tiers, "accumulate");
+    const TierPromotion* scale = findPromotion(*tiers, "scale");
+    const TierPromotion* add = findPromotion(*tiers, "add");
+    const TierPromotion* loop = findPromotion(*tiers, "loop");
+
+    int failures = 0;
+    failures += check(commands == baseline, "threshold 4 emits the same commands");
+    failures += check(tiers->promotions().size() == 4, "four functions promoted");
+    failures += check(accumulate && accumulate->loopIteration == 2 && accumulate->calls == 2 &&
+                      accumulate->backEdges == 3,
+                      "back-edges count towards promotion");
+    failures += check(scale && scale->loopIteration == 2 && scale->calls == 4 &&
+                      add && add->loopIteration == 2 && add->calls == 4,
+                      "hot helpers promoted on their fourth call");
+    failures += check(loop && loop->loopIteration == 4 && loop->calls == 4,
+                      "loop() promoted at an iteration boundary");
+
+    const FunctionTier* accumulateTier = findTier(*tiers, "accumulate");
+    const FunctionTier* loopTier = findTier(*tiers, "loop");
+    const FunctionTier* scaleTier = findTier(*tiers, "scale");
+    failures += check(accumulateTier && accumulateTier->tier == 1 && accumulateTier->boundCallSites == 2 &&
+                      accumulateTier->calls == 4 && accumulateTier->backEdges == 12,
+                      "tier 1 body binds its call sites");
+    failures += check(loopTier && loopTier->boundCallSites == 1, "loop() binds its call site after promotion");
+    failures += check(scaleTier && scaleTier->prepared.parameters.size() == 2 &&
+                      scaleTier->prepared.requiredParameters == 1 && scaleTier->prepared.returnType == "int",
+                      "prepared form keeps parameters, defaults and return type");
+    return failures;
+}
+
+// Function pointer values carry a generated id; compare everything else
+static std::vector<std::string> withoutPointerIds(std::vector<std::string> commands) {
+    for (auto& command : commands) {
+        size_t id = command.find("\"pointerId\":\"");
+        if (id == std::string::npos) continue;
+        size_t end = command.find('"', id + 13);
+        if (end != std::string::npos) command.erase(id, end + 1 - id);
+    }
+    return commands;
+}
+
+static int testShadowingPointer() {
+    InterpreterOptions opts = testOptions(0);
+    opts.maxLoopIterations = 1;
+    ASTInterpreter untiered(SHADOW_AST.data(), SHADOW_AST.size(), opts);
+    std::vector<std::string> baseline = withoutPointerIds(run(untiered));
+
+    opts.tierUpThreshold = 1;
+    ASTInterpreter eager(SHADOW_AST.data(), SHADOW_AST.size(), opts);
+    std::vector<std::string> commands = withoutPointerIds(run(eager));
+    const FunctionTiers* tiers = eager.getFunctionTiers();
+    const FunctionTier* step = tiers ? findTier(*tiers, "step") : nullptr;
+
+    int failures = 0;
+    failures += check(contains(baseline, "\"function\":\"mul\",\"arguments\":[6,4") &&
+                      contains(baseline, "\"function\":\"Serial.println\",\"arguments\":[\"36\"]"),
+                      "local function pointer shadows the function of the same name");
+    failures += check(commands == baseline, "bound call sites defer to a shadowing function pointer");
+    failures += check(step && step->boundCallSites == 4, "calls through a pointer are never bound");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    std::vector<std::string> baseline;
+    failures += testIdenticalStreams(baseline);
+    failures += testPromotions(baseline);
+    failures += testShadowingPointer();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#!/usr/bin/env node
+
+/**
+ * generate_benchmark_data.js - Export the benchmark sketch corpus
+ *
+ * Parses every sketch in benchmarks.js and writes, per sketch N:
+ *   benchmark_data/benchN.ast   CompactAST binary
+ *   benchmark_data/benchN.meta  name, sizes, loopIterations, source
+ *
+ * Expected command-stream checksums (benchmark_data/checksums.txt) come from
+ * the C++ interpreter itself, after regenerating:
+ *   ./build/sketch_benchmark benchmark_data --record
+ *
+ * USAGE:
+ *   node tests/generate_benchmark_data.js [output_dir]
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+const { parse, exportCompactAST } = require('../libs/ArduinoParser/src/ArduinoParser.js');
+const { benchmarkFiles } = require('./benchmarks.js');
+
+// Number of AST nodes, for the meta file (the synthetic sketches are sized by it)
+function countNodes(node) {
+    if (!node || typeof node !== 'object') return 0;
+    if (Array.isArray(node)) return node.reduce((sum, child) => sum + countNodes(child), 0);
+    let count = typeof node.type === 'string' ? 1 : 0;
+    for (const key of Object.keys(node)) {
+        if (key !== 'type') count += countNodes(node[key]);
+    }
+    return count;
+}
+
+function main() {
+    const outputDir = process.argv[2] || path.join(__dirname, '..', 'benchmark_data');
+    if (!fs.existsSync(outputDir)) {
+        fs.mkdirSync(outputDir);
+    }
+
+    let failures = 0;
+    benchmarkFiles.forEach((bench, i) => {
+        const baseName = `bench${i}`;
+        try {
+            const ast = parse(bench.content);
+            const compactAST = exportCompactAST(ast);
+            fs.writeFileSync(path.join(outputDir, `${baseName}.ast`), Buffer.from(compactAST));
+            fs.writeFileSync(
+                path.join(outputDir, `${baseName}.meta`),
+                [
+                    `name=${bench.name}`,
+                    `astSize=${compactAST.byteLength}`,
+                    `nodeCount=${countNodes(ast)}`,
+                    `codeSize=${bench.content.length}`,
+                    `loopIterations=${bench.loopIterations}`,
+                    `content=${bench.content}`
+                ].join('\n')
+            );
+            console.log(`${baseName}: ${bench.name} (${compactAST.byteLength} bytes)`);
+        } catch (error) {
+            failures++;
+            console.error(`❌ ${baseName}: ${bench.name} - ${error.message}`);
+        }
+    });
+
+    console.log(`${benchmarkFiles.length - failures}/${benchmarkFiles.length} benchmark sketches exported to ${outputDir}`);
+    process.exit(failures === 0 ? 0 : 1);
+}
+
+main();
@@ -0,0 +1,46 @@
+#!/usr/bin/env node
+
+/**
+ * generate_unit_fixtures.js - Export the unit test sketches
+ *
+ * Parses every sketch in unit_sketches.js and writes, per sketch:
+ *   tests/fixtures/<name>.ast   CompactAST binary
+ *
+ * The C++ unit tests load these with loadFixture("<name>"); regenerate and
+ * commit them with any change to a sketch or to the exporter.
+ *
+ * USAGE:
+ *   node tests/generate_unit_fixtures.js [output_dir]
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+const { parse, exportCompactAST } = require('../libs/ArduinoParser/src/ArduinoParser.js');
+const { unitSketches } = require('./unit_sketches.js');
+
+function main() {
+    const outputDir = process.argv[2] || path.join(__dirname, 'fixtures');
+    if (!fs.existsSync(outputDir)) {
+        fs.mkdirSync(outputDir);
+    }
+
+    let failures = 0;
+    unitSketches.forEach((sketch) => {
+        try {
+            const options = sketch.exportOptions || {};
+            const ast = parse(sketch.content, options);
+            const compactAST = exportCompactAST(ast, options);
+            fs.writeFileSync(path.join(outputDir, `${sketch.name}.ast`), Buffer.from(compactAST));
+            console.log(`${sketch.name}: ${compactAST.byteLength} bytes`);
+        } catch (error) {
+            failures++;
+            console.error(`❌ ${sketch.name} - ${error.message}`);
+        }
+    });
+
+    console.log(`${unitSketches.length - failures}/${unitSketches.length} unit sketches exported to ${outputDir}`);
+    process.exit(failures === 0 ? 0 : 1);
+}
+
+main();
@@ -0,0 +1,144 @@
+/**
+ * green_thread_test.cpp
+ *
+ * Verifies InterpreterOptions::greenThreads: FreeRTOS tasks created with
+ * xTaskCreate() run as cooperative green threads ordered by virtual wake
+ * time and priority, task deletion unwinds a task, and sketches without
+ * tasks produce the same command stream as without green threads.
+ *
+ * Usage: ./green_thread_test [test_data_dir]
+ *
+ * TASKS SKETCH: "green_thread_tasks" in tests/unit_sketches.js, 3 loop iterations
+ *
+ * DELETE SKETCH: "green_thread_delete" in tests/unit_sketches.js, 10 loop iterations
+ *
+ * EXPECTED RESULTS:
+ * - Tasks: sensor (priority 2) runs before blink; loop() prints 0, 3, 3;
+ *   both tasks end at their loop limit; the stream is identical across runs
+ * - Delete: oneShot prints 60 (recursion on its own stack) and never -1;
+ *   worker prints ticks 0, 30, 60, 90 until loop() deletes it
+ * - Corpus: identical streams with and without green threads
+ */
+
+#include "ASTInterpreter.hpp"
+#include "DeterministicDataProvider.hpp"
+#include "unit_test_helpers.hpp"
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> TASKS_AST = loadFixture("green_thread_tasks");
+static const std::vector<uint8_t> DELETE_AST = loadFixture("green_thread_delete");
+
+static std::string maskGeneratedIds(const std::string& json) {
+    static const std::regex pointerIds("(f?ptr)_[0-9]+_[0-9a-z]+");
+    static const std::regex longNumbers("[0-9]{9,}");
+    return std::regex_replace(std::regex_replace(json, pointerIds, "$1"), longNumbers, "N");
+}
+
+static std::vector<std::string> run(const uint8_t* ast, size_t size, uint32_t iterations, bool greenThreads) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+    opts.maxLoopIterations = iterations;
+    opts.greenThreads = greenThreads;
+
+    CollectingCallback callback;
+    DeterministicDataProvider provider;
+    {
+        ASTInterpreter interpreter(ast, size, opts);
+        interpreter.setCommandCallback(&callback);
+        interpreter.setSyncDataProvider(&provider);
+        interpreter.start();
+    }
+    for (auto& cmd : callback.commands) cmd = maskGeneratedIds(cmd);
+    return callback.commands;
+}
+
+// Value of a string field, or "" if absent
+static std::string field(const std::string& json, const std::string& name) {
+    std::string key = "\"" + name + "\":";
+    size_t pos = json.find(key);
+    if (pos == std::string::npos) return "";
+    pos += key.size();
+    if (json[pos] == '"') return json.substr(pos + 1, json.find('"', pos + 1) - pos - 1);
+    return json.substr(pos, json.find_first_of(",}", pos) - pos);
+}
+
+static std::vector<std::string> select(const std::vector<std::string>& commands, const std::string& type,
+                                       const std::string& valueField) {
+    std::vector<std::string> values;
+    for (const auto& cmd : commands) {
+        if (field(cmd, "type") == type || field(cmd, "function") == type) values.push_back(field(cmd, valueField));
+    }
+    return values;
+}
+
+static bool hasErrors(const std::vector<std::string>& commands) {
+    for (const auto& cmd : commands) {
+        if (field(cmd, "type") == "ERROR") return true;
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDir = argc > 1 ? argv[1] : "test_data";
+    int failures = 0;
+
+    // Two tasks and loop()
+    {
+        auto commands = run(TASKS_AST.data(), TASKS_AST.size(), 3, true);
+        auto switches = select(commands, "TASK_SWITCH", "task");
+        auto ended = select(commands, "TASK_END", "task");
+        auto printed = select(commands, "Serial.println", "data");
+        auto times = select(commands, "TASK_SWITCH", "virtualMicros");
+
+        failures += check(!hasErrors(commands), "tasks: no errors");
+        failures += check(!switches.empty() && switches.front() == "sensor", "tasks: higher priority task runs first");
+        failures += check(printed == std::vector<std::string>({"0", "3", "3"}), "tasks: loop() observes the sensor task");
+        failures += check(ended == std::vector<std::string>({"blink", "sensor"}), "tasks: both tasks end at their loop limit");
+        failures += check(!times.empty() && times.back() == "1000000", "tasks: virtual time follows the delays");
+        failures += check(commands == run(TASKS_AST.data(), TASKS_AST.size(), 3, true), "tasks: deterministic");
+    }
+
+    // Task deletion, vTaskDelayUntil(), recursion on a task stack
+    {
+        auto commands = run(DELETE_AST.data(), DELETE_AST.size(), 10, true);
+        auto printed = select(commands, "Serial.println", "data");
+        std::vector<std::string> expected = {"60", "0", "30", "60", "90"};
+        expected.insert(expected.end(), 10, "4");
+
+        failures += check(!hasErrors(commands), "delete: no errors");
+        failures += check(printed == expected, "delete: self-deleted and deleted tasks stop running");
+    }
+
+    // Sketches without tasks are unaffected
+    int tested = 0;
+    int mismatches = 0;
+    for (int n = 0; ; n++) {
+        auto ast = loadASTFile(dataDir + "/test" + std::to_string(n) + "_js.ast");
+        if (ast.empty()) break;
+        tested++;
+
+        auto plain = run(ast.data(), ast.size(), Config::TEST_MAX_LOOP_ITERATIONS, false);
+        auto green = run(ast.data(), ast.size(), Config::TEST_MAX_LOOP_ITERATIONS, true);
+        if (plain != green) {
+            mismatches++;
+            std::cout << "  FAIL  test" << n << ": stream differs with green threads\n";
+        }
+    }
+
+    if (tested == 0) {
+        std::cerr << "ERROR: No test ASTs found in " << dataDir << "\n";
+        return 1;
+    }
+    std::cout << tested - mismatches << "/" << tested << " sketches unchanged with green threads\n";
+
+    return failures + mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/**
+ * integer_model_test.cpp
+ *
+ * Verifies InterpreterOptions::intModel: ILP32 (ESP32) and AVR wrap char,
+ * short and int at their target widths, evaluate int * int at int width and
+ * size types like the target; HOST keeps every integer 32-bit. Also checks
+ * the IntegerModel kernels directly.
+ *
+ * Usage: ./integer_model_test
+ *
+ * TEST SKETCH: "integer_model" in tests/unit_sketches.js, setup() only
+ *
+ * EXPECTED RESULTS:
+ * - AVR: 4 -32536 65535 -5536 60000 2 3 44 4 (int is 16-bit)
+ * - ESP32: 4 33000 4294967295 60000 60000 4 3 44 4 (int is 32-bit)
+ * - HOST: 260 33000 4294967295 60000 60000 4 ... (no narrow types)
+ */
+
+#include "ASTInterpreter.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> INT_AST = loadFixture("integer_model");
+
+// Value of a field, or "" if absent
+static std::string field(const std::string& json, const std::string& name) {
+    std::string key = "\"" + name + "\":";
+    size_t pos = json.find(key);
+    if (pos == std::string::npos) return "";
+    pos += key.size();
+    if (json[pos] == '"') return json.substr(pos + 1, json.find('"', pos + 1) - pos - 1);
+    return json.substr(pos, json.find_first_of(",}", pos) - pos);
+}
+
+// Serial.println output of one run; "ERROR" marks an error command
+static std::vector<std::string> run(InterpreterOptions opts) {
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+    opts.maxLoopIterations = 10;   // Also bounds the for loop in setup()
+
+    CollectingCallback callback;
+    ASTInterpreter interpreter(INT_AST.data(), INT_AST.size(), opts);
+    interpreter.setCommandCallback(&callback);
+    interpreter.start();
+
+    std::vector<std::string> printed;
+    for (const auto& cmd : callback.commands) {
+        if (field(cmd, "function") == "Serial.println") printed.push_back(field(cmd, "data"));
+        if (field(cmd, "type") == "ERROR") printed.push_back("ERROR");
+    }
+    return printed;
+}
+
+static std::vector<std::string> runProfile(TargetProfile profile) {
+    InterpreterOptions opts;
+    applyTargetProfile(opts, profile);
+    return run(opts);
+}
+
+static std::string join(const std::vector<std::string>& values) {
+    std::string out;
+    for (const auto& value : values) out += (out.empty() ? "" : " ") + value;
+    return out;
+}
+
+template <typename T>
+static bool holds(const CommandValue& value, T expected) {
+    const auto* v = std::get_if<T>(&value);
+    return v && *v == expected;
+}
+
+int main() {
+    int failures = 0;
+
+    // Kernels
+    failures += check(intKindOf("int", IntModel::AVR) == IntKind::I16 && intKindOf("int", IntModel::ILP32) == IntKind::I32,
+                      "int is 16-bit on AVR, 32-bit on ILP32");
+    failures += check(intKindOf("char", IntModel::AVR) == IntKind::I8 && intKindOf("char", IntModel::ILP32) == IntKind::U8,
+                      "char is signed on AVR, unsigned on ILP32");
+    failures += check(intKindOf("volatile unsigned long", IntModel::AVR) == IntKind::U32 &&
+                      intKindOf("float", IntModel::AVR) == IntKind::NONE,
+                      "qualifiers are stripped, float has no integer kind");
+    failures += check(intKindOf("uint8_t", IntModel::HOST) == IntKind::U32, "HOST keeps 32-bit storage for uint8_t");
+    failures += check(holds<uint32_t>(narrowInt(CommandValue(uint32_t(256)), IntKind::U8), 0) &&
+                      holds<int32_t>(narrowInt(CommandValue(int32_t(200)), IntKind::I8), -56) &&
+                      holds<int32_t>(narrowInt(CommandValue(40000.0), IntKind::I16), -25536) &&
+                      holds<uint32_t>(narrowInt(CommandValue(-1.0), IntKind::U16), 65535),
+                      "narrowInt wraps and sign-extends");
+    failures += check(holds<int32_t>(narrowInt(CommandValue(3.9), IntKind::I32), 3) &&
+                      holds<std::string>(narrowInt(CommandValue(std::string("x")), IntKind::U8), std::string("x")),
+                      "narrowInt truncates doubles, passes non-numbers through");
+    failures += check(commonKind(IntKind::U8, IntKind::U8, IntModel::AVR) == IntKind::I16 &&
+                      commonKind(IntKind::U16, IntKind::I16, IntModel::AVR) == IntKind::U16 &&
+                      commonKind(IntKind::U16, IntKind::I32, IntModel::AVR) == IntKind::I32 &&
+                      commonKind(IntKind::U32, IntKind::I32, IntModel::ILP32) == IntKind::U32,
+                      "usual arithmetic conversions");
+    failures += check(targetSizeofType("int", IntModel::AVR) == 2 && targetSizeofType("char*", IntModel::AVR) == 2 &&
+                      targetSizeofType("long", IntModel::ILP32) == 4 && targetSizeofType("int", IntModel::HOST) == 0,
+                      "target sizeof");
+
+    // Interpreter
+    auto avr = runProfile(TargetProfile::AVR);
+    failures += check(avr == std::vector<std::string>({"4", "-32536", "65535", "-5536", "60000", "2", "3", "44", "4"}),
+                      "AVR: " + join(avr));
+
+    auto esp32 = runProfile(TargetProfile::ESP32);
+    failures += check(esp32 == std::vector<std::string>({"4", "33000", "4294967295", "60000", "60000", "4", "3", "44", "4"}),
+                      "ESP32: " + join(esp32));
+
+    auto host = runProfile(TargetProfile::HOST);
+    failures += check(host.size() == 9 && host[0] == "260" && host[1] == "33000" && host[2] == "4294967295" &&
+                      host[3] == "60000" && host[5] == "4",
+                      "HOST: " + join(host));
+
+    return failures == 0 ? 0 : 1;
+}
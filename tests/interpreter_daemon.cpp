@@ -0,0 +1,55 @@
+/**
+ * interpreter_daemon.cpp - Serve sketch runs over a UNIX domain socket
+ *
+ * Usage: ./interpreter_daemon <socket_path> [workers] [spares_per_program]
+ * Example: ./interpreter_daemon /tmp/asti.sock 8
+ *
+ * Data requests not covered by a request's input trace are answered by
+ * DeterministicDataProvider, so results match extract_cpp_commands.
+ * Runs until SIGINT or SIGTERM. Clients: src/cpp/DaemonClient.hpp
+ */
+
+#include "InterpreterDaemon.hpp"
+#include "DeterministicDataProvider.hpp"
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using namespace arduino_interpreter;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket_path> [workers] [spares_per_program]" << std::endl;
+        return 1;
+    }
+
+    DaemonOptions options;
+    options.socketPath = argv[1];
+    if (argc > 2) options.workers = static_cast<size_t>(std::stoul(argv[2]));
+    if (argc > 3) options.sparesPerProgram = static_cast<size_t>(std::stoul(argv[3]));
+    options.fallbackProvider = [] { return std::make_unique<DeterministicDataProvider>(); };
+
+    // Block the shutdown signals everywhere; the main thread waits for them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    InterpreterDaemon daemon(options);
+    if (!daemon.start()) {
+        std::cerr << "ERROR: " << daemon.getLastError() << std::endl;
+        return 1;
+    }
+    std::cerr << "Listening on " << options.socketPath << std::endl;
+
+    int received = 0;
+    sigwait(&signals, &received);
+    daemon.stop();
+
+    std::cerr << "Served " << daemon.getRequestsServed() << " requests ("
+              << daemon.getWarmStarts() << " warm starts, "
+              << daemon.getProgramCacheHits() << " program cache hits)" << std::endl;
+    return 0;
+}
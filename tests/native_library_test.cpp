@@ -0,0 +1,134 @@
+/**
+ * native_library_test.cpp
+ *
+ * Loads the example plugin (tests/native_plugins/counter_plugin.cpp) through
+ * ArduinoLibraryRegistry::loadNativeLibrary() and runs a sketch against it:
+ * constructor state, object methods, host callbacks, static methods, object
+ * cleanup and load errors.
+ *
+ * Usage: ./native_library_test <path/to/counter_plugin.so>
+ *
+ * TEST SKETCH: "native_library" in tests/unit_sketches.js, 2 loop iterations
+ * TEST SKETCH: "native_library_rebind" - a.value() after a = b, 2 loop iterations
+ *
+ * EXPECTED RESULTS:
+ * - println 16 then 27 (state lives in the plugin object across loops)
+ * - counter.reading() prints 42, the provider's "Counter"/"reading" value
+ * - Counter.clamp(300) == 255 via callStaticMethod()
+ * - Reloading the plugin leaves existing objects on their old definition
+ * - A bound a.value() call site follows a = b: 1, 100, 100, 100
+ * - The plugin object is destroyed with the interpreter
+ */
+
+#include "ASTInterpreter.hpp"
+#include "DeterministicDataProvider.hpp"
+#include "unit_test_helpers.hpp"
+#include <dlfcn.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> NATIVE_AST = loadFixture("native_library");
+static const std::vector<uint8_t> REBIND_AST = loadFixture("native_library_rebind");
+
+class CounterProvider : public DeterministicDataProvider {
+public:
+    int32_t getLibrarySensorValue(const std::string& libraryName, const std::string& methodName,
+                                  int32_t arg = 0) override {
+        if (libraryName == "Counter" && methodName == "reading") return 42;
+        return DeterministicDataProvider::getLibrarySensorValue(libraryName, methodName, arg);
+    }
+};
+
+static std::vector<std::string> printed(const std::vector<std::string>& commands) {
+    std::vector<std::string> lines;
+    const std::string marker = "\"function\":\"Serial.println\",\"arguments\":[\"";
+    for (const auto& cmd : commands) {
+        size_t pos = cmd.find(marker);
+        if (pos == std::string::npos) continue;
+        pos += marker.size();
+        lines.push_back(cmd.substr(pos, cmd.find('"', pos) - pos));
+    }
+    return lines;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <path/to/counter_plugin.so>" << std::endl;
+        return 1;
+    }
+    const std::string plugin = argv[1];
+    int failures = 0;
+
+    // Keep our own reference so the test hook stays callable after the interpreter is gone
+    void* handle = dlopen(plugin.c_str(), RTLD_NOW | RTLD_LOCAL);
+    auto liveObjects = handle ? reinterpret_cast<int32_t (*)()>(dlsym(handle, "counter_plugin_live_objects")) : nullptr;
+    failures += check(liveObjects != nullptr, "plugin test hook resolved");
+    if (!liveObjects) return 1;
+
+    {
+        InterpreterOptions opts;
+        opts.verbose = false;
+        opts.debug = false;
+        opts.syncMode = true;
+        opts.maxLoopIterations = 2;
+
+        CollectingCallback callback;
+        CounterProvider provider;
+        ASTInterpreter interpreter(NATIVE_AST.data(), NATIVE_AST.size(), opts);
+        interpreter.setCommandCallback(&callback);
+        interpreter.setSyncDataProvider(&provider);
+
+        std::string error;
+        auto* registry = interpreter.getLibraryRegistry();
+        failures += check(registry->loadNativeLibrary(plugin, &error), "plugin loads" + (error.empty() ? "" : " (" + error + ")"));
+        failures += check(registry->hasLibrary("Counter"), "Counter registered");
+        failures += check(registry->getLibraryDefinition("Counter")->externalMethods.count("reset") == 1,
+                          "external methods registered");
+
+        interpreter.start();
+
+        auto lines = printed(callback.commands);
+        failures += check(lines == std::vector<std::string>{"16", "42", "27", "42"}, "object state and host callback");
+        failures += check(liveObjects() == 1, "one plugin object alive while running");
+
+        auto clamped = registry->callStaticMethod("Counter", "clamp", {CommandValue(300)});
+        failures += check(std::holds_alternative<int32_t>(clamped) && std::get<int32_t>(clamped) == 255,
+                          "static method");
+
+        error.clear();
+        failures += check(!registry->loadNativeLibrary(plugin + ".missing", &error) && !error.empty(),
+                          "missing plugin reported");
+
+        failures += check(registry->loadNativeLibrary(plugin, &error), "plugin reloads");
+        auto value = registry->callObjectMethod("Counter_1", "value", {});
+        failures += check(std::holds_alternative<int32_t>(value) && std::get<int32_t>(value) == 27 &&
+                          liveObjects() == 1,
+                          "object keeps its definition when the library is re-registered");
+    }
+    failures += check(liveObjects() == 0, "plugin object destroyed with the interpreter");
+
+    {
+        InterpreterOptions opts;
+        opts.verbose = false;
+        opts.debug = false;
+        opts.syncMode = true;
+        opts.maxLoopIterations = 2;
+
+        CollectingCallback callback;
+        ASTInterpreter interpreter(REBIND_AST.data(), REBIND_AST.size(), opts);
+        interpreter.setCommandCallback(&callback);
+        interpreter.getLibraryRegistry()->loadNativeLibrary(plugin);
+        interpreter.start();
+
+        failures += check(printed(callback.commands) == std::vector<std::string>{"1", "100", "100", "100"},
+                          "bound method call follows the reassigned object");
+    }
+    failures += check(liveObjects() == 0, "both plugin objects destroyed with the second interpreter");
+
+    dlclose(handle);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/**
+ * counter_plugin.cpp - Example native library plugin (NativeLibraryABI.h)
+ *
+ * Simulates a "Counter" class natively, as an in-house library would:
+ *   Counter c = Counter(start);   c.increment();  c.add(n);  c.value();
+ *   c.reading()                   -> SyncDataProvider "Counter"/"reading"
+ *   Counter.clamp(x)              -> static, x limited to 0..255
+ *   c.reset()                     -> external (left to the parent app)
+ *
+ * Built as a MODULE by CMake and loaded by native_library_test.
+ */
+
+#include "NativeLibraryABI.h"
+#include <stddef.h>
+
+namespace {
+
+struct CounterState {
+    int32_t count;
+};
+
+int32_t liveCounters = 0;
+
+int32_t intArg(const ArduinoNativeValue* args, uint32_t argc, uint32_t index, int32_t fallback) {
+    if (index >= argc) return fallback;
+    if (args[index].type == ARDUINO_NATIVE_DOUBLE) return static_cast<int32_t>(args[index].asDouble);
+    if (args[index].type == ARDUINO_NATIVE_INT || args[index].type == ARDUINO_NATIVE_BOOL) return args[index].asInt;
+    return fallback;
+}
+
+void setInt(ArduinoNativeValue* result, int32_t value) {
+    result->type = ARDUINO_NATIVE_INT;
+    result->asInt = value;
+}
+
+void* counterCreate(const ArduinoNativeValue* args, uint32_t argc, const ArduinoNativeHost*) {
+    liveCounters++;
+    return new CounterState{intArg(args, argc, 0, 0)};
+}
+
+void counterDestroy(void* state) {
+    liveCounters--;
+    delete static_cast<CounterState*>(state);
+}
+
+void counterIncrement(void* state, const ArduinoNativeValue*, uint32_t, ArduinoNativeValue*, const ArduinoNativeHost*) {
+    static_cast<CounterState*>(state)->count++;
+}
+
+void counterAdd(void* state, const ArduinoNativeValue* args, uint32_t argc, ArduinoNativeValue*, const ArduinoNativeHost*) {
+    static_cast<CounterState*>(state)->count += intArg(args, argc, 0, 0);
+}
+
+void counterValue(void* state, const ArduinoNativeValue*, uint32_t, ArduinoNativeValue* result, const ArduinoNativeHost*) {
+    setInt(result, static_cast<CounterState*>(state)->count);
+}
+
+void counterReading(void*, const ArduinoNativeValue*, uint32_t, ArduinoNativeValue* result, const ArduinoNativeHost* host) {
+    setInt(result, host->sensorValue(host->context, "Counter", "reading", 0));
+}
+
+void counterClamp(void*, const ArduinoNativeValue* args, uint32_t argc, ArduinoNativeValue* result, const ArduinoNativeHost*) {
+    int32_t x = intArg(args, argc, 0, 0);
+    setInt(result, x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+const char* const constructorArgs[] = {"start"};
+
+const ArduinoNativeMethod methods[] = {
+    {"increment", &counterIncrement},
+    {"add", &counterAdd},
+    {"value", &counterValue},
+    {"reading", &counterReading},
+};
+
+const ArduinoNativeMethod staticMethods[] = {
+    {"clamp", &counterClamp},
+};
+
+const char* const externalMethods[] = {"reset"};
+
+const ArduinoNativeLibrary libraries[] = {{
+    sizeof(ArduinoNativeLibrary), "Counter",
+    constructorArgs, 1,
+    &counterCreate, &counterDestroy,
+    methods, sizeof(methods) / sizeof(methods[0]),
+    staticMethods, 1,
+    externalMethods, 1,
+}};
+
+const ArduinoNativeModule module = {ARDUINO_NATIVE_ABI_VERSION, 1, libraries};
+
+} // anonymous namespace
+
+extern "C" {
+
+ARDUINO_NATIVE_EXPORT const ArduinoNativeModule* arduino_native_module(uint32_t hostAbiVersion) {
+    return hostAbiVersion == ARDUINO_NATIVE_ABI_VERSION ? &module : NULL;
+}
+
+// Test hook: objects whose state has not been destroyed yet
+ARDUINO_NATIVE_EXPORT int32_t counter_plugin_live_objects() {
+    return liveCounters;
+}
+
+}
@@ -0,0 +1,836 @@
+/**
+ * perf_fuzz.cpp
+ *
+ * Grammar-aware performance fuzzer: builds random, well-formed sketches
+ * directly through the arduino_ast node constructors, grows them along one
+ * or more dimensions and flags work that grows faster than the sketch does.
+ *
+ * Usage: ./perf_fuzz [--seeds N] [--first-seed S] [--rungs N] [--threshold EXPONENT]
+ *                    [--known FILE] [--out DIR] [--inject-quadratic]
+ *                    [--expect-superlinear METRIC]
+ *
+ *   --seeds N            Inputs to generate (default 20)
+ *   --first-seed S       Seed of the first input (default 1)
+ *   --rungs N            Sizes per ladder, each twice the last (default 5)
+ *   --threshold X        Growth exponent above which a counter is superlinear (default 1.5)
+ *   --known FILE         Findings to report without failing (one key per line, # comments)
+ *   --out DIR            Save minimized reproducers as CompactAST files in DIR
+ *   --inject-quadratic   Allocate n^2 bytes per run (checks the detector itself)
+ *   --expect-superlinear METRIC  Succeed only if some input is superlinear in METRIC
+ *
+ * INPUTS: a seed, a set of grammar features and a set of scaled dimensions.
+ *   Features: straight (random statements), locals, globals, arrays (a global
+ *   array filled element by element), calls (one function per fan-out slot,
+ *   each called once), nesting (if/for/while/do/block wrappers around the
+ *   body), recursion (a recursive function as deep as the nesting).
+ *   Dimensions: statements (straight, locals, globals), depth (nesting,
+ *   recursion), arraySize, fanOut (calls).
+ * The seed picks the productions: statement kinds, operators, operands, the
+ * control structure of every nesting level and the order of the calls. The
+ * ladder doubles every scaled dimension from its base value and rebuilds
+ * the sketch at each rung; the same seed gives the same sketch shape.
+ *
+ * COSTS per rung, counted by this file's operator new and a command callback:
+ * - loadAllocations, loadBytes: ASTInterpreter construction (CompactASTReader
+ *   parse, canonicalization, registries)
+ * - runAllocations, runBytes: setup() and one loop()
+ * - commandBytes: JSON emitted
+ * - loadNs, runNs: wall time, reported but never flagged (noisy)
+ *
+ * VERDICT: a counter's marginal cost per rung is fitted against the scale
+ * factor (load counters: the node count) on a log-log scale, so fixed costs
+ * don't hide the trend. Linear work gives 1.0, quadratic work tends to 2.0.
+ * Counters that grow by less than 5% over the ladder are not fitted.
+ *
+ * MINIMIZATION: a superlinear input is reduced one step at a time while the
+ * same counter stays superlinear: features are dropped, then scaled
+ * dimensions, then the base sizes of the rest are halved. The result is keyed
+ * "<dimensions> <counter> <features>"; with --out every rung of it is saved
+ * as <key>-x<scale>.ast (read back with CompactASTReader to check it).
+ *
+ * Exit code 1 if a generated sketch emits an ERROR (a generator bug), or on
+ * any finding not in --known (with --expect-superlinear: if METRIC never is).
+ */
+
+#include "ASTInterpreter.hpp"
+#include "CompactAST.hpp"
+#include "ExecutionTracer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_ast;
+
+// =============================================================================
+// ALLOCATION ACCOUNTING
+// =============================================================================
+
+// Cumulative counts: every allocation is work, freed or not. Sizes ride in a
+// header so delete can stay symmetric with soak_test.cpp's accounting.
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_allocatedBytes{0};
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+void* trackedAlloc(size_t size) noexcept {
+    void* block = std::malloc(size + HEADER);
+    if (!block) return nullptr;
+    *static_cast<size_t*>(block) = size;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<char*>(block) + HEADER;
+}
+
+void trackedFree(void* pointer) noexcept {
+    if (!pointer) return;
+    std::free(static_cast<char*>(pointer) - HEADER);
+}
+
+void* trackedNew(size_t size) {
+    void* pointer = trackedAlloc(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return trackedNew(size); }
+void* operator new[](size_t size) { return trackedNew(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void operator delete(void* pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { trackedFree(pointer); }
+
+// =============================================================================
+// INPUTS
+// =============================================================================
+
+enum Feature : uint32_t {
+    STRAIGHT = 1u << 0,
+    LOCALS = 1u << 1,
+    GLOBALS = 1u << 2,
+    ARRAYS = 1u << 3,
+    CALLS = 1u << 4,
+    NESTING = 1u << 5,
+    RECURSION = 1u << 6,
+    FEATURE_COUNT = 7
+};
+
+static const char* const FEATURE_NAMES[FEATURE_COUNT] = {
+    "straight", "locals", "globals", "arrays", "calls", "nesting", "recursion"};
+
+enum Dimension : uint32_t { STATEMENTS = 0, DEPTH = 1, ARRAY_SIZE = 2, FAN_OUT = 3, DIMENSION_COUNT = 4 };
+
+static const char* const DIMENSION_NAMES[DIMENSION_COUNT] = {"statements", "depth", "arraySize", "fanOut"};
+
+// Features that grow with each dimension
+static const uint32_t DIMENSION_FEATURES[DIMENSION_COUNT] = {
+    STRAIGHT | LOCALS | GLOBALS, NESTING | RECURSION, ARRAYS, CALLS};
+
+enum Metric : size_t {
+    LOAD_ALLOCATIONS, LOAD_BYTES, RUN_ALLOCATIONS, RUN_BYTES, COMMAND_BYTES, LOAD_NS, RUN_NS, METRIC_COUNT
+};
+
+static const char* const METRIC_NAMES[METRIC_COUNT] = {
+    "loadAllocations", "loadBytes", "runAllocations", "runBytes", "commandBytes", "loadNs", "runNs"};
+
+static bool isFlaggable(size_t metric) { return metric != LOAD_NS && metric != RUN_NS; }
+
+struct FuzzInput {
+    uint64_t seed = 1;
+    uint32_t features = 0;
+    uint32_t scaled = 0;                                   // Bit per Dimension
+    uint32_t base[DIMENSION_COUNT] = {4, 2, 32, 2};         // Size of each dimension at rung 0
+
+    uint32_t size(Dimension dimension, uint32_t scale) const {
+        return (scaled & (1u << dimension)) ? base[dimension] * scale : base[dimension];
+    }
+};
+
+static std::string joinNames(uint32_t mask, const char* const* names, size_t count) {
+    std::string joined;
+    for (size_t i = 0; i < count; i++) {
+        if (!(mask & (1u << i))) continue;
+        if (!joined.empty()) joined += "+";
+        joined += names[i];
+    }
+    return joined.empty() ? "-" : joined;
+}
+
+static std::string findingKey(const FuzzInput& input, size_t metric) {
+    return joinNames(input.scaled, DIMENSION_NAMES, DIMENSION_COUNT) + " " + METRIC_NAMES[metric] + " " +
+           joinNames(input.features, FEATURE_NAMES, FEATURE_COUNT);
+}
+
+// =============================================================================
+// SKETCH GENERATOR
+// =============================================================================
+
+/**
+ * Builds one sketch. Names are fixed by position (v3, g3, f3), values and
+ * shapes come from the seed; every value stays within 0..1023 so nothing
+ * depends on overflow behaviour.
+ */
+class SketchGenerator {
+public:
+    SketchGenerator(const FuzzInput& input, uint32_t scale) : input_(input), scale_(scale), random_(input.seed) {}
+
+    ASTNodePtr build() {
+        auto program = std::make_unique<ProgramNode>();
+        const uint32_t statements = input_.size(STATEMENTS, scale_);
+        const uint32_t depth = input_.size(DEPTH, scale_);
+        const uint32_t arraySize = input_.size(ARRAY_SIZE, scale_);
+        const uint32_t fanOut = input_.size(FAN_OUT, scale_);
+
+        program->addChild(varDecl("int", "acc", number(0)));
+        section(1);
+        if (has(GLOBALS)) {
+            for (uint32_t i = 0; i < statements; i++) {
+                std::string name = "g" + std::to_string(i);
+                program->addChild(varDecl("int", name, number(literal())));
+                globals_.push_back(name);
+            }
+        }
+        if (has(ARRAYS)) program->addChild(arrayDecl("int", "arr", arraySize));
+        section(2);
+        if (has(CALLS)) {
+            for (uint32_t i = 0; i < fanOut; i++) program->addChild(callee(i));
+        }
+        if (has(RECURSION)) program->addChild(recursive());
+
+        section(3);
+        auto setup = block();
+        setup->addChild(expressionStatement(call("pinMode", number(13), number(1))));
+        setup->addChild(assign("acc", number(literal())));
+        program->addChild(funcDef("void", "setup", "", std::move(setup)));
+
+        auto body = block();
+        scope_ = globals_;
+        section(4);
+        if (has(LOCALS)) {
+            for (uint32_t i = 0; i < statements; i++) {
+                std::string name = "v" + std::to_string(i);
+                body->addChild(varDecl("int", name, expression(2)));
+                scope_.push_back(name);
+            }
+        }
+        if (has(GLOBALS)) {
+            for (const auto& name : globals_) {
+                body->addChild(assign("acc", masked(binary("^", identifier("acc"), identifier(name)))));
+            }
+        }
+        section(5);
+        if (has(STRAIGHT)) {
+            for (uint32_t i = 0; i < statements; i++) body->addChild(statement());
+        }
+        section(6);
+        if (has(ARRAYS)) body->addChild(fillArray(arraySize));
+        if (has(CALLS)) {
+            std::vector<uint32_t> order(fanOut);
+            for (uint32_t i = 0; i < fanOut; i++) order[i] = i;
+            section(7);
+            std::shuffle(order.begin(), order.end(), random_);
+            for (uint32_t i : order) {
+                body->addChild(assign("acc", call("f" + std::to_string(i), identifier("acc"))));
+            }
+        }
+        if (has(RECURSION)) {
+            body->addChild(assign("acc", masked(binary("+", identifier("acc"), call("rec", number(depth))))));
+        }
+        body->addChild(expressionStatement(call("digitalWrite", number(13), binary("&", identifier("acc"), number(1)))));
+
+        section(8);
+        if (has(NESTING)) {
+            for (uint32_t level = 0; level < depth; level++) body = nest(std::move(body), level);
+        }
+        program->addChild(funcDef("void", "loop", "", std::move(body)));
+        return program;
+    }
+
+private:
+    bool has(Feature feature) const { return (input_.features & feature) != 0; }
+
+    // Each section draws from its own stream, so dropping a feature during
+    // minimization leaves the productions of the others unchanged
+    void section(uint64_t id) { random_.seed(input_.seed * 0x9e3779b97f4a7c15ULL + id); }
+    uint32_t pick(uint32_t count) { return static_cast<uint32_t>(random_() % count); }
+    double literal() { return static_cast<double>(pick(100)); }
+
+    // --- Leaves and expressions ---
+
+    static ASTNodePtr number(double value) { return std::make_unique<NumberNode>(value); }
+    static ASTNodePtr identifier(const std::string& name) { return std::make_unique<IdentifierNode>(name); }
+
+    static ASTNodePtr binary(const std::string& op, ASTNodePtr left, ASTNodePtr right) {
+        auto node = std::make_unique<BinaryOpNode>();
+        node->setValue(op);
+        node->setLeft(std::move(left));
+        node->setRight(std::move(right));
+        return node;
+    }
+
+    static ASTNodePtr masked(ASTNodePtr value) { return binary("&", std::move(value), number(1023)); }
+
+    ASTNodePtr operand() {
+        uint32_t choice = pick(3);
+        if (choice == 0 || scope_.empty()) return choice == 2 ? identifier("acc") : number(literal());
+        return choice == 1 ? identifier("acc") : identifier(scope_[pick(static_cast<uint32_t>(scope_.size()))]);
+    }
+
+    // No * or / : values stay in 0..1023 through & and ^ and | of masked terms
+    ASTNodePtr expression(uint32_t depth) {
+        if (depth == 0 || pick(3) == 0) return operand();
+        static const char* const ops[] = {"+", "^", "|", "&", "-"};
+        const char* op = ops[pick(5)];
+        return masked(binary(op, expression(depth - 1), expression(depth - 1)));
+    }
+
+    // --- Statements ---
+
+    static ASTNodePtr expressionStatement(ASTNodePtr expression) {
+        auto node = std::make_unique<ExpressionStatement>();
+        node->setExpression(std::move(expression));
+        return node;
+    }
+
+    static ASTNodePtr assignTo(ASTNodePtr target, ASTNodePtr value, const std::string& op = "=") {
+        auto node = std::make_unique<AssignmentNode>();
+        node->setOperator(op);
+        node->setLeft(std::move(target));
+        node->setRight(std::move(value));
+        return expressionStatement(std::move(node));
+    }
+
+    static ASTNodePtr assign(const std::string& name, ASTNodePtr value) { return assignTo(identifier(name), std::move(value)); }
+
+    template <typename... Args>
+    static ASTNodePtr call(const std::string& name, Args&&... args) {
+        auto node = std::make_unique<FuncCallNode>();
+        node->setCallee(identifier(name));
+        (node->addArgument(std::forward<Args>(args)), ...);
+        return node;
+    }
+
+    static std::unique_ptr<CompoundStmtNode> block() { return std::make_unique<CompoundStmtNode>(); }
+
+    static ASTNodePtr varDecl(const std::string& type, const std::string& name, ASTNodePtr initializer) {
+        auto node = std::make_unique<VarDeclNode>();
+        node->setVarType(std::make_unique<TypeNode>(type));
+        auto declarator = std::make_unique<DeclaratorNode>(name);
+        declarator->addChild(std::move(initializer));
+        node->addDeclaration(std::move(declarator));
+        return node;
+    }
+
+    static ASTNodePtr arrayDecl(const std::string& type, const std::string& name, uint32_t size) {
+        auto node = std::make_unique<VarDeclNode>();
+        node->setVarType(std::make_unique<TypeNode>(type));
+        auto declarator = std::make_unique<ArrayDeclaratorNode>();
+        declarator->setIdentifier(identifier(name));
+        declarator->addDimension(number(size));
+        node->addDeclaration(std::move(declarator));
+        return node;
+    }
+
+    static ASTNodePtr funcDef(const std::string& type, const std::string& name, const std::string& param,
+                              ASTNodePtr body) {
+        auto node = std::make_unique<FuncDefNode>();
+        node->setReturnType(std::make_unique<TypeNode>(type));
+        node->setDeclarator(std::make_unique<DeclaratorNode>(name));
+        if (!param.empty()) {
+            auto parameter = std::make_unique<ParamNode>();
+            parameter->setParamType(std::make_unique<TypeNode>("int"));
+            parameter->setDeclarator(std::make_unique<DeclaratorNode>(param));
+            node->addParameter(std::move(parameter));
+        }
+        node->setBody(std::move(body));
+        return node;
+    }
+
+    static ASTNodePtr returnStatement(ASTNodePtr value) {
+        auto node = std::make_unique<ReturnStatement>();
+        node->setReturnValue(std::move(value));
+        return node;
+    }
+
+    static ASTNodePtr postfix(const std::string& name, const std::string& op) {
+        auto node = std::make_unique<PostfixExpressionNode>();
+        node->setOperand(identifier(name));
+        node->setOperator(op);
+        return node;
+    }
+
+    static ASTNodePtr wrap(ASTNodePtr statement) {
+        auto body = block();
+        body->addChild(std::move(statement));
+        return body;
+    }
+
+    ASTNodePtr statement() {
+        switch (pick(5)) {
+            case 0:
+                return assign("acc", expression(2));
+            case 1: {
+                static const char* const ops[] = {"^=", "|=", "&="};
+                return assignTo(identifier("acc"), expression(1), ops[pick(3)]);
+            }
+            case 2: {
+                auto node = std::make_unique<IfStatement>();
+                node->setCondition(binary(">", expression(1), number(literal())));
+                node->setConsequent(wrap(assign("acc", expression(1))));
+                if (pick(2)) node->setAlternate(wrap(assign("acc", expression(1))));
+                return node;
+            }
+            case 3: {
+                auto node = std::make_unique<TernaryExpressionNode>();
+                node->setCondition(binary("<", identifier("acc"), number(512)));
+                node->setTrueExpression(expression(1));
+                node->setFalseExpression(number(literal()));
+                return assign("acc", std::move(node));
+            }
+            default:
+                return expressionStatement(call("digitalWrite", number(13), binary("&", expression(1), number(1))));
+        }
+    }
+
+    // for (int i = 0; i < size; i++) { arr[i] = (i ^ k) & 1023; }
+    ASTNodePtr fillArray(uint32_t size) {
+        auto loop = std::make_unique<ForStatement>();
+        loop->setInitializer(varDecl("int", "i", number(0)));
+        loop->setCondition(binary("<", identifier("i"), number(size)));
+        loop->setIncrement(postfix("i", "++"));
+        auto element = std::make_unique<ArrayAccessNode>();
+        element->setIdentifier(identifier("arr"));
+        element->setIndex(identifier("i"));
+        loop->setBody(wrap(assignTo(std::move(element), masked(binary("^", identifier("i"), number(literal()))))));
+        return loop;
+    }
+
+    // int fN(int x) { x = <expression over x>; return x; }
+    ASTNodePtr callee(uint32_t index) {
+        auto body = block();
+        std::vector<std::string> saved = scope_;
+        scope_ = {"x"};
+        body->addChild(assign("x", masked(binary("^", identifier("x"), expression(1)))));
+        scope_ = saved;
+        body->addChild(returnStatement(identifier("x")));
+        return funcDef("int", "f" + std::to_string(index), "x", std::move(body));
+    }
+
+    // int rec(int n) { if (n <= 0) { return 0; } return rec(n - 1) + 1; }
+    ASTNodePtr recursive() {
+        auto body = block();
+        auto base = std::make_unique<IfStatement>();
+        base->setCondition(binary("<=", identifier("n"), number(0)));
+        base->setConsequent(wrap(returnStatement(number(0))));
+        body->addChild(std::move(base));
+        body->addChild(returnStatement(binary("+", call("rec", binary("-", identifier("n"), number(1))), number(1))));
+        return funcDef("int", "rec", "n", std::move(body));
+    }
+
+    // One level of nesting around `inner`; every variant runs its body exactly once
+    std::unique_ptr<CompoundStmtNode> nest(ASTNodePtr inner, uint32_t level) {
+        const std::string counter = "n" + std::to_string(level);
+        auto outer = block();
+        switch (pick(5)) {
+            case 0: {
+                auto node = std::make_unique<IfStatement>();
+                node->setCondition(binary(">=", identifier("acc"), number(0)));
+                node->setConsequent(std::move(inner));
+                outer->addChild(std::move(node));
+                break;
+            }
+            case 1: {
+                auto node = std::make_unique<ForStatement>();
+                node->setInitializer(varDecl("int", counter, number(0)));
+                node->setCondition(binary("<", identifier(counter), number(1)));
+                node->setIncrement(postfix(counter, "++"));
+                node->setBody(std::move(inner));
+                outer->addChild(std::move(node));
+                break;
+            }
+            case 2: {
+                outer->addChild(varDecl("int", counter, number(0)));
+                auto node = std::make_unique<WhileStatement>();
+                node->setCondition(binary("<", identifier(counter), number(1)));
+                auto body = block();
+                body->addChild(expressionStatement(postfix(counter, "++")));
+                body->addChild(std::move(inner));
+                node->setBody(std::move(body));
+                outer->addChild(std::move(node));
+                break;
+            }
+            case 3: {
+                auto node = std::make_unique<DoWhileStatement>();
+                node->setBody(std::move(inner));
+                node->setCondition(binary("<", identifier("acc"), number(0)));
+                outer->addChild(std::move(node));
+                break;
+            }
+            default:
+                outer->addChild(std::move(inner));
+                break;
+        }
+        return outer;
+    }
+
+    const FuzzInput& input_;
+    uint32_t scale_;
+    std::mt19937_64 random_;
+    std::vector<std::string> globals_;
+    std::vector<std::string> scope_;   // Variables an expression may read
+};
+
+// =============================================================================
+// MEASUREMENT
+// =============================================================================
+
+class CountingCallback : public CommandCallback {
+public:
+    void onCommand(const std::string& jsonCommand) override {
+        bytes += jsonCommand.size();
+        if (error.empty() && jsonCommand.find("\"type\":\"ERROR\"") != std::string::npos) error = jsonCommand;
+    }
+
+    uint64_t bytes = 0;
+    std::string error;
+};
+
+struct Rung {
+    uint32_t scale = 1;
+    size_t nodes = 0;
+    std::vector<uint8_t> ast;
+    double cost[METRIC_COUNT] = {};
+};
+
+struct LadderResult {
+    std::vector<Rung> rungs;
+    double exponent[METRIC_COUNT] = {};    // NaN when not fitted
+    std::string error;                     // First ERROR command, if any
+};
+
+struct FuzzOptions {
+    uint64_t seeds = 20;
+    uint64_t firstSeed = 1;
+    uint32_t rungs = 5;
+    double threshold = 1.5;
+    std::string known;
+    std::string out;
+    bool injectQuadratic = false;
+};
+
+static std::vector<uint8_t> compile(const FuzzInput& input, uint32_t scale) {
+    ASTNodePtr root = SketchGenerator(input, scale).build();
+    return CompactASTWriter().write(root.get());
+}
+
+static Rung measure(const FuzzInput& input, uint32_t scale, const FuzzOptions& options, std::string& error) {
+    Rung rung;
+    rung.scale = scale;
+    rung.ast = compile(input, scale);
+    rung.nodes = getCompactASTNodeCount(rung.ast.data(), rung.ast.size());
+
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+    opts.maxLoopIterations = 1;
+    opts.enforceLoopLimitsOnInternalLoops = false;
+
+    CountingCallback callback;
+    TRACE_CLEAR();   // The trace is per thread; earlier rungs must not pay for this one
+    auto counters = [] {
+        return std::make_pair(static_cast<double>(g_allocations.load(std::memory_order_relaxed)),
+                              static_cast<double>(g_allocatedBytes.load(std::memory_order_relaxed)));
+    };
+
+    auto start = counters();
+    auto clock = std::chrono::steady_clock::now();
+    auto interpreter = std::make_unique<ASTInterpreter>(rung.ast.data(), rung.ast.size(), opts);
+    auto loaded = counters();
+    auto loadedClock = std::chrono::steady_clock::now();
+
+    interpreter->setCommandCallback(&callback);
+    interpreter->start();
+    if (options.injectQuadratic) {
+        for (uint32_t i = 0; i < scale; i++) delete[] new char[static_cast<size_t>(scale) * 64];
+    }
+    auto ran = counters();
+    auto ranClock = std::chrono::steady_clock::now();
+    interpreter.reset();
+
+    rung.cost[LOAD_ALLOCATIONS] = loaded.first - start.first;
+    rung.cost[LOAD_BYTES] = loaded.second - start.second;
+    rung.cost[RUN_ALLOCATIONS] = ran.first - loaded.first;
+    rung.cost[RUN_BYTES] = ran.second - loaded.second;
+    rung.cost[COMMAND_BYTES] = static_cast<double>(callback.bytes);
+    rung.cost[LOAD_NS] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(loadedClock - clock).count());
+    rung.cost[RUN_NS] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(ranClock - loadedClock).count());
+    if (error.empty()) error = callback.error;
+    return rung;
+}
+
+/**
+ * Growth exponent from marginal costs: m_k = (cost_k - cost_k-1) / (scale_k -
+ * scale_k-1) is constant for linear work and doubles per rung for quadratic
+ * work, so 1 + the least-squares slope of log(m_k) over log(scale_k) is 1.0
+ * and 2.0 for them, whatever the fixed cost. NaN if the counter grew by less
+ * than 5% over the ladder or did not grow on some step. Load costs are fitted
+ * over the node count instead: loading works on the tree, and one more nesting
+ * level is not the same number of nodes whichever construct it wraps.
+ */
+static double growthExponent(const std::vector<Rung>& rungs, size_t metric) {
+    const double first = rungs.front().cost[metric];
+    const double last = rungs.back().cost[metric];
+    if (rungs.size() < 3 || last - first < 0.05 * std::max(first, 1.0)) return NAN;
+
+    const bool load = metric == LOAD_ALLOCATIONS || metric == LOAD_BYTES || metric == LOAD_NS;
+    auto size = [load](const Rung& rung) { return static_cast<double>(load ? rung.nodes : rung.scale); };
+
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = 1; i < rungs.size(); i++) {
+        double step = size(rungs[i]) - size(rungs[i - 1]);
+        double marginal = (rungs[i].cost[metric] - rungs[i - 1].cost[metric]) / step;
+        if (step <= 0 || marginal <= 0) return NAN;
+        double x = std::log(size(rungs[i]));
+        double y = std::log(marginal);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double n = static_cast<double>(rungs.size() - 1);
+    return 1.0 + (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+static LadderResult runLadder(const FuzzInput& input, const FuzzOptions& options) {
+    LadderResult result;
+    for (uint32_t r = 0, scale = 1; r < options.rungs; r++, scale *= 2) {
+        result.rungs.push_back(measure(input, scale, options, result.error));
+    }
+    for (size_t m = 0; m < METRIC_COUNT; m++) result.exponent[m] = growthExponent(result.rungs, m);
+    return result;
+}
+
+static bool superlinear(const LadderResult& result, size_t metric, const FuzzOptions& options) {
+    return isFlaggable(metric) && result.error.empty() && result.exponent[metric] > options.threshold;
+}
+
+// =============================================================================
+// MINIMIZATION
+// =============================================================================
+
+/**
+ * One-at-a-time reduction (1-minimal, like ddmin at granularity one): each
+ * accepted step keeps `metric` superlinear.
+ */
+static FuzzInput minimize(FuzzInput input, size_t metric, const FuzzOptions& options) {
+    auto stillSuperlinear = [&](const FuzzInput& candidate) {
+        return superlinear(runLadder(candidate, options), metric, options);
+    };
+
+    for (bool reduced = true; reduced;) {
+        reduced = false;
+        for (uint32_t bit = 0; bit < FEATURE_COUNT; bit++) {
+            if (!(input.features & (1u << bit))) continue;
+            FuzzInput candidate = input;
+            candidate.features &= ~(1u << bit);
+            if (stillSuperlinear(candidate)) {
+                input = candidate;
+                reduced = true;
+            }
+        }
+        for (uint32_t dimension = 0; dimension < DIMENSION_COUNT; dimension++) {
+            if (!(input.scaled & (1u << dimension)) || input.scaled == (1u << dimension)) continue;
+            FuzzInput candidate = input;
+            candidate.scaled &= ~(1u << dimension);
+            if (stillSuperlinear(candidate)) {
+                input = candidate;
+                reduced = true;
+            }
+        }
+    }
+
+    for (uint32_t dimension = 0; dimension < DIMENSION_COUNT; dimension++) {
+        while (input.base[dimension] > 1) {
+            FuzzInput candidate = input;
+            candidate.base[dimension] /= 2;
+            if (!stillSuperlinear(candidate)) break;
+            input = candidate;
+        }
+    }
+    return input;
+}
+
+static bool saveReproducer(const FuzzInput& input, size_t metric, const FuzzOptions& options) {
+    std::string key = findingKey(input, metric);
+    std::replace(key.begin(), key.end(), ' ', '-');
+    for (uint32_t r = 0, scale = 1; r < options.rungs; r++, scale *= 2) {
+        ASTNodePtr root = SketchGenerator(input, scale).build();
+        std::vector<uint8_t> ast = CompactASTWriter().write(root.get());
+
+        // The file must read back into the tree that was measured
+        CompactASTReader reader(ast.data(), ast.size());
+        ASTNodePtr readBack = reader.parse();
+        if (!readBack || CompactASTWriter().write(readBack.get()) != ast) {
+            std::cerr << "ERROR: reproducer " << key << " does not round-trip\n";
+            return false;
+        }
+
+        std::string path = options.out + "/" + key + "-x" + std::to_string(scale) + ".ast";
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(ast.data()), static_cast<std::streamsize>(ast.size()));
+        if (!file) {
+            std::cerr << "ERROR: cannot write " << path << "\n";
+            return false;
+        }
+    }
+    std::cout << "    saved " << options.out << "/" << key << "-x*.ast\n";
+    return true;
+}
+
+// =============================================================================
+// CAMPAIGN
+// =============================================================================
+
+static FuzzInput randomInput(uint64_t seed) {
+    std::mt19937_64 random(seed * 0x9e3779b97f4a7c15ULL);
+    FuzzInput input;
+    input.seed = seed;
+    while (input.features == 0) input.features = static_cast<uint32_t>(random() % (1u << FEATURE_COUNT));
+    // Scale only dimensions the features grow with
+    uint32_t relevant = 0;
+    for (uint32_t d = 0; d < DIMENSION_COUNT; d++) {
+        if (input.features & DIMENSION_FEATURES[d]) relevant |= 1u << d;
+    }
+    while (input.scaled == 0) input.scaled = static_cast<uint32_t>(random() % (1u << DIMENSION_COUNT)) & relevant;
+    return input;
+}
+
+static void printLadder(const FuzzInput& input, const LadderResult& result) {
+    const Rung& last = result.rungs.back();
+    std::printf("seed %llu  features %s  scaling %s  nodes %zu..%zu\n",
+                static_cast<unsigned long long>(input.seed),
+                joinNames(input.features, FEATURE_NAMES, FEATURE_COUNT).c_str(),
+                joinNames(input.scaled, DIMENSION_NAMES, DIMENSION_COUNT).c_str(), result.rungs.front().nodes,
+                last.nodes);
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        std::printf("  %-16s %14.0f -> %14.0f  exponent ", METRIC_NAMES[m], result.rungs.front().cost[m], last.cost[m]);
+        if (std::isnan(result.exponent[m])) std::printf("   -\n");
+        else std::printf("%5.2f\n", result.exponent[m]);
+    }
+}
+
+static std::set<std::string> loadKnown(const std::string& filename, bool& ok) {
+    std::set<std::string> known;
+    if (filename.empty()) return known;
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "ERROR: Cannot read " << filename << "\n";
+        ok = false;
+        return known;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) line.pop_back();
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin != std::string::npos) known.insert(line.substr(begin));
+    }
+    return known;
+}
+
+int main(int argc, char* argv[]) {
+    FuzzOptions options;
+    std::string expectMetric;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seeds" && i + 1 < argc) options.seeds = std::stoull(argv[++i]);
+        else if (arg == "--first-seed" && i + 1 < argc) options.firstSeed = std::stoull(argv[++i]);
+        else if (arg == "--rungs" && i + 1 < argc) options.rungs = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--threshold" && i + 1 < argc) options.threshold = std::stod(argv[++i]);
+        else if (arg == "--known" && i + 1 < argc) options.known = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) options.out = argv[++i];
+        else if (arg == "--inject-quadratic") options.injectQuadratic = true;
+        else if (arg == "--expect-superlinear" && i + 1 < argc) expectMetric = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--seeds N] [--first-seed S] [--rungs 3..8] [--threshold X]"
+                      << " [--known FILE] [--out DIR] [--inject-quadratic] [--expect-superlinear METRIC]\n";
+            return 1;
+        }
+    }
+    if (options.rungs < 3 || options.rungs > 8) {
+        std::cerr << "ERROR: --rungs must be 3..8\n";
+        return 1;
+    }
+
+    bool ok = true;
+    std::set<std::string> known = loadKnown(options.known, ok);
+    std::map<std::string, uint64_t> findings;   // Key -> first seed
+    bool expectedSeen = false;
+
+    for (uint64_t seed = options.firstSeed; seed < options.firstSeed + options.seeds; seed++) {
+        FuzzInput input = randomInput(seed);
+        LadderResult result = runLadder(input, options);
+        printLadder(input, result);
+        if (!result.error.empty()) {
+            std::cerr << "ERROR: seed " << seed << " generated a sketch that fails: " << result.error << "\n";
+            ok = false;
+            continue;
+        }
+
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (!superlinear(result, m, options)) continue;
+            if (METRIC_NAMES[m] == expectMetric) expectedSeen = true;
+
+            FuzzInput minimal = minimize(input, m, options);
+            std::string key = findingKey(minimal, m);
+            bool isKnown = known.count(key) != 0;
+            std::printf("  SUPERLINEAR %s (exponent %.2f) -> minimized: %s%s\n", METRIC_NAMES[m], result.exponent[m],
+                        key.c_str(), isKnown ? " [known]" : "");
+            if (findings.emplace(key, seed).second && !options.out.empty()) {
+                if (!saveReproducer(minimal, m, options)) ok = false;
+            }
+        }
+    }
+
+    std::cout << "\n" << findings.size() << " distinct superlinear finding(s)\n";
+    size_t unknown = 0;
+    for (const auto& [key, seed] : findings) {
+        bool isKnown = known.count(key) != 0;
+        if (!isKnown) unknown++;
+        std::printf("  %-60s seed %llu%s\n", key.c_str(), static_cast<unsigned long long>(seed),
+                    isKnown ? "  [known]" : "");
+    }
+
+    if (!expectMetric.empty()) {
+        if (!expectedSeen) {
+            std::cerr << "ERROR: expected " << expectMetric << " to grow superlinearly\n";
+            ok = false;
+        }
+    } else if (unknown > 0) {
+        ok = false;
+    }
+    std::cout << "\n" << (ok ? "No unexpected superlinear growth" : "FAILED") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/**
+ * program_cache_test.cpp
+ *
+ * Verifies ProgramCache: spares are handed out without parsing and rebuilt
+ * by refill(), least recently used programs are evicted to fit the budget,
+ * entries spill from internal RAM to PSRAM while their spares stay charged
+ * to internal RAM, spares are dropped before programs are evicted, refill()
+ * respects the free heap, and a file name with new content replaces its
+ * entry.
+ *
+ * Usage: ./program_cache_test
+ *
+ * TEST SKETCHES: "program_cache_a" and "program_cache_b" in tests/unit_sketches.js
+ *   (the same program, marker = 1 and marker = 2)
+ */
+
+#include "ProgramCache.hpp"
+#include "unit_test_helpers.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> SKETCH_A_AST = loadFixture("program_cache_a");
+static const std::vector<uint8_t> SKETCH_B_AST = loadFixture("program_cache_b");
+
+static size_t allocations[2] = {0, 0};
+static size_t releases[2] = {0, 0};
+static size_t freeHeapBytes = 0;
+
+static size_t fakeFreeHeap() { return freeHeapBytes; }
+
+static void* countingAllocate(size_t size, MemoryRegion region) {
+    allocations[static_cast<size_t>(region)]++;
+    return std::malloc(size);
+}
+
+static void countingRelease(void* data, MemoryRegion region) {
+    releases[static_cast<size_t>(region)]++;
+    std::free(data);
+}
+
+static InterpreterOptions interpreterOptions() {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = 1;
+    return opts;
+}
+
+static ProgramCacheOptions cacheOptions(size_t internalBudget, size_t psramBudget) {
+    ProgramCacheOptions options;
+    options.internalBudget = internalBudget;
+    options.psramBudget = psramBudget;
+    options.interpreterBaseBytes = 1000;
+    options.interpreterBytesPerASTByte = 2;
+    options.allocate = countingAllocate;
+    options.release = countingRelease;
+    return options;
+}
+
+// Bytes a spare is charged to internal RAM under cacheOptions()
+static size_t spareCost(size_t astSize) { return 1000 + astSize * 2; }
+
+// Bytes an entry with its spare is charged
+static size_t cost(size_t astSize) { return astSize + spareCost(astSize); }
+
+// marker as seen by the interpreter, -1 if there is none
+static int32_t marker(std::unique_ptr<ASTInterpreter> interpreter) {
+    if (!interpreter || !interpreter->initializeGlobals().success) return -1;
+    CommandValue value = interpreter->getVariableValue("marker");
+    return std::holds_alternative<int32_t>(value) ? std::get<int32_t>(value) : -1;
+}
+
+int main() {
+    int failures = 0;
+    const size_t sizeA = SKETCH_A_AST.size();
+    const size_t sizeB = SKETCH_B_AST.size();
+
+    {
+        ProgramCache cache(cacheOptions(cost(sizeA) + cost(sizeB), 0), interpreterOptions());
+        failures += check(!cache.take("/a.ast") && cache.getStats().misses == 1, "uncached name is a miss");
+
+        cache.insert("/a.ast", SKETCH_A_AST.data(), sizeA);
+        failures += check(marker(cache.take("/a.ast")) == 1 && cache.getStats().warmHits == 1,
+                          "no spare yet: parsed from the cached copy");
+
+        bool built = cache.refill();
+        failures += check(built && cache.hasSpare("/a.ast") && !cache.refill(), "refill() builds one spare");
+        failures += check(marker(cache.take("/a.ast")) == 1 && cache.getStats().hits == 1 && !cache.hasSpare("/a.ast"),
+                          "take() hands out the spare");
+        failures += check(cache.used(MemoryRegion::INTERNAL) == sizeA, "taken spare no longer charged");
+
+        cache.refill();
+        cache.insert("/a.ast", SKETCH_A_AST.data(), sizeA);
+        failures += check(cache.hasSpare("/a.ast") && cache.size() == 1, "same content keeps the entry and its spare");
+
+        cache.insert("/a.ast", SKETCH_B_AST.data(), sizeB);
+        failures += check(!cache.hasSpare("/a.ast") && marker(cache.take("/a.ast")) == 2,
+                          "same name, new content replaces the entry");
+
+        cache.invalidate("/a.ast");
+        failures += check(cache.size() == 0 && cache.used(MemoryRegion::INTERNAL) == 0, "invalidate() drops the entry");
+    }
+
+    {
+        // Room for two programs: a third evicts the least recently used
+        ProgramCache cache(cacheOptions(sizeA + sizeB, 0), interpreterOptions());
+        cache.insert("/a.ast", SKETCH_A_AST.data(), sizeA);
+        cache.insert("/b.ast", SKETCH_B_AST.data(), sizeB);
+        cache.take("/a.ast");
+        cache.insert("/c.ast", SKETCH_B_AST.data(), sizeB);
+        failures += check(cache.contains("/a.ast") && !cache.contains("/b.ast") && cache.contains("/c.ast") &&
+                              cache.getStats().evictions == 1,
+                          "least recently used program evicted");
+
+        ProgramCache tiny(cacheOptions(sizeA - 1, 0), interpreterOptions());
+        failures += check(!tiny.insert("/a.ast", SKETCH_A_AST.data(), sizeA) && tiny.getStats().rejected == 1,
+                          "program larger than every budget rejected");
+    }
+
+    {
+        // Internal RAM holds one program and its spare; the next spills to PSRAM
+        allocations[0] = allocations[1] = releases[0] = releases[1] = 0;
+        {
+            ProgramCache cache(cacheOptions(cost(sizeA), 2 * sizeB), interpreterOptions());
+            cache.insert("/a.ast", SKETCH_A_AST.data(), sizeA);
+            cache.refill();
+            cache.insert("/b.ast", SKETCH_B_AST.data(), sizeB);
+            failures += check(cache.used(MemoryRegion::INTERNAL) == cost(sizeA) &&
+                                  cache.used(MemoryRegion::PSRAM) == sizeB && allocations[1] == 1,
+                              "second program charged to and allocated from PSRAM");
+            failures += check(!cache.refill() && !cache.hasSpare("/b.ast"),
+                              "spare of a PSRAM program needs internal RAM");
+            failures += check(marker(cache.take("/a.ast")) == 1 && marker(cache.take("/b.ast")) == 2 &&
+                                  cache.used(MemoryRegion::INTERNAL) == sizeA,
+                              "both regions hand out programs");
+        }
+        failures += check(releases[0] == allocations[0] && releases[1] == allocations[1],
+                          "every AST copy released to its region");
+    }
+
+    {
+        // Spares are rebuilt cheaply: drop them before evicting a program
+        ProgramCache cache(cacheOptions(cost(sizeA) + sizeB - 1, 0), interpreterOptions());
+        cache.insert("/a.ast", SKETCH_A_AST.data(), sizeA);
+        cache.refill();
+        cache.insert("/b.ast", SKETCH_B_AST.data(), sizeB);
+        failures += check(cache.contains("/a.ast") && cache.contains("/b.ast") && !cache.hasSpare("/a.ast") &&
+                              cache.getStats().spareDrops == 1 && cache.getStats().evictions == 0,
+                          "spare dropped instead of evicting a program");
+    }
+
+    {
+        // refill() leaves heapReserve bytes of the heap free
+        ProgramCacheOptions options = cacheOptions(cost(sizeA), 0);
+        options.freeHeap = fakeFreeHeap;
+        options.heapReserve = 100;
+        ProgramCache cache(options, interpreterOptions());
+        cache.insert("/a.ast", SKETCH_A_AST.data(), sizeA);
+        freeHeapBytes = spareCost(sizeA) + 99;
+        failures += check(!cache.refill() && !cache.hasSpare("/a.ast"), "no spare without free heap");
+        freeHeapBytes = spareCost(sizeA) + 100;
+        failures += check(cache.refill() && cache.hasSpare("/a.ast"), "spare built once the heap has room");
+    }
+
+    return failures == 0 ? 0 : 1;
+}
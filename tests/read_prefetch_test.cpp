@@ -0,0 +1,238 @@
+/**
+ * read_prefetch_test.cpp
+ *
+ * Verifies speculative read prefetch (ReadPrefetcher.hpp): each loop()
+ * iteration's reads are requested up front as one READ_PREFETCH batch,
+ * predicted from the previous iteration; matching fresh answers replace the
+ * provider round-trip, and mispredicted, late or stale reads fall back to it
+ * without changing what the sketch sees.
+ *
+ * TEST SKETCH: "read_prefetch" in tests/unit_sketches.js
+ *
+ * void loop() {
+ *   int a = analogRead(A0);
+ *   if (a > 500) {
+ *     int d = digitalRead(2);
+ *     Serial.println(d);
+ *   }
+ *   unsigned long t = millis();
+ *   Serial.println(a + t);
+ * }
+ *
+ * EXPECTED RESULTS (5 iterations, A0 = 100 700 800 200 900):
+ * - Reads per iteration: [A0 millis] [A0 D2 millis] [A0 D2 millis] [A0 millis] [A0 D2 millis]
+ * - Iterations 2-5 emit READ_PREFETCH (4 batches); a host answering at once
+ *   gives 6 hits and 3 mispredicts (iterations 2, 4, 5 change path)
+ * - A host that never answers: 6 late reads; answers older than the limit: 6 stale
+ * - In every case the stream minus READ_PREFETCH equals the run without prefetch
+ *
+ * ASYNC RESUME: "read_prefetch_resume" (a = 7 leaves a cached continuation
+ * result before each read), syncMode off, 3 iterations:
+ * - Reads resumed from their continuation are not taken from the prefetcher:
+ *   no batches, no mispredicts, the stream of the run without prefetch
+ */
+
+#include "ASTInterpreter.hpp"
+#include "unit_test_helpers.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> PREFETCH_AST = loadFixture("read_prefetch");
+static const std::vector<uint8_t> RESUME_AST = loadFixture("read_prefetch_resume");
+
+// Sensor values are a function of the loop() iteration being run
+static int32_t analogWorld(uint32_t iteration) {
+    static const int32_t A0_VALUES[] = {100, 700, 800, 200, 900};
+    return iteration >= 1 && iteration <= 5 ? A0_VALUES[iteration - 1] : 0;
+}
+
+static int32_t digitalWorld(uint32_t iteration) { return iteration % 2; }
+
+static uint32_t millisWorld(uint32_t iteration) { return iteration * 10; }
+
+class WorldProvider : public SyncDataProvider {
+public:
+    uint32_t iteration = 0;
+    int32_t getAnalogReadValue(int32_t) override { return analogWorld(iteration); }
+    int32_t getDigitalReadValue(int32_t) override { return digitalWorld(iteration); }
+    uint32_t getMillisValue() override { return millisWorld(iteration); }
+    uint32_t getMicrosValue() override { return millisWorld(iteration) * 1000; }
+    uint32_t getPulseInValue(int32_t, int32_t, uint32_t) override { return 0; }
+    int32_t getLibrarySensorValue(const std::string&, const std::string&, int32_t) override { return 0; }
+};
+
+enum class HostMode { ANSWER, NEVER_ANSWER, ANSWER_THEN_STALL };
+
+// Plays the host: tracks the iteration and answers READ_PREFETCH batches
+class HostCallback : public CommandCallback {
+public:
+    HostCallback(WorldProvider& world, HostMode mode) : world_(world), mode_(mode) {}
+
+    ASTInterpreter* interpreter = nullptr;
+    std::vector<std::string> commands;     // Without READ_PREFETCH
+    std::vector<std::string> prefetches;
+    bool staleBatchRejected = true;
+
+    void onCommand(const std::string& jsonCommand) override {
+        if (jsonCommand.find("Starting loop iteration") != std::string::npos) world_.iteration++;
+        if (jsonCommand.find("\"type\":\"READ_PREFETCH\"") == std::string::npos) {
+            commands.push_back(jsonCommand);
+            return;
+        }
+        prefetches.push_back(jsonCommand);
+        if (mode_ == HostMode::NEVER_ANSWER) return;
+
+        // Answer every listed read from the world as it is now
+        std::vector<int32_t> values;
+        size_t at = jsonCommand.find("\"reads\":");
+        while ((at = jsonCommand.find("\"function\":\"", at)) != std::string::npos) {
+            at += 12;
+            std::string function = jsonCommand.substr(at, jsonCommand.find('"', at) - at);
+            if (function == "analogRead") values.push_back(analogWorld(world_.iteration));
+            else if (function == "digitalRead") values.push_back(digitalWorld(world_.iteration));
+            else values.push_back(static_cast<int32_t>(millisWorld(world_.iteration)));
+        }
+        size_t idStart = jsonCommand.find("\"requestId\":\"") + 13;
+        std::string requestId = jsonCommand.substr(idStart, jsonCommand.find('"', idStart) - idStart);
+        interpreter->handlePrefetchResponse(requestId, values);
+        if (prefetches.size() > 1 && interpreter->handlePrefetchResponse("prefetch_1", values)) {
+            staleBatchRejected = false;
+        }
+        if (mode_ == HostMode::ANSWER_THEN_STALL) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+private:
+    WorldProvider& world_;
+    HostMode mode_;
+};
+
+static InterpreterOptions testOptions(bool prefetch, uint32_t maxAgeMicros = 0) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = 5;
+    opts.syncMode = true;
+    opts.speculativePrefetch = prefetch;
+    opts.prefetchMaxAgeMicros = maxAgeMicros;
+    return opts;
+}
+
+struct RunResult {
+    std::vector<std::string> commands;
+    std::vector<std::string> prefetches;
+    PrefetchStats stats;
+    bool staleBatchRejected = true;
+};
+
+static RunResult run(bool prefetch, HostMode mode, uint32_t maxAgeMicros = 0) {
+    WorldProvider world;
+    HostCallback host(world, mode);
+    ASTInterpreter interpreter(PREFETCH_AST.data(), PREFETCH_AST.size(), testOptions(prefetch, maxAgeMicros));
+    host.interpreter = &interpreter;
+    interpreter.setSyncDataProvider(&world);
+    interpreter.setCommandCallback(&host);
+    interpreter.start();
+
+    RunResult result;
+    result.commands = host.commands;
+    result.prefetches = host.prefetches;
+    result.stats = interpreter.getPrefetchStats();
+    result.staleBatchRejected = host.staleBatchRejected;
+    return result;
+}
+
+static int testPredictedBatches(const RunResult& baseline) {
+    RunResult result = run(true, HostMode::ANSWER);
+
+    int failures = 0;
+    failures += check(baseline.prefetches.empty() && baseline.stats.batches == 0, "no batches with prefetch off");
+    failures += check(result.commands == baseline.commands, "answered reads leave the command stream unchanged");
+    failures += check(result.prefetches.size() == 4 && result.stats.batches == 4,
+                      "one batch per iteration after the first");
+    failures += check(!result.prefetches.empty() &&
+                      result.prefetches[0].find("\"requestId\":\"prefetch_2\",\"iteration\":2,\"reads\":"
+                                                "[{\"function\":\"analogRead\",\"pin\":14},{\"function\":\"millis\"}]")
+                          != std::string::npos,
+                      "batch lists the previous iteration's reads in order");
+    failures += check(result.prefetches.size() == 4 &&
+                      result.prefetches[1].find("{\"function\":\"digitalRead\",\"pin\":2}") != std::string::npos,
+                      "prediction follows the path the last iteration took");
+    failures += check(result.stats.hits == 6 && result.stats.mispredicts == 3 &&
+                      result.stats.late == 0 && result.stats.stale == 0,
+                      "matching reads hit, path changes mispredict");
+    failures += check(result.staleBatchRejected, "answers for an old batch are rejected");
+    return failures;
+}
+
+static int testFallbacks(const RunResult& baseline) {
+    RunResult late = run(true, HostMode::NEVER_ANSWER);
+    RunResult stale = run(true, HostMode::ANSWER_THEN_STALL, 1000);
+
+    int failures = 0;
+    failures += check(late.commands == baseline.commands && late.stats.hits == 0 && late.stats.late == 6 &&
+                      late.stats.mispredicts == 3,
+                      "unanswered reads fall back to the provider");
+    failures += check(stale.commands == baseline.commands && stale.stats.hits == 0 && stale.stats.stale == 6,
+                      "answers older than prefetchMaxAgeMicros fall back to the provider");
+    return failures;
+}
+
+// Host that answers every batch at once with fixed values
+class AnsweringCallback : public CommandCallback {
+public:
+    ASTInterpreter* interpreter = nullptr;
+    std::vector<std::string> commands;     // Without READ_PREFETCH
+
+    void onCommand(const std::string& jsonCommand) override {
+        if (jsonCommand.find("\"type\":\"READ_PREFETCH\"") == std::string::npos) {
+            commands.push_back(jsonCommand);
+            return;
+        }
+        size_t idStart = jsonCommand.find("\"requestId\":\"") + 13;
+        std::string requestId = jsonCommand.substr(idStart, jsonCommand.find('"', idStart) - idStart);
+        interpreter->handlePrefetchResponse(requestId, {500, 123});
+    }
+};
+
+static int testAsyncResume() {
+    auto runAsync = [](bool prefetch, PrefetchStats& stats) {
+        InterpreterOptions opts = testOptions(prefetch);
+        opts.syncMode = false;
+        opts.maxLoopIterations = 3;
+        AnsweringCallback host;
+        ASTInterpreter interpreter(RESUME_AST.data(), RESUME_AST.size(), opts);
+        host.interpreter = &interpreter;
+        interpreter.setCommandCallback(&host);
+        interpreter.start();
+        stats = interpreter.getPrefetchStats();
+        return host.commands;
+    };
+
+    PrefetchStats unused, stats;
+    std::vector<std::string> baseline = runAsync(false, unused);
+    std::vector<std::string> commands = runAsync(true, stats);
+
+    int failures = 0;
+    failures += check(commands == baseline && contains(commands, "Serial.println(14)"),
+                      "async: resumed reads return their continuation result");
+    failures += check(stats.batches == 0 && stats.hits == 0 && stats.mispredicts == 0,
+                      "async: resumed reads are not taken from the prefetcher again");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    RunResult baseline = run(false, HostMode::ANSWER);
+    failures += testPredictedBatches(baseline);
+    failures += testFallbacks(baseline);
+    failures += testAsyncResume();
+    return failures == 0 ? 0 : 1;
+}
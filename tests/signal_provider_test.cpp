@@ -0,0 +1,199 @@
+/**
+ * signal_provider_test.cpp
+ *
+ * Verifies SignalDataProvider: waveforms sampled in closed form from virtual
+ * time, composition of analog signals, seeded noise, switch bounce, traces,
+ * pulseIn() widths computed from edges, config file errors, and a sketch
+ * driven by the provider with delay() advancing its clock.
+ *
+ * TEST SKETCH: "signal_provider" in tests/unit_sketches.js
+ *
+ * void loop() {
+ *   int level = analogRead(A0);
+ *   unsigned long width = pulseIn(7, HIGH);
+ *   Serial.println(level);
+ *   Serial.println(width);
+ *   delay(250);
+ * }
+ *
+ * CONFIG: read_cost_us 0, A0 = ramp 0..1000 over 1 s, pin 7 = 1200us pulses every 20ms
+ *
+ * EXPECTED RESULTS (3 iterations):
+ * - level 0, 271, 531: reads at t = 0, 271.2 ms, 531.2 ms (pulseIn waits for
+ *   the next full pulse, delay(250) adds 250 ms)
+ * - width 1200 every iteration
+ */
+
+#include "ASTInterpreter.hpp"
+#include "SignalDataProvider.hpp"
+#include "unit_test_helpers.hpp"
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> SIGNAL_AST = loadFixture("signal_provider");
+
+static int testWaveforms() {
+    SignalDataProvider provider;
+    std::string error;
+    bool loaded = provider.load(
+        "# waveform shapes\n"
+        "read_cost_us 0\n"
+        "analog A0 sine amplitude=400 offset=512 period_ms=100\n"
+        "analog A1 ramp from=0 to=1000 period_ms=1000\n"
+        "analog A1 constant value=50          # added to the ramp\n"
+        "analog A2 triangle from=0 to=2000 period_ms=1000\n"
+        "analog A3 noise mean=500 amplitude=20 seed=7 interval_us=1000\n"
+        "analog A4 noise mean=500 amplitude=20 seed=8 interval_us=1000\n"
+        "analog A5 trace 0:0 100:1000 200:400\n", &error);
+
+    int failures = check(loaded, "config loads" + (error.empty() ? "" : " (" + error + ")"));
+
+    provider.setTime(25000);   // a quarter of the sine period
+    int32_t sinePeak = provider.getAnalogReadValue(14);
+    provider.setTime(250000);
+    int32_t rampWithOffset = provider.getAnalogReadValue(15);
+    provider.setTime(750000);
+    int32_t triangle = provider.getAnalogReadValue(16);
+    failures += check(sinePeak == 912 && rampWithOffset == 300 && triangle == 1000,
+                      "periodic shapes are closed-form in time; analog lines add up");
+
+    provider.setTime(900000);
+    int32_t clamped = provider.getAnalogReadValue(16);   // triangle 0..2000 at 0.9 periods = 400
+    provider.setTime(500000);
+    int32_t high = provider.getAnalogReadValue(16);      // 2000, clamped to analog_max
+    failures += check(clamped == 400 && high == 1023, "analogRead is clamped to 0..analog_max");
+
+    provider.setTime(5000000);
+    int32_t noiseA = provider.getAnalogReadValue(17);
+    provider.setTime(5000999);
+    int32_t noiseSameInterval = provider.getAnalogReadValue(17);
+    provider.setTime(5000000);
+    int32_t noiseOtherSeed = provider.getAnalogReadValue(18);
+    provider.setTime(5000000);
+    int32_t noiseRepeat = provider.getAnalogReadValue(17);
+    failures += check(noiseA >= 480 && noiseA <= 520 && noiseA == noiseSameInterval && noiseA == noiseRepeat &&
+                      noiseOtherSeed != noiseA,
+                      "seeded noise is reproducible and random-access");
+
+    provider.setTime(50000);
+    int32_t rising = provider.getAnalogReadValue(19);
+    provider.setTime(150000);
+    int32_t falling = provider.getAnalogReadValue(19);
+    provider.setTime(900000);
+    int32_t held = provider.getAnalogReadValue(19);
+    failures += check(rising == 500 && falling == 700 && held == 400, "traces interpolate and hold their last value");
+    return failures;
+}
+
+static int testDigitalAndTiming() {
+    SignalDataProvider provider;
+    std::string error;
+    bool loaded = provider.load(
+        "read_cost_us 10\n"
+        "start_ms 1\n"
+        "digital 2 bounce initial=0 final=1 at_ms=10 duration_ms=4 edges=5\n"
+        "digital 3 square period_us=20000 width_us=1200\n"
+        "digital 4 trace 0:0 5:1 7:0 20:1\n"
+        "digital 5 constant value=0\n", &error);
+    int failures = check(loaded, "digital config loads" + (error.empty() ? "" : " (" + error + ")"));
+
+    // Bounce edges at 10, 11, 12, 13, 14 ms
+    std::vector<int32_t> levels;
+    for (uint64_t t : {9000, 10000, 10500, 11000, 12500, 13000, 13999, 14000, 50000}) {
+        provider.setTime(t);
+        levels.push_back(provider.getDigitalReadValue(2));
+    }
+    failures += check(levels == std::vector<int32_t>{0, 1, 1, 0, 1, 0, 0, 1, 1}, "bounce burst settles on the final level");
+
+    provider.setTime(1000);
+    uint32_t millis = provider.getMillisValue();
+    uint32_t micros = provider.getMicrosValue();
+    provider.observe("{\"type\":\"DELAY\",\"timestamp\":0,\"duration\":5,\"actualDelay\":5}");
+    provider.observe("{\"type\":\"DELAY_MICROSECONDS\",\"timestamp\":0,\"duration\":30,\"actualDelay\":30}");
+    failures += check(millis == 1 && micros == 1010 && provider.now() == 1020 + 5000 + 30,
+                      "reads cost read_cost_us; observed delays advance the clock");
+
+    // pulseIn: HIGH pulses of 1200us every 20ms, starting at t = 0
+    provider.setTime(0);
+    uint32_t highInProgress = provider.getPulseInValue(3, 1, 1000000);
+    uint64_t afterHigh = provider.now();
+    provider.setTime(5000);
+    uint32_t lowWidth = provider.getPulseInValue(3, 0, 1000000);
+    uint64_t afterLow = provider.now();
+    failures += check(highInProgress == 1200 && afterHigh == 21200, "pulseIn skips the pulse in progress and times the next");
+    failures += check(lowWidth == 18800 && afterLow == 40000, "LOW pulses are timed from the same edges");
+
+    provider.setTime(0);
+    uint32_t tracePulse = provider.getPulseInValue(4, 1, 1000000);
+    provider.setTime(0);
+    uint32_t timedOut = provider.getPulseInValue(5, 1, 3000);
+    failures += check(tracePulse == 2000 && timedOut == 0 && provider.now() == 3000,
+                      "trace pulses and timeouts (clock moves by the timeout)");
+    return failures;
+}
+
+static int testConfigErrors() {
+    SignalDataProvider provider;
+    std::string unknownShape, badBounce, duplicate;
+    bool a = provider.load("read_cost_us 0\nanalog A0 sin amplitude=1\n", &unknownShape);
+    bool b = provider.load("digital 2 bounce initial=0 final=1 edges=4 duration_ms=2\n", &badBounce);
+    bool c = provider.load("digital 2 constant value=1\ndigital 2 constant value=0\n", &duplicate);
+
+    int failures = 0;
+    failures += check(!a && unknownShape == "line 2: unknown shape 'sin'", "errors name the line");
+    failures += check(!b && badBounce.find("odd number of edges") != std::string::npos, "bounce edge parity is checked");
+    failures += check(!c && duplicate.find("already has a signal") != std::string::npos, "one signal per digital pin");
+    return failures;
+}
+
+// Forwards the interpreter's delays to the provider's clock
+class ClockedCallback : public CommandCallback {
+public:
+    explicit ClockedCallback(SignalDataProvider& provider) : provider_(provider) {}
+    std::vector<std::string> printed;
+    void onCommand(const std::string& jsonCommand) override {
+        provider_.observe(jsonCommand);
+        if (jsonCommand.find("\"function\":\"Serial.println\"") != std::string::npos) {
+            size_t at = jsonCommand.find("\"arguments\":[\"") + 14;
+            printed.push_back(jsonCommand.substr(at, jsonCommand.find('"', at) - at));
+        }
+    }
+
+private:
+    SignalDataProvider& provider_;
+};
+
+static int testSketch() {
+    SignalDataProvider provider;
+    provider.load("read_cost_us 0\n"
+                  "analog A0 ramp from=0 to=1000 period_ms=1000\n"
+                  "digital 7 square period_us=20000 width_us=1200\n");
+    ClockedCallback output(provider);
+
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = 3;
+    opts.syncMode = true;
+    ASTInterpreter interpreter(SIGNAL_AST.data(), SIGNAL_AST.size(), opts);
+    interpreter.setSyncDataProvider(&provider);
+    interpreter.setCommandCallback(&output);
+    interpreter.start();
+
+    return check(output.printed == std::vector<std::string>{"0", "1200", "271", "1200", "531", "1200"},
+                 "sketch sees the waveform at virtual time and analytic pulse widths");
+}
+
+int main() {
+    int failures = 0;
+    failures += testWaveforms();
+    failures += testDigitalAndTiming();
+    failures += testConfigErrors();
+    failures += testSketch();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+/**
+ * sketch_benchmark.cpp
+ *
+ * Runs the benchmark corpus (benchmark_data/benchN.ast, generated from
+ * tests/benchmarks.js) and reports the time per run. Before timing, each
+ * sketch's command stream is checked against the checksum recorded in
+ * benchmark_data/checksums.txt, so a speedup that changes behaviour fails.
+ *
+ * Usage: ./sketch_benchmark <benchmark_data_dir> [--iterations N] [--filter TEXT] [--record]
+ *
+ *   --iterations N  Timed runs per sketch (default 5; 0 = checksums only)
+ *   --filter TEXT   Only sketches whose name contains TEXT
+ *   --record        Write checksums.txt from this build instead of checking it
+ *
+ * Internal for/while loops run to completion (enforceLoopLimitsOnInternalLoops
+ * off); loop() runs `loopIterations` times from the sketch's .meta file.
+ * Exit code 1 on a checksum mismatch or a sketch without a checksum.
+ */
+
+#include "ASTInterpreter.hpp"
+#include "ExecutionTracer.hpp"
+#include "DeterministicDataProvider.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+
+struct Benchmark {
+    std::string file;                // benchN
+    std::string name;
+    uint32_t loopIterations = 1;
+    std::vector<uint8_t> ast;
+};
+
+struct StreamDigest {
+    uint64_t commands = 0;
+    uint64_t checksum = 0;
+};
+
+// Generated ids (pointer ids, timestamped library object ids) differ between runs
+static std::string maskGeneratedIds(const std::string& json) {
+    std::string out;
+    out.reserve(json.size());
+    for (size_t i = 0; i < json.size();) {
+        if (json.compare(i, 4, "ptr_") == 0 && i + 4 < json.size() && std::isdigit(static_cast<unsigned char>(json[i + 4]))) {
+            out += "ptr";
+            i += 4;
+            while (i < json.size() && (std::isalnum(static_cast<unsigned char>(json[i])) || json[i] == '_')) i++;
+            continue;
+        }
+        if (std::isdigit(static_cast<unsigned char>(json[i]))) {
+            size_t end = i;
+            while (end < json.size() && std::isdigit(static_cast<unsigned char>(json[end]))) end++;
+            if (end - i >= 9) out += "N";
+            else out.append(json, i, end - i);
+            i = end;
+            continue;
+        }
+        out += json[i++];
+    }
+    return out;
+}
+
+// FNV-1a over the masked stream, one command per line
+class DigestCallback : public CommandCallback {
+public:
+    StreamDigest digest{0, 14695981039346656037ull};
+    void onCommand(const std::string& jsonCommand) override {
+        std::string masked = maskGeneratedIds(jsonCommand);
+        masked += '\n';
+        for (unsigned char c : masked) {
+            digest.checksum = (digest.checksum ^ c) * 1099511628211ull;
+        }
+        digest.commands++;
+    }
+};
+
+class CountingCallback : public CommandCallback {
+public:
+    uint64_t commands = 0;
+    uint64_t bytes = 0;
+    void onCommand(const std::string& jsonCommand) override {
+        commands++;
+        bytes += jsonCommand.size();
+    }
+};
+
+static std::vector<uint8_t> loadFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) return {};
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> buffer(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(buffer.data()), size);
+    return buffer;
+}
+
+static std::map<std::string, std::string> loadMeta(const std::string& filename) {
+    std::map<std::string, std::string> meta;
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = line.substr(0, eq);
+        meta[key] = line.substr(eq + 1);
+        if (key == "content") break;   // Sketch source follows; not needed here
+    }
+    return meta;
+}
+
+static InterpreterOptions benchmarkOptions(const Benchmark& bench) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+    opts.maxLoopIterations = bench.loopIterations;
+    opts.enforceLoopLimitsOnInternalLoops = false;
+    return opts;
+}
+
+template <typename Callback>
+static void runOnce(const Benchmark& bench, Callback& callback) {
+    DeterministicDataProvider provider;
+    ASTInterpreter interpreter(bench.ast.data(), bench.ast.size(), benchmarkOptions(bench));
+    interpreter.setCommandCallback(&callback);
+    interpreter.setSyncDataProvider(&provider);
+    interpreter.start();
+    TRACE_CLEAR();   // The tracer is per thread and only cleared between loop() passes
+}
+
+static std::string hex64(uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <benchmark_data_dir> [--iterations N] [--filter TEXT] [--record]\n";
+        return 1;
+    }
+    std::string dataDir = argv[1];
+    int iterations = 5;
+    std::string filter;
+    bool record = false;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) iterations = std::stoi(argv[++i]);
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--record") record = true;
+    }
+
+    std::vector<Benchmark> benchmarks;
+    for (int n = 0; ; n++) {
+        Benchmark bench;
+        bench.file = "bench" + std::to_string(n);
+        bench.ast = loadFile(dataDir + "/" + bench.file + ".ast");
+        if (bench.ast.empty()) break;
+        auto meta = loadMeta(dataDir + "/" + bench.file + ".meta");
+        bench.name = meta.count("name") ? meta["name"] : bench.file;
+        if (meta.count("loopIterations")) bench.loopIterations = static_cast<uint32_t>(std::stoul(meta["loopIterations"]));
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        benchmarks.push_back(std::move(bench));
+    }
+    if (benchmarks.empty()) {
+        std::cerr << "ERROR: No benchmark ASTs found in " << dataDir << "\n";
+        return 1;
+    }
+
+    // checksums.txt: "<file> <commands> <fnv1a64>" per line
+    const std::string checksumFile = dataDir + "/checksums.txt";
+    std::map<std::string, StreamDigest> expected;
+    {
+        std::ifstream file(checksumFile);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            std::string name, checksum;
+            StreamDigest digest;
+            if (fields >> name >> digest.commands >> checksum) {
+                digest.checksum = std::stoull(checksum, nullptr, 16);
+                expected[name] = digest;
+            }
+        }
+    }
+
+    int failures = 0;
+    std::map<std::string, StreamDigest> recorded = expected;
+    std::printf("%-8s %-28s %9s %10s %10s %12s  %s\n", "file", "sketch", "commands", "min ms", "median ms",
+                "commands/s", "checksum");
+
+    for (const auto& bench : benchmarks) {
+        DigestCallback digestCallback;
+        runOnce(bench, digestCallback);
+        const StreamDigest& digest = digestCallback.digest;
+
+        std::string status;
+        if (record) {
+            recorded[bench.file] = digest;
+            status = "recorded";
+        } else if (!expected.count(bench.file)) {
+            status = "MISSING";
+            failures++;
+        } else if (expected[bench.file].commands != digest.commands || expected[bench.file].checksum != digest.checksum) {
+            status = "MISMATCH (" + std::to_string(digest.commands) + " " + hex64(digest.checksum) + ")";
+            failures++;
+        } else {
+            status = "ok";
+        }
+
+        std::vector<double> times;
+        for (int i = 0; i < iterations; i++) {
+            CountingCallback counter;
+            auto start = std::chrono::steady_clock::now();
+            runOnce(bench, counter);
+            auto end = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        if (times.empty()) {
+            std::printf("%-8s %-28s %9llu %10s %10s %12s  %s\n", bench.file.c_str(), bench.name.c_str(),
+                        static_cast<unsigned long long>(digest.commands), "-", "-", "-", status.c_str());
+            continue;
+        }
+        std::sort(times.begin(), times.end());
+        double median = times[times.size() / 2];
+        double rate = median > 0 ? digest.commands / (median / 1000.0) : 0;
+        std::printf("%-8s %-28s %9llu %10.2f %10.2f %12.0f  %s\n", bench.file.c_str(), bench.name.c_str(),
+                    static_cast<unsigned long long>(digest.commands), times.front(), median, rate, status.c_str());
+    }
+
+    if (record) {
+        std::ofstream out(checksumFile);
+        out << "# sketch_benchmark --record: <file> <commands> <fnv1a64 of masked command stream>\n";
+        for (const auto& entry : recorded) {
+            out << entry.first << " " << entry.second.commands << " " << hex64(entry.second.checksum) << "\n";
+        }
+        std::cout << "Checksums written to " << checksumFile << "\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
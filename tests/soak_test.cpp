@@ -0,0 +1,311 @@
+/**
+ * soak_test.cpp
+ *
+ * Time-compressed soak harness: runs sketches for millions of loop()
+ * iterations on virtual time and flags anything that grows with the
+ * iteration count.
+ *
+ * Usage: ./soak_test <sketch.ast>... [--iterations N] [--sample-every N]
+ *                    [--warmup FRACTION] [--signals CONFIG] [--inject-leak BYTES]
+ *                    [--expect-drift SERIES]
+ *
+ *   --iterations N       loop() iterations per sketch (default 1000000)
+ *   --sample-every N     Iterations between samples (default 100)
+ *   --warmup FRACTION    Leading share of the samples left out of the fit (default 0.2)
+ *   --signals CONFIG     SignalDataProvider config for the sketch's inputs
+ *   --inject-leak BYTES  Leak BYTES per iteration (checks the detector itself)
+ *   --expect-drift NAME  Succeed only if series NAME drifts (with --inject-leak)
+ *
+ * TIME: inputs come from a SignalDataProvider (unconfigured pins fall back to
+ * DeterministicDataProvider). delay() advances its clock instead of sleeping,
+ * so an hour of sketch time costs only the interpretation work.
+ *
+ * OUTPUT: the command stream is dropped; the callback only advances the clock
+ * on DELAY commands and samples at each completed loop() iteration. Progress
+ * is printed every 10% of the run, then one row per series.
+ *
+ * SERIES (fitted after warm-up, see DriftDetector.hpp):
+ * - heapBytes, liveAllocations: counted by this file's operator new/delete
+ *   (requested bytes, so a 1-byte leak is 1 byte/iteration)
+ * - nsPerIteration: mean wall time per iteration over each sample window
+ * - every entry of ASTInterpreter::getContainerSizes()
+ *
+ * Exit code 1 if any series drifts (or, with --expect-drift, if NAME doesn't).
+ */
+
+#include "ASTInterpreter.hpp"
+#include "SignalDataProvider.hpp"
+#include "DeterministicDataProvider.hpp"
+#include "DriftDetector.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+
+// =============================================================================
+// HEAP ACCOUNTING
+// =============================================================================
+
+// Every allocation carries its requested size in a header. Over-aligned
+// new/delete are left to the runtime; they pair with each other and the
+// interpreter has no over-aligned types.
+namespace {
+
+std::atomic<int64_t> g_heapBytes{0};
+std::atomic<int64_t> g_liveAllocations{0};
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+void* trackedAlloc(size_t size) noexcept {
+    void* block = std::malloc(size + HEADER);
+    if (!block) return nullptr;
+    *static_cast<size_t*>(block) = size;
+    g_heapBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    g_liveAllocations.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<char*>(block) + HEADER;
+}
+
+void trackedFree(void* pointer) noexcept {
+    if (!pointer) return;
+    char* block = static_cast<char*>(pointer) - HEADER;
+    g_heapBytes.fetch_sub(static_cast<int64_t>(*reinterpret_cast<size_t*>(block)), std::memory_order_relaxed);
+    g_liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+    std::free(block);
+}
+
+void* trackedNew(size_t size) {
+    void* pointer = trackedAlloc(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return trackedNew(size); }
+void* operator new[](size_t size) { return trackedNew(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void operator delete(void* pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { trackedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { trackedFree(pointer); }
+
+// =============================================================================
+// SOAK RUN
+// =============================================================================
+
+struct SoakOptions {
+    uint64_t iterations = 1000000;
+    uint64_t sampleEvery = 100;
+    double warmup = 0.2;
+    std::string signals;
+    size_t injectLeak = 0;
+};
+
+// Limits per series; container sizes may grow by one entry per 1000 iterations at most
+static constexpr double HEAP_BYTES_PER_ITERATION = 0.5;
+static constexpr double ALLOCATIONS_PER_ITERATION = 0.01;
+static constexpr double CONTAINER_ENTRIES_PER_ITERATION = 0.001;
+static constexpr double LATENCY_GROWTH = 1.0;   // Iterations twice as slow by the end
+
+class SoakCallback : public CommandCallback {
+public:
+    SoakCallback(const SoakOptions& options, SignalDataProvider& provider)
+        : options_(options), provider_(provider) {
+        series_.emplace_back("heapBytes", HEAP_BYTES_PER_ITERATION);
+        series_.emplace_back("liveAllocations", ALLOCATIONS_PER_ITERATION);
+        series_.emplace_back("nsPerIteration", 0.0, LATENCY_GROWTH);
+        windowStart_ = std::chrono::steady_clock::now();
+    }
+
+    void attach(const ASTInterpreter* interpreter) { interpreter_ = interpreter; }
+
+    void onCommand(const std::string& jsonCommand) override {
+        if (jsonCommand.compare(0, 14, "{\"type\":\"DELAY") == 0) {
+            provider_.observe(jsonCommand);
+            return;
+        }
+        if (jsonCommand.compare(0, 24, "{\"type\":\"FUNCTION_CALL\",") != 0 ||
+            jsonCommand.find("\"completed\":true") == std::string::npos ||
+            jsonCommand.find("\"function\":\"loop\"") == std::string::npos) {
+            return;
+        }
+
+        iteration_++;
+        if (options_.injectLeak) leakSink_ = new char[options_.injectLeak];
+        if (iteration_ % options_.sampleEvery == 0) sample();
+        if (iteration_ % progressEvery() == 0) progress();
+    }
+
+    uint64_t iterations() const { return iteration_; }
+    const std::vector<DriftSeries>& series() const { return series_; }
+
+private:
+    uint64_t progressEvery() const {
+        uint64_t step = options_.iterations / 10;
+        return step == 0 ? 1 : step;
+    }
+
+    void sample() {
+        // Read the counters before anything below allocates
+        double heap = static_cast<double>(g_heapBytes.load(std::memory_order_relaxed));
+        double live = static_cast<double>(g_liveAllocations.load(std::memory_order_relaxed));
+        auto now = std::chrono::steady_clock::now();
+        double windowNs = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - windowStart_).count());
+        windowStart_ = now;
+
+        series_[0].add(iteration_, heap);
+        series_[1].add(iteration_, live);
+        series_[2].add(iteration_, windowNs / static_cast<double>(options_.sampleEvery));
+        lastNsPerIteration_ = windowNs / static_cast<double>(options_.sampleEvery);
+
+        if (!interpreter_) return;
+        auto containers = interpreter_->getContainerSizes();
+        if (series_.size() == 3) {
+            for (const auto& container : containers) {
+                series_.emplace_back(container.name, CONTAINER_ENTRIES_PER_ITERATION);
+            }
+        }
+        for (size_t i = 0; i < containers.size(); ++i) {
+            series_[3 + i].add(iteration_, static_cast<double>(containers[i].size));
+        }
+    }
+
+    void progress() const {
+        std::printf("  %12llu iterations  heap %10lld B  %8lld allocations  %8.0f ns/iteration  %10.1f s virtual\n",
+                    static_cast<unsigned long long>(iteration_),
+                    static_cast<long long>(g_heapBytes.load(std::memory_order_relaxed)),
+                    static_cast<long long>(g_liveAllocations.load(std::memory_order_relaxed)),
+                    lastNsPerIteration_, provider_.now() / 1e6);
+        std::fflush(stdout);
+    }
+
+    const SoakOptions& options_;
+    SignalDataProvider& provider_;
+    const ASTInterpreter* interpreter_ = nullptr;
+    std::vector<DriftSeries> series_;
+    uint64_t iteration_ = 0;
+    std::chrono::steady_clock::time_point windowStart_;
+    double lastNsPerIteration_ = 0.0;
+    char* volatile leakSink_ = nullptr;
+};
+
+static std::vector<uint8_t> loadFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) return {};
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> buffer(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(buffer.data()), size);
+    return buffer;
+}
+
+/**
+ * Run one sketch and print its drift table
+ * @return Names of the drifting series
+ */
+static std::vector<std::string> soak(const std::string& astFile, const SoakOptions& options, bool& ok) {
+    std::vector<std::string> drifting;
+    auto ast = loadFile(astFile);
+    if (ast.empty()) {
+        std::cerr << "ERROR: Cannot read " << astFile << "\n";
+        ok = false;
+        return drifting;
+    }
+
+    DeterministicDataProvider fallback;
+    SignalDataProvider provider(&fallback);
+    if (!options.signals.empty()) {
+        std::string error;
+        if (!provider.loadFile(options.signals, &error)) {
+            std::cerr << "ERROR: " << options.signals << ": " << error << "\n";
+            ok = false;
+            return drifting;
+        }
+    }
+
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.syncMode = true;
+    opts.maxLoopIterations = static_cast<uint32_t>(options.iterations);
+    opts.enforceLoopLimitsOnInternalLoops = false;
+
+    std::cout << "\n" << astFile << ": " << options.iterations << " iterations\n";
+    SoakCallback callback(options, provider);
+    auto wallStart = std::chrono::steady_clock::now();
+    {
+        ASTInterpreter interpreter(ast.data(), ast.size(), opts);
+        interpreter.setCommandCallback(&callback);
+        interpreter.setSyncDataProvider(&provider);
+        callback.attach(&interpreter);
+        interpreter.start();
+        callback.attach(nullptr);
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    std::printf("  %llu iterations, %.1f s virtual in %.1f s\n",
+                static_cast<unsigned long long>(callback.iterations()), provider.now() / 1e6, wallSeconds);
+    std::printf("  %-30s %14s %14s %14s %6s  %s\n", "series", "start", "end", "per iteration", "r2", "verdict");
+    for (const auto& series : callback.series()) {
+        DriftFit fit = series.fit(options.warmup);
+        bool drift = series.drifting(fit);
+        if (drift) drifting.push_back(series.name());
+        std::printf("  %-30s %14.1f %14.1f %14.6f %6.3f  %s\n", series.name().c_str(), fit.first, fit.last,
+                    fit.slope, fit.r2, drift ? "DRIFT" : "ok");
+    }
+    if (callback.iterations() < options.iterations) {
+        std::cerr << "ERROR: sketch stopped after " << callback.iterations() << " iterations\n";
+        ok = false;
+    }
+    return drifting;
+}
+
+int main(int argc, char* argv[]) {
+    SoakOptions options;
+    std::vector<std::string> sketches;
+    std::string expectDrift;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) options.iterations = std::stoull(argv[++i]);
+        else if (arg == "--sample-every" && i + 1 < argc) options.sampleEvery = std::stoull(argv[++i]);
+        else if (arg == "--warmup" && i + 1 < argc) options.warmup = std::stod(argv[++i]);
+        else if (arg == "--signals" && i + 1 < argc) options.signals = argv[++i];
+        else if (arg == "--inject-leak" && i + 1 < argc) options.injectLeak = std::stoul(argv[++i]);
+        else if (arg == "--expect-drift" && i + 1 < argc) expectDrift = argv[++i];
+        else sketches.push_back(arg);
+    }
+    if (sketches.empty() || options.iterations == 0 || options.iterations > UINT32_MAX || options.sampleEvery == 0) {
+        std::cerr << "Usage: " << argv[0] << " <sketch.ast>... [--iterations 1..4294967295] [--sample-every N]"
+                  << " [--warmup FRACTION] [--signals CONFIG] [--inject-leak BYTES] [--expect-drift SERIES]\n";
+        return 1;
+    }
+
+    bool ok = true;
+    for (const auto& sketch : sketches) {
+        auto drifting = soak(sketch, options, ok);
+        if (expectDrift.empty()) {
+            if (!drifting.empty()) ok = false;
+            continue;
+        }
+        bool found = false;
+        for (const auto& name : drifting) found = found || name == expectDrift;
+        if (!found) {
+            std::cerr << "ERROR: expected " << expectDrift << " to drift\n";
+            ok = false;
+        }
+    }
+    std::cout << "\n" << (ok ? "No unexpected drift" : "FAILED") << "\n";
+    return ok ? 0 : 1;
+}
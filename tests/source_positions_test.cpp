@@ -0,0 +1,189 @@
+/**
+ * source_positions_test.cpp
+ *
+ * Verifies the optional CompactAST source position section: the reader turns
+ * it into a side table (SourcePositionMap), statements map to their .ino
+ * lines (after #define lines, so the preprocessor must keep line numbers),
+ * ERROR commands carry the failing statement's location, and an AST exported
+ * without the section behaves exactly as before.
+ *
+ * TEST SKETCH: "source_positions" in tests/unit_sketches.js, exported with
+ * { sourcePositions: true, sourceFile: "Positions.ino" }, and the same source
+ * exported without them as "source_positions_plain":
+ *    1  #define LED 13
+ *    2  int counter = 0;
+ *    3
+ *    4  void setup() {
+ *    5    pinMode(LED, OUTPUT);
+ *    6  }
+ *    7
+ *    8  void loop() {
+ *    9    counter++;
+ *   10    if (counter > 1) {
+ *   11      digitalWrite(LED, HIGH);
+ *   12    }
+ *   13    int y = missing + 1;
+ *   14  }
+ *
+ * EXPECTED RESULTS (2 loop iterations):
+ * - Stepping every statement gives lines 5, 9 10 13, 9 10 11 13
+ *   (a hot-line report: line 9, 10 and 13 run twice, 11 once)
+ * - The undefined-variable ERROR reports line 13, column 3, Positions.ino
+ * - Without the section: no positions, no location in ERROR, same commands otherwise
+ *
+ * "source_positions_nested" (sourceFile "C:\\sketches\\Nested.ino") raises its
+ * errors after the statement's call or body has run:
+ *    3  int f() {
+ *    4    int local = 1;
+ *    5    return local;
+ *    6  }
+ *    7  void setup() {
+ *    8    y = f() / zero;
+ *    9    for (int i = 0; i < 10 / (1 - i); i++) {
+ *   10      y++;
+ *   11    }
+ *   12  }
+ * - The division after f() returned reports line 8, not f()'s line 5
+ * - The for condition failing after one pass of the body reports line 9
+ * - The file name is JSON-escaped
+ */
+
+#include "DebugSession.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> POSITIONS_AST = loadFixture("source_positions");
+static const std::vector<uint8_t> PLAIN_AST = loadFixture("source_positions_plain");
+static const std::vector<uint8_t> NESTED_AST = loadFixture("source_positions_nested");
+
+// Steps through every statement from the first one in setup()
+class LineProfiler : public DebugCallback {
+public:
+    std::vector<int> lines;
+    std::map<int, int> hits;
+    void onStop(ASTInterpreter& interpreter, const DebugStop& stop) override {
+        const auto* positions = interpreter.getSourcePositions();
+        const arduino_ast::SourcePosition* position = positions ? positions->find(stop.statement) : nullptr;
+        int line = position ? position->line : -1;
+        lines.push_back(line);
+        hits[line]++;
+        interpreter.step();
+    }
+};
+
+static InterpreterOptions testOptions() {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = 2;
+    opts.syncMode = true;
+    return opts;
+}
+
+static std::string findError(const std::vector<std::string>& commands) {
+    for (const auto& command : commands) {
+        if (command.find("\"type\":\"ERROR\"") != std::string::npos) return command;
+    }
+    return "";
+}
+
+static int testPositionTable() {
+    ASTInterpreter interpreter(POSITIONS_AST.data(), POSITIONS_AST.size(), testOptions());
+    const auto* positions = interpreter.getSourcePositions();
+
+    int failures = 0;
+    failures += check(positions && positions->size() == 9 && positions->fileName(0) == "Positions.ino",
+                      "reader loads the section into a side table");
+
+    arduino_ast::SourcePosition position;
+    position.line = 13;
+    position.column = 3;
+    failures += check(positions && positions->format(position) == "Positions.ino:13:3", "format() names file:line:column");
+    failures += check(!interpreter.getCurrentSourcePosition(position), "no current position before start()");
+    return failures;
+}
+
+static int testLineProfile() {
+    CollectingCallback output;
+    ASTInterpreter interpreter(POSITIONS_AST.data(), POSITIONS_AST.size(), testOptions());
+    interpreter.setCommandCallback(&output);
+    LineProfiler profiler;
+    interpreter.setDebugCallback(&profiler);
+    interpreter.addBreakpoint("setup", 0);
+    interpreter.start();
+
+    return check(profiler.lines == std::vector<int>{5, 9, 10, 13, 9, 10, 11, 13} &&
+                 profiler.hits[9] == 2 && profiler.hits[11] == 1 && profiler.hits[13] == 2,
+                 "statements map to their source lines");
+}
+
+static int testErrorLocation(std::vector<std::string>& commands) {
+    CollectingCallback output;
+    ASTInterpreter interpreter(POSITIONS_AST.data(), POSITIONS_AST.size(), testOptions());
+    interpreter.setCommandCallback(&output);
+    interpreter.start();
+    commands = output.commands;
+
+    std::string error = findError(output.commands);
+    return check(error.find("\"line\":13,\"column\":3,\"file\":\"Positions.ino\"") != std::string::npos,
+                 "ERROR carries the failing statement's location");
+}
+
+static int testWithoutSection(const std::vector<std::string>& withPositions) {
+    CollectingCallback output;
+    ASTInterpreter interpreter(PLAIN_AST.data(), PLAIN_AST.size(), testOptions());
+    interpreter.setCommandCallback(&output);
+    interpreter.start();
+
+    // Identical apart from the location fields
+    std::vector<std::string> stripped = withPositions;
+    for (auto& command : stripped) {
+        size_t at = command.find(",\"line\":");
+        if (at != std::string::npos) command.erase(at, command.size() - 1 - at);
+    }
+
+    std::string error = findError(output.commands);
+    return check(interpreter.getSourcePositions() == nullptr && !error.empty() &&
+                 error.find("\"line\"") == std::string::npos && output.commands == stripped,
+                 "AST without the section runs unchanged");
+}
+
+static int testNestedErrorLocations() {
+    CollectingCallback output;
+    ASTInterpreter interpreter(NESTED_AST.data(), NESTED_AST.size(), testOptions());
+    interpreter.setCommandCallback(&output);
+    interpreter.start();
+
+    std::vector<std::string> errors;
+    for (const auto& command : output.commands) {
+        if (command.find("\"type\":\"ERROR\"") != std::string::npos) errors.push_back(command);
+    }
+    const std::string file = ",\"file\":\"C:\\\\sketches\\\\Nested.ino\"";
+
+    int failures = 0;
+    failures += check(errors.size() == 2, "two division errors");
+    failures += check(errors.size() > 0 && errors[0].find("\"line\":8,\"column\":3" + file) != std::string::npos,
+                      "error after a returned call reports the caller's statement");
+    failures += check(errors.size() > 1 && errors[1].find("\"line\":9,\"column\":3" + file) != std::string::npos,
+                      "for condition after the body reports the for statement");
+    arduino_ast::SourcePosition position;
+    failures += check(!interpreter.getCurrentSourcePosition(position), "no current position after the program ends");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    std::vector<std::string> withPositions;
+    failures += testPositionTable();
+    failures += testLineProfile();
+    failures += testErrorLocation(withPositions);
+    failures += testWithoutSection(withPositions);
+    failures += testNestedErrorLocations();
+    return failures == 0 ? 0 : 1;
+}
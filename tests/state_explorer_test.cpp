@@ -0,0 +1,101 @@
+/**
+ * state_explorer_test.cpp
+ *
+ * Verifies StateExplorer: breadth-first enumeration of digitalRead() and
+ * analogRead() answers, pruning of already-seen states, the depth bound,
+ * shortest input paths to a state, and stopping from the transition
+ * callback. Prints the exploration rate.
+ *
+ * Usage: ./state_explorer_test
+ *
+ * TEST SKETCH: "state_explorer" in tests/unit_sketches.js
+ *
+ * EXPECTED RESULTS:
+ * - Digital input only: 10 states (after setup; then presses 0..3 x ledOn x
+ *   lastButton as reachable), the last one first reached at depth 8
+ * - With analog levels 0/512/1023: each post-loop state in 3 variants, 28
+ * - The first state with fault == 1 is reached by button inputs 1 0 1 0 1
+ */
+
+#include "StateExplorer.hpp"
+#include "unit_test_helpers.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> EXPLORE_AST = loadFixture("state_explorer");
+
+static InterpreterOptions interpreterOptions() {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    return opts;
+}
+
+static std::string describe(const ExplorationStats& stats) {
+    return std::to_string(stats.states) + " states, " + std::to_string(stats.transitions) + " transitions, " +
+           std::to_string(stats.pruned) + " pruned, depth " + std::to_string(stats.maxDepthReached) +
+           (stats.failedSteps ? ", " + std::to_string(stats.failedSteps) + " failed" : "") +
+           (stats.complete ? "" : ", incomplete");
+}
+
+int main() {
+    int failures = 0;
+    StateExplorer explorer(EXPLORE_AST.data(), EXPLORE_AST.size(), interpreterOptions());
+
+    ExplorationOptions digitalOnly;
+    digitalOnly.maxDepth = 12;
+    digitalOnly.analogValues = {0};
+    ExplorationStats stats = explorer.explore(digitalOnly);
+    failures += check(stats.complete && stats.states == 10 && stats.maxDepthReached == 8 && stats.failedSteps == 0,
+                      "digital only: " + describe(stats));
+    failures += check(stats.pruned == stats.transitions - stats.states, "every other transition was pruned");
+    failures += check(explorer.getState(1).pins.at(13).mode == 1 && explorer.getState(1).pins.at(13).value == -1,
+                      "pin shadow after setup(): 13 is OUTPUT, not written");
+
+    ExplorationOptions withAnalog;
+    withAnalog.maxDepth = 12;
+    stats = explorer.explore(withAnalog);
+    failures += check(stats.complete && stats.states == 28, "digital + analog: " + describe(stats));
+
+    ExplorationOptions shallow;
+    shallow.maxDepth = 2;
+    shallow.analogValues = {0};
+    stats = explorer.explore(shallow);
+    failures += check(stats.complete && stats.maxDepthReached == 2 && stats.states < 10,
+                      "depth bound 2: " + describe(stats));
+
+    // Stop at the first state with fault set; breadth-first gives the shortest input path
+    size_t faultState = ExploredState::NO_PARENT;
+    explorer.setTransitionCallback([&](const StateExplorer::Transition& t) {
+        if (!t.newState || std::get<int32_t>(t.interpreter.getVariableValue("fault")) == 0) return true;
+        faultState = t.to;
+        return false;
+    });
+    stats = explorer.explore(digitalOnly);
+    std::string buttons;
+    if (faultState != ExploredState::NO_PARENT) {
+        for (const auto& step : explorer.pathTo(faultState)) {
+            for (const auto& query : step) {
+                if (query.kind == InputQuery::Kind::DIGITAL_READ) buttons += std::to_string(query.result) + " ";
+            }
+        }
+    }
+    failures += check(stats.stopped && buttons == "1 0 1 0 1 ", "fault reached by buttons " + buttons);
+    explorer.setTransitionCallback(nullptr);
+
+    // Throughput: 256 analog levels make 512 transitions per state
+    ExplorationOptions wide;
+    wide.maxDepth = 12;
+    wide.analogValues.clear();
+    for (int32_t v = 0; v < 1024; v += 4) wide.analogValues.push_back(v);
+    stats = explorer.explore(wide);
+    failures += check(stats.complete && stats.states == 28, "256 analog levels: " + describe(stats));
+    std::cout << "  INFO  " << static_cast<long>(stats.transitions / (stats.seconds > 0 ? stats.seconds : 1e-9))
+              << " transitions/s\n";
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,376 @@
+// Unit Test Sketch Suite Version: 1
+//
+// Sketches the C++ unit tests run, one per fixture. Exported to
+// tests/fixtures/<name>.ast by generate_unit_fixtures.js and loaded with
+// loadFixture("<name>") (unit_test_helpers.hpp), so each test's AST is the
+// parse of the source below. `exportOptions` are passed to exportCompactAST
+// (and to parse) as given.
+
+// Line numbers matter: source_positions_test checks statements against them
+const positionsSketch = `#define LED 13
+int counter = 0;
+
+void setup() {
+  pinMode(LED, OUTPUT);
+}
+
+void loop() {
+  counter++;
+  if (counter > 1) {
+    digitalWrite(LED, HIGH);
+  }
+  int y = missing + 1;
+}
+`;
+
+// Line numbers matter: errors raised after a call, a block or a return
+const nestedPositionsSketch = `int zero = 0;
+int y = 0;
+int f() {
+  int local = 1;
+  return local;
+}
+void setup() {
+  y = f() / zero;
+  for (int i = 0; i < 10 / (1 - i); i++) {
+    y++;
+  }
+}
+void loop() {}
+`;
+
+const unitSketches = [
+  { "name": "ast_canonicalizer", "content": `struct Point { int x; int y; };
+static int global_counter = 0;
+static void incrementCounter() { global_counter++; }
+String vals = "xy";
+void setup() { Serial.begin(9600); }
+void loop() {
+  struct Point a, b;
+  a.x = 3; b.x = a.x + 1;
+  incrementCounter();
+  Serial.print('A');
+  int n = Serial.print('B');
+  for (char v : vals) { Serial.print('C'); }
+  ledPin = 13;
+  Serial.println(b.x);
+}
+` },
+  { "name": "buffer_builtins", "content": `char buf[8];
+char out[32];
+char tail[8];
+int v[5] = {5,3,9,1,7};
+float w[4] = {2.5, 0.25, 1.5, 0.75};
+int cmp(const void* a, const void* b) { return *(const int*)b - *(const int*)a; }
+int cmpf(const void* a, const void* b) {
+  float d = *(const float*)a - *(const float*)b;
+  return d < 0 ? -1 : (d > 0 ? 1 : 0);
+}
+void setup(){
+  strcpy(buf, "abc");
+  int l = strlen(buf);
+  strcat(buf, "de");
+  sprintf(out, "%s|%5.2f|%-4x|%c|%03d", buf, 3.14159, 255, 65, 7);
+  int s = strcmp(buf, "abcde");
+  dtostrf(2.5, 6, 2, out);
+  sprintf(tail, "%s", out + 3);
+  itoa(-42, buf, 10);
+  int k = atoi(buf);
+  qsort(v, 5, sizeof(int), cmp);
+  qsort(w, 4, sizeof(float), cmpf);
+  snprintf(buf, 4, "%d", 123456);
+  memset(buf, 'x', 10);
+  int c = memcmp(v, v, 5);
+  char* r = strcpy(buf, "ok");
+  strcat(r, "!");
+  memset(buf, 'y', -1);
+  char* lit = "hi";
+  strcpy(lit, "yo");
+  strcpy(lit, "toolong");
+}
+void loop(){}
+` },
+  { "name": "debugger", "content": `int counter = 0;
+int total = 0;
+int accumulate(int n) {
+  int sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += i;
+  }
+  return sum;
+}
+void setup() { Serial.begin(9600); }
+void loop() {
+  counter++;
+  total = total + accumulate(counter);
+  Serial.println(total);
+}
+` },
+  { "name": "direct_call", "content": `int total = 0;
+int computeChecksum(int buf[], int len) {
+  int sum = 0;
+  for (int i = 0; i < len; i++) { sum += buf[i]; }
+  return sum & 255;
+}
+int addToTotal(int x) {
+  total += x;
+  return total;
+}
+void blink(int pin) {
+  digitalWrite(pin, HIGH);
+}
+void setup() { pinMode(13, OUTPUT); }
+void loop() { blink(13); }
+` },
+  { "name": "direct_call_bad_global", "content": `int ok = 1;
+int bad = missing + 1;
+int readOk() { return ok; }
+void setup() {}
+void loop() {}
+` },
+  { "name": "fast_assignment", "content": `int counts[4] = {1, 2, 3, 4};
+unsigned long ticks = 0;
+byte mask = 1;
+int total = 0;
+void setup() { Serial.begin(9600); }
+void loop() {
+  counts[1] += 10; counts[2]++; --counts[3];
+  ticks--; mask <<= 3; mask |= 2;
+  total += counts[1] - counts[0];
+  int old = total++;
+  Serial.println(counts[1]); Serial.println(counts[2]); Serial.println(counts[3]);
+  Serial.println(ticks); Serial.println(mask); Serial.println(old); Serial.println(total);
+}
+` },
+  { "name": "fast_assignment_bounds", "content": `int counts[4] = {1, 2, 3, 4};
+float levels[2] = {0.5, 1.5};
+void setup() {
+  Serial.begin(9600);
+  int i = 4;
+  counts[i] = 9;
+  counts[-1] += 5;
+  levels[2] = 2.5;
+  counts[0] = 7;
+  Serial.println(counts[0]);
+}
+void loop() {}
+` },
+  { "name": "float_model", "content": `float big = 16777216.0;
+float f = 0;
+double d = 1;
+float samples[3] = {0.5, 0.25, 0.125};
+float acc = 0.0;
+void setup() { Serial.begin(9600); d = d / 10; f = d; }
+void loop() {
+  big = big + 1;
+  Serial.println(big - 16777216);
+  Serial.println((d - f) * 1000000000);
+  acc += samples[0] + samples[1] * samples[2];
+  Serial.println(acc);
+  samples[2]++;
+  Serial.println(samples[2]);
+  Serial.println(sizeof(double));
+  Serial.println((f * 3.0 - 0.3) * 1000000000);
+  Serial.println((0.1f * 3 - 0.3) * 1000000000);
+}
+` },
+  { "name": "function_tiers", "content": `int total = 0;
+
+int scale(int v, int factor = 2) {
+  return v * factor;
+}
+
+int add(int a, int b) {
+  return a + b;
+}
+
+void accumulate(int n) {
+  for (int i = 0; i < n; i++) {
+    total = add(total, scale(i));
+  }
+}
+
+void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  accumulate(3);
+  Serial.println(total);
+}
+` },
+  { "name": "function_tiers_shadow", "content": `int add(int a, int b) { return a + b; }
+int mul(int a, int b) { return a * b; }
+int total = 1;
+void bump() { add(total, 1); }
+int twice(int v) { return add(v, v); }
+void step() {
+  bump();
+  total = twice(total);
+  int (*add)(int, int);
+  add = &mul;
+  total = add(total, 3);
+  add(total, 4);
+  bump();
+  total = twice(total);
+}
+void setup() { Serial.begin(9600); }
+void loop() { step(); Serial.println(total); }
+` },
+  { "name": "green_thread_tasks", "content": `int ticks = 0;
+TaskHandle_t blinkHandle;
+void blinkTask(void *param) {
+  for (;;) {
+    digitalWrite(2, HIGH); vTaskDelay(100 / portTICK_PERIOD_MS);
+    digitalWrite(2, LOW);  vTaskDelay(100 / portTICK_PERIOD_MS);
+  }
+}
+void sensorTask(void *param) {
+  while (true) { int v = analogRead(A0); ticks++; vTaskDelay(pdMS_TO_TICKS(250)); }
+}
+void setup() {
+  Serial.begin(9600);
+  xTaskCreate(blinkTask, "blink", 2048, NULL, 1, &blinkHandle);
+  xTaskCreatePinnedToCore(sensorTask, "sensor", 4096, NULL, 2, NULL, 1);
+}
+void loop() { Serial.println(ticks); delay(500); }
+` },
+  { "name": "green_thread_delete", "content": `TaskHandle_t workerHandle = NULL;
+int workerRuns = 0;
+int depth(int n) { if (n == 0) return 0; return 1 + depth(n - 1); }
+void worker(void *param) {
+  TickType_t lastWake = xTaskGetTickCount();
+  while (true) { workerRuns++; Serial.println(xTaskGetTickCount()); vTaskDelayUntil(&lastWake, 30); }
+}
+void oneShot(void *param) { Serial.println(depth(60)); vTaskDelete(NULL); Serial.println(-1); }
+void setup() {
+  Serial.begin(115200);
+  xTaskCreate(worker, "worker", 2048, NULL, 1, &workerHandle);
+  xTaskCreate(oneShot, "oneShot", 2048, NULL, 3, NULL);
+}
+void loop() { delay(100); if (workerRuns >= 3) { vTaskDelete(workerHandle); } Serial.println(workerRuns); }
+` },
+  { "name": "integer_model", "content": `byte counter = 250;
+int total = 32000;
+unsigned int u = 0;
+int a = 300;
+int b = 200;
+long p = 0;
+byte c = 200;
+byte arr[2] = {250, 0};
+void setup() {
+  Serial.begin(9600);
+  for (int i = 0; i < 10; i++) { counter++; }
+  Serial.println(counter);
+  total = total + 1000;       Serial.println(total);
+  u = u - 1;                  Serial.println(u);
+  p = a * b;                  Serial.println(p);
+  p = (long)a * b;            Serial.println(p);
+  Serial.println(sizeof(int));
+  Serial.println(7 / 2);
+  c += 100;                   Serial.println(c);
+  arr[0] += 10;               Serial.println(arr[0]);
+}
+void loop() {}
+` },
+  { "name": "native_library", "content": `Counter counter = Counter(5);
+void setup() { Serial.begin(9600); }
+void loop() {
+  counter.increment();
+  counter.add(10);
+  Serial.println(counter.value());
+  Serial.println(counter.reading());
+}
+` },
+  { "name": "native_library_rebind", "content": `Counter a = Counter(1);
+Counter b = Counter(100);
+void setup() { Serial.begin(9600); }
+void loop() {
+  Serial.println(a.value());
+  a = b;
+  Serial.println(a.value());
+}
+` },
+  { "name": "program_cache_a", "content": `int marker = 1; void setup() { Serial.begin(9600); Serial.println(marker); } void loop() {}
+` },
+  { "name": "program_cache_b", "content": `int marker = 2; void setup() { Serial.begin(9600); Serial.println(marker); } void loop() {}
+` },
+  { "name": "read_prefetch", "content": `void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  int a = analogRead(A0);
+  if (a > 500) {
+    int d = digitalRead(2);
+    Serial.println(d);
+  }
+  unsigned long t = millis();
+  Serial.println(a + t);
+}
+` },
+  { "name": "read_prefetch_resume", "content": `int a = 0;
+unsigned long t = 0;
+void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  a = 7;
+  a = analogRead(A0);
+  t = millis();
+  Serial.println(a + t);
+}
+` },
+  { "name": "signal_provider", "content": `void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+  int level = analogRead(A0);
+  unsigned long width = pulseIn(7, HIGH);
+  Serial.println(level);
+  Serial.println(width);
+  delay(250);
+}
+` },
+  { "name": "source_positions", "exportOptions": { "sourcePositions": true, "sourceFile": "Positions.ino" },
+    "content": positionsSketch },
+  { "name": "source_positions_plain", "content": positionsSketch },
+  { "name": "source_positions_nested", "exportOptions": { "sourcePositions": true, "sourceFile": "C:\\sketches\\Nested.ino" },
+    "content": nestedPositionsSketch },
+  { "name": "state_explorer", "content": `int ledOn = 0;
+int lastButton = 0;
+int presses = 0;
+int fault = 0;
+int level = 0;
+void setup() { pinMode(2, INPUT); pinMode(13, OUTPUT); }
+void loop() {
+  int b = digitalRead(2);
+  if (b == 1 && lastButton == 0) {
+    ledOn = 1 - ledOn;
+    digitalWrite(13, ledOn);
+    if (presses < 3) presses++;
+  }
+  lastButton = b;
+  if (presses == 3) fault = 1;
+  int a = analogRead(A0);
+  level = a > 600 ? 2 : (a > 300 ? 1 : 0);
+  analogWrite(9, level * 100);
+}
+` },
+  { "name": "worker_pool_oversized", "content": `int samples[2000];
+void setup() { Serial.begin(9600); }
+void loop() {}
+` },
+  { "name": "worker_pool_spin", "content": `int x = 0;
+void setup() { Serial.begin(9600); }
+void loop() { while (true) { x = analogRead(A0); } }
+` }
+];
+
+if (typeof module !== 'undefined' && module.exports) {
+    module.exports = {
+        unitSketches
+    };
+}
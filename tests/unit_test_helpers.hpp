@@ -0,0 +1,74 @@
+/**
+ * unit_test_helpers.hpp - Shared helpers for the C++ unit tests
+ *
+ * - check() prints one PASS/FAIL line and returns the failure count (0 or 1)
+ * - CollectingCallback keeps every emitted command; contains() searches them
+ * - loadFixture() reads a sketch exported by tests/generate_unit_fixtures.js
+ *   from tests/unit_sketches.js; loadASTFile() reads any CompactAST file
+ *
+ * UNIT_FIXTURE_DIR is set by CMakeLists.txt for every test target.
+ */
+
+#pragma once
+
+#include "ASTInterpreter.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef UNIT_FIXTURE_DIR
+#define UNIT_FIXTURE_DIR "tests/fixtures"
+#endif
+
+namespace arduino_interpreter {
+namespace testing {
+
+inline int check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  PASS  " : "  FAIL  ") << what << "\n";
+    return ok ? 0 : 1;
+}
+
+class CollectingCallback : public CommandCallback {
+public:
+    std::vector<std::string> commands;
+    void onCommand(const std::string& jsonCommand) override {
+        commands.push_back(jsonCommand);
+    }
+};
+
+inline bool contains(const std::vector<std::string>& commands, const std::string& needle) {
+    for (const auto& cmd : commands) {
+        if (cmd.find(needle) != std::string::npos) return true;
+    }
+    return false;
+}
+
+inline std::vector<uint8_t> loadASTFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) return {};
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> buffer(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(buffer.data()), size);
+    return buffer;
+}
+
+/**
+ * The CompactAST of unit_sketches.js entry `name`; exits if it is missing
+ * (run node tests/generate_unit_fixtures.js)
+ */
+inline std::vector<uint8_t> loadFixture(const std::string& name) {
+    std::string path = std::string(UNIT_FIXTURE_DIR) + "/" + name + ".ast";
+    std::vector<uint8_t> ast = loadASTFile(path);
+    if (ast.empty()) {
+        std::cerr << "ERROR: cannot read fixture " << path << "\n";
+        std::exit(1);
+    }
+    return ast;
+}
+
+} // namespace testing
+} // namespace arduino_interpreter
@@ -0,0 +1,73 @@
+/**
+ * value_serialization_test.cpp
+ *
+ * Pins the bytes produced by commandValueToJsonString / appendCommandValueJson
+ * for every CommandValue alternative, so the buffer-direct formatter keeps
+ * matching the stream-based output the reference command streams were
+ * recorded with: scalars as std::to_string (%f), array elements as
+ * operator<< (%g).
+ *
+ * Usage: ./value_serialization_test
+ */
+
+#include "ASTInterpreter.hpp"
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+
+static int check(const CommandValue& value, const std::string& expected, const std::string& what) {
+    std::string appended = "prefix:";
+    appendCommandValueJson(appended, value);
+    std::string json = commandValueToJsonString(value);
+    bool ok = json == expected && appended == "prefix:" + expected;
+    std::cout << (ok ? "  PASS  " : "  FAIL  ") << what;
+    if (!ok) std::cout << " (got " << json << ", expected " << expected << ")";
+    std::cout << "\n";
+    return ok ? 0 : 1;
+}
+
+// What operator<< produced for an array element
+static std::string streamed(double v) {
+    std::ostringstream os;
+    os << v;
+    return os.str();
+}
+
+int main() {
+    int failures = 0;
+
+    failures += check(std::monostate{}, "null", "monostate");
+    failures += check(true, "true", "bool");
+    failures += check(int32_t(-2147483647 - 1), "-2147483648", "int32 minimum");
+    failures += check(uint32_t(4294967295u), "4294967295", "uint32 maximum");
+    failures += check(0.1, std::to_string(0.1), "double 0.1");
+    failures += check(-0.0, std::to_string(-0.0), "negative zero");
+    failures += check(1e300, std::to_string(1e300), "double beyond the fixed-format buffer");
+    failures += check(std::numeric_limits<double>::infinity(), std::to_string(std::numeric_limits<double>::infinity()),
+                      "infinity");
+    failures += check(std::string("hi"), "\"hi\"", "string");
+
+    failures += check(std::vector<int32_t>{1, -2, 300000}, "[1,-2,300000]", "int array");
+    failures += check(std::vector<int32_t>{}, "[]", "empty array");
+
+    std::vector<double> doubles{0.5, 1.0 / 3, 1e-5, 123456789.0, -2.0};
+    std::string expected = "[";
+    for (size_t i = 0; i < doubles.size(); i++) {
+        if (i > 0) expected += ",";
+        expected += streamed(doubles[i]);
+    }
+    expected += "]";
+    failures += check(doubles, expected, "double array");
+
+    failures += check(std::vector<std::string>{"a", "b"}, "[\"a\",\"b\"]", "string array");
+    failures += check(std::vector<std::vector<int32_t>>{{1, 2}, {3}}, "[[1,2],[3]]", "2D int array");
+    failures += check(std::vector<std::vector<double>>{{0.25}, {1e-7, 2.5}},
+                      "[[" + streamed(0.25) + "],[" + streamed(1e-7) + "," + streamed(2.5) + "]]",
+                      "2D double array");
+
+    return failures == 0 ? 0 : 1;
+}
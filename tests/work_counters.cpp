@@ -0,0 +1,308 @@
+/**
+ * work_counters.cpp
+ *
+ * Records the interpreter's deterministic work-unit counters (WorkCounters.hpp)
+ * for every test_data example and compares them with a checked-in baseline.
+ * Unlike wall time and RSS, the counts are the same on every run of the same
+ * build, so any difference is a change in work done.
+ *
+ * Usage: ./work_counters [test_data_dir] [--record FILE | --check FILE]
+ *                        [--tolerance PCT] [--only N] [--async]
+ *   --record FILE    Write the counts of every test to FILE (the baseline)
+ *   --check FILE     Compare with FILE; print every per-test, per-counter delta
+ *   --tolerance PCT  With --check, accept changes up to PCT percent (default 0)
+ *   --only N         Run testN only (prints its counts)
+ *   --async          Run with asyncEmission; --check then compares only
+ *                    bytesFormatted and commandsEmitted, which must match the
+ *                    synchronous baseline
+ *
+ * RUN: every test_data/testN_js.ast, as extract_cpp_commands runs it (sync
+ * mode, DeterministicDataProvider, TEST_MAX_LOOP_ITERATIONS). Each sketch runs
+ * twice and the second run is counted: first-use caches are warm by then, so a
+ * test's counts don't depend on which tests ran before it. Heap allocations
+ * come from this file's operator new.
+ *
+ * BASELINE: one line per test and phase (program, setup, loop):
+ *   test12 loop <nodesVisited> <scopeLookups> ... (in WorkUnit order)
+ * Counts depend on the toolchain and standard library; re-record with
+ * --record after an intended change and commit the file with it.
+ *
+ * Exit code 1 on any delta beyond the tolerance, or a test added or missing;
+ * 77 (skipped) if the library was built without ENABLE_WORK_COUNTERS.
+ */
+
+#include "ASTInterpreter.hpp"
+#include "DeterministicDataProvider.hpp"
+#include "ExecutionTracer.hpp"
+#include "WorkCounters.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+
+// =============================================================================
+// HEAP ACCOUNTING
+// =============================================================================
+
+void* operator new(std::size_t size) {
+    countHeapAllocation();
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// =============================================================================
+// RUNNING
+// =============================================================================
+
+class NullCallback : public CommandCallback {
+public:
+    void onCommand(const std::string&) override {}
+};
+
+static std::vector<uint8_t> loadASTFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) return {};
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> buffer(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(buffer.data()), size);
+    return buffer;
+}
+
+static WorkCounters runOnce(const std::vector<uint8_t>& ast, bool async) {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = Config::TEST_MAX_LOOP_ITERATIONS;
+    opts.syncMode = true;
+    opts.asyncEmission = async;
+
+    TRACE_CLEAR();   // The trace is per thread; earlier tests must not pay for this one
+    NullCallback callback;
+    DeterministicDataProvider dataProvider;
+    ASTInterpreter interpreter(ast.data(), ast.size(), opts);
+    interpreter.setCommandCallback(&callback);
+    interpreter.setSyncDataProvider(&dataProvider);
+    interpreter.start();
+    return interpreter.getWorkCounters();
+}
+
+static WorkCounters measure(const std::vector<uint8_t>& ast, bool async) {
+    runOnce(ast, async);
+    return runOnce(ast, async);
+}
+
+// =============================================================================
+// BASELINE FILE
+// =============================================================================
+
+using Baseline = std::map<int, WorkCounters>;   // Test number -> counts
+
+static void writeBaseline(std::ostream& out, const Baseline& baseline) {
+    out << "# Work-unit baseline: tests/work_counters.cpp --record\n";
+    out << "# test phase";
+    for (size_t u = 0; u < WORK_UNIT_COUNT; u++) out << " " << workUnitName(static_cast<WorkUnit>(u));
+    out << "\n";
+    for (const auto& [test, counters] : baseline) {
+        for (size_t p = 0; p < WORK_PHASE_COUNT; p++) {
+            out << "test" << test << " " << workPhaseName(static_cast<WorkPhase>(p));
+            for (size_t u = 0; u < WORK_UNIT_COUNT; u++) out << " " << counters.counts[p][u];
+            out << "\n";
+        }
+    }
+}
+
+static bool readBaseline(const std::string& path, Baseline& baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        std::string test, phase;
+        fields >> test >> phase;
+        size_t p = 0;
+        while (p < WORK_PHASE_COUNT && phase != workPhaseName(static_cast<WorkPhase>(p))) p++;
+        if (test.compare(0, 4, "test") != 0 || p == WORK_PHASE_COUNT) {
+            std::cerr << "ERROR: " << path << ":" << lineNumber << ": bad line\n";
+            return false;
+        }
+
+        WorkCounters& counters = baseline[std::atoi(test.c_str() + 4)];
+        for (size_t u = 0; u < WORK_UNIT_COUNT; u++) {
+            if (!(fields >> counters.counts[p][u])) {
+                std::cerr << "ERROR: " << path << ":" << lineNumber << ": expected " << WORK_UNIT_COUNT << " counts\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// COMPARISON
+// =============================================================================
+
+static double percentChange(uint64_t before, uint64_t after) {
+    if (before == 0) return after == 0 ? 0.0 : INFINITY;
+    return 100.0 * (static_cast<double>(after) - static_cast<double>(before)) / static_cast<double>(before);
+}
+
+static bool isOutputUnit(size_t unit) {
+    return unit == static_cast<size_t>(WorkUnit::BYTES_FORMATTED) ||
+           unit == static_cast<size_t>(WorkUnit::COMMANDS_EMITTED);
+}
+
+/**
+ * Prints every changed count; returns the number beyond the tolerance.
+ * With outputOnly, counts other than bytesFormatted/commandsEmitted are skipped.
+ */
+static int compare(const Baseline& expected, const Baseline& actual, double tolerance, bool outputOnly) {
+    int regressions = 0;
+    uint64_t totalBefore[WORK_UNIT_COUNT] = {}, totalAfter[WORK_UNIT_COUNT] = {};
+
+    for (const auto& [test, before] : expected) {
+        auto found = actual.find(test);
+        if (found == actual.end()) {
+            std::cout << "  MISSING  test" << test << " (in the baseline, not in test_data)\n";
+            regressions++;
+            continue;
+        }
+        const WorkCounters& after = found->second;
+        for (size_t p = 0; p < WORK_PHASE_COUNT; p++) {
+            for (size_t u = 0; u < WORK_UNIT_COUNT; u++) {
+                if (outputOnly && !isOutputUnit(u)) continue;
+                uint64_t b = before.counts[p][u], a = after.counts[p][u];
+                totalBefore[u] += b;
+                totalAfter[u] += a;
+                if (a == b) continue;
+
+                double change = percentChange(b, a);
+                bool beyond = std::fabs(change) > tolerance;
+                if (beyond) regressions++;
+                std::printf("  %-8s test%-4d %-8s %-16s %12llu -> %12llu  %+lld (%+.1f%%)\n",
+                            beyond ? "CHANGED" : "within", test, workPhaseName(static_cast<WorkPhase>(p)),
+                            workUnitName(static_cast<WorkUnit>(u)), static_cast<unsigned long long>(b),
+                            static_cast<unsigned long long>(a),
+                            static_cast<long long>(a) - static_cast<long long>(b), change);
+            }
+        }
+    }
+    for (const auto& [test, counters] : actual) {
+        if (expected.count(test) == 0) {
+            std::cout << "  NEW      test" << test << " (not in the baseline)\n";
+            regressions++;
+        }
+    }
+
+    std::cout << "\nTotals over the tests in both:\n";
+    for (size_t u = 0; u < WORK_UNIT_COUNT; u++) {
+        if (outputOnly && !isOutputUnit(u)) continue;
+        std::printf("  %-16s %14llu -> %14llu  (%+.2f%%)\n", workUnitName(static_cast<WorkUnit>(u)),
+                    static_cast<unsigned long long>(totalBefore[u]),
+                    static_cast<unsigned long long>(totalAfter[u]), percentChange(totalBefore[u], totalAfter[u]));
+    }
+    return regressions;
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(int argc, char* argv[]) {
+    std::string dataDir = "test_data";
+    std::string recordPath, checkPath;
+    double tolerance = 0.0;
+    int only = -1;
+    bool async = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--record" && hasValue) {
+            recordPath = argv[++i];
+        } else if (arg == "--check" && hasValue) {
+            checkPath = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            tolerance = std::atof(argv[++i]);
+        } else if (arg == "--only" && hasValue) {
+            only = std::atoi(argv[++i]);
+        } else if (arg == "--async") {
+            async = true;
+        } else if (!arg.empty() && arg[0] != '-') {
+            dataDir = arg;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [test_data_dir] [--record FILE | --check FILE]"
+                      << " [--tolerance PCT] [--only N] [--async]\n";
+            return 2;
+        }
+    }
+
+    if (!ENABLE_WORK_COUNTERS) {
+        std::cout << "Work counters are compiled out (ENABLE_WORK_COUNTERS=0); nothing to measure\n";
+        return 77;
+    }
+
+    Baseline actual;
+    for (int n = only < 0 ? 0 : only; ; n++) {
+        auto ast = loadASTFile(dataDir + "/test" + std::to_string(n) + "_js.ast");
+        if (ast.empty()) break;
+        actual[n] = measure(ast, async);
+        if (only >= 0) break;
+    }
+    if (actual.empty()) {
+        std::cerr << "ERROR: No test ASTs found in " << dataDir << "\n";
+        return 1;
+    }
+
+    if (!recordPath.empty()) {
+        std::ofstream out(recordPath);
+        writeBaseline(out, actual);
+        if (!out) {
+            std::cerr << "ERROR: cannot write " << recordPath << "\n";
+            return 1;
+        }
+        std::cout << "Recorded " << actual.size() << " tests to " << recordPath << "\n";
+        return 0;
+    }
+
+    if (checkPath.empty()) {
+        writeBaseline(std::cout, actual);
+        return 0;
+    }
+
+    Baseline expected;
+    if (!readBaseline(checkPath, expected)) {
+        std::cerr << "ERROR: cannot read baseline " << checkPath << "\n";
+        return 1;
+    }
+    if (only >= 0) {
+        Baseline single;
+        if (expected.count(only)) single[only] = expected[only];
+        expected.swap(single);
+    }
+
+    std::cout << "Work units of " << actual.size() << " tests against " << checkPath << "\n";
+    int regressions = compare(expected, actual, tolerance, async);
+    if (regressions > 0) {
+        std::cout << "\nFAILED: " << regressions << " count(s) changed beyond " << tolerance
+                  << "% (re-record with --record if intended)\n";
+        return 1;
+    }
+    std::cout << "\nNo work-unit changes beyond " << tolerance << "%\n";
+    return 0;
+}
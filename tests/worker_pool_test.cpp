@@ -0,0 +1,195 @@
+/**
+ * worker_pool_test.cpp
+ *
+ * Verifies the forked WorkerPool: command streams read back from the
+ * shared-memory rings match in-process runs, and crashing or runaway jobs
+ * are isolated, reported and followed by a restarted worker.
+ *
+ * Usage: ./worker_pool_test [test_data_dir] [workers]
+ *
+ * TEST CASES:
+ * - every test_data/testN_js.ast, run in the pool and in-process
+ * - a data provider that aborts on its first analogRead (simulated crash)
+ * - a sketch that never leaves loop() ("worker_pool_spin" in
+ *   tests/unit_sketches.js), with a 1 second CPU limit
+ * - a 4 KB ring: a sketch whose array VAR_SET exceeds one record
+ *   ("worker_pool_oversized"), then test0 through the same worker
+ *
+ * EXPECTED RESULTS:
+ * - Identical command streams (generated pointer/object ids masked)
+ * - The aborting job is CRASHED with SIGABRT and a non-empty crash report
+ * - The runaway job is CPU_LIMIT; the jobs queued after both still complete
+ * - The oversized job is FAILED with an overflow error and only whole
+ *   records; test0 behind it completes with its usual stream
+ */
+
+#include "WorkerPool.hpp"
+#include "DeterministicDataProvider.hpp"
+#include "unit_test_helpers.hpp"
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace arduino_interpreter;
+using namespace arduino_interpreter::testing;
+
+static const std::vector<uint8_t> SPIN_AST = loadFixture("worker_pool_spin");
+static const std::vector<uint8_t> OVERSIZED_AST = loadFixture("worker_pool_oversized");
+
+// Stands in for an interpreter bug that takes the process down
+class AbortingDataProvider : public DeterministicDataProvider {
+public:
+    int32_t getAnalogReadValue(int32_t) override { std::abort(); }
+};
+
+static std::string maskGeneratedIds(const std::string& json) {
+    static const std::regex pointerIds("(f?ptr)_[0-9]+_[0-9a-z]+");
+    static const std::regex longNumbers("[0-9]{9,}");
+    return std::regex_replace(std::regex_replace(json, pointerIds, "$1"), longNumbers, "N");
+}
+
+static InterpreterOptions testOptions() {
+    InterpreterOptions opts;
+    opts.verbose = false;
+    opts.debug = false;
+    opts.maxLoopIterations = Config::TEST_MAX_LOOP_ITERATIONS;
+    opts.syncMode = true;
+    return opts;
+}
+
+static std::vector<std::string> runInProcess(const std::vector<uint8_t>& ast) {
+    CollectingCallback callback;
+    DeterministicDataProvider dataProvider;
+    {
+        ASTInterpreter interpreter(ast.data(), ast.size(), testOptions());
+        interpreter.setCommandCallback(&callback);
+        interpreter.setSyncDataProvider(&dataProvider);
+        interpreter.start();
+    }
+    std::vector<std::string> masked;
+    for (const auto& cmd : callback.commands) masked.push_back(maskGeneratedIds(cmd));
+    return masked;
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDir = argc > 1 ? argv[1] : "test_data";
+    size_t workerCount = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 4;
+
+    std::vector<std::vector<uint8_t>> asts;
+    for (int n = 0; ; n++) {
+        auto ast = loadASTFile(dataDir + "/test" + std::to_string(n) + "_js.ast");
+        if (ast.empty()) break;
+        asts.push_back(std::move(ast));
+    }
+    if (asts.empty()) {
+        std::cerr << "ERROR: No test ASTs found in " << dataDir << "\n";
+        return 1;
+    }
+
+    // One provider per job: a worker keeps its copy across the jobs it runs
+    std::vector<DeterministicDataProvider> dataProviders(asts.size() + 1);
+    AbortingDataProvider abortingProvider;
+
+    // Crash and runaway jobs sit in the middle so later jobs prove the restart
+    std::vector<BatchJob> jobs;
+    for (size_t i = 0; i < asts.size(); i++) {
+        if (i == asts.size() / 2) {
+            BatchJob crash;
+            crash.ast = SPIN_AST.data();
+            crash.astSize = SPIN_AST.size();
+            crash.options = testOptions();
+            crash.dataProvider = &abortingProvider;
+            jobs.push_back(crash);
+
+            BatchJob runaway = crash;
+            runaway.options.enforceLoopLimitsOnInternalLoops = false;
+            runaway.dataProvider = &dataProviders.back();
+            runaway.cpuLimitSeconds = 1;
+            jobs.push_back(runaway);
+        }
+        BatchJob job;
+        job.ast = asts[i].data();
+        job.astSize = asts[i].size();
+        job.options = testOptions();
+        job.dataProvider = &dataProviders[i];
+        jobs.push_back(job);
+    }
+    const size_t crashJob = asts.size() / 2;
+    const size_t runawayJob = crashJob + 1;
+
+    WorkerPoolOptions poolOptions;
+    poolOptions.workers = workerCount;
+    poolOptions.ringBytes = 64 * 1024;   // Small ring exercises wrap-around and backpressure
+    WorkerPool pool(poolOptions);
+
+    std::vector<std::vector<std::string>> streams(jobs.size());
+    auto results = pool.run(jobs, [&](size_t job, std::string_view json) {
+        if (job != runawayJob) streams[job].push_back(maskGeneratedIds(std::string(json)));
+    });
+
+    int failures = 0;
+    for (size_t job = 0, n = 0; job < jobs.size(); job++) {
+        if (job == crashJob || job == runawayJob) continue;
+        auto expected = runInProcess(asts[n]);
+        if (results[job].status != BatchResult::Status::COMPLETED || streams[job] != expected) {
+            failures++;
+            std::cout << "  FAIL  test" << n << ": " << expected.size() << " in-process vs "
+                      << streams[job].size() << " pooled commands (" << results[job].error << ")\n";
+        }
+        n++;
+    }
+    std::cout << asts.size() - failures << "/" << asts.size() << " pooled command streams identical\n";
+
+    const auto& crash = results[crashJob];
+    bool crashOk = crash.status == BatchResult::Status::CRASHED && crash.signal == SIGABRT &&
+                   !crash.lastCommands.empty();
+    std::cout << (crashOk ? "  PASS  " : "  FAIL  ") << "aborting job reported as crash: " << crash.error << "\n";
+    if (!crashOk) failures++;
+
+    const auto& runaway = results[runawayJob];
+    bool runawayOk = runaway.status == BatchResult::Status::CPU_LIMIT && !runaway.lastCommands.empty();
+    std::cout << (runawayOk ? "  PASS  " : "  FAIL  ") << "runaway job stopped by CPU limit after "
+              << runaway.commandCount << " commands\n";
+    if (!runawayOk) failures++;
+
+    bool restartsOk = pool.getWorkerRestarts() == 2;
+    std::cout << (restartsOk ? "  PASS  " : "  FAIL  ") << pool.getWorkerRestarts() << " worker restarts\n";
+    if (!restartsOk) failures++;
+
+    // Oversized command: FAILED with an explicit error, never a cut-off record
+    WorkerPoolOptions smallOptions;
+    smallOptions.workers = 1;
+    smallOptions.ringBytes = 4096;
+    WorkerPool smallPool(smallOptions);
+    DeterministicDataProvider smallProviders[2];
+    std::vector<BatchJob> smallJobs(2);
+    smallJobs[0].ast = OVERSIZED_AST.data();
+    smallJobs[0].astSize = OVERSIZED_AST.size();
+    smallJobs[1].ast = asts[0].data();
+    smallJobs[1].astSize = asts[0].size();
+    for (size_t i = 0; i < smallJobs.size(); i++) {
+        smallJobs[i].options = testOptions();
+        smallJobs[i].dataProvider = &smallProviders[i];
+    }
+    std::vector<std::vector<std::string>> smallStreams(smallJobs.size());
+    auto smallResults = smallPool.run(smallJobs, [&](size_t job, std::string_view json) {
+        smallStreams[job].push_back(maskGeneratedIds(std::string(json)));
+    });
+    bool wholeRecords = true;
+    for (const auto& cmd : smallStreams[0]) {
+        if (cmd.empty() || cmd.back() != '}' || cmd.find("samples") != std::string::npos) wholeRecords = false;
+    }
+    failures += check(smallResults[0].status == BatchResult::Status::FAILED &&
+                      smallResults[0].error.find("exceeds") != std::string::npos,
+                      "oversized command fails its job: " + smallResults[0].error);
+    failures += check(wholeRecords && !smallStreams[0].empty(), "stream stops at the last whole command");
+    failures += check(smallResults[1].status == BatchResult::Status::COMPLETED &&
+                      smallStreams[1] == runInProcess(asts[0]),
+                      "next job on the same worker completes through the 4 KB ring");
+
+    return failures == 0 ? 0 : 1;
+}